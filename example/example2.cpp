@@ -1,7 +1,11 @@
 
 #include "SDL.h"
 
+#include <sdl++/events.hpp>
 #include <sdl++/init.hpp>
+#include <sdl++/sprite_batch.hpp>
+
+#include <vector>
 
 int main(int, char**) {
     auto init = sdl::init_guard{sdl::init_flags::everything};
@@ -13,12 +17,26 @@ int main(int, char**) {
     auto renderer = SDL_CreateRenderer(
         window, 0, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
 
+    // A 16x16 white square, drawn in a few shared tints
+    auto texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                                     SDL_TEXTUREACCESS_STATIC, 16, 16);
+    const std::vector<Uint32> white(16 * 16, 0xFFFFFFFF);
+    SDL_UpdateTexture(texture, nullptr, white.data(), 16 * sizeof(Uint32));
+
+    const SDL_Color tints[] = {{255, 64, 0, 255},
+                               {255, 192, 0, 255},
+                               {0, 160, 255, 255},
+                               {160, 64, 255, 255}};
+    constexpr int tint_count = sizeof(tints) / sizeof(tints[0]);
+
+    auto pump = sdl::event_pump{};
+    auto batch = sdl::sprite_batch{};
+    int frame = 0;
+
     bool quit = false;
     while (!quit) {
-        SDL_Event event;
-
-        // Enter the event loop
-        while (SDL_PollEvent(&event)) {
+        // Handle all of this frame's events
+        for (const SDL_Event& event : pump.poll()) {
             switch (event.type) {
             case SDL_QUIT:
                 quit = true;
@@ -32,9 +50,27 @@ int main(int, char**) {
         // Draw a frame
         SDL_SetRenderDrawColor(renderer, 0, 128, 0, 255);
         SDL_RenderClear(renderer);
+
+        // Diagonal stripes which move over time. Sprites sharing a tint
+        // are drawn together, so the tint changes only once per stripe
+        for (int t = 0; t < tint_count; t++) {
+            batch.set_tint(tints[t]);
+            for (int y = 0; y < 600; y += 20) {
+                for (int x = 0; x < 800; x += 20) {
+                    if (((x + y) / 20 + frame / 8) % tint_count != t) {
+                        continue;
+                    }
+                    batch.draw(texture, SDL_Rect{x + 2, y + 2, 16, 16});
+                }
+            }
+        }
+        batch.submit(renderer);
+        ++frame;
+
         SDL_RenderPresent(renderer);
     }
 
+    SDL_DestroyTexture(texture);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
 
@@ -0,0 +1,62 @@
+
+// Packs files into an sdl++ asset archive, for use with sdl::asset_archive.
+//
+// Usage: pack_assets [-z] [-a alignment] output.pak file...
+//
+// Each file is stored under the name given on the command line. With -z,
+// files are compressed where this makes them smaller.
+
+#include "SDL.h"
+
+#include <sdl++/asset_archive.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv) {
+    bool compress = false;
+    size_t alignment = 16;
+
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        if (std::strcmp(argv[arg], "-z") == 0) {
+            compress = true;
+        } else if (std::strcmp(argv[arg], "-a") == 0 && arg + 1 < argc) {
+            alignment = std::strtoul(argv[++arg], nullptr, 10);
+        } else {
+            break;
+        }
+    }
+
+    if (argc - arg < 2 || alignment == 0 ||
+        (alignment & (alignment - 1)) != 0) {
+        std::fprintf(stderr, "Usage: %s [-z] [-a alignment] output.pak "
+                             "file...\n",
+                     argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const char* output = argv[arg++];
+    sdl::asset_archive_builder builder{alignment};
+
+    for (; arg < argc; arg++) {
+        const auto r = builder.try_add_file(argv[arg], argv[arg], compress);
+        if (!r) {
+            std::fprintf(stderr, "Error reading %s: %s\n", argv[arg],
+                         r.error_message());
+            return EXIT_FAILURE;
+        }
+    }
+
+    const auto r = builder.try_write(output);
+    if (!r) {
+        std::fprintf(stderr, "Error writing %s: %s\n", output,
+                     r.error_message());
+        return EXIT_FAILURE;
+    }
+
+    std::printf("Wrote %u assets to %s\n",
+                static_cast<unsigned>(builder.size()), output);
+    return EXIT_SUCCESS;
+}
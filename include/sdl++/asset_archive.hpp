@@ -0,0 +1,691 @@
+/*!
+  @file asset_archive.hpp
+  Simple DirectMedia Layer C++ Bindings
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDLXX_ASSET_ARCHIVE_HPP
+#define SDLXX_ASSET_ARCHIVE_HPP
+
+#include "SDL_rwops.h"
+
+#include "detail/lz.hpp"
+#include "detail/mapped_file.hpp"
+#include "macros.hpp"
+#include "result.hpp"
+#include "rwops.hpp"
+#include "stdinc.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace sdl {
+
+/*!
+ @defgroup AssetArchive Asset Archives
+
+ An asset archive packs many files into a single read-only file, which is
+ memory-mapped when opened. Opening an asset is then a hash table lookup
+ rather than a filesystem operation, and uncompressed assets can be used in
+ place without copying.
+
+ Archives are created with `sdl::asset_archive_builder`, either at runtime
+ or using the `pack_assets` example program, and read with
+ `sdl::asset_archive`:
+
+ ```
+ sdl::paths paths{"My Company", "My Game"};
+ sdl::path_buffer<> buf;
+ sdl::asset_archive assets{paths.join_base(buf, "assets.pak").value().data()};
+
+ // A zero-copy view of an uncompressed asset
+ sdl::span<const sdl::uint8_t> level = assets.view("levels/level1.map");
+
+ // An SDL_RWops stream, for APIs such as SDL_LoadBMP_RW()
+ auto bmp = assets.open_rwops("textures/hero.bmp");
+ SDL_Surface* hero = SDL_LoadBMP_RW(bmp.get(), 0);
+ ```
+
+ File format
+ -----------
+
+ All integers are little-endian. The file begins with a 32-byte header:
+
+ | Offset | Type     | Contents                                        |
+ |--------|----------|-------------------------------------------------|
+ | 0      | char[8]  | The magic string `SDLXXPAK`                     |
+ | 8      | uint32   | Format version, currently 1                     |
+ | 12     | uint32   | Number of entries                               |
+ | 16     | uint32   | Number of bits of the hash used for buckets     |
+ | 20     | uint32   | Alignment of entry data                         |
+ | 24     | uint64   | Offset of the index                             |
+
+ Entry data follows the header, each entry starting at a multiple of the
+ alignment. The index consists of `2^bits + 1` uint32 bucket start
+ positions, padded to a multiple of eight bytes, then the entries sorted by
+ hash, then the entry names. Each entry is 40 bytes:
+
+ | Offset | Type     | Contents                                        |
+ |--------|----------|-------------------------------------------------|
+ | 0      | uint64   | 64-bit FNV-1a hash of the name                  |
+ | 8      | uint64   | Offset of the data from the start of the file   |
+ | 16     | uint64   | Uncompressed size                               |
+ | 24     | uint64   | Stored size; if less than the uncompressed size |
+ |        |          | the data is compressed                          |
+ | 32     | uint32   | Offset of the name from the start of the names  |
+ | 36     | uint32   | Length of the name                              |
+
+ The entries whose hashes have the same top `bits` bits form a bucket; the
+ bucket table gives the index of the first entry in each bucket, and the
+ final value is the number of entries. With the number of buckets chosen to
+ be at least the number of entries, a lookup examines one entry on average.
+
+ @{
+ */
+
+namespace detail {
+
+    constexpr char asset_archive_magic[8] = {'S', 'D', 'L', 'X',
+                                             'X', 'P', 'A', 'K'};
+    constexpr uint32_t asset_archive_version = 1;
+    constexpr size_t asset_header_size = 32;
+    constexpr size_t asset_entry_size = 40;
+    constexpr uint32_t asset_max_bucket_bits = 24;
+
+    inline uint64_t asset_name_hash(string_view name) noexcept {
+        uint64_t hash = 14695981039346656037ull;
+        for (char c : name) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    inline uint32_t asset_bucket_bits(size_t count) noexcept {
+        uint32_t bits = 0;
+        while (bits < asset_max_bucket_bits && (size_t{1} << bits) < count) {
+            ++bits;
+        }
+        return bits;
+    }
+
+    inline uint64_t asset_bucket(uint64_t hash, uint32_t bits) noexcept {
+        return bits == 0 ? 0 : hash >> (64 - bits);
+    }
+
+    inline uint32_t load_le32(const uint8_t* p) noexcept {
+        return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 |
+               uint32_t(p[3]) << 24;
+    }
+
+    inline uint64_t load_le64(const uint8_t* p) noexcept {
+        return uint64_t(load_le32(p)) | uint64_t(load_le32(p + 4)) << 32;
+    }
+
+    inline void store_le32(std::vector<uint8_t>& out, uint32_t v) {
+        for (int i = 0; i < 4; i++) {
+            out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+        }
+    }
+
+    inline void store_le64(std::vector<uint8_t>& out, uint64_t v) {
+        store_le32(out, static_cast<uint32_t>(v));
+        store_le32(out, static_cast<uint32_t>(v >> 32));
+    }
+
+    constexpr uint64_t align_up(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    // An SDL_RWops close function for memory streams which own their buffer
+    inline int SDLCALL close_owning_mem_rwops(SDL_RWops* rw) {
+        ::SDL_free(rw->hidden.mem.base);
+        ::SDL_FreeRW(rw);
+        return 0;
+    }
+
+    // SDL refuses to create a memory stream of size zero, so open a stream
+    // over a one-byte buffer and then move its end back to the start
+    inline SDL_RWops* open_empty_rwops() {
+        static const uint8_t byte = 0;
+        SDL_RWops* rw = ::SDL_RWFromConstMem(&byte, 1);
+        if (rw) { rw->hidden.mem.stop = rw->hidden.mem.base; }
+        return rw;
+    }
+
+} // end namespace detail
+
+/*!
+ Information about an entry in an `sdl::asset_archive`
+ */
+struct asset_info {
+    //! The name of the asset
+    string_view name;
+    //! The size of the asset, in bytes
+    size_t size;
+    //! The number of bytes used to store the asset in the archive
+    size_t stored_size;
+
+    //! Returns true if the asset is stored compressed, in which case it
+    //! cannot be viewed in place
+    bool compressed() const noexcept { return stored_size < size; }
+};
+
+/*!
+ A read-only, memory-mapped archive of assets
+
+ Opening an archive maps the file into memory and validates its index, after
+ which looking up an asset by name takes constant time on average and does
+ not allocate. The views returned by `view()` refer directly into the
+ mapping and remain valid for the lifetime of the archive.
+
+ `asset_archive` is move-only. Its `const` members may be called from
+ multiple threads at once.
+ */
+class asset_archive {
+public:
+    /*!
+     Opens the archive at `path`
+     @throws sdl::error if the file could not be opened or is not a valid
+             archive
+     */
+    explicit asset_archive(const char* path)
+        : asset_archive(try_open(path).value()) {}
+
+    //! @overload
+    explicit asset_archive(const string& path) : asset_archive(path.c_str()) {}
+
+    /*!
+     Opens the archive at `path`, without throwing.
+     @returns An `asset_archive`, or a failed result if the file could not be
+              opened or is not a valid archive
+     */
+    static result<asset_archive> try_open(const char* path) {
+        auto file = detail::mapped_file::open(path);
+        if (!file) { return failure; }
+        asset_archive archive{std::move(*file)};
+        if (!archive.validate()) {
+            ::SDL_SetError("Not a valid sdl++ asset archive");
+            return failure;
+        }
+        return archive;
+    }
+
+    //! @overload
+    static result<asset_archive> try_open(const string& path) {
+        return try_open(path.c_str());
+    }
+
+    //! Move constructor
+    asset_archive(asset_archive&&) noexcept = default;
+
+    //! Move assignment operator
+    asset_archive& operator=(asset_archive&&) noexcept = default;
+
+    //! Returns the number of assets in the archive
+    size_t size() const noexcept { return count; }
+
+    //! Returns true if the archive contains an asset called `name`
+    bool contains(string_view name) const noexcept {
+        return find_index(name) != not_found;
+    }
+
+    //! Returns information about the asset called `name`, or `nullopt` if
+    //! there is no such asset
+    optional<asset_info> find(string_view name) const noexcept {
+        const auto i = find_index(name);
+        if (i == not_found) { return nullopt; }
+        return info(i);
+    }
+
+    //! Returns information about every asset, in unspecified order
+    std::vector<asset_info> list() const {
+        std::vector<asset_info> infos;
+        infos.reserve(count);
+        for (size_t i = 0; i < count; i++) { infos.push_back(info(i)); }
+        return infos;
+    }
+
+    /*!
+     Returns a view of the uncompressed asset called `name`, which refers
+     directly into the archive's memory
+     @throws sdl::error if there is no such asset, or it is compressed
+     */
+    span<const uint8_t> view(string_view name) const {
+        return try_view(name).value();
+    }
+
+    //! Like `view()`, but returns a failed result rather than throwing
+    result<span<const uint8_t>> try_view(string_view name) const {
+        const auto i = find_index(name);
+        if (i == not_found) { return not_found_error(); }
+        const uint8_t* e = entry(i);
+        if (detail::load_le64(e + 24) < detail::load_le64(e + 16)) {
+            ::SDL_SetError("Asset is compressed and cannot be viewed");
+            return failure;
+        }
+        return data_of(e);
+    }
+
+    /*!
+     Returns a copy of the asset called `name`, decompressing it if necessary
+     @throws sdl::error if there is no such asset, or it is corrupt
+     */
+    std::vector<uint8_t> read(string_view name) const {
+        return try_read(name).value();
+    }
+
+    //! Like `read()`, but returns a failed result rather than throwing
+    result<std::vector<uint8_t>> try_read(string_view name) const {
+        const auto i = find_index(name);
+        if (i == not_found) { return not_found_error(); }
+        const uint8_t* e = entry(i);
+        const auto size = static_cast<size_t>(detail::load_le64(e + 16));
+        std::vector<uint8_t> out(size);
+        if (!extract(e, out.data())) { return failure; }
+        return out;
+    }
+
+    /*!
+     Opens the asset called `name` as a read-only `SDL_RWops` stream.
+     Uncompressed assets are read directly from the archive's memory, which
+     must outlive the stream; compressed assets are decompressed into a buffer
+     owned by the stream.
+     @throws sdl::error if there is no such asset, or it is corrupt
+     */
+    rwops_ptr open_rwops(string_view name) const {
+        return try_open_rwops(name).value();
+    }
+
+    //! Like `open_rwops()`, but returns a failed result rather than throwing
+    result<rwops_ptr> try_open_rwops(string_view name) const {
+        const auto i = find_index(name);
+        if (i == not_found) { return not_found_error(); }
+        const uint8_t* e = entry(i);
+        const auto size = detail::load_le64(e + 16);
+        if (size > static_cast<uint64_t>(SDL_MAX_SINT32)) {
+            ::SDL_SetError("Asset is too large for an SDL_RWops");
+            return failure;
+        }
+
+        if (size == 0) {
+            rwops_ptr rw{detail::open_empty_rwops()};
+            if (!rw) { return failure; }
+            return rw;
+        }
+
+        if (detail::load_le64(e + 24) == size) {
+            const auto data = data_of(e);
+            rwops_ptr rw{::SDL_RWFromConstMem(data.data(),
+                                              static_cast<int>(data.size()))};
+            if (!rw) { return failure; }
+            return rw;
+        }
+
+        auto buf = static_cast<uint8_t*>(::SDL_malloc(size));
+        if (!buf) {
+            ::SDL_OutOfMemory();
+            return failure;
+        }
+        SDL_RWops* rw = nullptr;
+        if (extract(e, buf)) {
+            rw = ::SDL_RWFromConstMem(buf, static_cast<int>(size));
+        }
+        if (!rw) {
+            ::SDL_free(buf);
+            return failure;
+        }
+        // Memory streams leave their buffer alone when closed, so replace
+        // the close function with one which frees it
+        rw->close = detail::close_owning_mem_rwops;
+        return rwops_ptr{rw};
+    }
+
+    //! Returns true if the archive file is memory-mapped, rather than having
+    //! been read into memory
+    bool is_mapped() const noexcept { return file.is_mapped(); }
+
+private:
+    static constexpr size_t not_found = size_t(-1);
+
+    explicit asset_archive(detail::mapped_file file) : file{std::move(file)} {}
+
+    static failure_t not_found_error() {
+        ::SDL_SetError("Asset not found");
+        return failure;
+    }
+
+    // Checks the header and that every entry lies within the file, so that
+    // lookups need no further bounds checks
+    bool validate() {
+        const uint8_t* base = file.data();
+        const uint64_t file_size = file.size();
+        if (file_size < detail::asset_header_size ||
+            SDL_memcmp(base, detail::asset_archive_magic,
+                       sizeof(detail::asset_archive_magic)) != 0 ||
+            detail::load_le32(base + 8) != detail::asset_archive_version) {
+            return false;
+        }
+
+        const uint64_t n = detail::load_le32(base + 12);
+        bits = detail::load_le32(base + 16);
+        const uint64_t index_offset = detail::load_le64(base + 24);
+        if (bits > detail::asset_max_bucket_bits) { return false; }
+
+        const uint64_t n_buckets = (uint64_t{1} << bits) + 1;
+        const uint64_t entries_offset =
+            index_offset + detail::align_up(n_buckets * 4, 8);
+        const uint64_t names_offset =
+            entries_offset + n * detail::asset_entry_size;
+        if (index_offset > file_size || names_offset > file_size) {
+            return false;
+        }
+
+        buckets = base + index_offset;
+        entries = base + entries_offset;
+        names = base + names_offset;
+        count = static_cast<size_t>(n);
+        const uint64_t names_size = file_size - names_offset;
+
+        uint32_t prev = 0;
+        for (uint64_t b = 0; b < n_buckets; b++) {
+            const auto start = detail::load_le32(buckets + 4 * b);
+            if (start < prev || start > n) { return false; }
+            prev = start;
+        }
+        if (prev != n) { return false; }
+
+        for (size_t i = 0; i < count; i++) {
+            const uint8_t* e = entry(i);
+            const auto offset = detail::load_le64(e + 8);
+            const auto size = detail::load_le64(e + 16);
+            const auto stored = detail::load_le64(e + 24);
+            const uint64_t name_offset = detail::load_le32(e + 32);
+            const uint64_t name_len = detail::load_le32(e + 36);
+            if (stored > size || offset > file_size ||
+                stored > file_size - offset || size > SIZE_MAX ||
+                name_offset + name_len > names_size) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const uint8_t* entry(size_t i) const noexcept {
+        return entries + i * detail::asset_entry_size;
+    }
+
+    string_view name_of(const uint8_t* e) const noexcept {
+        return {reinterpret_cast<const char*>(names) +
+                    detail::load_le32(e + 32),
+                detail::load_le32(e + 36)};
+    }
+
+    span<const uint8_t> data_of(const uint8_t* e) const noexcept {
+        return {file.data() + detail::load_le64(e + 8),
+                static_cast<size_t>(detail::load_le64(e + 24))};
+    }
+
+    asset_info info(size_t i) const noexcept {
+        const uint8_t* e = entry(i);
+        return {name_of(e), static_cast<size_t>(detail::load_le64(e + 16)),
+                static_cast<size_t>(detail::load_le64(e + 24))};
+    }
+
+    size_t find_index(string_view name) const noexcept {
+        const auto hash = detail::asset_name_hash(name);
+        const auto b = detail::asset_bucket(hash, bits);
+        const size_t first = detail::load_le32(buckets + 4 * b);
+        const size_t last = detail::load_le32(buckets + 4 * b + 4);
+        for (size_t i = first; i < last; i++) {
+            const uint8_t* e = entry(i);
+            const auto h = detail::load_le64(e);
+            if (h == hash && name_of(e) == name) { return i; }
+            if (h > hash) { break; }
+        }
+        return not_found;
+    }
+
+    // Copies or decompresses the entry into `out`, which must be large
+    // enough to hold it
+    bool extract(const uint8_t* e, uint8_t* out) const {
+        const auto data = data_of(e);
+        const auto size = static_cast<size_t>(detail::load_le64(e + 16));
+        if (data.size() == size) {
+            if (size) { SDL_memcpy(out, data.data(), size); }
+            return true;
+        }
+        if (!detail::lz_decompress(data.data(), data.size(), out, size)) {
+            ::SDL_SetError("Corrupt asset in sdl++ asset archive");
+            return false;
+        }
+        return true;
+    }
+
+    detail::mapped_file file;
+    const uint8_t* buckets = nullptr;
+    const uint8_t* entries = nullptr;
+    const uint8_t* names = nullptr;
+    size_t count = 0;
+    uint32_t bits = 0;
+};
+
+/*!
+ Creates an `sdl::asset_archive` file
+
+ Assets are added with `add()` or `add_file()`, and held in memory until the
+ archive is written with `write()`. If an asset is added more than once with
+ the same name, the last one wins.
+
+ ```
+ sdl::asset_archive_builder builder;
+ builder.add_file("textures/hero.bmp", "art/hero.bmp");
+ builder.add_file("levels/level1.map", "levels/level1.map", true);
+ builder.write("assets.pak");
+ ```
+ */
+class asset_archive_builder {
+public:
+    /*!
+     Creates a builder with no assets
+     @param alignment The alignment of each asset's data within the archive,
+                      which must be a power of two. This is also the
+                      alignment of the views returned by
+                      `asset_archive::view()`, as the mapping itself is page
+                      aligned.
+     */
+    explicit asset_archive_builder(size_t alignment = 16)
+        : alignment{alignment} {
+        SDL_assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+    }
+
+    /*!
+     Adds an asset called `name` with the contents `data`.
+     @param compress If true, the asset is compressed, unless this would not
+                     make it smaller. Compressed assets must be decompressed
+                     when read, and cannot be viewed in place.
+     */
+    void add(string_view name, span<const uint8_t> data,
+             bool compress = false) {
+        pending p;
+        p.name = name.to_string();
+        p.hash = detail::asset_name_hash(name);
+        p.size = data.size();
+        if (compress && !data.empty()) {
+            p.data = detail::lz_compress(data.data(), data.size());
+        }
+        if (p.data.empty() || p.data.size() >= data.size()) {
+            p.data.assign(data.begin(), data.end());
+        }
+        assets.push_back(std::move(p));
+    }
+
+    /*!
+     Adds an asset called `name` with the contents of the file at `path`.
+     @throws sdl::error if the file could not be read
+     */
+    void add_file(string_view name, const char* path, bool compress = false) {
+        try_add_file(name, path, compress).value();
+    }
+
+    //! Like `add_file()`, but returns a failed result rather than throwing
+    result<void> try_add_file(string_view name, const char* path,
+                              bool compress = false) {
+        auto file = detail::mapped_file::open(path);
+        if (!file) { return failure; }
+        add(name, {file->data(), file->size()}, compress);
+        return {};
+    }
+
+    //! Returns the number of assets added so far
+    size_t size() const noexcept { return assets.size(); }
+
+    /*!
+     Writes the archive to `path`, overwriting any existing file.
+     @throws sdl::error if the file could not be written
+     */
+    void write(const char* path) { try_write(path).value(); }
+
+    //! Like `write()`, but returns a failed result rather than throwing
+    result<void> try_write(const char* path) {
+        sort_assets();
+        if (assets.size() > SDL_MAX_UINT32) {
+            ::SDL_SetError("Too many assets");
+            return failure;
+        }
+
+        rwops_ptr rw{::SDL_RWFromFile(path, "wb")};
+        if (!rw) { return failure; }
+
+        const auto bits = detail::asset_bucket_bits(assets.size());
+
+        // Lay out the data
+        std::vector<uint64_t> offsets;
+        offsets.reserve(assets.size());
+        uint64_t pos = detail::align_up(detail::asset_header_size, alignment);
+        for (const auto& a : assets) {
+            offsets.push_back(pos);
+            pos = detail::align_up(pos + a.data.size(), alignment);
+        }
+        const uint64_t index_offset = detail::align_up(pos, 8);
+
+        std::vector<uint8_t> header;
+        header.insert(header.end(), std::begin(detail::asset_archive_magic),
+                      std::end(detail::asset_archive_magic));
+        detail::store_le32(header, detail::asset_archive_version);
+        detail::store_le32(header, static_cast<uint32_t>(assets.size()));
+        detail::store_le32(header, bits);
+        detail::store_le32(header, static_cast<uint32_t>(alignment));
+        detail::store_le64(header, index_offset);
+
+        std::vector<uint8_t> index;
+        const uint64_t n_buckets = uint64_t{1} << bits;
+        size_t i = 0;
+        for (uint64_t b = 0; b <= n_buckets; b++) {
+            while (i < assets.size() &&
+                   detail::asset_bucket(assets[i].hash, bits) < b) {
+                ++i;
+            }
+            detail::store_le32(index, static_cast<uint32_t>(i));
+        }
+        index.resize(static_cast<size_t>(detail::align_up(index.size(), 8)));
+
+        std::vector<uint8_t> names;
+        for (size_t k = 0; k < assets.size(); k++) {
+            const auto& a = assets[k];
+            detail::store_le64(index, a.hash);
+            detail::store_le64(index, offsets[k]);
+            detail::store_le64(index, a.size);
+            detail::store_le64(index, a.data.size());
+            detail::store_le32(index, static_cast<uint32_t>(names.size()));
+            detail::store_le32(index, static_cast<uint32_t>(a.name.size()));
+            names.insert(names.end(), a.name.begin(), a.name.end());
+        }
+
+        uint64_t written = 0;
+        const auto put = [&](const uint8_t* data, size_t n) {
+            if (n == 0) { return true; }
+            written += n;
+            return SDL_RWwrite(rw.get(), data, 1, n) == n;
+        };
+        const auto pad_to = [&](uint64_t target) {
+            static const uint8_t zeros[64] = {};
+            while (written < target) {
+                const auto n = std::min<uint64_t>(target - written,
+                                                  sizeof(zeros));
+                if (!put(zeros, static_cast<size_t>(n))) { return false; }
+            }
+            return true;
+        };
+
+        bool ok = put(header.data(), header.size());
+        for (size_t k = 0; ok && k < assets.size(); k++) {
+            ok = pad_to(offsets[k]) &&
+                 put(assets[k].data.data(), assets[k].data.size());
+        }
+        ok = ok && pad_to(index_offset) && put(index.data(), index.size()) &&
+             put(names.data(), names.size());
+
+        // SDL_RWclose() is a macro which evaluates its argument twice
+        SDL_RWops* const raw = rw.release();
+        if (SDL_RWclose(raw) != 0) { ok = false; }
+        if (!ok) {
+            ::SDL_SetError("Error writing sdl++ asset archive");
+            return failure;
+        }
+        return {};
+    }
+
+private:
+    struct pending {
+        string name;
+        uint64_t hash;
+        uint64_t size;
+        std::vector<uint8_t> data;
+    };
+
+    // Sorts by hash, keeping only the most recently added of any assets
+    // with the same name
+    void sort_assets() {
+        std::stable_sort(assets.begin(), assets.end(),
+                         [](const pending& a, const pending& b) {
+                             return a.hash < b.hash ||
+                                    (a.hash == b.hash && a.name < b.name);
+                         });
+        std::vector<pending> unique;
+        unique.reserve(assets.size());
+        for (auto& a : assets) {
+            if (!unique.empty() && unique.back().name == a.name) {
+                unique.back() = std::move(a);
+            } else {
+                unique.push_back(std::move(a));
+            }
+        }
+        assets = std::move(unique);
+    }
+
+    size_t alignment;
+    std::vector<pending> assets;
+};
+
+//! @}
+
+} // end namespace sdl
+
+#endif // SDLXX_ASSET_ARCHIVE_HPP
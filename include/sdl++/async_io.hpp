@@ -0,0 +1,595 @@
+/*!
+  @file async_io.hpp
+  Simple DirectMedia Layer C++ Bindings
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDLXX_ASYNC_IO_HPP
+#define SDLXX_ASYNC_IO_HPP
+
+#include "SDL_events.h"
+#include "SDL_rwops.h"
+
+#include "macros.hpp"
+#include "rwops.hpp"
+#include "stdinc.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace sdl {
+
+/*!
+ @defgroup AsyncIO Asynchronous File Loading
+
+ `sdl::async_io` reads files on a small pool of background threads, so that
+ loading assets never blocks the main thread. Each request reads a whole
+ file, or a byte range of one, either into a buffer supplied by the caller
+ or into a buffer taken from an internal pool.
+
+ Completion can be reported in three ways:
+
+  - with a future, returned by `async_io::read()`;
+  - with a callback, which runs on an I/O thread, passed to `read()`; or
+  - with an event posted to the SDL event queue, by `async_io::post()`.
+    The event has type `async_io::event_type()` and its result is retrieved
+    with `async_io::take_result()`.
+
+ ```
+ sdl::async_io io;
+ io.post({"levels/level2.map"});
+
+ // ...later, in the event loop
+ if (event.type == io.event_type()) {
+     auto result = sdl::async_io::take_result(event);
+     if (*result) { load_level(result->data()); }
+ }
+ ```
+
+ Identical requests for pooled buffers which are waiting or in progress at
+ the same time are coalesced, so the file is only read once and all of the
+ requesters share the same buffer. Requests are started in order of
+ priority, then in the order in which they were made. A request may be
+ cancelled until its result is delivered.
+
+ @{
+ */
+
+//! The priority of an `sdl::io_request`
+enum class io_priority { low, normal, high };
+
+/*!
+ A request to read a file, or part of one
+ */
+struct io_request {
+    //! Constructs a request to read the whole of the file at `path`
+    io_request(string path) : path(std::move(path)) {}
+
+    //! Constructs a request to read `length` bytes starting at `offset`
+    io_request(string path, uint64_t offset, uint64_t length)
+        : path(std::move(path)), offset{offset}, length{length} {}
+
+    //! The file to read, as passed to `SDL_RWFromFile()`
+    string path;
+    //! The position in the file at which to start reading
+    uint64_t offset = 0;
+    //! The number of bytes to read, or `nullopt` to read to the end of the
+    //! file
+    optional<uint64_t> length;
+    //! If not empty, the data is read into this buffer, which must remain
+    //! valid until the result is delivered. It is an error for the data to
+    //! be larger than the buffer. If empty, a pooled buffer is used.
+    span<uint8_t> buffer;
+    //! The priority of the request
+    io_priority priority = io_priority::normal;
+};
+
+/*!
+ The outcome of an `sdl::io_request`
+ */
+class io_result {
+public:
+    //! The possible outcomes of a request
+    enum class status { ok, failed, cancelled };
+
+    //! @cond
+    io_result() = default;
+    //! @endcond
+
+    //! Returns the outcome of the request
+    status get_status() const noexcept { return stat; }
+
+    //! Returns true if the data was read successfully
+    bool ok() const noexcept { return stat == status::ok; }
+
+    //! Returns true if the data was read successfully
+    explicit operator bool() const noexcept { return ok(); }
+
+    //! Returns true if the request was cancelled
+    bool cancelled() const noexcept { return stat == status::cancelled; }
+
+    //! Returns the data which was read. For requests using pooled buffers,
+    //! the buffer remains valid for as long as any copy of this result
+    //! exists.
+    span<const uint8_t> data() const noexcept { return bytes; }
+
+    //! Returns a description of the error if the request failed, or an
+    //! empty string otherwise
+    const string& error_message() const noexcept { return error; }
+
+private:
+    friend class async_io;
+
+    status stat = status::cancelled;
+    span<const uint8_t> bytes;
+    std::shared_ptr<const std::vector<uint8_t>> storage;
+    string error;
+};
+
+/*!
+ Identifies a request made to an `sdl::async_io`, for use with
+ `async_io::cancel()`
+ */
+class io_ticket {
+public:
+    //! Returns an identifier for the request, unique within its `async_io`.
+    //! This is also the `code` of the completion event posted by
+    //! `async_io::post()`, truncated to 32 bits.
+    uint64_t id() const noexcept { return id_; }
+
+    //! Returns the future which will hold the result. Only valid for
+    //! tickets returned by `async_io::read()` without a callback.
+    const std::shared_future<io_result>& future() const noexcept {
+        return future_;
+    }
+
+private:
+    friend class async_io;
+
+    uint64_t id_ = 0;
+    std::shared_future<io_result> future_;
+};
+
+namespace detail {
+
+    // Recycles the buffers used for pooled reads. Buffers are returned to
+    // the pool when the last result referring to them is destroyed, which
+    // may be after the async_io itself has gone.
+    class io_buffer_pool : public std::enable_shared_from_this<io_buffer_pool> {
+    public:
+        std::shared_ptr<std::vector<uint8_t>> acquire(size_t size) {
+            std::vector<uint8_t> buf;
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                // Take the smallest free buffer which is big enough
+                auto best = free.end();
+                for (auto it = free.begin(); it != free.end(); ++it) {
+                    if (it->capacity() >= size &&
+                        (best == free.end() ||
+                         it->capacity() < best->capacity())) {
+                        best = it;
+                    }
+                }
+                if (best != free.end()) {
+                    buf = std::move(*best);
+                    free.erase(best);
+                }
+            }
+            buf.resize(size);
+
+            std::weak_ptr<io_buffer_pool> weak = shared_from_this();
+            return {new std::vector<uint8_t>(std::move(buf)),
+                    [weak](std::vector<uint8_t>* p) {
+                        if (auto pool = weak.lock()) {
+                            pool->release(std::move(*p));
+                        }
+                        delete p;
+                    }};
+        }
+
+    private:
+        static constexpr size_t max_free = 16;
+
+        void release(std::vector<uint8_t>&& buf) {
+            std::lock_guard<std::mutex> lock{mutex};
+            if (free.size() < max_free) { free.push_back(std::move(buf)); }
+        }
+
+        std::mutex mutex;
+        std::vector<std::vector<uint8_t>> free;
+    };
+
+} // end namespace detail
+
+/*!
+ A pool of threads which read files in the background
+
+ The destructor cancels any requests which have not yet started, then waits
+ for those in progress to finish. `async_io` is neither copyable nor
+ movable.
+
+ @warning Callbacks run on an I/O thread, and must not block for long, as
+ this delays other requests. They must not destroy the `async_io`.
+ */
+class async_io {
+public:
+    //! The type of callback which may be passed to `read()`
+    using callback_type = std::function<void(const io_result&)>;
+
+    /*!
+     Starts `threads` I/O threads.
+
+     A small number of threads is usually best: more threads only help if
+     the storage device can service several reads at once.
+     @throws sdl::error if no SDL user event type could be registered
+     */
+    explicit async_io(unsigned threads = 2)
+        : event_type_{::SDL_RegisterEvents(1)} {
+        if (event_type_ == static_cast<uint32_t>(-1)) {
+            ::SDL_SetError("No SDL user event types are available");
+            SDLXX_CHECK(false);
+        }
+        threads = std::max(threads, 1u);
+        for (unsigned i = 0; i < threads; i++) {
+            workers.emplace_back([this] { run(); });
+        }
+    }
+
+    async_io(const async_io&) = delete;
+    async_io& operator=(const async_io&) = delete;
+
+    //! Cancels requests which have not started, and waits for the rest
+    ~async_io() {
+        std::vector<std::shared_ptr<waiter>> cancelled;
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            stopping = true;
+            for (const auto& entry : queue) {
+                for (auto& w : entry.second->waiters) {
+                    cancelled.push_back(std::move(w));
+                }
+            }
+            queue.clear();
+            coalescing.clear();
+        }
+        wake.notify_all();
+        for (const auto& w : cancelled) { deliver(*w, io_result{}); }
+        for (auto& t : workers) { t.join(); }
+    }
+
+    /*!
+     Reads a file in the background.
+     @returns A ticket holding the future to which the result will be
+              delivered
+     */
+    io_ticket read(io_request request) {
+        auto w = std::make_shared<waiter>();
+        io_ticket ticket;
+        ticket.future_ = w->promise.get_future().share();
+        ticket.id_ = submit(std::move(request), std::move(w));
+        return ticket;
+    }
+
+    /*!
+     Reads a file in the background, then calls `callback` with the result
+     on an I/O thread.
+
+     If the request is cancelled before it starts, `callback` is called with
+     a cancelled result on the thread calling `cancel()`. If it has already
+     started, the cancelled result is delivered on the I/O thread once the
+     read has stopped.
+     */
+    io_ticket read(io_request request, callback_type callback) {
+        auto w = std::make_shared<waiter>();
+        w->callback = std::move(callback);
+        io_ticket ticket;
+        ticket.id_ = submit(std::move(request), std::move(w));
+        return ticket;
+    }
+
+    /*!
+     Reads a file in the background, then posts an event of type
+     `event_type()` to the SDL event queue. Its `user.code` is the ticket's
+     id, and the result must be retrieved from it with `take_result()`.
+
+     @note The result is leaked if the event is removed from the queue
+     without calling `take_result()`.
+     */
+    io_ticket post(io_request request) {
+        auto w = std::make_shared<waiter>();
+        w->post_event = true;
+        io_ticket ticket;
+        ticket.id_ = submit(std::move(request), std::move(w));
+        return ticket;
+    }
+
+    //! Returns the type of the events posted by `post()`
+    uint32_t event_type() const noexcept { return event_type_; }
+
+    //! Takes ownership of the result held by an event posted by `post()`
+    static std::unique_ptr<io_result> take_result(const SDL_Event& event) {
+        return std::unique_ptr<io_result>{
+            static_cast<io_result*>(event.user.data1)};
+    }
+
+    /*!
+     Cancels a request. If the request was coalesced with others, only this
+     requester is affected. A request which is in progress is abandoned if
+     nobody else is waiting for it.
+
+     A request which has not started receives its cancelled result before
+     this function returns. For one which is in progress, the cancelled
+     result is delivered by the I/O thread once it has stopped reading, so
+     a caller-supplied buffer may be written to until then.
+     @returns true if the request was cancelled, or false if its result has
+              already been delivered
+     */
+    bool cancel(const io_ticket& ticket) {
+        std::shared_ptr<waiter> w;
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            const auto it = waiting.find(ticket.id());
+            if (it == waiting.end()) { return false; }
+            const auto j = it->second;
+            waiting.erase(it);
+
+            auto& ws = j->waiters;
+            const auto wit = std::find_if(
+                ws.begin(), ws.end(), [&](const std::shared_ptr<waiter>& p) {
+                    return p->id == ticket.id();
+                });
+            w = std::move(*wit);
+            ws.erase(wit);
+
+            if (ws.empty()) {
+                // A later identical request must not join the abandoned job
+                j->abandoned = true;
+                forget(j);
+                if (!j->started) { queue.erase(j->key); }
+            }
+            // The worker may still be writing to the buffer, so it delivers
+            // the result once it has finished with it
+            if (j->started) {
+                j->cancelled.push_back(std::move(w));
+                return true;
+            }
+        }
+        deliver(*w, io_result{});
+        return true;
+    }
+
+    //! Returns the number of requests which have not yet completed
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock{mutex};
+        return waiting.size();
+    }
+
+private:
+    struct waiter {
+        uint64_t id = 0;
+        std::promise<io_result> promise;
+        callback_type callback;
+        bool post_event = false;
+    };
+
+    // Jobs are ordered by priority, highest first, then by sequence number
+    using job_key = std::pair<int, uint64_t>;
+    using coalesce_key = std::tuple<string, uint64_t, optional<uint64_t>>;
+
+    struct job {
+        explicit job(io_request request) : request(std::move(request)) {}
+
+        io_request request;
+        job_key key;
+        std::vector<std::shared_ptr<waiter>> waiters;
+        // Waiters cancelled after the job started, awaiting delivery
+        std::vector<std::shared_ptr<waiter>> cancelled;
+        bool started = false;
+        bool abandoned = false;
+        bool coalescable = false;
+    };
+
+    uint64_t submit(io_request request, std::shared_ptr<waiter> w) {
+        std::unique_lock<std::mutex> lock{mutex};
+        const uint64_t id = ++next_id;
+        w->id = id;
+        const int priority = -static_cast<int>(request.priority);
+
+        if (request.buffer.empty()) {
+            const auto ck = coalesce_key{request.path, request.offset,
+                                         request.length};
+            const auto it = coalescing.find(ck);
+            if (it != coalescing.end()) {
+                auto j = it->second;
+                j->waiters.push_back(std::move(w));
+                waiting.emplace(id, j);
+                // Promote the shared job if this request is more urgent
+                if (!j->started && priority < j->key.first) {
+                    queue.erase(j->key);
+                    j->key.first = priority;
+                    queue.emplace(j->key, j);
+                }
+                return id;
+            }
+        }
+
+        auto j = std::make_shared<job>(std::move(request));
+        j->key = {priority, id};
+        j->waiters.push_back(std::move(w));
+        if (j->request.buffer.empty()) {
+            j->coalescable = true;
+            coalescing.emplace(coalesce_key{j->request.path, j->request.offset,
+                                            j->request.length},
+                               j);
+        }
+        waiting.emplace(id, j);
+        queue.emplace(j->key, j);
+        lock.unlock();
+        wake.notify_one();
+        return id;
+    }
+
+    // Removes a job which will not be delivered from the coalescing map
+    void forget(const std::shared_ptr<job>& j) {
+        if (!j->coalescable) { return; }
+        const auto it = coalescing.find(coalesce_key{
+            j->request.path, j->request.offset, j->request.length});
+        if (it != coalescing.end() && it->second == j) {
+            coalescing.erase(it);
+        }
+    }
+
+    void run() {
+        for (;;) {
+            std::shared_ptr<job> j;
+            {
+                std::unique_lock<std::mutex> lock{mutex};
+                wake.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (queue.empty()) { return; }
+                j = queue.begin()->second;
+                queue.erase(queue.begin());
+                j->started = true;
+            }
+
+            auto result = execute(*j);
+
+            std::vector<std::shared_ptr<waiter>> ws;
+            std::vector<std::shared_ptr<waiter>> cancelled;
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                forget(j);
+                ws = std::move(j->waiters);
+                cancelled = std::move(j->cancelled);
+                for (const auto& w : ws) { waiting.erase(w->id); }
+            }
+            for (const auto& w : ws) { deliver(*w, result); }
+            for (const auto& w : cancelled) { deliver(*w, io_result{}); }
+        }
+    }
+
+    bool is_abandoned(const job& j) {
+        std::lock_guard<std::mutex> lock{mutex};
+        return j.abandoned;
+    }
+
+    static io_result failed(const char* message) {
+        io_result r;
+        r.stat = io_result::status::failed;
+        r.error = message;
+        return r;
+    }
+
+    io_result execute(const job& j) {
+        static constexpr size_t chunk_size = 256 * 1024;
+        const auto& req = j.request;
+
+        // SDL's error message is thread-local, so it is copied into the
+        // result for delivery to another thread
+        rwops_ptr rw{::SDL_RWFromFile(req.path.c_str(), "rb")};
+        if (!rw) { return failed(::SDL_GetError()); }
+
+        uint64_t size = 0;
+        if (req.length) {
+            size = *req.length;
+        } else {
+            const Sint64 file_size = SDL_RWsize(rw.get());
+            if (file_size < 0) { return failed(::SDL_GetError()); }
+            if (static_cast<uint64_t>(file_size) < req.offset) {
+                return failed("Offset is beyond the end of the file");
+            }
+            size = static_cast<uint64_t>(file_size) - req.offset;
+        }
+        if (size > SIZE_MAX) { return failed("File is too large"); }
+        if (req.offset != 0 &&
+            SDL_RWseek(rw.get(), static_cast<Sint64>(req.offset),
+                       RW_SEEK_SET) < 0) {
+            return failed(::SDL_GetError());
+        }
+
+        io_result result;
+        uint8_t* dest = nullptr;
+        if (!req.buffer.empty()) {
+            if (size > req.buffer.size()) {
+                return failed("Buffer is too small");
+            }
+            dest = req.buffer.data();
+        } else {
+            auto buf = pool->acquire(static_cast<size_t>(size));
+            dest = buf->data();
+            result.storage = std::move(buf);
+        }
+
+        // Read in chunks, so that abandoned requests stop promptly
+        size_t done = 0;
+        while (done < size) {
+            if (is_abandoned(j)) { return io_result{}; }
+            const auto want =
+                std::min<size_t>(chunk_size, static_cast<size_t>(size) - done);
+            const auto n = SDL_RWread(rw.get(), dest + done, 1, want);
+            done += n;
+            if (n != want) { break; }
+        }
+        if (done != size) { return failed("Unexpected end of file"); }
+
+        result.stat = io_result::status::ok;
+        result.bytes = {dest, done};
+        return result;
+    }
+
+    void deliver(waiter& w, const io_result& result) {
+        if (w.callback) {
+            w.callback(result);
+        } else if (w.post_event) {
+            SDL_Event event{};
+            event.type = event_type_;
+            event.user.code = static_cast<Sint32>(w.id);
+            auto owned = std::make_unique<io_result>(result);
+            event.user.data1 = owned.get();
+            if (::SDL_PushEvent(&event) > 0) { owned.release(); }
+        } else {
+            w.promise.set_value(result);
+        }
+    }
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::map<job_key, std::shared_ptr<job>> queue;
+    std::map<coalesce_key, std::shared_ptr<job>> coalescing;
+    std::map<uint64_t, std::shared_ptr<job>> waiting;
+    std::shared_ptr<detail::io_buffer_pool> pool =
+        std::make_shared<detail::io_buffer_pool>();
+    uint64_t next_id = 0;
+    bool stopping = false;
+    uint32_t event_type_;
+    std::vector<std::thread> workers;
+};
+
+//! @}
+
+} // end namespace sdl
+
+#endif // SDLXX_ASYNC_IO_HPP
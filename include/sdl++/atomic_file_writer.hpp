@@ -0,0 +1,442 @@
+/*!
+  @file atomic_file_writer.hpp
+  Simple DirectMedia Layer C++ Bindings
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDLXX_ATOMIC_FILE_WRITER_HPP
+#define SDLXX_ATOMIC_FILE_WRITER_HPP
+
+#include "SDL_platform.h"
+
+#include "stdinc.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#if defined(__WIN32__) && !defined(__WINRT__)
+#define SDLXX_ATOMIC_FILE_WIN32 1
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#define SDLXX_ATOMIC_FILE_POSIX 1
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace sdl {
+
+/*!
+ @defgroup AtomicFileWriter Atomic File Writing
+
+ Saving a game or its configuration by overwriting a file in place leaves a
+ corrupt file behind if the program crashes or the power fails part way
+ through. `sdl::atomic_file_writer` instead writes the new contents to a
+ temporary file in the same directory, flushes it to disk, and then renames
+ it over the original. The rename is atomic, so the file always holds
+ either the complete old contents or the complete new contents.
+
+ Writes are performed on a background thread, so the main thread never
+ waits for the disk.
+
+ ```
+ sdl::paths dirs{"My Company", "My Game"};
+ sdl::atomic_file_writer writer;
+
+ sdl::path_buffer<> path;
+ const auto save = dirs.join_pref(path, "save1.dat").value();
+ auto done = writer.write(save.to_string(), serialize(game_state));
+ // ...later
+ if (!done.get()) { show_error(done.get().error_message()); }
+ ```
+
+ @{
+ */
+
+/*!
+ The outcome of an `sdl::atomic_file_writer` write
+ */
+class write_result {
+public:
+    //! Constructs a successful result
+    write_result() = default;
+
+    //! Constructs a failed result with the given message
+    explicit write_result(string message) : error(std::move(message)) {}
+
+    //! Returns true if the file was written successfully
+    bool ok() const noexcept { return error.empty(); }
+
+    //! Returns true if the file was written successfully
+    explicit operator bool() const noexcept { return ok(); }
+
+    //! Returns a description of the error, or an empty string on success
+    const string& error_message() const noexcept { return error; }
+
+private:
+    string error;
+};
+
+namespace detail {
+
+    inline string temp_path_for(const string& path) { return path + ".tmp"; }
+
+    inline string file_error(const char* what, const string& path) {
+#if defined(SDLXX_ATOMIC_FILE_WIN32)
+        return string{what} + " " + path + " (error " +
+               std::to_string(::GetLastError()) + ")";
+#elif defined(SDLXX_ATOMIC_FILE_POSIX)
+        return string{what} + " " + path + ": " + std::strerror(errno);
+#else
+        return string{what} + " " + path;
+#endif
+    }
+
+    // Writes data to the temporary file for path and flushes it to disk.
+    // Returns an empty string on success, or an error message.
+    inline string write_temp_file(const string& path,
+                                  const std::vector<uint8_t>& data) {
+        const string temp = temp_path_for(path);
+#if defined(SDLXX_ATOMIC_FILE_WIN32)
+        const int wlen =
+            ::MultiByteToWideChar(CP_UTF8, 0, temp.c_str(), -1, nullptr, 0);
+        if (wlen <= 0) { return file_error("Invalid path", temp); }
+        std::vector<wchar_t> wtemp(static_cast<size_t>(wlen));
+        ::MultiByteToWideChar(CP_UTF8, 0, temp.c_str(), -1, wtemp.data(),
+                              wlen);
+
+        const HANDLE file =
+            ::CreateFileW(wtemp.data(), GENERIC_WRITE, 0, nullptr,
+                          CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return file_error("Couldn't create", temp);
+        }
+        size_t done = 0;
+        while (done < data.size()) {
+            DWORD n = 0;
+            const auto want = static_cast<DWORD>(
+                std::min<size_t>(data.size() - done, 1u << 30));
+            if (!::WriteFile(file, data.data() + done, want, &n, nullptr)) {
+                auto msg = file_error("Couldn't write", temp);
+                ::CloseHandle(file);
+                return msg;
+            }
+            done += n;
+        }
+        if (!::FlushFileBuffers(file)) {
+            auto msg = file_error("Couldn't flush", temp);
+            ::CloseHandle(file);
+            return msg;
+        }
+        ::CloseHandle(file);
+        return {};
+#elif defined(SDLXX_ATOMIC_FILE_POSIX)
+        const int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if (fd < 0) { return file_error("Couldn't create", temp); }
+        size_t done = 0;
+        while (done < data.size()) {
+            const auto n = ::write(fd, data.data() + done, data.size() - done);
+            if (n < 0) {
+                if (errno == EINTR) { continue; }
+                auto msg = file_error("Couldn't write", temp);
+                ::close(fd);
+                return msg;
+            }
+            done += static_cast<size_t>(n);
+        }
+        if (::fsync(fd) != 0) {
+            auto msg = file_error("Couldn't flush", temp);
+            ::close(fd);
+            return msg;
+        }
+        if (::close(fd) != 0) { return file_error("Couldn't close", temp); }
+        return {};
+#else
+        // Without native file APIs the data cannot be flushed explicitly,
+        // but the rename still protects against partial writes
+        std::FILE* f = std::fopen(temp.c_str(), "wb");
+        if (!f) { return file_error("Couldn't create", temp); }
+        const bool ok =
+            std::fwrite(data.data(), 1, data.size(), f) == data.size();
+        if (std::fclose(f) != 0 || !ok) {
+            return file_error("Couldn't write", temp);
+        }
+        return {};
+#endif
+    }
+
+    // Atomically replaces path with its temporary file
+    inline string replace_with_temp_file(const string& path) {
+        const string temp = temp_path_for(path);
+#if defined(SDLXX_ATOMIC_FILE_WIN32)
+        auto widen = [](const string& s) {
+            const int n =
+                ::MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, nullptr, 0);
+            std::vector<wchar_t> w(static_cast<size_t>(n > 0 ? n : 1));
+            ::MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, w.data(), n);
+            return w;
+        };
+        if (!::MoveFileExW(widen(temp).data(), widen(path).data(),
+                           MOVEFILE_REPLACE_EXISTING |
+                               MOVEFILE_WRITE_THROUGH)) {
+            return file_error("Couldn't replace", path);
+        }
+#else
+        if (std::rename(temp.c_str(), path.c_str()) != 0) {
+            return file_error("Couldn't replace", path);
+        }
+#endif
+        return {};
+    }
+
+    inline string parent_directory(const string& path) {
+        const auto pos = path.find_last_of("/\\");
+        if (pos == string::npos) { return "."; }
+        if (pos == 0) { return path.substr(0, 1); }
+        return path.substr(0, pos);
+    }
+
+    // Flushes a directory, so that renames within it survive a power
+    // failure. Windows has no equivalent, and uses MOVEFILE_WRITE_THROUGH
+    // instead. Returns an error message, or an empty string on success.
+    inline string sync_directory(const string& dir) {
+#if defined(SDLXX_ATOMIC_FILE_POSIX)
+        const int fd = ::open(dir.c_str(), O_RDONLY);
+        if (fd < 0) { return file_error("Couldn't open", dir); }
+        // EINVAL means the file system cannot flush directories at all
+        if (::fsync(fd) != 0 && errno != EINVAL) {
+            auto msg = file_error("Couldn't flush", dir);
+            ::close(fd);
+            return msg;
+        }
+        ::close(fd);
+#else
+        (void) dir;
+#endif
+        return {};
+    }
+
+} // end namespace detail
+
+/*!
+ Writes whole files atomically on a background thread
+
+ Each call to `write()` replaces the entire contents of a file. Writes are
+ batched: those submitted while an earlier batch is being written, or
+ within `commit_delay` of the first write of a batch, are committed
+ together, with each affected directory flushed only once per batch. If the
+ same file is written more than once in a batch, only the last contents are
+ written, and every caller receives the result of that single commit.
+
+ The temporary file is the destination path with `.tmp` appended. Two
+ writers must not write to the same file at the same time.
+
+ The destructor waits for all pending writes to complete.
+ */
+class atomic_file_writer {
+public:
+    //! The type of callback which may be passed to `write()`
+    using callback_type = std::function<void(const write_result&)>;
+
+    /*!
+     Starts the writer thread.
+     @param commit_delay How long to wait after the first write of a batch
+                         for further writes to join it
+     */
+    explicit atomic_file_writer(
+        std::chrono::milliseconds commit_delay = std::chrono::milliseconds{0})
+        : delay{commit_delay}, worker{[this] { run(); }} {}
+
+    atomic_file_writer(const atomic_file_writer&) = delete;
+    atomic_file_writer& operator=(const atomic_file_writer&) = delete;
+
+    //! Waits for pending writes, then stops the writer thread
+    ~atomic_file_writer() {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            stopping = true;
+        }
+        wake.notify_all();
+        worker.join();
+    }
+
+    /*!
+     Replaces the contents of the file at `path` with `data`.
+     @returns A future which becomes ready when the file has been committed
+     */
+    std::shared_future<write_result> write(string path,
+                                           std::vector<uint8_t> data) {
+        std::promise<write_result> promise;
+        auto future = promise.get_future().share();
+        submit(std::move(path), std::move(data),
+               [p = std::make_shared<std::promise<write_result>>(
+                    std::move(promise))](const write_result& r) {
+                   p->set_value(r);
+               });
+        return future;
+    }
+
+    //! @overload
+    std::shared_future<write_result> write(string path, string_view text) {
+        return write(std::move(path),
+                     std::vector<uint8_t>(text.begin(), text.end()));
+    }
+
+    /*!
+     Replaces the contents of the file at `path` with `data`, then calls
+     `callback` with the result on the writer thread.
+     */
+    void write(string path, std::vector<uint8_t> data,
+               callback_type callback) {
+        submit(std::move(path), std::move(data), std::move(callback));
+    }
+
+    //! Blocks until every write submitted so far has been committed
+    void flush() {
+        std::unique_lock<std::mutex> lock{mutex};
+        const auto target = submitted;
+        idle.wait(lock, [&] { return completed >= target; });
+    }
+
+    //! Returns the number of batches committed so far
+    size_t batches() const {
+        std::lock_guard<std::mutex> lock{mutex};
+        return batch_count;
+    }
+
+private:
+    struct pending_write {
+        std::vector<uint8_t> data;
+        std::vector<callback_type> callbacks;
+    };
+
+    void submit(string path, std::vector<uint8_t> data,
+                callback_type callback) {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            auto& entry = pending[std::move(path)];
+            entry.data = std::move(data);
+            entry.callbacks.push_back(std::move(callback));
+            ++submitted;
+        }
+        wake.notify_one();
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock{mutex};
+        for (;;) {
+            wake.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (pending.empty()) { return; }
+
+            // Let more writes join the batch, unless we are shutting down
+            if (delay.count() > 0 && !stopping) {
+                wake.wait_for(lock, delay, [this] { return stopping; });
+            }
+
+            auto batch = std::move(pending);
+            pending.clear();
+            lock.unlock();
+
+            const auto done = commit(batch);
+
+            lock.lock();
+            ++batch_count;
+            completed += done;
+            idle.notify_all();
+        }
+    }
+
+    // Writes each file in the batch and renames it into place, then
+    // flushes the affected directories. Returns the number of writes
+    // completed.
+    static size_t commit(std::map<string, pending_write>& batch) {
+        std::map<string, string> errors;
+        for (const auto& entry : batch) {
+            auto msg = detail::write_temp_file(entry.first, entry.second.data);
+            if (msg.empty()) {
+                msg = detail::replace_with_temp_file(entry.first);
+            }
+            if (!msg.empty()) {
+                std::remove(detail::temp_path_for(entry.first).c_str());
+                errors.emplace(entry.first, std::move(msg));
+            }
+        }
+
+        std::set<string> dirs;
+        for (const auto& entry : batch) {
+            if (!errors.count(entry.first)) {
+                dirs.insert(detail::parent_directory(entry.first));
+            }
+        }
+        // The new contents are in place, but may not survive a power
+        // failure, if their directory could not be flushed
+        for (const auto& dir : dirs) {
+            const auto msg = detail::sync_directory(dir);
+            if (msg.empty()) { continue; }
+            for (const auto& entry : batch) {
+                if (detail::parent_directory(entry.first) == dir) {
+                    errors.emplace(entry.first, msg);
+                }
+            }
+        }
+
+        size_t count = 0;
+        for (auto& entry : batch) {
+            const auto err = errors.find(entry.first);
+            const auto result = err == errors.end()
+                                    ? write_result{}
+                                    : write_result{err->second};
+            for (const auto& callback : entry.second.callbacks) {
+                callback(result);
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::map<string, pending_write> pending;
+    uint64_t submitted = 0;
+    uint64_t completed = 0;
+    size_t batch_count = 0;
+    bool stopping = false;
+    std::chrono::milliseconds delay;
+    std::thread worker;
+};
+
+//! @}
+
+} // end namespace sdl
+
+#endif // SDLXX_ATOMIC_FILE_WRITER_HPP
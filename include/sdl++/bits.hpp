@@ -23,10 +23,26 @@
 #ifndef SDLXX_BITS_HPP
 #define SDLXX_BITS_HPP
 
-#include "SDL_bits.h"
-
 #include "stdinc.hpp"
 
+#include <limits>
+#include <type_traits>
+
+/*! @macro SDLXX_NO_BUILTIN_BITOPS
+ By default, the functions in bits.hpp use compiler intrinsics such as
+ `__builtin_clz()` where they are available (that is, on GCC and Clang). These
+ are usable in constant expressions, and will compile down to single
+ instructions such as `LZCNT`, `TZCNT` and `POPCNT` when the target
+ architecture supports them (for example with `-mbmi -mlzcnt -mpopcnt`, or
+ `-march=native`).
+
+ Defining `SDLXX_NO_BUILTIN_BITOPS` forces the use of the portable
+ implementations instead. These are always used with other compilers.
+ */
+#if defined(__GNUC__) && !defined(SDLXX_NO_BUILTIN_BITOPS)
+#define SDLXX_HAS_BUILTIN_BITOPS 1
+#endif
+
 namespace sdl {
 
 /*!
@@ -34,18 +50,234 @@ namespace sdl {
 
  This category contains functions for bit-level operations ("bit-twiddling").
 
+ With the exception of `most_significant_bit_index()`, the functions in this
+ category are templates which accept any unsigned integer type of up to 64
+ bits, and follow the naming and semantics of the C++20 `<bit>` header.
+ All of them may be used in constant expressions.
+
  @{
  */
 
+namespace detail {
+
+    template <typename T>
+    using check_bit_type_t =
+        std::enable_if_t<std::is_integral<T>::value &&
+                         std::is_unsigned<T>::value &&
+                         !std::is_same<T, bool>::value && sizeof(T) <= 8>;
+
+    template <typename T>
+    constexpr int digits() noexcept {
+        return std::numeric_limits<T>::digits;
+    }
+
+    // Portable implementations. These operate on a 64-bit value which is
+    // known to be less than 2^width. They are written as single return
+    // statements, as MSVC 2015 only supports C++11 constexpr functions.
+
+    constexpr uint64_t popcount_pairs(uint64_t x) noexcept {
+        return x - ((x >> 1) & 0x5555555555555555ull);
+    }
+
+    constexpr uint64_t popcount_nibbles(uint64_t x) noexcept {
+        return (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    }
+
+    constexpr uint64_t popcount_bytes(uint64_t x) noexcept {
+        return (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    }
+
+    constexpr int portable_popcount(uint64_t x) noexcept {
+        return static_cast<int>(
+            (popcount_bytes(popcount_nibbles(popcount_pairs(x))) *
+             0x0101010101010101ull) >>
+            56);
+    }
+
+    // Binary search for the highest set bit of a non-zero x: if the top
+    // `half` bits are clear, count them and shift them out
+    constexpr int leading_zeros_search(uint64_t x, int half) noexcept {
+        return half == 0
+                   ? 0
+                   : (x >> (64 - half)) == 0
+                         ? half + leading_zeros_search(x << half, half / 2)
+                         : leading_zeros_search(x, half / 2);
+    }
+
+    constexpr int portable_countl_zero(uint64_t x, int width) noexcept {
+        return x == 0 ? width
+                      : leading_zeros_search(x, 32) - (64 - width);
+    }
+
+    // Isolates the lowest set bit, then counts the ones below it
+    constexpr int portable_countr_zero(uint64_t x, int width) noexcept {
+        return x == 0 ? width : portable_popcount((x & (~x + 1)) - 1);
+    }
+
+    // Rotates left by r bits, where -digits < r < digits
+    template <typename T>
+    constexpr T rotate_left(T x, int r) noexcept {
+        return r == 0 ? x
+                      : r > 0 ? static_cast<T>((x << r) |
+                                               (x >> (digits<T>() - r)))
+                              : static_cast<T>((x >> -r) |
+                                               (x << (digits<T>() + r)));
+    }
+
+#ifdef SDLXX_HAS_BUILTIN_BITOPS
+    static_assert(sizeof(unsigned int) == 4 && sizeof(unsigned long long) == 8,
+                  "Unexpected integer sizes for compiler builtins");
+
+    constexpr int builtin_countl_zero(uint64_t x, int width) noexcept {
+        return x == 0 ? width
+                      : width <= 32
+                            ? __builtin_clz(static_cast<unsigned int>(x)) -
+                                  (32 - width)
+                            : __builtin_clzll(x);
+    }
+
+    constexpr int builtin_countr_zero(uint64_t x, int width) noexcept {
+        return x == 0 ? width
+                      : width <= 32
+                            ? __builtin_ctz(static_cast<unsigned int>(x))
+                            : __builtin_ctzll(x);
+    }
+
+    constexpr int builtin_popcount(uint64_t x) noexcept {
+        return __builtin_popcountll(x);
+    }
+#endif // SDLXX_HAS_BUILTIN_BITOPS
+
+    constexpr int countl_zero_impl(uint64_t x, int width) noexcept {
+#ifdef SDLXX_HAS_BUILTIN_BITOPS
+        return builtin_countl_zero(x, width);
+#else
+        return portable_countl_zero(x, width);
+#endif
+    }
+
+    constexpr int countr_zero_impl(uint64_t x, int width) noexcept {
+#ifdef SDLXX_HAS_BUILTIN_BITOPS
+        return builtin_countr_zero(x, width);
+#else
+        return portable_countr_zero(x, width);
+#endif
+    }
+
+    constexpr int popcount_impl(uint64_t x) noexcept {
+// Without a hardware POPCNT instruction the builtin becomes a library call,
+// which is slower than the SWAR version
+#if defined(SDLXX_HAS_BUILTIN_BITOPS) && defined(__POPCNT__)
+        return builtin_popcount(x);
+#else
+        return portable_popcount(x);
+#endif
+    }
+
+} // end namespace detail
+
+//! Returns the number of consecutive zero bits, starting from the most
+//! significant bit. Returns the width of `T` if `x` is zero.
+template <typename T, typename = detail::check_bit_type_t<T>>
+constexpr int countl_zero(T x) noexcept {
+    return detail::countl_zero_impl(x, detail::digits<T>());
+}
+
+//! Returns the number of consecutive one bits, starting from the most
+//! significant bit.
+template <typename T, typename = detail::check_bit_type_t<T>>
+constexpr int countl_one(T x) noexcept {
+    return countl_zero(static_cast<T>(~x));
+}
+
+//! Returns the number of consecutive zero bits, starting from the least
+//! significant bit. Returns the width of `T` if `x` is zero.
+template <typename T, typename = detail::check_bit_type_t<T>>
+constexpr int countr_zero(T x) noexcept {
+    return detail::countr_zero_impl(x, detail::digits<T>());
+}
+
+//! Returns the number of consecutive one bits, starting from the least
+//! significant bit.
+template <typename T, typename = detail::check_bit_type_t<T>>
+constexpr int countr_one(T x) noexcept {
+    return countr_zero(static_cast<T>(~x));
+}
+
+//! Returns the number of set bits in `x`
+template <typename T, typename = detail::check_bit_type_t<T>>
+constexpr int popcount(T x) noexcept {
+    return detail::popcount_impl(x);
+}
+
+//! Returns true if `x` is an integral power of two
+template <typename T, typename = detail::check_bit_type_t<T>>
+constexpr bool has_single_bit(T x) noexcept {
+    return x != 0 && (x & (x - 1)) == 0;
+}
+
+//! Returns the number of bits needed to represent `x`, that is
+//! `1 + floor(log2(x))`, or zero if `x` is zero.
+template <typename T, typename = detail::check_bit_type_t<T>>
+constexpr int bit_width(T x) noexcept {
+    return detail::digits<T>() - countl_zero(x);
+}
+
+//! Returns the largest power of two not greater than `x`, or zero if `x` is
+//! zero.
+template <typename T, typename = detail::check_bit_type_t<T>>
+constexpr T bit_floor(T x) noexcept {
+    return x == 0 ? T{0} : static_cast<T>(T{1} << (bit_width(x) - 1));
+}
+
+/*!
+ Returns the smallest power of two not less than `x`.
+
+ @pre The result must be representable in `T`, that is `x` must not be greater
+      than `T{1} << (std::numeric_limits<T>::digits - 1)`
+ */
+template <typename T, typename = detail::check_bit_type_t<T>>
+constexpr T bit_ceil(T x) noexcept {
+    return x <= 1 ? T{1}
+                  : static_cast<T>(T{1} << bit_width(static_cast<T>(x - 1)));
+}
+
+//! Returns `x` rotated left by `s` bits. A negative `s` rotates right.
+template <typename T, typename = detail::check_bit_type_t<T>>
+constexpr T rotl(T x, int s) noexcept {
+    return detail::rotate_left(x, s % detail::digits<T>());
+}
+
+//! Returns `x` rotated right by `s` bits. A negative `s` rotates left.
+template <typename T, typename = detail::check_bit_type_t<T>>
+constexpr T rotr(T x, int s) noexcept {
+    return rotl(x, -(s % detail::digits<T>()));
+}
+
+//! Returns the index of the most significant set bit, or -1 if `x` is zero
+template <typename T, typename = detail::check_bit_type_t<T>>
+constexpr int msb(T x) noexcept {
+    return bit_width(x) - 1;
+}
+
+//! Returns the index of the least significant set bit, or -1 if `x` is zero
+template <typename T, typename = detail::check_bit_type_t<T>>
+constexpr int lsb(T x) noexcept {
+    return x == 0 ? -1 : countr_zero(x);
+}
+
 /*!
  Get the index of the most significant bit. Result is undefined when called
  with 0. This operation can also be stated as "count leading zeroes" and
  "log base 2".
 
+ This gives the same result as `SDL_MostSignificantBitIndex32()`, but may be
+ used in constant expressions. For other integer widths, use `sdl::msb()`.
+
  @return Index of the most significant bit, or -1 if the value is 0.
  */
-inline int most_significant_bit_index(uint32_t x) noexcept {
-    return ::SDL_MostSignificantBitIndex32(x);
+constexpr int most_significant_bit_index(uint32_t x) noexcept {
+    return msb(x);
 }
 
 } // end namespace sdl
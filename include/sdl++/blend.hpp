@@ -0,0 +1,506 @@
+/*!
+  @file blend.hpp
+  Simple DirectMedia Layer C++ Bindings
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDLXX_BLEND_HPP
+#define SDLXX_BLEND_HPP
+
+#include "blendmode.hpp"
+#include "detail/convert_pixels.hpp"
+#include "detail/simd.hpp"
+#include "result.hpp"
+#include "surface.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace sdl {
+
+/*!
+ @defgroup Blend Software Blending
+
+ This category contains a software implementation of SDL's blend modes, for
+ composing images without a renderer, such as when drawing thumbnails on a
+ server.
+
+ The arithmetic follows SDL's generic software blitter, `SDL_blit_slow.c`:
+ the formulas given for `sdl::blend_mode`, computed in 8-bit integers with
+ division by 255 rounding down. `SDL_BlitSurface()` uses optimized blitters
+ for many formats, and for `blend_mode::blend` these approximate the
+ formula, so its results may differ slightly. Kernels for SSE2 and AVX2 are
+ chosen at run time, and skip blocks of pixels which are fully opaque or
+ fully transparent.
+
+ @{
+ */
+
+//! How the colour channels of source pixels relate to their alpha
+enum class blend_alpha {
+    //! Colour is independent of alpha, as in SDL
+    straight,
+    /*!
+     Colour has already been multiplied by alpha, for example by
+     `sdl::premultiply_alpha()`. `blend_mode::blend` then computes
+     `dstRGB = srcRGB + (dstRGB * (1-srcA))`, and `blend_mode::add`
+     computes `dstRGB = srcRGB + dstRGB`, saving a multiplication.
+     */
+    premultiplied
+};
+
+namespace detail {
+
+    // Blending works on bytes, given the offset of the alpha byte in each
+    // 4-byte pixel; the other three channels are treated alike
+
+    inline unsigned div255(unsigned x) noexcept { return x / 255; }
+
+    template <blend_mode Mode, bool Premultiplied>
+    void blend_row(int alpha, const unsigned char* src, unsigned char* dst,
+                   size_t count) {
+        for (size_t i = 0; i < count; i++, src += 4, dst += 4) {
+            const unsigned sa = src[alpha];
+            for (int c = 0; c < 4; c++) {
+                if (c == alpha) { continue; }
+                unsigned s = src[c];
+                const unsigned d = dst[c];
+                if (!Premultiplied && Mode != blend_mode::mod) {
+                    s = div255(s * sa);
+                }
+                switch (Mode) {
+                case blend_mode::blend:
+                    // Only premultiplied colour greater than alpha overflows
+                    dst[c] = static_cast<unsigned char>(
+                        std::min(s + div255((255 - sa) * d), 255u));
+                    break;
+                case blend_mode::add:
+                    dst[c] = static_cast<unsigned char>(std::min(s + d, 255u));
+                    break;
+                default:
+                    dst[c] = static_cast<unsigned char>(div255(s * d));
+                    break;
+                }
+            }
+            if (Mode == blend_mode::blend) {
+                dst[alpha] = static_cast<unsigned char>(
+                    sa + div255((255 - sa) * dst[alpha]));
+            }
+        }
+    }
+
+#ifdef SDLXX_SIMD_X86
+
+    // Exact division of 16-bit products by 255, rounding down
+    SDLXX_TARGET_SSE2
+    inline __m128i div255_sse2(__m128i x) {
+        return _mm_srli_epi16(
+            _mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)),
+                          _mm_srli_epi16(x, 8)),
+            8);
+    }
+
+    // The constants for blending pixels with alpha at a given byte
+    struct blend_masks_sse2 {
+        __m128i shift;      // Shifts alpha to the bottom of each pixel
+        __m128i alpha;      // The alpha byte of each pixel
+        __m128i alpha_word; // The alpha channel of pixels unpacked to words
+    };
+
+    SDLXX_TARGET_SSE2
+    inline blend_masks_sse2 make_blend_masks_sse2(int alpha) {
+        const auto word = static_cast<long long>(0xFFFFull << 16 * alpha);
+        return {_mm_cvtsi32_si128(8 * alpha),
+                _mm_set1_epi32(static_cast<int>(0xFFu << 8 * alpha)),
+                _mm_set1_epi64x(word)};
+    }
+
+    // Blends 4 pixels
+    template <blend_mode Mode, bool Premultiplied>
+    SDLXX_TARGET_SSE2 inline __m128i blend4_sse2(__m128i s, __m128i d,
+                                                 const blend_masks_sse2& m) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i max = _mm_set1_epi16(255);
+
+        // Each pixel's alpha, spread over its 4 channels as 16-bit words
+        const __m128i a = _mm_and_si128(_mm_srl_epi32(s, m.shift),
+                                        _mm_set1_epi32(0xFF));
+        const __m128i a2 = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+        const __m128i a_lo = _mm_unpacklo_epi32(a2, a2);
+        const __m128i a_hi = _mm_unpackhi_epi32(a2, a2);
+
+        __m128i s_lo = _mm_unpacklo_epi8(s, zero);
+        __m128i s_hi = _mm_unpackhi_epi8(s, zero);
+        const __m128i d_lo = _mm_unpacklo_epi8(d, zero);
+        const __m128i d_hi = _mm_unpackhi_epi8(d, zero);
+
+        if (!Premultiplied && Mode != blend_mode::mod) {
+            // Multiply colour by alpha, and alpha by 255 to keep it
+            const __m128i keep = _mm_and_si128(m.alpha_word, max);
+            const __m128i f_lo =
+                _mm_or_si128(_mm_andnot_si128(m.alpha_word, a_lo), keep);
+            const __m128i f_hi =
+                _mm_or_si128(_mm_andnot_si128(m.alpha_word, a_hi), keep);
+            s_lo = div255_sse2(_mm_mullo_epi16(s_lo, f_lo));
+            s_hi = div255_sse2(_mm_mullo_epi16(s_hi, f_hi));
+        }
+
+        if (Mode == blend_mode::blend) {
+            const __m128i inv_lo = _mm_sub_epi16(max, a_lo);
+            const __m128i inv_hi = _mm_sub_epi16(max, a_hi);
+            const __m128i lo = _mm_add_epi16(
+                s_lo, div255_sse2(_mm_mullo_epi16(d_lo, inv_lo)));
+            const __m128i hi = _mm_add_epi16(
+                s_hi, div255_sse2(_mm_mullo_epi16(d_hi, inv_hi)));
+            return _mm_packus_epi16(lo, hi);
+        }
+
+        __m128i out;
+        if (Mode == blend_mode::add) {
+            out = _mm_adds_epu8(_mm_packus_epi16(s_lo, s_hi), d);
+        } else {
+            out = _mm_packus_epi16(div255_sse2(_mm_mullo_epi16(s_lo, d_lo)),
+                                   div255_sse2(_mm_mullo_epi16(s_hi, d_hi)));
+        }
+        // Add and mod leave the destination's alpha alone
+        return _mm_or_si128(_mm_andnot_si128(m.alpha, out),
+                            _mm_and_si128(m.alpha, d));
+    }
+
+    template <blend_mode Mode, bool Premultiplied>
+    SDLXX_TARGET_SSE2 void blend_row_sse2(int alpha, const unsigned char* src,
+                                          unsigned char* dst, size_t count) {
+        const auto m = make_blend_masks_sse2(alpha);
+        const __m128i zero = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m128i s =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i));
+            auto* out = reinterpret_cast<__m128i*>(dst + 4 * i);
+            if (Mode != blend_mode::mod) {
+                const __m128i a = _mm_and_si128(s, m.alpha);
+                const __m128i skip = Premultiplied ? s : a;
+                if (_mm_movemask_epi8(_mm_cmpeq_epi8(skip, zero)) == 0xFFFF) {
+                    continue;
+                }
+                if (Mode == blend_mode::blend &&
+                    _mm_movemask_epi8(_mm_cmpeq_epi8(a, m.alpha)) == 0xFFFF) {
+                    _mm_storeu_si128(out, s);
+                    continue;
+                }
+            }
+            const __m128i d = _mm_loadu_si128(out);
+            _mm_storeu_si128(out, blend4_sse2<Mode, Premultiplied>(s, d, m));
+        }
+        blend_row<Mode, Premultiplied>(alpha, src + 4 * i, dst + 4 * i,
+                                       count - i);
+    }
+
+    SDLXX_TARGET_AVX2
+    inline __m256i div255_avx2(__m256i x) {
+        return _mm256_srli_epi16(
+            _mm256_add_epi16(_mm256_add_epi16(x, _mm256_set1_epi16(1)),
+                             _mm256_srli_epi16(x, 8)),
+            8);
+    }
+
+    // Blends 8 pixels, as blend4_sse2() with each 128-bit lane holding 4
+    template <blend_mode Mode, bool Premultiplied>
+    SDLXX_TARGET_AVX2 inline __m256i blend8_avx2(__m256i s, __m256i d,
+                                                 __m128i shift,
+                                                 __m256i alpha_mask,
+                                                 __m256i alpha_word) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i max = _mm256_set1_epi16(255);
+
+        const __m256i a = _mm256_and_si256(_mm256_srl_epi32(s, shift),
+                                           _mm256_set1_epi32(0xFF));
+        const __m256i a2 = _mm256_or_si256(a, _mm256_slli_epi32(a, 16));
+        const __m256i a_lo = _mm256_unpacklo_epi32(a2, a2);
+        const __m256i a_hi = _mm256_unpackhi_epi32(a2, a2);
+
+        __m256i s_lo = _mm256_unpacklo_epi8(s, zero);
+        __m256i s_hi = _mm256_unpackhi_epi8(s, zero);
+        const __m256i d_lo = _mm256_unpacklo_epi8(d, zero);
+        const __m256i d_hi = _mm256_unpackhi_epi8(d, zero);
+
+        if (!Premultiplied && Mode != blend_mode::mod) {
+            const __m256i keep = _mm256_and_si256(alpha_word, max);
+            const __m256i f_lo =
+                _mm256_or_si256(_mm256_andnot_si256(alpha_word, a_lo), keep);
+            const __m256i f_hi =
+                _mm256_or_si256(_mm256_andnot_si256(alpha_word, a_hi), keep);
+            s_lo = div255_avx2(_mm256_mullo_epi16(s_lo, f_lo));
+            s_hi = div255_avx2(_mm256_mullo_epi16(s_hi, f_hi));
+        }
+
+        if (Mode == blend_mode::blend) {
+            const __m256i inv_lo = _mm256_sub_epi16(max, a_lo);
+            const __m256i inv_hi = _mm256_sub_epi16(max, a_hi);
+            const __m256i lo = _mm256_add_epi16(
+                s_lo, div255_avx2(_mm256_mullo_epi16(d_lo, inv_lo)));
+            const __m256i hi = _mm256_add_epi16(
+                s_hi, div255_avx2(_mm256_mullo_epi16(d_hi, inv_hi)));
+            return _mm256_packus_epi16(lo, hi);
+        }
+
+        __m256i out;
+        if (Mode == blend_mode::add) {
+            out = _mm256_adds_epu8(_mm256_packus_epi16(s_lo, s_hi), d);
+        } else {
+            out = _mm256_packus_epi16(
+                div255_avx2(_mm256_mullo_epi16(s_lo, d_lo)),
+                div255_avx2(_mm256_mullo_epi16(s_hi, d_hi)));
+        }
+        return _mm256_or_si256(_mm256_andnot_si256(alpha_mask, out),
+                               _mm256_and_si256(alpha_mask, d));
+    }
+
+    template <blend_mode Mode, bool Premultiplied>
+    SDLXX_TARGET_AVX2 void blend_row_avx2(int alpha, const unsigned char* src,
+                                          unsigned char* dst, size_t count) {
+        const __m128i shift = _mm_cvtsi32_si128(8 * alpha);
+        const __m256i alpha_mask =
+            _mm256_set1_epi32(static_cast<int>(0xFFu << 8 * alpha));
+        const __m256i alpha_word = _mm256_set1_epi64x(
+            static_cast<long long>(0xFFFFull << 16 * alpha));
+        const __m256i zero = _mm256_setzero_si256();
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m256i s = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(src + 4 * i));
+            auto* out = reinterpret_cast<__m256i*>(dst + 4 * i);
+            if (Mode != blend_mode::mod) {
+                const __m256i a = _mm256_and_si256(s, alpha_mask);
+                const __m256i skip = Premultiplied ? s : a;
+                if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(skip, zero)) == -1) {
+                    continue;
+                }
+                if (Mode == blend_mode::blend &&
+                    _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, alpha_mask)) ==
+                        -1) {
+                    _mm256_storeu_si256(out, s);
+                    continue;
+                }
+            }
+            const __m256i d = _mm256_loadu_si256(out);
+            _mm256_storeu_si256(out, blend8_avx2<Mode, Premultiplied>(
+                                         s, d, shift, alpha_mask, alpha_word));
+        }
+        blend_row_sse2<Mode, Premultiplied>(alpha, src + 4 * i, dst + 4 * i,
+                                            count - i);
+    }
+
+#endif // SDLXX_SIMD_X86
+
+    using blend_row_fn = void (*)(int, const unsigned char*, unsigned char*,
+                                  size_t);
+
+    template <blend_mode Mode, bool Premultiplied>
+    blend_row_fn select_blend_row(simd_level level) {
+#ifdef SDLXX_SIMD_X86
+        if (level == simd_level::avx2) {
+            return &blend_row_avx2<Mode, Premultiplied>;
+        }
+        if (level != simd_level::none) {
+            return &blend_row_sse2<Mode, Premultiplied>;
+        }
+#endif
+        static_cast<void>(level);
+        return &blend_row<Mode, Premultiplied>;
+    }
+
+    // Returns the kernel for `mode` at `level`, or null for blend_mode::none,
+    // which is a copy
+    inline blend_row_fn select_blend_row(blend_mode mode, blend_alpha alpha,
+                                         simd_level level) {
+        const bool pm = alpha == blend_alpha::premultiplied;
+        switch (mode) {
+        case blend_mode::blend:
+            return pm ? select_blend_row<blend_mode::blend, true>(level)
+                      : select_blend_row<blend_mode::blend, false>(level);
+        case blend_mode::add:
+            return pm ? select_blend_row<blend_mode::add, true>(level)
+                      : select_blend_row<blend_mode::add, false>(level);
+        case blend_mode::mod:
+            return select_blend_row<blend_mode::mod, false>(level);
+        default:
+            return nullptr;
+        }
+    }
+
+    inline result<int> blend_alpha_offset(pixel_format format) {
+        pixel_byte_order order;
+        if (!get_pixel_byte_order(static_cast<uint32_t>(format), order) ||
+            !order.alpha) {
+            ::SDL_SetError("Blending requires a 32-bit format with alpha");
+            return failure;
+        }
+        return order.a;
+    }
+
+} // end namespace detail
+
+/*!
+ Blends `count` pixels from `src` onto `dst`, without throwing
+
+ Both spans hold pixels in `format`, which must be a 32-bit format with
+ alpha such as `pixel_format::rgba8888`.
+
+ @returns A failed result if `format` is not supported
+ */
+inline result<void> try_blend_span(blend_mode mode, pixel_format format,
+                                   const uint32_t* src, uint32_t* dst,
+                                   size_t count,
+                                   blend_alpha alpha = blend_alpha::straight) {
+    const auto offset = detail::blend_alpha_offset(format);
+    if (!offset) { return failure; }
+    const auto row =
+        detail::select_blend_row(mode, alpha, detail::best_simd_level());
+    if (!row) {
+        std::memmove(dst, src, count * sizeof(uint32_t));
+    } else {
+        row(*offset, reinterpret_cast<const unsigned char*>(src),
+            reinterpret_cast<unsigned char*>(dst), count);
+    }
+    return {};
+}
+
+/*!
+ Blends `count` pixels from `src` onto `dst`
+ @see try_blend_span()
+ @throws sdl::error if `format` is not supported
+ */
+inline void blend_span(blend_mode mode, pixel_format format,
+                       const uint32_t* src, uint32_t* dst, size_t count,
+                       blend_alpha alpha = blend_alpha::straight) {
+    try_blend_span(mode, format, src, dst, count, alpha).value();
+}
+
+/*!
+ Blends the pixels of `src` onto `dst`, which must be the same size,
+ without throwing
+ @returns A failed result if `format` is not supported or the sizes differ
+ */
+inline result<void> try_blend_rect(blend_mode mode, pixel_format format,
+                                   pixel_view<const uint32_t> src,
+                                   pixel_view<uint32_t> dst,
+                                   blend_alpha alpha = blend_alpha::straight) {
+    if (src.width() != dst.width() || src.height() != dst.height()) {
+        ::SDL_SetError("Blended rectangles must be the same size");
+        return failure;
+    }
+    const auto offset = detail::blend_alpha_offset(format);
+    if (!offset) { return failure; }
+    const auto row =
+        detail::select_blend_row(mode, alpha, detail::best_simd_level());
+    const auto width = static_cast<size_t>(src.width());
+    for (int y = 0; y < src.height(); y++) {
+        const auto in = src.row(y).data();
+        const auto out = dst.row(y).data();
+        if (!row) {
+            std::memmove(out, in, width * sizeof(uint32_t));
+        } else {
+            row(*offset, reinterpret_cast<const unsigned char*>(in),
+                reinterpret_cast<unsigned char*>(out), width);
+        }
+    }
+    return {};
+}
+
+/*!
+ Blends the pixels of `src` onto `dst`, which must be the same size
+ @see try_blend_rect()
+ @throws sdl::error if `format` is not supported or the sizes differ
+ */
+inline void blend_rect(blend_mode mode, pixel_format format,
+                       pixel_view<const uint32_t> src, pixel_view<uint32_t> dst,
+                       blend_alpha alpha = blend_alpha::straight) {
+    try_blend_rect(mode, format, src, dst, alpha).value();
+}
+
+/*!
+ Blends `src` onto `dst` with its top left corner at (`x`, `y`), clipped to
+ `dst`, without throwing
+
+ This follows `SDL_blit_slow.c`, so gives the same result as
+ `SDL_BlitSurface()` with the source's blend mode set to `mode`, except that
+ SDL's optimized blitters may differ slightly for `blend_mode::blend`. Both
+ surfaces must have the same 32-bit format with alpha. Surfaces which must
+ be locked are locked while their pixels are accessed.
+
+ @returns A failed result if the formats differ or are not supported, or a
+          surface could not be locked
+ */
+inline result<void> try_blend_rect(blend_mode mode, const surface& src,
+                                   surface& dst, int x, int y,
+                                   blend_alpha alpha = blend_alpha::straight) {
+    if (src.format() != dst.format()) {
+        ::SDL_SetError("Blended surfaces must have the same format");
+        return failure;
+    }
+    const int left = std::max(x, 0);
+    const int top = std::max(y, 0);
+    const int right = std::min(x + src.width(), dst.width());
+    const int bottom = std::min(y + src.height(), dst.height());
+    if (right <= left || bottom <= top) {
+        return detail::blend_alpha_offset(src.format()) ? result<void>{}
+                                                        : failure;
+    }
+    const int w = right - left;
+    const int h = bottom - top;
+
+    // Locking does not change a surface's pixels, so the source may be
+    // locked even though it is const
+    optional<surface_lock> src_lock, dst_lock;
+    if (src.must_lock()) {
+        auto lock = const_cast<surface&>(src).try_lock();
+        if (!lock) { return failure; }
+        src_lock.emplace(std::move(*lock));
+    }
+    if (dst.must_lock()) {
+        auto lock = dst.try_lock();
+        if (!lock) { return failure; }
+        dst_lock.emplace(std::move(*lock));
+    }
+    return try_blend_rect(
+        mode, src.format(),
+        src.view<uint32_t>().subview(left - x, top - y, w, h),
+        dst.view<uint32_t>().subview(left, top, w, h), alpha);
+}
+
+/*!
+ Blends `src` onto `dst` with its top left corner at (`x`, `y`), clipped to
+ `dst`
+ @see try_blend_rect()
+ @throws sdl::error if the formats differ or are not supported
+ */
+inline void blend_rect(blend_mode mode, const surface& src, surface& dst,
+                       int x, int y,
+                       blend_alpha alpha = blend_alpha::straight) {
+    try_blend_rect(mode, src, dst, x, y, alpha).value();
+}
+
+//! @}
+
+} // end namespace sdl
+
+#endif // SDLXX_BLEND_HPP
@@ -28,6 +28,7 @@
 namespace sdl {
 
 //! The blend mode used in `sdl::renderer::copy()` and drawing operations.
+//! Surfaces can be blended in software with `sdl::blend_rect()`.
 //! @ingroup Render
 enum class blend_mode {
     /*!
@@ -23,11 +23,25 @@
 #define SDLXX_CLIPBOARD_HPP
 
 #include "SDL_clipboard.h"
+#include "SDL_events.h"
+#include "SDL_video.h"
 
 #include "detail/wrapper.hpp"
+#include "init.hpp"
 #include "macros.hpp"
+#include "main_thread_queue.hpp"
+#include "result.hpp"
 #include "stdinc.hpp"
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 namespace sdl {
 
 /*! @defgroup Clipboard Clipboard Handling
@@ -40,27 +54,294 @@ namespace sdl {
 //! Put UTF-8 text into the clipboard
 //! @throws sdl::error on failure
 inline void set_clipboard_text(const char* text) {
+    require_subsystems(init_flags::video);
     SDLXX_CHECK(::SDL_SetClipboardText(text) == 0);
 }
 
 //! Put UTF-8 text into the clipboard
 //! @throws sdl::error on failure
 inline void set_clipboard_text(const string& text) {
+    require_subsystems(init_flags::video);
     SDLXX_CHECK(detail::c_call(::SDL_SetClipboardText, text) == 0);
 }
 
-//! Get UTF-8 text from the clipboard
-//! @returns The clipboard contents, or an empty string
-inline string get_clipboard_text() {
-    return detail::c_call(::SDL_GetClipboardText);
+//! Put UTF-8 text into the clipboard
+//! @returns A failed result on failure
+SDLXX_ATTR_WARN_UNUSED_RESULT
+inline result<void> try_set_clipboard_text(const char* text) {
+    if (!try_require_subsystems(init_flags::video)) { return failure; }
+    return detail::check_zero(::SDL_SetClipboardText(text));
+}
+
+//! Put UTF-8 text into the clipboard
+//! @returns A failed result on failure
+SDLXX_ATTR_WARN_UNUSED_RESULT
+inline result<void> try_set_clipboard_text(const string& text) {
+    return try_set_clipboard_text(text.c_str());
+}
+
+/*!
+ Get UTF-8 text from the clipboard
+ @tparam String The type to return: either `sdl::string` (the default), which
+                holds a copy of the text, or `sdl::sdl_string`, which takes
+                ownership of SDL's buffer without copying
+ @returns The clipboard contents, or an empty string
+ */
+template <typename String = string>
+String get_clipboard_text() {
+    require_subsystems(init_flags::video);
+    return detail::c_call_as<String>(::SDL_GetClipboardText);
 }
 
 //! Returns a flag indicating whether the clipboard exists and contains a text
 //! string that is non-empty
 inline bool has_clipboard_text() {
+    require_subsystems(init_flags::video);
     return detail::c_call(::SDL_HasClipboardText);
 }
 
+namespace detail {
+
+    // Runs tasks in order on a single background thread
+    class task_thread {
+    public:
+        task_thread() : worker{[this] { run(); }} {}
+
+        task_thread(const task_thread&) = delete;
+        task_thread& operator=(const task_thread&) = delete;
+
+        // Runs the remaining tasks, then stops the thread
+        ~task_thread() {
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                stopping = true;
+            }
+            wake.notify_all();
+            worker.join();
+        }
+
+        void post(std::function<void()> task) {
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                tasks.push_back(std::move(task));
+            }
+            wake.notify_one();
+        }
+
+        // Blocks until every task posted so far has run
+        void wait_idle() {
+            std::unique_lock<std::mutex> lock{mutex};
+            idle.wait(lock, [this] { return tasks.empty() && !busy; });
+        }
+
+    private:
+        void run() {
+            std::unique_lock<std::mutex> lock{mutex};
+            for (;;) {
+                wake.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) { return; }
+                auto task = std::move(tasks.front());
+                tasks.pop_front();
+                busy = true;
+                lock.unlock();
+                task();
+                lock.lock();
+                busy = false;
+                if (tasks.empty()) { idle.notify_all(); }
+            }
+        }
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable idle;
+        std::deque<std::function<void()>> tasks;
+        bool busy = false;
+        bool stopping = false;
+        std::thread worker;
+    };
+
+    // Returns false, setting SDL's error, if the current video driver pumps
+    // window system events while accessing the clipboard, and so must only
+    // do so on the thread which initialized video
+    inline bool can_use_clipboard_off_main_thread() {
+        const char* driver = ::SDL_GetCurrentVideoDriver();
+        if (!driver) { return true; }
+        const string_view name{driver};
+        if (name == "x11" || name == "wayland") {
+            ::SDL_SetError("The %s video driver only allows clipboard access "
+                           "on the main thread",
+                           driver);
+            return false;
+        }
+        return true;
+    }
+
+} // end namespace detail
+
+/*!
+ Accesses the clipboard without blocking the calling thread
+
+ On some platforms (notably X11) reading or writing the clipboard requires a
+ round trip to the application which owns it, which can take a long time
+ for large payloads. `async_clipboard` makes these calls elsewhere and
+ returns futures. Requests are carried out in the order in which they are
+ made, so reading the clipboard after setting it returns the new text.
+
+ By default, the calls are made on a helper thread. The X11 and Wayland
+ video drivers pump window system events while accessing the clipboard,
+ and so must only do so on the thread which initialized video; the default
+ constructor refuses to start the helper thread on these drivers. Instead,
+ construct the `async_clipboard` with a `sdl::main_thread_queue`, and the
+ calls are made on the main thread when it drains the queue. Callers still
+ receive futures rather than waiting, but the main thread is busy while
+ each request is carried out.
+
+ Text is read as an `sdl::sdl_string`, which takes ownership of SDL's buffer
+ rather than copying it, and is written from a string which is moved into
+ the request.
+
+ Rather than querying SDL every frame, `has_text()` returns a cached value.
+ The cache is refreshed in the background when this object sets the text,
+ and when an `SDL_CLIPBOARDUPDATE` event is passed to `handle_event()`:
+
+ ```
+ sdl::async_clipboard clipboard;
+
+ while (SDL_PollEvent(&event)) {
+     clipboard.handle_event(event);
+     // ...
+ }
+
+ paste_button.enabled(clipboard.has_text());
+ ```
+
+ The destructor waits for outstanding requests on the helper thread to
+ complete. Requests posted to a `main_thread_queue` remain valid after the
+ `async_clipboard` is destroyed, and complete when the queue is drained.
+
+ @warning The video subsystem must be initialized for as long as requests
+ are outstanding.
+ */
+class async_clipboard {
+public:
+    /*!
+     Starts the helper thread. The video subsystem must already be
+     initialized, unless it was requested by an active
+     `sdl::lazy_init_guard`, in which case it is initialized now.
+     @throws sdl::error if the video subsystem could not be initialized, or
+             if the video driver is X11 or Wayland, which only allow
+             clipboard access on the main thread
+     */
+    async_clipboard() {
+        require_subsystems(init_flags::video);
+        SDLXX_CHECK(detail::can_use_clipboard_off_main_thread());
+        tasks = std::make_unique<detail::task_thread>();
+        refresh();
+    }
+
+    /*!
+     Makes requests by posting them to `queue`, which must be drained by the
+     thread which initialized video, and must outlive any requests made.
+     Video initialization is as for the default constructor.
+     @throws sdl::error if the video subsystem could not be initialized
+     */
+    explicit async_clipboard(main_thread_queue<>& queue)
+        : main_queue{&queue} {
+        require_subsystems(init_flags::video);
+        refresh();
+    }
+
+    /*!
+     Puts UTF-8 text into the clipboard.
+     @returns A future which becomes ready when the text has been set. On
+              failure, it holds an `sdl::error` which is thrown by `get()`.
+     */
+    std::future<void> set_text(string text) {
+        return set(std::make_shared<string>(std::move(text)));
+    }
+
+    //! @overload
+    std::future<void> set_text(sdl_string text) {
+        return set(std::make_shared<sdl_string>(std::move(text)));
+    }
+
+    //! Gets UTF-8 text from the clipboard
+    //! @returns A future holding the clipboard contents, or an empty string
+    std::future<sdl_string> get_text() {
+        auto promise = std::make_shared<std::promise<sdl_string>>();
+        auto future = promise->get_future();
+        post([promise] {
+            promise->set_value(sdl_string{::SDL_GetClipboardText()});
+        });
+        return future;
+    }
+
+    //! Returns the cached result of `SDL_HasClipboardText()`
+    bool has_text() const noexcept {
+        return cached_has_text->load(std::memory_order_acquire);
+    }
+
+    //! Refreshes the cached result of `has_text()` in the background
+    void refresh() {
+        post([cached = cached_has_text] {
+            cached->store(::SDL_HasClipboardText() == SDL_TRUE,
+                          std::memory_order_release);
+        });
+    }
+
+    //! Refreshes the cache if `event` is an `SDL_CLIPBOARDUPDATE` event
+    //! @returns true if the event was a clipboard update
+    bool handle_event(const SDL_Event& event) {
+        if (event.type != SDL_CLIPBOARDUPDATE) { return false; }
+        refresh();
+        return true;
+    }
+
+    //! Blocks until every request made so far on the helper thread has
+    //! completed. Requests posted to a `main_thread_queue` complete when it
+    //! is drained instead, and this function returns immediately.
+    void wait_idle() {
+        if (tasks) { tasks->wait_idle(); }
+    }
+
+private:
+    // Tasks only capture shared state, as those posted to a queue may run
+    // after this object has been destroyed
+    template <typename Func>
+    void post(Func&& func) {
+        if (main_queue) {
+            main_queue->post(std::forward<Func>(func));
+        } else {
+            tasks->post(std::forward<Func>(func));
+        }
+    }
+
+    template <typename String>
+    std::future<void> set(std::shared_ptr<String> text) {
+        auto promise = std::make_shared<std::promise<void>>();
+        auto future = promise->get_future();
+        post([cached = cached_has_text, promise, text] {
+            if (::SDL_SetClipboardText(text->c_str()) == 0) {
+                cached->store(!text->empty(), std::memory_order_release);
+                promise->set_value();
+            } else {
+                // SDL's error message is thread-local, so it is captured
+                // here for rethrowing on the thread which calls get()
+                promise->set_exception(
+                    std::make_exception_ptr(error(::SDL_GetError())));
+            }
+        });
+        return future;
+    }
+
+    std::shared_ptr<std::atomic<bool>> cached_has_text =
+        std::make_shared<std::atomic<bool>>(false);
+    main_thread_queue<>* main_queue = nullptr;
+    // Declared last, so that outstanding tasks finish before the other
+    // members are destroyed
+    std::unique_ptr<detail::task_thread> tasks;
+};
+
 } // end namespace sdl
 
 #endif // SDLXX_CLIPBOARD_HPP
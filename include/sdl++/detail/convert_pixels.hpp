@@ -0,0 +1,623 @@
+/*!
+  @file convert_pixels.hpp
+  Simple DirectMedia Layer C++ Bindings
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDLXX_DETAIL_CONVERT_PIXELS_HPP
+#define SDLXX_DETAIL_CONVERT_PIXELS_HPP
+
+#include <sdl++/detail/simd.hpp>
+#include <sdl++/stdinc.hpp>
+
+#include "SDL_pixels.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+namespace sdl {
+namespace detail {
+
+    // Pixel conversion kernels for the format pairs which are common in
+    // video and image loading, where SDL_ConvertPixels() uses its generic
+    // blitters. Each kernel converts a single row; SIMD kernels convert as
+    // much of the row as they can and hand the rest to the scalar kernel,
+    // which gives identical results.
+
+    // The offset in memory of each channel of an RGB pixel. `a` is the
+    // offset of the alpha or padding byte, or -1 for 3-byte formats.
+    struct pixel_byte_order {
+        int bytes;
+        int r, g, b, a;
+        bool alpha;
+    };
+
+    inline bool get_pixel_byte_order(uint32_t format,
+                                     pixel_byte_order& order) noexcept {
+        // Offsets on a little-endian machine
+        static const struct {
+            uint32_t format;
+            pixel_byte_order order;
+        } table[] = {
+            {SDL_PIXELFORMAT_RGB24, {3, 0, 1, 2, -1, false}},
+            {SDL_PIXELFORMAT_BGR24, {3, 2, 1, 0, -1, false}},
+            {SDL_PIXELFORMAT_RGB888, {4, 2, 1, 0, 3, false}},
+            {SDL_PIXELFORMAT_BGR888, {4, 0, 1, 2, 3, false}},
+            {SDL_PIXELFORMAT_RGBX8888, {4, 3, 2, 1, 0, false}},
+            {SDL_PIXELFORMAT_BGRX8888, {4, 1, 2, 3, 0, false}},
+            {SDL_PIXELFORMAT_ARGB8888, {4, 2, 1, 0, 3, true}},
+            {SDL_PIXELFORMAT_RGBA8888, {4, 3, 2, 1, 0, true}},
+            {SDL_PIXELFORMAT_ABGR8888, {4, 0, 1, 2, 3, true}},
+            {SDL_PIXELFORMAT_BGRA8888, {4, 1, 2, 3, 0, true}},
+        };
+        for (const auto& entry : table) {
+            if (entry.format != format) { continue; }
+            order = entry.order;
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+            // Packed formats are stored the other way round; the 3-byte
+            // formats are arrays of bytes, so are the same on both
+            if (order.bytes == 4) {
+                order.r = 3 - order.r;
+                order.g = 3 - order.g;
+                order.b = 3 - order.b;
+                order.a = 3 - order.a;
+            }
+#endif
+            return true;
+        }
+        return false;
+    }
+
+    struct pixel_conversion;
+
+    using convert_row_fn = void (*)(const pixel_conversion&,
+                                    const unsigned char* src,
+                                    const unsigned char* chroma,
+                                    unsigned char* dst, int width);
+
+    struct pixel_conversion {
+        convert_row_fn row = nullptr;
+        int src_bytes = 0;
+        int dst_bytes = 0;
+        // True for NV12 and NV21, whose chroma is in a second plane
+        bool planar = false;
+
+        // RGB to RGB: the source byte of each destination byte, or -1 if
+        // it is set to 0xFF; and the same as a pshufb mask for 4 pixels
+        int src_offset[4] = {-1, -1, -1, -1};
+        unsigned char shuffle[16] = {};
+        uint32_t fill = 0;
+
+        // YUV to RGB: the destination offsets of R, G, B and A/padding and
+        // the channel at each destination byte; and the offsets of Y, U
+        // and V in each 2-pixel group, or of U and V in the chroma plane
+        int dst_offset[4] = {0, 0, 0, 0};
+        int order[4] = {0, 0, 0, 0};
+        int y_offset = 0;
+        int u_offset = 0;
+        int v_offset = 0;
+    };
+
+    // ITU-R BT.601 limited range YUV to RGB, in 8-bit fixed point
+    inline void yuv_to_rgb_pixel(int y, int u, int v, const int* offset,
+                                 unsigned char* dst) noexcept {
+        auto clamp = [](int x) {
+            return static_cast<unsigned char>(x < 0 ? 0 : x > 255 ? 255 : x);
+        };
+        const int c = y - 16;
+        const int d = u - 128;
+        const int e = v - 128;
+        dst[offset[0]] = clamp((298 * c + 409 * e + 128) >> 8);
+        dst[offset[1]] = clamp((298 * c - 100 * d - 208 * e + 128) >> 8);
+        dst[offset[2]] = clamp((298 * c + 516 * d + 128) >> 8);
+        dst[offset[3]] = 0xFF;
+    }
+
+    inline unsigned char premultiply_channel(unsigned c, unsigned a) noexcept {
+        // Exact rounded division by 255
+        const unsigned t = c * a + 128;
+        return static_cast<unsigned char>((t + (t >> 8)) >> 8);
+    }
+
+    // Scalar kernels
+
+    inline void copy_row(const pixel_conversion& conv,
+                         const unsigned char* src, const unsigned char*,
+                         unsigned char* dst, int width) {
+        std::memcpy(dst, src, static_cast<size_t>(width) * conv.dst_bytes);
+    }
+
+    inline void shuffle_row(const pixel_conversion& conv,
+                            const unsigned char* src, const unsigned char*,
+                            unsigned char* dst, int width) {
+        const int* off = conv.src_offset;
+        for (int x = 0; x < width; x++) {
+            for (int j = 0; j < 4; j++) {
+                dst[j] = off[j] < 0 ? 0xFF : src[off[j]];
+            }
+            src += conv.src_bytes;
+            dst += 4;
+        }
+    }
+
+    inline void packed_yuv_row(const pixel_conversion& conv,
+                               const unsigned char* src, const unsigned char*,
+                               unsigned char* dst, int width) {
+        for (int x = 0; x < width; x += 2) {
+            const int u = src[conv.u_offset];
+            const int v = src[conv.v_offset];
+            yuv_to_rgb_pixel(src[conv.y_offset], u, v, conv.dst_offset, dst);
+            if (x + 1 < width) {
+                yuv_to_rgb_pixel(src[conv.y_offset + 2], u, v,
+                                 conv.dst_offset, dst + 4);
+            }
+            src += 4;
+            dst += 8;
+        }
+    }
+
+    inline void planar_yuv_row(const pixel_conversion& conv,
+                               const unsigned char* src,
+                               const unsigned char* chroma, unsigned char* dst,
+                               int width) {
+        for (int x = 0; x < width; x++) {
+            const int u = chroma[(x & ~1) + conv.u_offset];
+            const int v = chroma[(x & ~1) + conv.v_offset];
+            yuv_to_rgb_pixel(src[x], u, v, conv.dst_offset, dst + 4 * x);
+        }
+    }
+
+    inline void premultiply_row(int alpha, const unsigned char* src,
+                                unsigned char* dst, int width) {
+        for (int x = 0; x < width; x++) {
+            const unsigned a = src[alpha];
+            for (int j = 0; j < 4; j++) {
+                dst[j] = j == alpha ? src[j] : premultiply_channel(src[j], a);
+            }
+            src += 4;
+            dst += 4;
+        }
+    }
+
+#ifdef SDLXX_SIMD_X86
+
+    // SSE2 kernels
+
+    SDLXX_TARGET_SSE2
+    inline void shuffle_row_sse2(const pixel_conversion& conv,
+                                 const unsigned char* src,
+                                 const unsigned char* chroma,
+                                 unsigned char* dst, int width) {
+        // Without pshufb, each destination byte is masked out of its
+        // source byte and shifted into place
+        __m128i masks[4];
+        __m128i left[4];
+        __m128i right[4];
+        for (int j = 0; j < 4; j++) {
+            const int i = conv.src_offset[j];
+            const int shift = 8 * (j - i);
+            masks[j] = _mm_set1_epi32(
+                i < 0 ? 0 : static_cast<int>(0xFFu << 8 * i));
+            left[j] = _mm_cvtsi32_si128(i < 0 || shift < 0 ? 0 : shift);
+            right[j] = _mm_cvtsi32_si128(i < 0 || shift > 0 ? 0 : -shift);
+        }
+        const __m128i fill = _mm_set1_epi32(static_cast<int>(conv.fill));
+
+        int x = 0;
+        for (; x + 4 <= width; x += 4) {
+            const __m128i v = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(src + 4 * x));
+            __m128i out = fill;
+            for (int j = 0; j < 4; j++) {
+                const __m128i t = _mm_and_si128(v, masks[j]);
+                out = _mm_or_si128(
+                    out, _mm_srl_epi32(_mm_sll_epi32(t, left[j]), right[j]));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * x), out);
+        }
+        shuffle_row(conv, src + 4 * x, chroma, dst + 4 * x, width - x);
+    }
+
+    // Multiply-adds pairs of (C, E) or (C, D) to get exact 32-bit sums, and
+    // returns the 8 results clamped to bytes. The G channel's third term
+    // and its rounding come from pairs of (E, 1) in `lo_add` and `hi_add`.
+    SDLXX_TARGET_SSE2
+    inline __m128i yuv_channel_sse2(__m128i lo_pairs, __m128i hi_pairs,
+                                    __m128i coef, __m128i lo_add,
+                                    __m128i hi_add) {
+        const __m128i lo = _mm_srai_epi32(
+            _mm_add_epi32(_mm_madd_epi16(lo_pairs, coef), lo_add), 8);
+        const __m128i hi = _mm_srai_epi32(
+            _mm_add_epi32(_mm_madd_epi16(hi_pairs, coef), hi_add), 8);
+        const __m128i words = _mm_packs_epi32(lo, hi);
+        return _mm_packus_epi16(words, words);
+    }
+
+    // Converts 8 pixels, given their luma and their interleaved chroma
+    // (u0 v0 u1 v1 u2 v2 u3 v3) as 16-bit values. `order` gives the channel
+    // (R, G, B or A) at each byte of the destination pixel.
+    SDLXX_TARGET_SSE2
+    inline void yuv_to_rgb_sse2(__m128i luma, __m128i chroma, bool swap_uv,
+                                const int* order, unsigned char* dst) {
+        const __m128i c = _mm_sub_epi16(luma, _mm_set1_epi16(16));
+        const __m128i uv = _mm_sub_epi16(chroma, _mm_set1_epi16(128));
+        __m128i d = _mm_shufflehi_epi16(
+            _mm_shufflelo_epi16(uv, _MM_SHUFFLE(2, 2, 0, 0)),
+            _MM_SHUFFLE(2, 2, 0, 0));
+        __m128i e = _mm_shufflehi_epi16(
+            _mm_shufflelo_epi16(uv, _MM_SHUFFLE(3, 3, 1, 1)),
+            _MM_SHUFFLE(3, 3, 1, 1));
+        if (swap_uv) { std::swap(d, e); }
+
+        const __m128i one = _mm_set1_epi16(1);
+        const __m128i round = _mm_set1_epi32(128);
+        const __m128i r_coef = _mm_set_epi16(409, 298, 409, 298, 409, 298,
+                                             409, 298);
+        const __m128i g_coef = _mm_set_epi16(-100, 298, -100, 298, -100, 298,
+                                             -100, 298);
+        const __m128i g2_coef = _mm_set_epi16(128, -208, 128, -208, 128, -208,
+                                              128, -208);
+        const __m128i b_coef = _mm_set_epi16(516, 298, 516, 298, 516, 298,
+                                             516, 298);
+
+        const __m128i ce_lo = _mm_unpacklo_epi16(c, e);
+        const __m128i ce_hi = _mm_unpackhi_epi16(c, e);
+        const __m128i cd_lo = _mm_unpacklo_epi16(c, d);
+        const __m128i cd_hi = _mm_unpackhi_epi16(c, d);
+        const __m128i e1_lo = _mm_unpacklo_epi16(e, one);
+        const __m128i e1_hi = _mm_unpackhi_epi16(e, one);
+
+        __m128i channels[4];
+        channels[0] = yuv_channel_sse2(ce_lo, ce_hi, r_coef, round, round);
+        channels[1] = yuv_channel_sse2(cd_lo, cd_hi, g_coef,
+                                       _mm_madd_epi16(e1_lo, g2_coef),
+                                       _mm_madd_epi16(e1_hi, g2_coef));
+        channels[2] = yuv_channel_sse2(cd_lo, cd_hi, b_coef, round, round);
+        channels[3] = _mm_set1_epi8(-1);
+
+        const __m128i lo = _mm_unpacklo_epi8(channels[order[0]],
+                                             channels[order[1]]);
+        const __m128i hi = _mm_unpacklo_epi8(channels[order[2]],
+                                             channels[order[3]]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                         _mm_unpacklo_epi16(lo, hi));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16),
+                         _mm_unpackhi_epi16(lo, hi));
+    }
+
+    SDLXX_TARGET_SSE2
+    inline void packed_yuv_row_sse2(const pixel_conversion& conv,
+                                    const unsigned char* src,
+                                    const unsigned char* chroma,
+                                    unsigned char* dst, int width) {
+        // Each 16-bit word holds a luma and a chroma byte
+        const __m128i low_bytes = _mm_set1_epi16(0xFF);
+        const __m128i y_shift = _mm_cvtsi32_si128(8 * conv.y_offset);
+        const __m128i c_shift = _mm_cvtsi32_si128(8 * (1 - conv.y_offset));
+        const bool swap_uv = conv.v_offset < conv.u_offset;
+
+        int x = 0;
+        for (; x + 8 <= width; x += 8) {
+            const __m128i v = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(src + 2 * x));
+            const __m128i luma =
+                _mm_and_si128(_mm_srl_epi16(v, y_shift), low_bytes);
+            const __m128i uv =
+                _mm_and_si128(_mm_srl_epi16(v, c_shift), low_bytes);
+            yuv_to_rgb_sse2(luma, uv, swap_uv, conv.order, dst + 4 * x);
+        }
+        packed_yuv_row(conv, src + 2 * x, chroma, dst + 4 * x, width - x);
+    }
+
+    SDLXX_TARGET_SSE2
+    inline void planar_yuv_row_sse2(const pixel_conversion& conv,
+                                    const unsigned char* src,
+                                    const unsigned char* chroma,
+                                    unsigned char* dst, int width) {
+        const __m128i zero = _mm_setzero_si128();
+        const bool swap_uv = conv.v_offset < conv.u_offset;
+
+        int x = 0;
+        for (; x + 8 <= width; x += 8) {
+            const __m128i luma = _mm_unpacklo_epi8(
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + x)),
+                zero);
+            const __m128i uv = _mm_unpacklo_epi8(
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(chroma + x)),
+                zero);
+            yuv_to_rgb_sse2(luma, uv, swap_uv, conv.order, dst + 4 * x);
+        }
+        planar_yuv_row(conv, src + x, chroma + x, dst + 4 * x, width - x);
+    }
+
+    // Multiplies the colour channels of 4 pixels by their alpha
+    SDLXX_TARGET_SSE2
+    inline __m128i premultiply_sse2(__m128i v, __m128i alpha_shift,
+                                    __m128i alpha_mask) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i round = _mm_set1_epi16(128);
+        // Each 32-bit lane of `a2` holds its pixel's alpha twice, and is
+        // then spread over the pixel's four 16-bit channels
+        const __m128i a = _mm_and_si128(_mm_srl_epi32(v, alpha_shift),
+                                        _mm_set1_epi32(0xFF));
+        const __m128i a2 = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+
+        __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(v, zero),
+                                     _mm_unpacklo_epi32(a2, a2));
+        __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(v, zero),
+                                     _mm_unpackhi_epi32(a2, a2));
+        lo = _mm_add_epi16(lo, round);
+        hi = _mm_add_epi16(hi, round);
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+
+        const __m128i out = _mm_packus_epi16(lo, hi);
+        return _mm_or_si128(_mm_andnot_si128(alpha_mask, out),
+                            _mm_and_si128(alpha_mask, v));
+    }
+
+    SDLXX_TARGET_SSE2
+    inline void premultiply_row_sse2(int alpha, const unsigned char* src,
+                                     unsigned char* dst, int width) {
+        const __m128i shift = _mm_cvtsi32_si128(8 * alpha);
+        const __m128i mask =
+            _mm_set1_epi32(static_cast<int>(0xFFu << 8 * alpha));
+        int x = 0;
+        for (; x + 4 <= width; x += 4) {
+            const __m128i v = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(src + 4 * x));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * x),
+                             premultiply_sse2(v, shift, mask));
+        }
+        premultiply_row(alpha, src + 4 * x, dst + 4 * x, width - x);
+    }
+
+    // SSSE3 kernels, used when SSE4.1 is available
+
+    SDLXX_TARGET_SSE41
+    inline void shuffle_row_ssse3(const pixel_conversion& conv,
+                                  const unsigned char* src,
+                                  const unsigned char* chroma,
+                                  unsigned char* dst, int width) {
+        const __m128i mask =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(conv.shuffle));
+        const __m128i fill = _mm_set1_epi32(static_cast<int>(conv.fill));
+        const int bytes = conv.src_bytes;
+        // 3-byte pixels use 12 of the 16 bytes loaded, so the loop must
+        // stop early enough not to read past the end of the row
+        const int stop = bytes == 4 ? width - 4 : width - 6;
+
+        int x = 0;
+        for (; x <= stop; x += 4) {
+            const __m128i v = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(src + bytes * x));
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(dst + 4 * x),
+                _mm_or_si128(_mm_shuffle_epi8(v, mask), fill));
+        }
+        shuffle_row(conv, src + bytes * x, chroma, dst + 4 * x, width - x);
+    }
+
+    // AVX2 kernels
+
+    SDLXX_TARGET_AVX2
+    inline void shuffle_row_avx2(const pixel_conversion& conv,
+                                 const unsigned char* src,
+                                 const unsigned char* chroma,
+                                 unsigned char* dst, int width) {
+        // vpshufb works within each 128-bit lane, so each lane converts 4
+        // pixels with the same mask
+        const __m128i mask128 =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(conv.shuffle));
+        const __m256i mask = _mm256_broadcastsi128_si256(mask128);
+        const __m256i fill = _mm256_set1_epi32(static_cast<int>(conv.fill));
+        const int bytes = conv.src_bytes;
+        const int stop = bytes == 4 ? width - 8 : width - 10;
+
+        int x = 0;
+        for (; x <= stop; x += 8) {
+            const unsigned char* p = src + bytes * x;
+            __m256i v;
+            if (bytes == 4) {
+                v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            } else {
+                v = _mm256_inserti128_si256(
+                    _mm256_castsi128_si256(
+                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p))),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 12)),
+                    1);
+            }
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i*>(dst + 4 * x),
+                _mm256_or_si256(_mm256_shuffle_epi8(v, mask), fill));
+        }
+        shuffle_row_ssse3(conv, src + bytes * x, chroma, dst + 4 * x,
+                          width - x);
+    }
+
+    SDLXX_TARGET_AVX2
+    inline void premultiply_row_avx2(int alpha, const unsigned char* src,
+                                     unsigned char* dst, int width) {
+        const __m128i shift = _mm_cvtsi32_si128(8 * alpha);
+        const __m256i alpha_mask =
+            _mm256_set1_epi32(static_cast<int>(0xFFu << 8 * alpha));
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i round = _mm256_set1_epi16(128);
+        const __m256i low_byte = _mm256_set1_epi32(0xFF);
+
+        // As premultiply_sse2(), with each 128-bit lane holding 4 pixels
+        int x = 0;
+        for (; x + 8 <= width; x += 8) {
+            const __m256i v = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(src + 4 * x));
+            const __m256i a =
+                _mm256_and_si256(_mm256_srl_epi32(v, shift), low_byte);
+            const __m256i a2 = _mm256_or_si256(a, _mm256_slli_epi32(a, 16));
+
+            __m256i lo = _mm256_mullo_epi16(_mm256_unpacklo_epi8(v, zero),
+                                            _mm256_unpacklo_epi32(a2, a2));
+            __m256i hi = _mm256_mullo_epi16(_mm256_unpackhi_epi8(v, zero),
+                                            _mm256_unpackhi_epi32(a2, a2));
+            lo = _mm256_add_epi16(lo, round);
+            hi = _mm256_add_epi16(hi, round);
+            lo = _mm256_srli_epi16(
+                _mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8);
+            hi = _mm256_srli_epi16(
+                _mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8);
+
+            const __m256i out = _mm256_packus_epi16(lo, hi);
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i*>(dst + 4 * x),
+                _mm256_or_si256(_mm256_andnot_si256(alpha_mask, out),
+                                _mm256_and_si256(alpha_mask, v)));
+        }
+        premultiply_row_sse2(alpha, src + 4 * x, dst + 4 * x, width - x);
+    }
+
+#endif // SDLXX_SIMD_X86
+
+    // Chooses the kernel for converting `src` to `dst` pixels at the given
+    // SIMD level. If the pair is not supported, the kernel is null.
+    inline pixel_conversion plan_pixel_conversion(uint32_t src, uint32_t dst,
+                                                  simd_level level) {
+        static_cast<void>(level); // Unused without x86 kernels
+        pixel_conversion conv;
+        pixel_byte_order to;
+        if (!get_pixel_byte_order(dst, to) || to.bytes != 4) {
+            if (src == dst && !SDL_ISPIXELFORMAT_FOURCC(src) &&
+                SDL_BITSPERPIXEL(src) >= 8) {
+                conv.src_bytes = conv.dst_bytes = SDL_BYTESPERPIXEL(src);
+                conv.row = &copy_row;
+            }
+            return conv;
+        }
+        conv.dst_bytes = 4;
+
+        pixel_byte_order from;
+        if (get_pixel_byte_order(src, from)) {
+            conv.src_bytes = from.bytes;
+            if (src == dst) {
+                conv.row = &copy_row;
+                return conv;
+            }
+            const int channels[4][2] = {{to.r, from.r},
+                                        {to.g, from.g},
+                                        {to.b, from.b},
+                                        {to.a, from.alpha ? from.a : -1}};
+            for (const auto& c : channels) {
+                // Padding is always set to 0xFF
+                conv.src_offset[c[0]] = to.alpha || c[0] != to.a ? c[1] : -1;
+            }
+            for (int j = 0; j < 4; j++) {
+                const int i = conv.src_offset[j];
+                if (i < 0) { conv.fill |= 0xFFu << 8 * j; }
+                for (int p = 0; p < 4; p++) {
+                    conv.shuffle[4 * p + j] = static_cast<unsigned char>(
+                        i < 0 ? 0x80 : p * from.bytes + i);
+                }
+            }
+            conv.row = &shuffle_row;
+#ifdef SDLXX_SIMD_X86
+            if (level == simd_level::avx2) {
+                conv.row = &shuffle_row_avx2;
+            } else if (level == simd_level::sse41) {
+                conv.row = &shuffle_row_ssse3;
+            } else if (level == simd_level::sse2 && from.bytes == 4) {
+                conv.row = &shuffle_row_sse2;
+            }
+#endif
+            return conv;
+        }
+
+        conv.dst_offset[0] = to.r;
+        conv.dst_offset[1] = to.g;
+        conv.dst_offset[2] = to.b;
+        conv.dst_offset[3] = to.a;
+        for (int c = 0; c < 4; c++) { conv.order[conv.dst_offset[c]] = c; }
+
+        static const struct {
+            uint32_t format;
+            bool planar;
+            int y, u, v;
+        } yuv_formats[] = {
+            {SDL_PIXELFORMAT_YUY2, false, 0, 1, 3},
+            {SDL_PIXELFORMAT_UYVY, false, 1, 0, 2},
+            {SDL_PIXELFORMAT_YVYU, false, 0, 3, 1},
+            {SDL_PIXELFORMAT_NV12, true, 0, 0, 1},
+            {SDL_PIXELFORMAT_NV21, true, 0, 1, 0},
+        };
+        const auto yuv = std::find_if(
+            std::begin(yuv_formats), std::end(yuv_formats),
+            [src](const auto& entry) { return entry.format == src; });
+        if (yuv == std::end(yuv_formats)) { return conv; }
+        conv.planar = yuv->planar;
+        conv.y_offset = yuv->y;
+        conv.u_offset = yuv->u;
+        conv.v_offset = yuv->v;
+
+        conv.row = conv.planar ? &planar_yuv_row : &packed_yuv_row;
+#ifdef SDLXX_SIMD_X86
+        if (level != simd_level::none) {
+            conv.row = conv.planar ? &planar_yuv_row_sse2
+                                   : &packed_yuv_row_sse2;
+        }
+#endif
+        return conv;
+    }
+
+    // Runs a conversion planned by plan_pixel_conversion(). NV12 and NV21
+    // have their interleaved chroma plane after the luma plane, at half the
+    // height, and with the same pitch rounded up to an even number.
+    inline void convert_pixels(const pixel_conversion& conv, int width,
+                               int height, const void* src, int src_pitch,
+                               void* dst, int dst_pitch) {
+        const auto s = static_cast<const unsigned char*>(src);
+        const auto d = static_cast<unsigned char*>(dst);
+        const unsigned char* chroma = nullptr;
+        std::ptrdiff_t chroma_pitch = 0;
+        if (conv.planar) {
+            chroma = s + static_cast<std::ptrdiff_t>(src_pitch) * height;
+            chroma_pitch = (src_pitch + 1) & ~1;
+        }
+        for (int y = 0; y < height; y++) {
+            conv.row(conv, s + static_cast<std::ptrdiff_t>(y) * src_pitch,
+                     chroma ? chroma + (y / 2) * chroma_pitch : nullptr,
+                     d + static_cast<std::ptrdiff_t>(y) * dst_pitch, width);
+        }
+    }
+
+    using premultiply_row_fn = void (*)(int, const unsigned char*,
+                                        unsigned char*, int);
+
+    inline premultiply_row_fn select_premultiply(simd_level level) {
+#ifdef SDLXX_SIMD_X86
+        if (level == simd_level::avx2) { return &premultiply_row_avx2; }
+        if (level != simd_level::none) { return &premultiply_row_sse2; }
+#endif
+        static_cast<void>(level);
+        return &premultiply_row;
+    }
+
+} // end namespace detail
+} // end namespace sdl
+
+#endif // SDLXX_DETAIL_CONVERT_PIXELS_HPP
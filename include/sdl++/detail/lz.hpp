@@ -0,0 +1,179 @@
+/*!
+  @file lz.hpp
+  Simple DirectMedia Layer C++ Bindings
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDLXX_DETAIL_LZ_HPP
+#define SDLXX_DETAIL_LZ_HPP
+
+#include <sdl++/stdinc.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace sdl {
+namespace detail {
+
+    // A simple LZ77 block codec, in the style of LZ4. It is designed for fast
+    // decompression of data compressed ahead of time, such as game assets.
+    //
+    // The compressed data is a series of sequences. Each sequence begins with
+    // a token byte: the high nibble is the number of literal bytes and the
+    // low nibble is the match length minus lz_min_match. A nibble of 15
+    // means that the length continues in following bytes, each of which is
+    // added to it, until a byte other than 255. The literal bytes follow,
+    // then (except in the final sequence) a two-byte little-endian offset
+    // back into the output from which the match is copied.
+
+    constexpr size_t lz_min_match = 4;
+    constexpr size_t lz_max_offset = 65535;
+    constexpr unsigned lz_hash_bits = 12;
+
+    inline uint32_t lz_read32(const uint8_t* p) {
+        uint32_t v;
+        SDL_memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline void lz_put_length(std::vector<uint8_t>& out, size_t len) {
+        while (len >= 255) {
+            out.push_back(255);
+            len -= 255;
+        }
+        out.push_back(static_cast<uint8_t>(len));
+    }
+
+    inline void lz_put_sequence(std::vector<uint8_t>& out,
+                                const uint8_t* literals, size_t literal_len,
+                                size_t offset, size_t match_len) {
+        const size_t match_code = match_len ? match_len - lz_min_match : 0;
+        out.push_back(static_cast<uint8_t>(
+            (std::min<size_t>(literal_len, 15) << 4) |
+            std::min<size_t>(match_code, 15)));
+        if (literal_len >= 15) { lz_put_length(out, literal_len - 15); }
+        out.insert(out.end(), literals, literals + literal_len);
+        if (match_len == 0) { return; }
+        out.push_back(static_cast<uint8_t>(offset));
+        out.push_back(static_cast<uint8_t>(offset >> 8));
+        if (match_code >= 15) { lz_put_length(out, match_code - 15); }
+    }
+
+    //! Compresses `n` bytes starting at `src`
+    inline std::vector<uint8_t> lz_compress(const uint8_t* src, size_t n) {
+        std::vector<uint8_t> out;
+        out.reserve(n + n / 255 + 16);
+
+        // Positions are stored plus one, so that zero means empty
+        std::vector<uint32_t> table(size_t{1} << lz_hash_bits);
+        size_t anchor = 0;
+        size_t i = 0;
+
+        while (i + lz_min_match <= n) {
+            const uint32_t h = (lz_read32(src + i) * 2654435761u) >>
+                               (32 - lz_hash_bits);
+            const size_t candidate = table[h];
+            table[h] = static_cast<uint32_t>(i + 1);
+
+            if (candidate != 0 && i - (candidate - 1) <= lz_max_offset &&
+                lz_read32(src + candidate - 1) == lz_read32(src + i)) {
+                const size_t match = candidate - 1;
+                size_t len = lz_min_match;
+                while (i + len < n && src[match + len] == src[i + len]) {
+                    ++len;
+                }
+                lz_put_sequence(out, src + anchor, i - anchor, i - match, len);
+                i += len;
+                anchor = i;
+            } else {
+                ++i;
+            }
+        }
+
+        lz_put_sequence(out, src + anchor, n - anchor, 0, 0);
+        return out;
+    }
+
+    inline bool lz_get_length(const uint8_t*& ip, const uint8_t* end,
+                              size_t& len) {
+        uint8_t byte;
+        do {
+            if (ip == end) { return false; }
+            byte = *ip++;
+            len += byte;
+        } while (byte == 255);
+        return true;
+    }
+
+    //! Decompresses `src_len` bytes from `src` into exactly `dst_len` bytes
+    //! at `dst`
+    //! @returns false if the input is malformed or does not decompress to
+    //!          exactly `dst_len` bytes
+    inline bool lz_decompress(const uint8_t* src, size_t src_len, uint8_t* dst,
+                              size_t dst_len) {
+        const uint8_t* ip = src;
+        const uint8_t* const ip_end = src + src_len;
+        uint8_t* op = dst;
+        uint8_t* const op_end = dst + dst_len;
+
+        while (ip != ip_end) {
+            const uint8_t token = *ip++;
+
+            size_t literal_len = token >> 4;
+            if (literal_len == 15 && !lz_get_length(ip, ip_end, literal_len)) {
+                return false;
+            }
+            if (literal_len > static_cast<size_t>(ip_end - ip) ||
+                literal_len > static_cast<size_t>(op_end - op)) {
+                return false;
+            }
+            if (literal_len) { SDL_memcpy(op, ip, literal_len); }
+            ip += literal_len;
+            op += literal_len;
+
+            // The final sequence has no match
+            if (ip == ip_end) { break; }
+
+            if (ip_end - ip < 2) { return false; }
+            const size_t offset = ip[0] | (ip[1] << 8);
+            ip += 2;
+
+            size_t match_len = token & 15;
+            if (match_len == 15 && !lz_get_length(ip, ip_end, match_len)) {
+                return false;
+            }
+            match_len += lz_min_match;
+
+            if (offset == 0 || offset > static_cast<size_t>(op - dst) ||
+                match_len > static_cast<size_t>(op_end - op)) {
+                return false;
+            }
+            // The match may overlap the output, so copy forwards byte by byte
+            const uint8_t* match = op - offset;
+            for (size_t k = 0; k < match_len; ++k) { op[k] = match[k]; }
+            op += match_len;
+        }
+
+        return op == op_end;
+    }
+
+} // end namespace detail
+} // end namespace sdl
+
+#endif // SDLXX_DETAIL_LZ_HPP
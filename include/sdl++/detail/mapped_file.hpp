@@ -0,0 +1,192 @@
+/*!
+  @file mapped_file.hpp
+  Simple DirectMedia Layer C++ Bindings
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDLXX_DETAIL_MAPPED_FILE_HPP
+#define SDLXX_DETAIL_MAPPED_FILE_HPP
+
+#include "SDL_platform.h"
+#include "SDL_rwops.h"
+
+#include <sdl++/result.hpp>
+#include <sdl++/stdinc.hpp>
+
+#include <cstdint>
+#include <utility>
+
+#if defined(__WIN32__) && !defined(__WINRT__)
+#define SDLXX_MAPPED_FILE_WIN32 1
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <vector>
+#elif defined(__unix__) || defined(__APPLE__)
+#define SDLXX_MAPPED_FILE_POSIX 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sdl {
+namespace detail {
+
+    // A read-only view of an entire file. Where the platform supports it the
+    // file is memory-mapped, so that pages are only read from disk when they
+    // are touched. Otherwise (or if mapping fails, for example for Android
+    // assets, which are not real files) the file is read into memory using
+    // SDL_RWops.
+    class mapped_file {
+    public:
+        mapped_file() = default;
+
+        mapped_file(mapped_file&& other) noexcept
+            : ptr{other.ptr}, len{other.len}, mapped{other.mapped} {
+            other.ptr = nullptr;
+            other.len = 0;
+        }
+
+        mapped_file& operator=(mapped_file&& other) noexcept {
+            std::swap(ptr, other.ptr);
+            std::swap(len, other.len);
+            std::swap(mapped, other.mapped);
+            return *this;
+        }
+
+        ~mapped_file() { release(); }
+
+        static result<mapped_file> open(const char* path) {
+            mapped_file file;
+            if (file.map(path) || file.read(path)) { return file; }
+            return failure;
+        }
+
+        const uint8_t* data() const noexcept { return ptr; }
+        size_t size() const noexcept { return len; }
+        bool is_mapped() const noexcept { return mapped; }
+
+    private:
+#if defined(SDLXX_MAPPED_FILE_WIN32)
+        bool map(const char* path) {
+            const int wlen = ::MultiByteToWideChar(CP_UTF8, 0, path, -1,
+                                                   nullptr, 0);
+            if (wlen <= 0) { return false; }
+            std::vector<wchar_t> wpath(static_cast<size_t>(wlen));
+            ::MultiByteToWideChar(CP_UTF8, 0, path, -1, wpath.data(), wlen);
+
+            const HANDLE file = ::CreateFileW(
+                wpath.data(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) { return false; }
+
+            LARGE_INTEGER size;
+            HANDLE mapping = nullptr;
+            if (::GetFileSizeEx(file, &size) && size.QuadPart > 0 &&
+                static_cast<uint64_t>(size.QuadPart) <= SIZE_MAX) {
+                mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0,
+                                               0, nullptr);
+            }
+            ::CloseHandle(file);
+            if (!mapping) { return false; }
+
+            // The view keeps the mapping alive after its handle is closed
+            const void* view =
+                ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            ::CloseHandle(mapping);
+            if (!view) { return false; }
+
+            ptr = static_cast<const uint8_t*>(view);
+            len = static_cast<size_t>(size.QuadPart);
+            mapped = true;
+            return true;
+        }
+#elif defined(SDLXX_MAPPED_FILE_POSIX)
+        bool map(const char* path) {
+            const int fd = ::open(path, O_RDONLY);
+            if (fd < 0) { return false; }
+
+            struct stat st;
+            void* view = MAP_FAILED;
+            if (::fstat(fd, &st) == 0 && st.st_size > 0 &&
+                static_cast<uint64_t>(st.st_size) <= SIZE_MAX) {
+                view = ::mmap(nullptr, static_cast<size_t>(st.st_size),
+                              PROT_READ, MAP_PRIVATE, fd, 0);
+            }
+            // The mapping remains valid after the descriptor is closed
+            ::close(fd);
+            if (view == MAP_FAILED) { return false; }
+
+            ptr = static_cast<const uint8_t*>(view);
+            len = static_cast<size_t>(st.st_size);
+            mapped = true;
+            return true;
+        }
+#else
+        bool map(const char*) { return false; }
+#endif
+
+        bool read(const char* path) {
+            SDL_RWops* rw = ::SDL_RWFromFile(path, "rb");
+            if (!rw) { return false; }
+
+            bool ok = false;
+            const Sint64 size = SDL_RWsize(rw);
+            if (size == 0) {
+                ok = true;
+            } else if (size > 0 && static_cast<uint64_t>(size) <= SIZE_MAX) {
+                const auto n = static_cast<size_t>(size);
+                auto buf = static_cast<uint8_t*>(::SDL_malloc(n));
+                if (buf && SDL_RWread(rw, buf, 1, n) == n) {
+                    ptr = buf;
+                    len = n;
+                    ok = true;
+                } else {
+                    ::SDL_free(buf);
+                    if (buf) { ::SDL_SetError("Error reading file"); }
+                }
+            }
+            SDL_RWclose(rw);
+            return ok;
+        }
+
+        void release() noexcept {
+            if (!ptr) { return; }
+            if (!mapped) {
+                ::SDL_free(const_cast<uint8_t*>(ptr));
+            } else {
+#if defined(SDLXX_MAPPED_FILE_WIN32)
+                ::UnmapViewOfFile(ptr);
+#elif defined(SDLXX_MAPPED_FILE_POSIX)
+                ::munmap(const_cast<uint8_t*>(ptr), len);
+#endif
+            }
+        }
+
+        const uint8_t* ptr = nullptr;
+        size_t len = 0;
+        bool mapped = false;
+    };
+
+} // end namespace detail
+} // end namespace sdl
+
+#endif // SDLXX_DETAIL_MAPPED_FILE_HPP
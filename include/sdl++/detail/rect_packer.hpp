@@ -0,0 +1,257 @@
+/*!
+  @file rect_packer.hpp
+  Simple DirectMedia Layer C++ Bindings
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDLXX_DETAIL_RECT_PACKER_HPP
+#define SDLXX_DETAIL_RECT_PACKER_HPP
+
+#include "SDL_rect.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <vector>
+
+namespace sdl {
+namespace detail {
+
+    // Allocates rectangles within a fixed-size area, for texture atlases.
+    //
+    // New rectangles are placed on a skyline: the outline of the tops of
+    // the rectangles placed so far, stored as horizontal segments from left
+    // to right. Each rectangle goes where its top edge is lowest, which is
+    // the bottom-left heuristic of Jukka Jylanki's "A Thousand Ways to Pack
+    // the Bin".
+    //
+    // Space which the skyline cannot reach, below a rectangle placed over a
+    // lower segment, goes onto a free list along with released rectangles.
+    // Allocation tries the free list first, choosing the rectangle which
+    // leaves the least area unused and splitting off the remainder
+    // guillotine-style. Released space is not merged, but the whole area is
+    // reset when everything has been released.
+    //
+    // A full packer is asked about every rectangle added to a multi-page
+    // atlas, so both steps keep enough state to reject most sizes at once.
+    class rect_packer {
+    public:
+        rect_packer(int width, int height) : width{width}, height{height} {
+            reset();
+        }
+
+        int get_width() const noexcept { return width; }
+        int get_height() const noexcept { return height; }
+
+        // Releases all rectangles
+        void reset() {
+            skyline.assign(1, skyline_node{0, 0, width});
+            free_rects.clear();
+            free_max_w = free_max_h = 0;
+            min_w = min_h = INT_MAX;
+            free_fail_w = free_fail_h = INT_MAX;
+            skyline_fail_w = skyline_fail_h = INT_MAX;
+        }
+
+        // Allocates a `w` by `h` rectangle, returning false if there is no
+        // room
+        bool insert(int w, int h, SDL_Rect& out) {
+            if (w <= 0 || h <= 0 || w > width || h > height) { return false; }
+            min_w = std::min(min_w, w);
+            min_h = std::min(min_h, h);
+            return insert_free(w, h, out) || insert_skyline(w, h, out);
+        }
+
+        // Makes the space of an allocated rectangle available again
+        void release(const SDL_Rect& r) { add_free(r); }
+
+        // The number of rectangles on the free list, for testing
+        size_t free_count() const noexcept { return free_rects.size(); }
+
+    private:
+        struct skyline_node {
+            int x;
+            int y;
+            int w;
+        };
+
+        bool insert_free(int w, int h, SDL_Rect& out) {
+            // free_max_w and free_max_h are upper bounds, made exact by any
+            // search which fails. Until space is added, a size at least as
+            // large as one which failed will also fail.
+            if (w > free_max_w || h > free_max_h ||
+                (w >= free_fail_w && h >= free_fail_h)) {
+                return false;
+            }
+            auto best = free_rects.end();
+            long long best_waste = LLONG_MAX;
+            int max_w = 0;
+            int max_h = 0;
+            for (auto it = free_rects.begin(); it != free_rects.end(); ++it) {
+                max_w = std::max(max_w, it->w);
+                max_h = std::max(max_h, it->h);
+                if (it->w < w || it->h < h) { continue; }
+                const long long waste =
+                    area(it->w, it->h) - area(w, h);
+                if (waste < best_waste) {
+                    best = it;
+                    best_waste = waste;
+                    if (waste == 0) { break; }
+                }
+            }
+            if (best == free_rects.end()) {
+                free_max_w = max_w;
+                free_max_h = max_h;
+                remember_failure(w, h, free_fail_w, free_fail_h);
+                return false;
+            }
+
+            const SDL_Rect f = *best;
+            *best = free_rects.back();
+            free_rects.pop_back();
+            out = SDL_Rect{f.x, f.y, w, h};
+
+            // Split along the shorter leftover axis, so that the larger
+            // piece stays as large as possible
+            const int right = f.w - w;
+            const int below = f.h - h;
+            if (right < below) {
+                add_free({f.x + w, f.y, right, h});
+                add_free({f.x, f.y + h, f.w, below});
+            } else {
+                add_free({f.x + w, f.y, right, f.h});
+                add_free({f.x, f.y + h, w, below});
+            }
+            return true;
+        }
+
+        // Space narrower or shorter than anything yet requested is dropped,
+        // as it would mostly be scanned and never used
+        void add_free(const SDL_Rect& r) {
+            if (r.w < min_w || r.h < min_h) { return; }
+            free_rects.push_back(r);
+            free_max_w = std::max(free_max_w, r.w);
+            free_max_h = std::max(free_max_h, r.h);
+            free_fail_w = free_fail_h = INT_MAX;
+        }
+
+        static long long area(int w, int h) noexcept {
+            return static_cast<long long>(w) * h;
+        }
+
+        // Keeps the smaller of two sizes which did not fit, so as to reject
+        // as many later sizes as possible
+        static void remember_failure(int w, int h, int& fail_w,
+                                     int& fail_h) noexcept {
+            if (area(w, h) < area(fail_w, fail_h)) {
+                fail_w = w;
+                fail_h = h;
+            }
+        }
+
+        // Returns the lowest y at which a `w` by `h` rectangle fits with its
+        // left edge on node `i`, or -1 if it does not fit
+        int fit(size_t i, int w, int h) const noexcept {
+            if (skyline[i].x + w > width) { return -1; }
+            int y = 0;
+            for (int remaining = w; remaining > 0; i++) {
+                y = std::max(y, skyline[i].y);
+                if (y + h > height) { return -1; }
+                remaining -= skyline[i].w;
+            }
+            return y;
+        }
+
+        bool insert_skyline(int w, int h, SDL_Rect& out) {
+            // The skyline only rises, so a size which did not fit never will
+            if (w >= skyline_fail_w && h >= skyline_fail_h) { return false; }
+            size_t best = skyline.size();
+            int best_y = INT_MAX;
+            int best_width = INT_MAX;
+            for (size_t i = 0; i < skyline.size(); i++) {
+                const int y = fit(i, w, h);
+                if (y < 0) { continue; }
+                if (y < best_y || (y == best_y && skyline[i].w < best_width)) {
+                    best = i;
+                    best_y = y;
+                    best_width = skyline[i].w;
+                }
+            }
+            if (best == skyline.size()) {
+                remember_failure(w, h, skyline_fail_w, skyline_fail_h);
+                return false;
+            }
+
+            const int x = skyline[best].x;
+            out = SDL_Rect{x, best_y, w, h};
+
+            // The space between the rectangle and the segments below it
+            for (size_t i = best; i < skyline.size(); i++) {
+                const auto& node = skyline[i];
+                if (node.x >= x + w) { break; }
+                const int right = std::min(node.x + node.w, x + w);
+                add_free({node.x, node.y, right - node.x, best_y - node.y});
+            }
+
+            skyline.insert(skyline.begin() + static_cast<std::ptrdiff_t>(best),
+                           skyline_node{x, best_y + h, w});
+
+            // Trim the segments now underneath the new one
+            for (size_t i = best + 1; i < skyline.size();) {
+                const auto& prev = skyline[i - 1];
+                auto& node = skyline[i];
+                const int overlap = prev.x + prev.w - node.x;
+                if (overlap <= 0) { break; }
+                node.x += overlap;
+                node.w -= overlap;
+                if (node.w > 0) { break; }
+                skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(i));
+            }
+
+            // Merge neighbouring segments of the same height
+            for (size_t i = 0; i + 1 < skyline.size();) {
+                if (skyline[i].y == skyline[i + 1].y) {
+                    skyline[i].w += skyline[i + 1].w;
+                    skyline.erase(skyline.begin() +
+                                  static_cast<std::ptrdiff_t>(i + 1));
+                } else {
+                    i++;
+                }
+            }
+            return true;
+        }
+
+        int width;
+        int height;
+        std::vector<skyline_node> skyline;
+        std::vector<SDL_Rect> free_rects;
+        int free_max_w = 0;
+        int free_max_h = 0;
+        int free_fail_w = INT_MAX;
+        int free_fail_h = INT_MAX;
+        int min_w = INT_MAX;
+        int min_h = INT_MAX;
+        int skyline_fail_w = INT_MAX;
+        int skyline_fail_h = INT_MAX;
+    };
+
+} // end namespace detail
+} // end namespace sdl
+
+#endif // SDLXX_DETAIL_RECT_PACKER_HPP
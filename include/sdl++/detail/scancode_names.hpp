@@ -0,0 +1,275 @@
+/*!
+  @file scancode_names.hpp
+  Simple DirectMedia Layer C++ Bindings
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+  @copyright (C) 1997-2016 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDLXX_DETAIL_SCANCODE_NAMES_HPP
+#define SDLXX_DETAIL_SCANCODE_NAMES_HPP
+
+#include "SDL_scancode.h"
+
+#include <sdl++/macros.hpp>
+#include <sdl++/stdinc.hpp>
+
+namespace sdl {
+namespace detail {
+
+    // Scancode names, as returned by SDL_GetScancodeName(). Indexed by
+    // scancode; codes without a name are nullptr.
+    constexpr const char* scancode_names[SDL_NUM_SCANCODES] = {
+        /*   0 */ nullptr, nullptr, nullptr, nullptr, "A", "B", "C", "D", "E",
+        /*   9 */ "F", "G", "H", "I", "J", "K", "L", "M", "N", "O", "P", "Q",
+        /*  21 */ "R", "S", "T", "U", "V", "W", "X", "Y", "Z", "1", "2", "3",
+        /*  33 */ "4", "5", "6", "7", "8", "9", "0", "Return", "Escape",
+        /*  42 */ "Backspace", "Tab", "Space", "-", "=", "[", "]", "\\", "#",
+        /*  51 */ ";", "'", "`", ",", ".", "/", "CapsLock", "F1", "F2", "F3",
+        /*  61 */ "F4", "F5", "F6", "F7", "F8", "F9", "F10", "F11", "F12",
+        /*  70 */ "PrintScreen", "ScrollLock", "Pause", "Insert", "Home",
+        /*  75 */ "PageUp", "Delete", "End", "PageDown", "Right", "Left",
+        /*  81 */ "Down", "Up", "Numlock", "Keypad /", "Keypad *", "Keypad -",
+        /*  87 */ "Keypad +", "Keypad Enter", "Keypad 1", "Keypad 2",
+        /*  91 */ "Keypad 3", "Keypad 4", "Keypad 5", "Keypad 6", "Keypad 7",
+        /*  96 */ "Keypad 8", "Keypad 9", "Keypad 0", "Keypad .", nullptr,
+        /* 101 */ "Application", "Power", "Keypad =", "F13", "F14", "F15",
+        /* 107 */ "F16", "F17", "F18", "F19", "F20", "F21", "F22", "F23", "F24",
+        /* 116 */ "Execute", "Help", "Menu", "Select", "Stop", "Again", "Undo",
+        /* 123 */ "Cut", "Copy", "Paste", "Find", "Mute", "VolumeUp",
+        /* 129 */ "VolumeDown", nullptr, nullptr, nullptr, "Keypad ,",
+        /* 134 */ "Keypad = (AS400)", nullptr, nullptr, nullptr, nullptr,
+        /* 139 */ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+        /* 146 */ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+        /* 153 */ "AltErase", "SysReq", "Cancel", "Clear", "Prior", "Return",
+        /* 159 */ "Separator", "Out", "Oper", "Clear / Again", "CrSel", "ExSel",
+        /* 165 */ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+        /* 172 */ nullptr, nullptr, nullptr, nullptr, "Keypad 00", "Keypad 000",
+        /* 178 */ "ThousandsSeparator", "DecimalSeparator", "CurrencyUnit",
+        /* 181 */ "CurrencySubUnit", "Keypad (", "Keypad )", "Keypad {",
+        /* 185 */ "Keypad }", "Keypad Tab", "Keypad Backspace", "Keypad A",
+        /* 189 */ "Keypad B", "Keypad C", "Keypad D", "Keypad E", "Keypad F",
+        /* 194 */ "Keypad XOR", "Keypad ^", "Keypad %", "Keypad <", "Keypad >",
+        /* 199 */ "Keypad &", "Keypad &&", "Keypad |", "Keypad ||", "Keypad :",
+        /* 204 */ "Keypad #", "Keypad Space", "Keypad @", "Keypad !",
+        /* 208 */ "Keypad MemStore", "Keypad MemRecall", "Keypad MemClear",
+        /* 211 */ "Keypad MemAdd", "Keypad MemSubtract", "Keypad MemMultiply",
+        /* 214 */ "Keypad MemDivide", "Keypad +/-", "Keypad Clear",
+        /* 217 */ "Keypad ClearEntry", "Keypad Binary", "Keypad Octal",
+        /* 220 */ "Keypad Decimal", "Keypad Hexadecimal", nullptr, nullptr,
+        /* 224 */ "Left Ctrl", "Left Shift", "Left Alt", "Left GUI",
+        /* 228 */ "Right Ctrl", "Right Shift", "Right Alt", "Right GUI",
+        /* 232 */ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+        /* 239 */ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+        /* 246 */ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+        /* 253 */ nullptr, nullptr, nullptr, nullptr, "ModeSwitch", "AudioNext",
+        /* 259 */ "AudioPrev", "AudioStop", "AudioPlay", "AudioMute",
+        /* 263 */ "MediaSelect", "WWW", "Mail", "Calculator", "Computer",
+        /* 268 */ "AC Search", "AC Home", "AC Back", "AC Forward", "AC Stop",
+        /* 273 */ "AC Refresh", "AC Bookmarks", "BrightnessDown",
+        /* 276 */ "BrightnessUp", "DisplaySwitch", "KBDIllumToggle",
+        /* 279 */ "KBDIllumDown", "KBDIllumUp", "Eject", "Sleep", "App1",
+        /* 284 */ "App2",
+    };
+
+    constexpr char to_lower_ascii(char c) noexcept {
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    inline SDLXX_CONSTEXPR14 size_t const_strlen(const char* s) noexcept {
+        size_t n = 0;
+        while (s[n] != '\0') { ++n; }
+        return n;
+    }
+
+    // Case-insensitive comparison of a null-terminated string `a` with the
+    // `b_len` characters starting at `b`
+    inline SDLXX_CONSTEXPR14 bool equal_nocase(const char* a, const char* b,
+                                size_t b_len) noexcept {
+        for (size_t i = 0; i < b_len; i++) {
+            if (a[i] == '\0' || to_lower_ascii(a[i]) != to_lower_ascii(b[i])) {
+                return false;
+            }
+        }
+        return a[b_len] == '\0';
+    }
+
+    /*
+     Reverse lookup uses a minimal-effort perfect hash ("hash and displace"),
+     built at compile time from the table above. Each name is hashed once.
+     The top bits of the hash select one of a small number of buckets, and
+     each bucket has a displacement value which has been chosen so that all
+     names in all buckets land in distinct slots. A lookup therefore costs
+     one hash, two table reads and one string comparison.
+     */
+    constexpr size_t scancode_hash_buckets = 64;
+    constexpr size_t scancode_hash_slots = 512;
+
+    // Case-insensitive 64-bit FNV-1a
+    inline SDLXX_CONSTEXPR14 uint64_t scancode_name_hash(const char* s,
+                                                         size_t n) noexcept {
+        uint64_t h = 0xcbf29ce484222325ull;
+        for (size_t i = 0; i < n; i++) {
+            h = (h ^ static_cast<uint8_t>(to_lower_ascii(s[i]))) *
+                0x100000001b3ull;
+        }
+        return h;
+    }
+
+    constexpr size_t scancode_hash_bucket(uint64_t h) noexcept {
+        return static_cast<size_t>(h >> 32) % scancode_hash_buckets;
+    }
+
+    constexpr size_t scancode_hash_slot(uint64_t h, uint32_t d) noexcept {
+        uint32_t x = static_cast<uint32_t>(h) ^ (d * 0x9E3779B9u);
+        x ^= x >> 16;
+        x *= 0x85EBCA6Bu;
+        x ^= x >> 13;
+        x *= 0xC2B2AE35u;
+        x ^= x >> 16;
+        return x % scancode_hash_slots;
+    }
+
+    struct scancode_hash_table {
+        uint32_t displacement[scancode_hash_buckets];
+        // Scancode plus one, or zero for an empty slot
+        uint16_t slots[scancode_hash_slots];
+    };
+
+    inline SDLXX_CONSTEXPR14 scancode_hash_table
+    make_scancode_hash_table() noexcept {
+        scancode_hash_table table{};
+        uint64_t hashes[SDL_NUM_SCANCODES] = {};
+        bool included[SDL_NUM_SCANCODES] = {};
+        size_t bucket_sizes[scancode_hash_buckets] = {};
+
+        // Where names are duplicated, only the first (lowest) scancode is
+        // included, matching SDL_GetScancodeFromName()
+        for (size_t code = 0; code < SDL_NUM_SCANCODES; code++) {
+            const char* name = scancode_names[code];
+            if (!name) { continue; }
+            const size_t len = const_strlen(name);
+            hashes[code] = scancode_name_hash(name, len);
+            bool duplicate = false;
+            for (size_t prev = 0; prev < code && !duplicate; prev++) {
+                duplicate = included[prev] && hashes[prev] == hashes[code] &&
+                            equal_nocase(scancode_names[prev], name, len);
+            }
+            if (!duplicate) {
+                included[code] = true;
+                ++bucket_sizes[scancode_hash_bucket(hashes[code])];
+            }
+        }
+
+        size_t max_size = 0;
+        for (auto size : bucket_sizes) {
+            if (size > max_size) { max_size = size; }
+        }
+
+        // Place the largest buckets first, while there are the most free slots
+        for (size_t size = max_size; size > 0; --size) {
+            for (size_t b = 0; b < scancode_hash_buckets; b++) {
+                if (bucket_sizes[b] != size) { continue; }
+
+                for (uint32_t d = 0;; ++d) {
+                    bool placed = true;
+                    for (size_t code = 0; code < SDL_NUM_SCANCODES; code++) {
+                        if (!included[code] ||
+                            scancode_hash_bucket(hashes[code]) != b) {
+                            continue;
+                        }
+                        auto& slot =
+                            table.slots[scancode_hash_slot(hashes[code], d)];
+                        if (slot != 0) {
+                            placed = false;
+                            break;
+                        }
+                        slot = static_cast<uint16_t>(code + 1);
+                    }
+
+                    if (placed) {
+                        table.displacement[b] = d;
+                        break;
+                    }
+
+                    // Undo this attempt
+                    for (auto& slot : table.slots) {
+                        if (slot != 0 &&
+                            scancode_hash_bucket(hashes[slot - 1]) == b) {
+                            slot = 0;
+                        }
+                    }
+                }
+            }
+        }
+
+        return table;
+    }
+
+#ifdef SDLXX_HAS_CONSTEXPR14
+    constexpr scancode_hash_table scancode_table = make_scancode_hash_table();
+
+    constexpr const scancode_hash_table& get_scancode_table() noexcept {
+        return scancode_table;
+    }
+#else
+    // Without relaxed constexpr, the table is built on first use instead
+    inline const scancode_hash_table& get_scancode_table() noexcept {
+        static const scancode_hash_table table = make_scancode_hash_table();
+        return table;
+    }
+#endif
+
+    // Returns the scancode with the given name, or 0 (SDL_SCANCODE_UNKNOWN)
+    inline SDLXX_CONSTEXPR14 int find_scancode(const char* name,
+                                               size_t len) noexcept {
+        const uint64_t h = scancode_name_hash(name, len);
+        const auto& table = get_scancode_table();
+        const uint32_t d = table.displacement[scancode_hash_bucket(h)];
+        const int entry = table.slots[scancode_hash_slot(h, d)];
+        return entry != 0 &&
+                       equal_nocase(scancode_names[entry - 1], name, len)
+                   ? entry - 1
+                   : 0;
+    }
+
+    // Checks that every name can be found again
+    inline SDLXX_CONSTEXPR14 bool scancode_hash_is_perfect() noexcept {
+        for (size_t code = 0; code < SDL_NUM_SCANCODES; code++) {
+            const char* name = scancode_names[code];
+            if (!name) { continue; }
+            const int found = find_scancode(name, const_strlen(name));
+            if (found < 0 || found > static_cast<int>(code) ||
+                scancode_names[found] == nullptr ||
+                !equal_nocase(scancode_names[found], name,
+                              const_strlen(name))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+#ifdef SDLXX_HAS_CONSTEXPR14
+    static_assert(scancode_hash_is_perfect(),
+                  "Scancode name hash table is not perfect");
+#endif
+
+} // end namespace detail
+} // end namespace sdl
+
+#endif
@@ -0,0 +1,72 @@
+/*!
+  @file simd.hpp
+  Simple DirectMedia Layer C++ Bindings
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDLXX_DETAIL_SIMD_HPP
+#define SDLXX_DETAIL_SIMD_HPP
+
+#include <sdl++/cpuinfo.hpp>
+
+// x86 SIMD kernels are compiled with per-function target attributes, so
+// that they may be selected at run time without building the whole program
+// for the newest instruction set. MSVC allows any intrinsic in any function.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) ||             \
+    defined(_M_IX86)
+#define SDLXX_SIMD_X86 1
+#include <immintrin.h>
+#if defined(__GNUC__)
+#define SDLXX_TARGET_SSE2 __attribute__((target("sse2")))
+#define SDLXX_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define SDLXX_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SDLXX_TARGET_SSE2
+#define SDLXX_TARGET_SSE41
+#define SDLXX_TARGET_AVX2
+#endif
+#endif
+
+namespace sdl {
+namespace detail {
+
+    // Instruction sets for which kernels are provided, in increasing order.
+    // SDL does not report SSSE3, so kernels using it require SSE4.1, which
+    // every processor with SSE4.1 also supports.
+    enum class simd_level { none, sse2, sse41, avx2 };
+
+    inline simd_level detect_simd_level() {
+#ifdef SDLXX_SIMD_X86
+        if (cpu_has_avx2()) { return simd_level::avx2; }
+        if (cpu_has_sse41()) { return simd_level::sse41; }
+        if (cpu_has_sse2()) { return simd_level::sse2; }
+#endif
+        return simd_level::none;
+    }
+
+    // The best level supported by this processor, detected on first use
+    inline simd_level best_simd_level() {
+        static const simd_level level = detect_simd_level();
+        return level;
+    }
+
+} // end namespace detail
+} // end namespace sdl
+
+#endif // SDLXX_DETAIL_SIMD_HPP
@@ -0,0 +1,159 @@
+/*!
+  @file span.hpp
+  Simple DirectMedia Layer C++ Bindings
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef SDLXX_DETAIL_SPAN_HPP
+#define SDLXX_DETAIL_SPAN_HPP
+
+#include <cstddef>
+#include <type_traits>
+
+namespace sdl {
+
+namespace detail {
+
+    template <typename Container, typename T, typename = void>
+    struct is_span_compatible : std::false_type {};
+
+    // Containers with contiguous storage expose data() and size(); we
+    // require that data() returns a pointer convertible to T*
+    template <typename Container, typename T>
+    struct is_span_compatible<
+        Container, T,
+        std::enable_if_t<
+            std::is_convertible<
+                std::remove_pointer_t<decltype(
+                    std::declval<Container&>().data())> (*)[],
+                T (*)[]>::value &&
+            std::is_convertible<decltype(std::declval<Container&>().size()),
+                                std::size_t>::value>> : std::true_type {};
+
+} // end namespace detail
+
+/*!
+ A non-owning reference to a contiguous sequence of objects
+
+ This is a minimal version of the proposed `std::span` (formerly
+ `array_view`), with a dynamic extent only. It can be constructed from a
+ pointer and a length, a built-in array, or any container with `data()` and
+ `size()` members such as `std::vector` or `std::array`.
+
+ sdl++ uses spans to pass buffers to SDL functions which take a pointer and a
+ length.
+ */
+template <typename T>
+class span {
+public:
+    //! @cond
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+    using pointer = T*;
+    using reference = T&;
+    using iterator = T*;
+    using size_type = std::size_t;
+    //! @endcond
+
+    //! Constructs an empty `span`
+    constexpr span() noexcept = default;
+
+    //! Constructs a `span` referring to `count` objects starting at `ptr`
+    constexpr span(T* ptr, size_type count) noexcept : ptr{ptr}, len{count} {}
+
+    //! Constructs a `span` referring to the elements of an array
+    template <std::size_t N>
+    constexpr span(T (&arr)[N]) noexcept : ptr{arr}, len{N} {}
+
+    //! Constructs a `span` referring to the contents of a contiguous container
+    template <typename Container,
+              typename = std::enable_if_t<
+                  !std::is_same<std::decay_t<Container>, span>::value &&
+                  detail::is_span_compatible<Container, T>::value>>
+    constexpr span(Container& c) noexcept(noexcept(c.data()))
+        : ptr{c.data()}, len{static_cast<size_type>(c.size())} {}
+
+    //! Constructs a `span` of `const` elements referring to the contents of
+    //! a contiguous container, which may be a temporary
+    template <typename Container,
+              typename = std::enable_if_t<
+                  std::is_const<T>::value &&
+                  !std::is_same<std::decay_t<Container>, span>::value &&
+                  detail::is_span_compatible<const Container, T>::value>>
+    constexpr span(const Container& c) noexcept(noexcept(c.data()))
+        : ptr{c.data()}, len{static_cast<size_type>(c.size())} {}
+
+    //! Converts a span of `U` to a span of `T`, for example `span<int>` to
+    //! `span<const int>`
+    template <typename U,
+              typename = std::enable_if_t<
+                  std::is_convertible<U (*)[], T (*)[]>::value>>
+    constexpr span(const span<U>& other) noexcept
+        : ptr{other.data()}, len{other.size()} {}
+
+    //! Returns a pointer to the first element
+    constexpr T* data() const noexcept { return ptr; }
+    //! Returns the number of elements
+    constexpr size_type size() const noexcept { return len; }
+    //! Returns the size of the referenced elements in bytes
+    constexpr size_type size_bytes() const noexcept { return len * sizeof(T); }
+    //! Returns true if the span has no elements
+    constexpr bool empty() const noexcept { return len == 0; }
+
+    //! Returns the element at `idx`, which must be less than `size()`
+    constexpr T& operator[](size_type idx) const noexcept { return ptr[idx]; }
+
+    //! Returns an iterator to the first element
+    constexpr iterator begin() const noexcept { return ptr; }
+    //! Returns an iterator past the last element
+    constexpr iterator end() const noexcept { return ptr + len; }
+
+    //! Returns a span of the first `count` elements
+    constexpr span first(size_type count) const noexcept {
+        return {ptr, count};
+    }
+
+    //! Returns a span of the last `count` elements
+    constexpr span last(size_type count) const noexcept {
+        return {ptr + (len - count), count};
+    }
+
+    //! Returns a span of `count` elements starting at `offset`, or of all
+    //! the remaining elements if `count` is not given
+    constexpr span subspan(size_type offset,
+                           size_type count = size_type(-1)) const noexcept {
+        return {ptr + offset, count == size_type(-1) ? len - offset : count};
+    }
+
+private:
+    T* ptr = nullptr;
+    size_type len = 0;
+};
+
+//! Returns a span of the bytes making up the objects in `s`
+//! @relates span
+template <typename T>
+span<const unsigned char> as_bytes(span<T> s) noexcept {
+    return {reinterpret_cast<const unsigned char*>(s.data()), s.size_bytes()};
+}
+
+} // end namespace sdl
+
+#endif // SDLXX_DETAIL_SPAN_HPP
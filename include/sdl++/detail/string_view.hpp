@@ -0,0 +1,256 @@
+/*!
+  @file string_view.hpp
+  Simple DirectMedia Layer C++ Bindings
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDLXX_DETAIL_STRING_VIEW_HPP
+#define SDLXX_DETAIL_STRING_VIEW_HPP
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+namespace sdl {
+
+namespace detail {
+
+    // Defining npos in a class template base allows it to be odr-used
+    // without an out-of-line definition in a separate translation unit
+    template <typename = void>
+    struct string_view_npos {
+        static constexpr std::size_t npos = std::size_t(-1);
+    };
+
+    template <typename T>
+    constexpr std::size_t string_view_npos<T>::npos;
+
+} // end namespace detail
+
+/*!
+ A non-owning reference to a sequence of characters
+
+ This is a cut-down version of C++17's `std::string_view`. The library is
+ written against C++14, so this type is used for string parameters on every
+ compiler, whether or not `std::string_view` is also available. It provides
+ the most commonly used members, with the same names and semantics as the
+ standard version.
+
+ @note A `string_view` is not necessarily null-terminated.
+ */
+class string_view : public detail::string_view_npos<> {
+public:
+    //! @cond
+    using value_type = char;
+    using pointer = const char*;
+    using const_pointer = const char*;
+    using reference = const char&;
+    using const_reference = const char&;
+    using iterator = const char*;
+    using const_iterator = const char*;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    //! @endcond
+
+    //! Special value returned by the `find()` members when there is no match
+    using detail::string_view_npos<>::npos;
+
+    //! Constructs an empty `string_view`
+    constexpr string_view() noexcept = default;
+
+    //! Constructs a `string_view` referring to `count` characters starting at
+    //! `str`
+    constexpr string_view(const char* str, size_type count) noexcept
+        : ptr{str}, len{count} {}
+
+    //! Constructs a `string_view` referring to the null-terminated string
+    //! `str`
+    string_view(const char* str) noexcept
+        : ptr{str}, len{str ? std::strlen(str) : 0} {}
+
+    //! Constructs a `string_view` referring to the contents of `str`
+    string_view(const std::string& str) noexcept
+        : ptr{str.data()}, len{str.size()} {}
+
+    //! Returns an iterator to the first character
+    constexpr const_iterator begin() const noexcept { return ptr; }
+    //! Returns an iterator past the last character
+    constexpr const_iterator end() const noexcept { return ptr + len; }
+    //! @copydoc begin()
+    constexpr const_iterator cbegin() const noexcept { return ptr; }
+    //! @copydoc end()
+    constexpr const_iterator cend() const noexcept { return ptr + len; }
+
+    //! Returns the number of characters
+    constexpr size_type size() const noexcept { return len; }
+    //! Returns the number of characters
+    constexpr size_type length() const noexcept { return len; }
+    //! Returns true if the view has no characters
+    constexpr bool empty() const noexcept { return len == 0; }
+
+    //! Returns the character at `pos`, which must be less than `size()`
+    constexpr const_reference operator[](size_type pos) const noexcept {
+        return ptr[pos];
+    }
+
+    //! Returns the character at `pos`
+    //! @throws std::out_of_range if `pos >= size()`
+    const_reference at(size_type pos) const {
+        if (pos >= len) { throw std::out_of_range("sdl::string_view::at"); }
+        return ptr[pos];
+    }
+
+    //! Returns the first character. The view must not be empty.
+    constexpr const_reference front() const noexcept { return ptr[0]; }
+    //! Returns the last character. The view must not be empty.
+    constexpr const_reference back() const noexcept { return ptr[len - 1]; }
+    //! Returns a pointer to the first character
+    constexpr const_pointer data() const noexcept { return ptr; }
+
+    //! Removes the first `n` characters from the view
+    void remove_prefix(size_type n) noexcept {
+        ptr += n;
+        len -= n;
+    }
+
+    //! Removes the last `n` characters from the view
+    void remove_suffix(size_type n) noexcept { len -= n; }
+
+    //! Swaps the contents of two views
+    void swap(string_view& other) noexcept {
+        std::swap(ptr, other.ptr);
+        std::swap(len, other.len);
+    }
+
+    //! Returns a view of up to `count` characters starting at `pos`
+    //! @throws std::out_of_range if `pos > size()`
+    string_view substr(size_type pos = 0, size_type count = npos) const {
+        if (pos > len) { throw std::out_of_range("sdl::string_view::substr"); }
+        return {ptr + pos, std::min(count, len - pos)};
+    }
+
+    //! Copies the characters into a new `std::string`
+    std::string to_string() const { return {ptr, len}; }
+
+    //! Copies the characters into a new `std::string`
+    explicit operator std::string() const { return to_string(); }
+
+    //! Lexicographically compares two views, returning a negative value, zero
+    //! or a positive value in the manner of `std::string::compare()`
+    int compare(string_view other) const noexcept {
+        const size_type n = std::min(len, other.len);
+        const int r = n ? std::memcmp(ptr, other.ptr, n) : 0;
+        if (r != 0) { return r; }
+        return len < other.len ? -1 : (len > other.len ? 1 : 0);
+    }
+
+    //! Returns the position of the first occurrence of `c` at or after
+    //! `pos`, or `npos`
+    size_type find(char c, size_type pos = 0) const noexcept {
+        if (pos >= len) { return npos; }
+        const void* p = std::memchr(ptr + pos, c, len - pos);
+        return p ? static_cast<size_type>(static_cast<const char*>(p) - ptr)
+                 : npos;
+    }
+
+    //! Returns the position of the first occurrence of `str` at or after
+    //! `pos`, or `npos`
+    size_type find(string_view str, size_type pos = 0) const noexcept {
+        if (pos > len || str.len > len - pos) { return npos; }
+        const auto it = std::search(ptr + pos, ptr + len, str.ptr,
+                                    str.ptr + str.len);
+        return it == ptr + len && str.len != 0
+                   ? npos
+                   : static_cast<size_type>(it - ptr);
+    }
+
+    //! Returns the position of the last occurrence of `c` at or before
+    //! `pos`, or `npos`
+    size_type rfind(char c, size_type pos = npos) const noexcept {
+        if (len == 0) { return npos; }
+        for (size_type i = std::min(pos, len - 1) + 1; i > 0; --i) {
+            if (ptr[i - 1] == c) { return i - 1; }
+        }
+        return npos;
+    }
+
+private:
+    const char* ptr = nullptr;
+    size_type len = 0;
+};
+
+//! @cond
+// Comparisons. The extra overloads allow comparison with anything implicitly
+// convertible to string_view, such as string literals and std::strings.
+inline bool operator==(string_view lhs, string_view rhs) noexcept {
+    return lhs.size() == rhs.size() && lhs.compare(rhs) == 0;
+}
+
+inline bool operator!=(string_view lhs, string_view rhs) noexcept {
+    return !(lhs == rhs);
+}
+
+inline bool operator<(string_view lhs, string_view rhs) noexcept {
+    return lhs.compare(rhs) < 0;
+}
+
+inline bool operator>(string_view lhs, string_view rhs) noexcept {
+    return rhs < lhs;
+}
+
+inline bool operator<=(string_view lhs, string_view rhs) noexcept {
+    return !(rhs < lhs);
+}
+
+inline bool operator>=(string_view lhs, string_view rhs) noexcept {
+    return !(lhs < rhs);
+}
+
+#define SDLXX_STRING_VIEW_MIXED_COMPARISON(op, type)                           \
+    inline bool operator op(string_view lhs, type rhs) noexcept {              \
+        return lhs op string_view(rhs);                                        \
+    }                                                                          \
+    inline bool operator op(type lhs, string_view rhs) noexcept {              \
+        return string_view(lhs) op rhs;                                        \
+    }
+
+#define SDLXX_STRING_VIEW_MIXED_COMPARISONS(type)                              \
+    SDLXX_STRING_VIEW_MIXED_COMPARISON(==, type)                               \
+    SDLXX_STRING_VIEW_MIXED_COMPARISON(!=, type)                               \
+    SDLXX_STRING_VIEW_MIXED_COMPARISON(<, type)                                \
+    SDLXX_STRING_VIEW_MIXED_COMPARISON(>, type)                                \
+    SDLXX_STRING_VIEW_MIXED_COMPARISON(<=, type)                               \
+    SDLXX_STRING_VIEW_MIXED_COMPARISON(>=, type)
+
+SDLXX_STRING_VIEW_MIXED_COMPARISONS(const char*)
+SDLXX_STRING_VIEW_MIXED_COMPARISONS(const std::string&)
+
+#undef SDLXX_STRING_VIEW_MIXED_COMPARISONS
+#undef SDLXX_STRING_VIEW_MIXED_COMPARISON
+
+inline std::ostream& operator<<(std::ostream& os, string_view str) {
+    return os.write(str.data(), static_cast<std::streamsize>(str.size()));
+}
+//! @endcond
+
+} // end namespace sdl
+
+#endif // SDLXX_DETAIL_STRING_VIEW_HPP
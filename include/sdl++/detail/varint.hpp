@@ -0,0 +1,81 @@
+/*!
+  @file varint.hpp
+  Simple DirectMedia Layer C++ Bindings
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDLXX_DETAIL_VARINT_HPP
+#define SDLXX_DETAIL_VARINT_HPP
+
+#include <sdl++/stdinc.hpp>
+
+#include <vector>
+
+namespace sdl {
+namespace detail {
+
+    // LEB128-style variable length integers: seven bits per byte, least
+    // significant group first, with the top bit set on all but the last byte.
+
+    //! The maximum number of bytes used to encode a 64-bit varint
+    constexpr size_t max_varint_size = 10;
+
+    //! Appends `value` to `out` as a varint
+    inline void put_varint(std::vector<uint8_t>& out, uint64_t value) {
+        uint8_t buf[max_varint_size];
+        size_t n = 0;
+        while (value >= 0x80) {
+            buf[n++] = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        buf[n++] = static_cast<uint8_t>(value);
+        out.insert(out.end(), buf, buf + n);
+    }
+
+    //! Reads a varint from the range `[first, last)` into `value`
+    //! @returns A pointer past the end of the varint, or `nullptr` if the
+    //!          input is truncated or malformed
+    inline const uint8_t* get_varint(const uint8_t* first, const uint8_t* last,
+                                     uint64_t& value) {
+        value = 0;
+        for (unsigned shift = 0; first != last && shift < 64; shift += 7) {
+            const uint8_t byte = *first++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) { return first; }
+        }
+        return nullptr;
+    }
+
+    //! Maps signed values to unsigned so that small magnitudes of either sign
+    //! produce short varints: 0, -1, 1, -2, 2... become 0, 1, 2, 3, 4...
+    constexpr uint64_t zigzag_encode(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^
+               static_cast<uint64_t>(value >> 63);
+    }
+
+    //! Inverse of `zigzag_encode()`
+    constexpr int64_t zigzag_decode(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^
+               -static_cast<int64_t>(value & 1);
+    }
+
+} // end namespace detail
+} // end namespace sdl
+
+#endif
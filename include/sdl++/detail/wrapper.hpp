@@ -22,7 +22,11 @@
 
 #include <sdl++/stdinc.hpp>
 
+#include <cstring>
+#include <memory>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 
 #ifndef SDLXX_DETAIL_WRAPPER_HPP
 #define SDLXX_DETAIL_WRAPPER_HPP
@@ -38,18 +42,6 @@ namespace detail {
     template <typename CppType>
     using c_type_t = typename c_type<CppType>::type;
 
-    template <typename T,
-              typename = std::enable_if_t<std::is_fundamental<T>::value ||
-                                          std::is_enum<T>::value ||
-                                          std::is_pointer<T>::value>>
-    auto to_c_value(T arg) {
-        return static_cast<c_type_t<T>>(arg);
-    }
-
-    inline auto to_c_value(bool arg) { return arg ? SDL_TRUE : SDL_FALSE; }
-
-    inline auto to_c_value(const string& arg) { return arg.c_str(); }
-
     template <typename CType>
     struct cpp_type {
         using type = CType;
@@ -77,31 +69,220 @@ namespace detail {
         return s;
     }
 
+    template <typename T,
+              typename = std::enable_if_t<std::is_fundamental<T>::value ||
+                                          std::is_enum<T>::value ||
+                                          std::is_pointer<T>::value>>
+    auto to_c_value(T arg) {
+        return static_cast<c_type_t<T>>(arg);
+    }
+
+    inline auto to_c_value(bool arg) { return arg ? SDL_TRUE : SDL_FALSE; }
+
+    inline auto to_c_value(const string& arg) { return arg.c_str(); }
+
+    inline auto to_c_value(const sdl_string& arg) { return arg.c_str(); }
+
+    // Holds a null-terminated copy of a string_view for the duration of a C
+    // call. Strings shorter than the internal buffer avoid any allocation.
+    class c_string_arg {
+    public:
+        explicit c_string_arg(string_view str) : len{str.size()} {
+            char* dest = buf;
+            if (len >= sizeof(buf)) {
+                heap.reset(new char[len + 1]);
+                dest = heap.get();
+            }
+            if (len > 0) { std::memcpy(dest, str.data(), len); }
+            dest[len] = '\0';
+        }
+
+        c_string_arg(c_string_arg&& other) noexcept
+            : heap{std::move(other.heap)}, len{other.len} {
+            if (!heap) { std::memcpy(buf, other.buf, len + 1); }
+        }
+
+        operator const char*() const noexcept {
+            return heap ? heap.get() : buf;
+        }
+
+    private:
+        char buf[256];
+        std::unique_ptr<char[]> heap;
+        size_t len;
+    };
+
+    // Note that a string_view cannot be used for the variadic arguments of a
+    // C function such as SDL_Log(), as the conversion would not take place
+    inline c_string_arg to_c_value(string_view arg) {
+        return c_string_arg{arg};
+    }
+
+    // Output parameters: a C++ variable passed as out(var) becomes a pointer
+    // argument to the C function
+    template <typename T>
+    struct out_param {
+        T* ptr;
+    };
+
+    template <typename T>
+    out_param<T> out(T& ref) noexcept {
+        return {&ref};
+    }
+
+    template <typename T>
+    using out_c_type_t = std::conditional_t<std::is_same<T, bool>::value,
+                                            SDL_bool, c_type_t<T>>;
+
+    template <typename T>
+    using out_is_direct = std::is_same<out_c_type_t<T>, T>;
+
+    // Receives an output value of the C type, and converts it to the C++ type
+    // when destroyed at the end of the call
+    template <typename T>
+    class out_proxy {
+    public:
+        explicit out_proxy(T& target) noexcept : target{&target} {}
+
+        out_proxy(out_proxy&& other) noexcept
+            : target{other.target}, value{other.value} {
+            other.target = nullptr;
+        }
+
+        ~out_proxy() {
+            if (target) { *target = static_cast<T>(from_c_value(value)); }
+        }
+
+        operator out_c_type_t<T>*() const noexcept { return &value; }
+
+    private:
+        T* target;
+        mutable out_c_type_t<T> value{};
+    };
+
+    // Where the C and C++ types are the same, the pointer is passed directly.
+    // Both overloads take out_param by const reference, so that the choice
+    // between them depends only on out_is_direct and not on value category.
+    template <typename T, typename = std::enable_if_t<out_is_direct<T>::value>>
+    T* to_c_value(const out_param<T>& arg) noexcept {
+        return arg.ptr;
+    }
+
+    template <typename T,
+              typename = std::enable_if_t<!out_is_direct<T>::value>,
+              typename = void>
+    out_proxy<T> to_c_value(const out_param<T>& arg) noexcept {
+        return out_proxy<T>{*arg.ptr};
+    }
+
+    template <typename T>
+    struct type_tag {};
+
+    // Conversions for C functions returning strings which the caller must
+    // free, selected by the caller's requested return type
+
+    inline string from_c_value(type_tag<string>, char* c_str) {
+        return from_c_value(c_str);
+    }
+
+    inline sdl_string from_c_value(type_tag<sdl_string>, char* c_str) {
+        return sdl_string{c_str};
+    }
+
+    // Contiguous spans are passed to C functions as a pointer and a length,
+    // which requires expanding each argument into a tuple of C arguments
+
+    template <typename T>
+    struct is_span : std::false_type {};
+
+    template <typename T>
+    struct is_span<span<T>> : std::true_type {};
+
+    template <bool...>
+    struct bool_pack;
+
+    template <typename... CppArgs>
+    using has_span_arg = std::integral_constant<
+        bool, !std::is_same<
+                  bool_pack<false, is_span<std::decay_t<CppArgs>>::value...>,
+                  bool_pack<is_span<std::decay_t<CppArgs>>::value...,
+                            false>>::value>;
+
+    template <typename T,
+              typename = std::enable_if_t<!is_span<std::decay_t<T>>::value>>
+    auto to_c_args(T&& arg) {
+        return std::tuple<decltype(to_c_value(std::forward<T>(arg)))>{
+            to_c_value(std::forward<T>(arg))};
+    }
+
+    template <typename T>
+    auto to_c_args(span<T> arg) {
+        return std::make_tuple(arg.data(), arg.size());
+    }
+
+    template <typename CFunc, typename Tuple, size_t... I>
+    decltype(auto) apply_c_args(CFunc c_function, Tuple& c_args,
+                                std::index_sequence<I...>) {
+        return c_function(std::get<I>(c_args)...);
+    }
+
+    // In the common case, each C++ argument maps to exactly one C argument
+    // and the call compiles down to the plain C call
+    template <typename CFunc, typename... CppArgs>
+    decltype(auto) call_with_c_args(std::false_type, CFunc c_function,
+                                    CppArgs&&... args) {
+        return c_function(to_c_value(std::forward<CppArgs>(args))...);
+    }
+
+    template <typename CFunc, typename... CppArgs>
+    decltype(auto) call_with_c_args(std::true_type, CFunc c_function,
+                                    CppArgs&&... args) {
+        auto c_args =
+            std::tuple_cat(to_c_args(std::forward<CppArgs>(args))...);
+        using indices =
+            std::make_index_sequence<std::tuple_size<decltype(c_args)>::value>;
+        return apply_c_args(c_function, c_args, indices{});
+    }
+
+    // Calls the C function, returning the unconverted C return value
+    template <typename CFunc, typename... CppArgs>
+    decltype(auto) call_c(CFunc c_function, CppArgs&&... args) {
+        return call_with_c_args(has_span_arg<CppArgs...>{}, c_function,
+                                std::forward<CppArgs>(args)...);
+    }
+
     struct void_return_tag {};
     struct value_return_tag {};
 
     template <typename CFunc, typename... CppArgs>
     auto do_c_call(value_return_tag, CFunc c_function, CppArgs&&... args) {
         return from_c_value(
-            c_function(to_c_value(std::forward<CppArgs>(args))...));
+            call_c(c_function, std::forward<CppArgs>(args)...));
     }
 
     template <typename CFunc, typename... CppArgs>
     void do_c_call(void_return_tag, CFunc c_function, CppArgs&&... args) {
-        c_function(to_c_value(std::forward<CppArgs>(args))...);
+        call_c(c_function, std::forward<CppArgs>(args)...);
     }
 
     template <typename CFunc, typename... CppArgs>
     auto c_call(CFunc c_function, CppArgs&&... args) {
-        constexpr bool is_void_return =
-            std::is_same<std::result_of_t<CFunc(decltype(
-                             to_c_value(std::forward<CppArgs>(args)))...)>,
-                         void>::value;
+        constexpr bool is_void_return = std::is_void<decltype(
+            call_c(c_function, std::forward<CppArgs>(args)...))>::value;
         using return_tag = std::conditional_t<is_void_return, void_return_tag,
                                               value_return_tag>;
         return do_c_call(return_tag{}, c_function,
                          std::forward<CppArgs>(args)...);
     }
+
+    // Like c_call(), but converts the return value to the C++ type `Ret`
+    // rather than the default type for the C return type. Used to return
+    // SDL-allocated strings as an sdl_string instead of copying them.
+    template <typename Ret, typename CFunc, typename... CppArgs>
+    Ret c_call_as(CFunc c_function, CppArgs&&... args) {
+        return from_c_value(type_tag<Ret>{},
+                            call_c(c_function, std::forward<CppArgs>(args)...));
+    }
 }
 }
 
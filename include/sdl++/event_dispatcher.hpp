@@ -0,0 +1,443 @@
+/*!
+  @file event_dispatcher.hpp
+  Simple DirectMedia Layer C++ Bindings
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDLXX_EVENT_DISPATCHER_HPP
+#define SDLXX_EVENT_DISPATCHER_HPP
+
+#include "SDL_events.h"
+#include "SDL_version.h"
+
+#include "stdinc.hpp"
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace sdl {
+
+namespace detail {
+
+    // Describes which event types use each member of the SDL_Event union
+    template <typename Event>
+    struct event_traits;
+
+#define SDLXX_EVENT_TRAITS(Struct, member, First, Last)                        \
+    template <>                                                                \
+    struct event_traits<Struct> {                                              \
+        static constexpr uint32_t first = First;                               \
+        static constexpr uint32_t last = Last;                                 \
+        static const Struct& get(const SDL_Event& e) noexcept {                \
+            return e.member;                                                   \
+        }                                                                      \
+    };
+
+    SDLXX_EVENT_TRAITS(SDL_QuitEvent, quit, SDL_QUIT, SDL_QUIT)
+    SDLXX_EVENT_TRAITS(SDL_WindowEvent, window, SDL_WINDOWEVENT,
+                       SDL_WINDOWEVENT)
+    SDLXX_EVENT_TRAITS(SDL_SysWMEvent, syswm, SDL_SYSWMEVENT, SDL_SYSWMEVENT)
+    SDLXX_EVENT_TRAITS(SDL_KeyboardEvent, key, SDL_KEYDOWN, SDL_KEYUP)
+    SDLXX_EVENT_TRAITS(SDL_TextEditingEvent, edit, SDL_TEXTEDITING,
+                       SDL_TEXTEDITING)
+    SDLXX_EVENT_TRAITS(SDL_TextInputEvent, text, SDL_TEXTINPUT, SDL_TEXTINPUT)
+    SDLXX_EVENT_TRAITS(SDL_MouseMotionEvent, motion, SDL_MOUSEMOTION,
+                       SDL_MOUSEMOTION)
+    SDLXX_EVENT_TRAITS(SDL_MouseButtonEvent, button, SDL_MOUSEBUTTONDOWN,
+                       SDL_MOUSEBUTTONUP)
+    SDLXX_EVENT_TRAITS(SDL_MouseWheelEvent, wheel, SDL_MOUSEWHEEL,
+                       SDL_MOUSEWHEEL)
+    SDLXX_EVENT_TRAITS(SDL_JoyAxisEvent, jaxis, SDL_JOYAXISMOTION,
+                       SDL_JOYAXISMOTION)
+    SDLXX_EVENT_TRAITS(SDL_JoyBallEvent, jball, SDL_JOYBALLMOTION,
+                       SDL_JOYBALLMOTION)
+    SDLXX_EVENT_TRAITS(SDL_JoyHatEvent, jhat, SDL_JOYHATMOTION,
+                       SDL_JOYHATMOTION)
+    SDLXX_EVENT_TRAITS(SDL_JoyButtonEvent, jbutton, SDL_JOYBUTTONDOWN,
+                       SDL_JOYBUTTONUP)
+    SDLXX_EVENT_TRAITS(SDL_JoyDeviceEvent, jdevice, SDL_JOYDEVICEADDED,
+                       SDL_JOYDEVICEREMOVED)
+    SDLXX_EVENT_TRAITS(SDL_ControllerAxisEvent, caxis,
+                       SDL_CONTROLLERAXISMOTION, SDL_CONTROLLERAXISMOTION)
+    SDLXX_EVENT_TRAITS(SDL_ControllerButtonEvent, cbutton,
+                       SDL_CONTROLLERBUTTONDOWN, SDL_CONTROLLERBUTTONUP)
+    SDLXX_EVENT_TRAITS(SDL_ControllerDeviceEvent, cdevice,
+                       SDL_CONTROLLERDEVICEADDED, SDL_CONTROLLERDEVICEREMAPPED)
+    SDLXX_EVENT_TRAITS(SDL_TouchFingerEvent, tfinger, SDL_FINGERDOWN,
+                       SDL_FINGERMOTION)
+    SDLXX_EVENT_TRAITS(SDL_DollarGestureEvent, dgesture, SDL_DOLLARGESTURE,
+                       SDL_DOLLARRECORD)
+    SDLXX_EVENT_TRAITS(SDL_MultiGestureEvent, mgesture, SDL_MULTIGESTURE,
+                       SDL_MULTIGESTURE)
+#if SDL_VERSION_ATLEAST(2, 0, 5)
+    SDLXX_EVENT_TRAITS(SDL_DropEvent, drop, SDL_DROPFILE, SDL_DROPCOMPLETE)
+#else
+    SDLXX_EVENT_TRAITS(SDL_DropEvent, drop, SDL_DROPFILE, SDL_DROPFILE)
+#endif
+    SDLXX_EVENT_TRAITS(SDL_AudioDeviceEvent, adevice, SDL_AUDIODEVICEADDED,
+                       SDL_AUDIODEVICEREMOVED)
+    SDLXX_EVENT_TRAITS(SDL_UserEvent, user, SDL_USEREVENT, SDL_LASTEVENT - 1)
+
+#undef SDLXX_EVENT_TRAITS
+
+    template <typename... Events>
+    struct event_list {
+        static constexpr size_t size = sizeof...(Events);
+    };
+
+    // Every event structure which may be handled. Its position in this list,
+    // plus one, is its "kind"; kind 0 is used for types with no structure.
+    using event_structs = event_list<
+        SDL_QuitEvent, SDL_WindowEvent, SDL_SysWMEvent, SDL_KeyboardEvent,
+        SDL_TextEditingEvent, SDL_TextInputEvent, SDL_MouseMotionEvent,
+        SDL_MouseButtonEvent, SDL_MouseWheelEvent, SDL_JoyAxisEvent,
+        SDL_JoyBallEvent, SDL_JoyHatEvent, SDL_JoyButtonEvent,
+        SDL_JoyDeviceEvent, SDL_ControllerAxisEvent, SDL_ControllerButtonEvent,
+        SDL_ControllerDeviceEvent, SDL_TouchFingerEvent,
+        SDL_DollarGestureEvent, SDL_MultiGestureEvent, SDL_DropEvent,
+        SDL_AudioDeviceEvent, SDL_UserEvent>;
+
+    template <size_t Kind, typename List>
+    struct event_struct_at;
+
+    template <typename Event, typename... Events>
+    struct event_struct_at<1, event_list<Event, Events...>> {
+        using type = Event;
+    };
+
+    template <size_t Kind, typename Event, typename... Events>
+    struct event_struct_at<Kind, event_list<Event, Events...>>
+        : event_struct_at<Kind - 1, event_list<Events...>> {};
+
+    constexpr uint8_t event_kind_of(uint32_t, uint8_t, event_list<>) {
+        return 0;
+    }
+
+    template <typename Event, typename... Events>
+    constexpr uint8_t event_kind_of(uint32_t type, uint8_t kind,
+                                    event_list<Event, Events...>) {
+        return type >= event_traits<Event>::first &&
+                       type <= event_traits<Event>::last
+                   ? kind
+                   : event_kind_of(type, kind + 1, event_list<Events...>{});
+    }
+
+    // Returns the kind of the structure used by events of the given type
+    constexpr uint8_t event_kind_of(uint32_t type) {
+        return event_kind_of(type, 1, event_structs{});
+    }
+
+    // SDL's built-in event types are all below this value. User events
+    // above it are handled without the table.
+    constexpr uint32_t builtin_event_limit = SDL_AUDIODEVICEREMOVED + 1;
+
+    // A table mapping each built-in event type to its kind, computed at
+    // compile time and shared by all dispatchers
+    template <typename Seq>
+    struct event_kind_table;
+
+    template <size_t... Types>
+    struct event_kind_table<std::index_sequence<Types...>> {
+        static constexpr uint8_t kinds[sizeof...(Types)] = {
+            event_kind_of(static_cast<uint32_t>(Types))...};
+    };
+
+    template <size_t... Types>
+    constexpr uint8_t
+        event_kind_table<std::index_sequence<Types...>>::kinds[sizeof...(
+            Types)];
+
+    inline uint8_t event_kind(uint32_t type) noexcept {
+        using table = event_kind_table<
+            std::make_index_sequence<builtin_event_limit>>;
+        if (type < builtin_event_limit) { return table::kinds[type]; }
+        return type >= SDL_USEREVENT && type < SDL_LASTEVENT
+                   ? event_kind_of(SDL_USEREVENT)
+                   : 0;
+    }
+
+    // Deduces the event structure a handler accepts from its call operator
+    template <typename T>
+    struct handler_arg;
+
+    template <typename R, typename Arg>
+    struct handler_arg<R (*)(Arg)> {
+        using type = std::decay_t<Arg>;
+    };
+
+    template <typename R, typename C, typename Arg>
+    struct handler_arg<R (C::*)(Arg)> {
+        using type = std::decay_t<Arg>;
+    };
+
+    template <typename R, typename C, typename Arg>
+    struct handler_arg<R (C::*)(Arg) const> {
+        using type = std::decay_t<Arg>;
+    };
+
+    template <typename Handler, typename = void>
+    struct handler_event {
+        using type = typename handler_arg<Handler>::type;
+    };
+
+    template <typename Handler>
+    struct handler_event<Handler,
+                         std::enable_if_t<std::is_class<Handler>::value>> {
+        using type =
+            typename handler_arg<decltype(&Handler::operator())>::type;
+    };
+
+    template <typename Handler>
+    using handler_event_t = typename handler_event<Handler>::type;
+
+    // Returns the index of the first handler for Event, or the number of
+    // handlers if there is none
+    template <typename Event>
+    constexpr size_t find_handler(size_t) {
+        return 0;
+    }
+
+    template <typename Event, typename Handler, typename... Handlers>
+    constexpr size_t find_handler(size_t) {
+        return std::is_same<handler_event_t<Handler>, Event>::value
+                   ? 0
+                   : 1 + find_handler<Event, Handlers...>(0);
+    }
+
+    template <bool...>
+    struct bool_pack;
+
+    template <bool... Values>
+    using all_of =
+        std::is_same<bool_pack<true, Values...>, bool_pack<Values..., true>>;
+
+    template <typename Event>
+    constexpr bool is_event_struct(event_list<>) {
+        return false;
+    }
+
+    template <typename Event, typename First, typename... Rest>
+    constexpr bool is_event_struct(event_list<First, Rest...>) {
+        return std::is_same<Event, First>::value ||
+               is_event_struct<Event>(event_list<Rest...>{});
+    }
+
+    // True if every handler accepts an event structure, or SDL_Event
+    template <typename... Handlers>
+    using handlers_recognised = all_of<(
+        is_event_struct<handler_event_t<Handlers>>(event_structs{}) ||
+        std::is_same<handler_event_t<Handlers>, SDL_Event>::value)...>;
+
+    // True if no two handlers accept the same structure, in which case each
+    // handler is the first for its structure
+    template <typename Seq, typename... Handlers>
+    struct handlers_unique;
+
+    template <size_t... Indices, typename... Handlers>
+    struct handlers_unique<std::index_sequence<Indices...>, Handlers...>
+        : all_of<(find_handler<handler_event_t<Handlers>, Handlers...>(0) ==
+                  Indices)...> {};
+
+    template <typename Dispatcher, typename Seq>
+    struct event_jump_table;
+
+} // end namespace detail
+
+/*!
+ @addtogroup Events
+ @{
+ */
+
+/*!
+ Calls a handler for each event according to its type
+
+ Each handler accepts a single event structure such as `SDL_KeyboardEvent`
+ or `SDL_MouseMotionEvent`, by value or by const reference. When an event is
+ dispatched, the handler for the structure used by its type is called with
+ the corresponding member of the `SDL_Event` union. At most one handler may
+ accept a structure, which is checked at compile time. A handler accepting
+ `SDL_Event` itself, if present, receives every event which no other handler
+ accepts.
+
+ Handlers are stored by value and called directly: there are no virtual
+ calls or `std::function`s. The handler is found using a table of function
+ pointers built at compile time, indexed by event type, so dispatch costs
+ the same whatever the number of handlers. Event types without a handler
+ have a null entry in the table, and generate no code.
+
+ Handlers must be function pointers or non-generic function objects, such
+ as lambdas with a declared parameter type. Use
+ `sdl::make_event_dispatcher()` to construct a dispatcher from lambdas:
+
+ ```
+ bool quit = false;
+ auto dispatcher = sdl::make_event_dispatcher(
+     [&](const SDL_QuitEvent&) { quit = true; },
+     [&](const SDL_KeyboardEvent& e) {
+         if (e.keysym.sym == SDLK_ESCAPE) { quit = true; }
+     },
+     [&](const SDL_MouseMotionEvent& e) { cursor = {e.x, e.y}; });
+
+ for (const SDL_Event& event : pump.poll()) {
+     dispatcher.dispatch(event);
+ }
+ ```
+ */
+template <typename... Handlers>
+class event_dispatcher {
+    static_assert(detail::handlers_recognised<Handlers...>::value,
+                  "Each handler must accept an SDL event structure which "
+                  "is a member of SDL_Event, or SDL_Event itself");
+    static_assert(
+        detail::handlers_unique<std::index_sequence_for<Handlers...>,
+                                Handlers...>::value,
+        "At most one handler may accept each event structure");
+
+public:
+    //! Constructs a dispatcher holding copies of `handlers`
+    explicit event_dispatcher(Handlers... handlers)
+        : handlers{std::move(handlers)...} {}
+
+    /*!
+     Calls the handler for `event`.
+     @returns true if a handler was called, or false if the event's type
+              has no handler
+     */
+    bool dispatch(const SDL_Event& event) {
+        using table =
+            detail::event_jump_table<event_dispatcher,
+                                     std::make_index_sequence<kind_count>>;
+        const auto entry = table::entries[detail::event_kind(event.type)];
+        if (!entry) { return false; }
+        entry(*this, event);
+        return true;
+    }
+
+    //! Calls the handler for each of `events` in turn
+    //! @returns The number of events for which a handler was called
+    size_t dispatch(span<const SDL_Event> events) {
+        size_t handled = 0;
+        for (const auto& event : events) { handled += dispatch(event); }
+        return handled;
+    }
+
+    //! Returns true if the dispatcher has a handler for events of `type`
+    static bool handles(uint32_t type) noexcept {
+        using table =
+            detail::event_jump_table<event_dispatcher,
+                                     std::make_index_sequence<kind_count>>;
+        return table::entries[detail::event_kind(type)] != nullptr;
+    }
+
+private:
+    template <typename, typename>
+    friend struct detail::event_jump_table;
+
+    using entry_type = void (*)(event_dispatcher&, const SDL_Event&);
+
+    static constexpr size_t kind_count = detail::event_structs::size + 1;
+    static constexpr size_t handler_count = sizeof...(Handlers);
+
+    template <typename Event>
+    static constexpr size_t handler_for() {
+        return detail::find_handler<Event, Handlers...>(0);
+    }
+
+    static constexpr size_t fallback =
+        detail::find_handler<SDL_Event, Handlers...>(0);
+
+    template <size_t Index, typename Event>
+    static void call(event_dispatcher& self, const SDL_Event& event) {
+        std::get<Index>(self.handlers)(detail::event_traits<Event>::get(event));
+    }
+
+    template <size_t Index>
+    static void call_fallback(event_dispatcher& self, const SDL_Event& event) {
+        std::get<Index>(self.handlers)(event);
+    }
+
+    template <typename Event>
+    static constexpr entry_type select(std::true_type) {
+        return &call<handler_for<Event>(), Event>;
+    }
+
+    template <typename Event>
+    static constexpr entry_type select(std::false_type) {
+        return select_fallback(
+            std::integral_constant<bool, (fallback < handler_count)>{});
+    }
+
+    static constexpr entry_type select_fallback(std::true_type) {
+        return &call_fallback<(fallback < handler_count ? fallback : 0)>;
+    }
+
+    static constexpr entry_type select_fallback(std::false_type) {
+        return nullptr;
+    }
+
+    // Returns the table entry for events of the given kind
+    template <size_t Kind>
+    static constexpr entry_type entry_for(std::true_type) {
+        using event = typename detail::event_struct_at<
+            Kind, detail::event_structs>::type;
+        return select<event>(
+            std::integral_constant<bool,
+                                   (handler_for<event>() < handler_count)>{});
+    }
+
+    // Kind 0 is used for event types without a structure
+    template <size_t Kind>
+    static constexpr entry_type entry_for(std::false_type) {
+        return select_fallback(
+            std::integral_constant<bool, (fallback < handler_count)>{});
+    }
+
+    std::tuple<Handlers...> handlers;
+};
+
+//! Returns an `sdl::event_dispatcher` holding copies of `handlers`
+//! @relates event_dispatcher
+template <typename... Handlers>
+event_dispatcher<std::decay_t<Handlers>...>
+make_event_dispatcher(Handlers&&... handlers) {
+    return event_dispatcher<std::decay_t<Handlers>...>{
+        std::forward<Handlers>(handlers)...};
+}
+
+//! @}
+
+namespace detail {
+
+    template <typename Dispatcher, size_t... Kinds>
+    struct event_jump_table<Dispatcher, std::index_sequence<Kinds...>> {
+        static constexpr typename Dispatcher::entry_type entries[] = {
+            Dispatcher::template entry_for<Kinds>(
+                std::integral_constant<bool, (Kinds > 0)>{})...};
+    };
+
+    template <typename Dispatcher, size_t... Kinds>
+    constexpr typename Dispatcher::entry_type
+        event_jump_table<Dispatcher, std::index_sequence<Kinds...>>::entries[];
+
+} // end namespace detail
+
+} // end namespace sdl
+
+#endif // SDLXX_EVENT_DISPATCHER_HPP
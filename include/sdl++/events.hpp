@@ -0,0 +1,555 @@
+/*!
+  @file events.hpp
+  Simple DirectMedia Layer C++ Bindings
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDLXX_EVENTS_HPP
+#define SDLXX_EVENTS_HPP
+
+#include "SDL_events.h"
+
+#include "detail/flags.hpp"
+#include "init.hpp"
+#include "macros.hpp"
+#include "result.hpp"
+#include "stdinc.hpp"
+
+#include <algorithm>
+#include <initializer_list>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sdl {
+
+/*!
+ @defgroup Events Event Handling
+
+ This category contains classes for reading events from SDL's event queue.
+
+ @{
+ */
+
+/*!
+ The kinds of event which an `sdl::event_pump` merges
+
+ These flags may be combined with `|`.
+ */
+enum class coalesce {
+    //! No events are merged
+    none = 0,
+    //! `SDL_MOUSEMOTION` events, per window and mouse
+    mouse_motion = 1,
+    //! `SDL_JOYAXISMOTION` events, per joystick and axis
+    joystick_axes = 2,
+    //! `SDL_CONTROLLERAXISMOTION` events, per controller and axis
+    controller_axes = 4,
+    //! All of the above
+    all = mouse_motion | joystick_axes | controller_axes
+};
+
+//! @cond
+namespace detail {
+    template <>
+    struct is_flags<coalesce> : std::true_type {};
+} // end namespace detail
+//! @endcond
+
+/*!
+ Reads events from SDL's queue in bulk
+
+ The usual event loop calls `SDL_PollEvent()` once per event. Each call
+ takes the event queue's lock, and may also pump the operating system's
+ event queue, which is wasteful when many events arrive in a single frame.
+ An `event_pump` instead calls `SDL_PumpEvents()` once per `poll()`, then
+ drains the queue with as few calls to `SDL_PeepEvents()` as possible, into
+ a buffer which is reused from frame to frame:
+
+ ```
+ sdl::event_pump pump;
+
+ while (!quit) {
+     for (const SDL_Event& event : pump.poll()) {
+         if (event.type == SDL_QUIT) { quit = true; }
+     }
+     // ...
+ }
+ ```
+
+ The buffer starts with room for `capacity` events, and grows if more than
+ that are waiting. The span returned by `poll()` remains valid until the
+ next call to `poll()`.
+
+ High polling-rate devices can produce many motion events per frame, each
+ of which would otherwise be handled separately. A pump can optionally
+ merge these, so that the cost of handling input depends on the number of
+ devices which moved rather than on the number of raw events:
+
+  - For mouse motion, the merged event has the latest position, button
+    state and timestamp, and the sum of the relative motion.
+  - For joystick and controller axes, the merged event has the latest
+    value and timestamp.
+
+ Motion events are only merged across other events which are being merged.
+ Any other event, such as a button press, ends the run, so it is still
+ seen with the position at which it happened. `merge_counts()` gives the
+ number of raw events which each returned event represents.
+ */
+class event_pump {
+public:
+    //! The default initial capacity of the buffer
+    static constexpr size_t default_capacity = 256;
+
+    /*!
+     Creates a pump with room for `capacity` events.
+     @throws sdl::error if the events subsystem could not be initialized
+     */
+    explicit event_pump(size_t capacity = default_capacity)
+        : buffer(std::max<size_t>(capacity, 1)) {
+        require_subsystems(init_flags::events);
+    }
+
+    /*!
+     Creates a pump which merges the kinds of motion event given by `mode`,
+     with room for `capacity` events.
+     @throws sdl::error if the events subsystem could not be initialized
+     */
+    explicit event_pump(coalesce mode, size_t capacity = default_capacity)
+        : event_pump(capacity) {
+        set_coalescing(mode);
+    }
+
+    //! Sets the kinds of motion event which are merged by later polls
+    void set_coalescing(coalesce mode) noexcept { coalescing = mode; }
+
+    //! Returns the kinds of motion event which are merged
+    coalesce get_coalescing() const noexcept { return coalescing; }
+
+    /*!
+     Pumps the event loop, then removes every waiting event from the queue.
+     @returns The events which were removed, in the order they were queued
+     @throws sdl::error if reading the event queue failed
+     */
+    span<const SDL_Event> poll() { return try_poll().value(); }
+
+    //! Like `poll()`, but returns a failed result rather than throwing
+    result<span<const SDL_Event>> try_poll() {
+        ::SDL_PumpEvents();
+        return try_drain();
+    }
+
+    /*!
+     Removes every waiting event from the queue without pumping the event
+     loop, for example from a thread other than the one which set the video
+     mode.
+     @throws sdl::error if reading the event queue failed
+     */
+    span<const SDL_Event> drain() { return try_drain().value(); }
+
+    //! Like `drain()`, but returns a failed result rather than throwing
+    result<span<const SDL_Event>> try_drain() {
+        count = 0;
+        for (;;) {
+            const int n = ::SDL_PeepEvents(
+                buffer.data() + count, static_cast<int>(buffer.size() - count),
+                SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+            if (n < 0) {
+                count = 0;
+                return failure;
+            }
+            count += static_cast<size_t>(n);
+            // A partly-filled buffer means the queue is now empty
+            if (count < buffer.size()) { break; }
+            buffer.resize(buffer.size() * 2);
+        }
+        raw = count;
+        merges.clear();
+        if (coalescing != coalesce::none) { merge_motion(); }
+        return events();
+    }
+
+    //! Returns the events read by the last call to `poll()` or `drain()`
+    span<const SDL_Event> events() const noexcept {
+        return {buffer.data(), count};
+    }
+
+    /*!
+     Returns, for each event returned by the last poll, the number of raw
+     events merged into it. This is empty if coalescing is disabled.
+     */
+    span<const uint32_t> merge_counts() const noexcept { return merges; }
+
+    //! Returns the number of raw events read by the last poll, before any
+    //! were merged
+    size_t raw_count() const noexcept { return raw; }
+
+    //! Returns the number of events the buffer can hold without growing
+    size_t capacity() const noexcept { return buffer.size(); }
+
+private:
+    // Identifies the device (and axis) an event belongs to, or returns 0 if
+    // the event should not be merged
+    uint64_t merge_key(const SDL_Event& e) const noexcept {
+        switch (e.type) {
+        case SDL_MOUSEMOTION:
+            if (!flag_is_set(coalescing, coalesce::mouse_motion)) { break; }
+            return (uint64_t{1} << 62) |
+                   (static_cast<uint64_t>(e.motion.windowID) << 32) |
+                   e.motion.which;
+        case SDL_JOYAXISMOTION:
+            if (!flag_is_set(coalescing, coalesce::joystick_axes)) { break; }
+            return (uint64_t{2} << 62) |
+                   (static_cast<uint64_t>(e.jaxis.axis) << 32) |
+                   static_cast<uint32_t>(e.jaxis.which);
+        case SDL_CONTROLLERAXISMOTION:
+            if (!flag_is_set(coalescing, coalesce::controller_axes)) {
+                break;
+            }
+            return (uint64_t{3} << 62) |
+                   (static_cast<uint64_t>(e.caxis.axis) << 32) |
+                   static_cast<uint32_t>(e.caxis.which);
+        }
+        return 0;
+    }
+
+    // Merges each motion event into the earlier one for the same device in
+    // the current run of motion events, compacting the buffer in place
+    void merge_motion() {
+        merges.assign(count, 1);
+        // The devices seen in the current run, and where their events are.
+        // There are rarely more than a handful, so a linear search is used.
+        run.clear();
+        size_t out = 0;
+        for (size_t i = 0; i < count; i++) {
+            const SDL_Event& e = buffer[i];
+            const uint64_t key = merge_key(e);
+            if (key == 0) {
+                run.clear();
+            } else {
+                const auto it = std::find_if(
+                    run.begin(), run.end(),
+                    [key](const std::pair<uint64_t, size_t>& r) {
+                        return r.first == key;
+                    });
+                if (it != run.end()) {
+                    merge_into(buffer[it->second], e);
+                    ++merges[it->second];
+                    continue;
+                }
+                run.emplace_back(key, out);
+            }
+            buffer[out] = e;
+            merges[out] = 1;
+            ++out;
+        }
+        count = out;
+        merges.resize(count);
+    }
+
+    static void merge_into(SDL_Event& target, const SDL_Event& e) noexcept {
+        if (e.type == SDL_MOUSEMOTION) {
+            const int32_t xrel = target.motion.xrel + e.motion.xrel;
+            const int32_t yrel = target.motion.yrel + e.motion.yrel;
+            target.motion = e.motion;
+            target.motion.xrel = xrel;
+            target.motion.yrel = yrel;
+        } else {
+            target = e;
+        }
+    }
+
+    std::vector<SDL_Event> buffer;
+    std::vector<uint32_t> merges;
+    std::vector<std::pair<uint64_t, size_t>> run;
+    size_t count = 0;
+    size_t raw = 0;
+    coalesce coalescing = coalesce::none;
+};
+
+namespace detail {
+
+    // A heap-allocated callback registered with SDL. SDL holds the address
+    // of the callback, which therefore does not change when the handle
+    // owning it is moved.
+    class event_callback {
+    public:
+        event_callback() = default;
+
+        template <typename Func>
+        event_callback(Func* func, SDL_EventFilter thunk) noexcept
+            : ptr{func}, fn{thunk}, destroy{[](void* p) {
+                  delete static_cast<Func*>(p);
+              }} {}
+
+        event_callback(event_callback&& other) noexcept
+            : ptr{other.ptr}, fn{other.fn}, destroy{other.destroy} {
+            other.ptr = nullptr;
+        }
+
+        event_callback& operator=(event_callback&& other) noexcept {
+            std::swap(ptr, other.ptr);
+            std::swap(fn, other.fn);
+            std::swap(destroy, other.destroy);
+            return *this;
+        }
+
+        ~event_callback() {
+            if (ptr) { destroy(ptr); }
+        }
+
+        void* userdata() const noexcept { return ptr; }
+        SDL_EventFilter function() const noexcept { return fn; }
+        explicit operator bool() const noexcept { return ptr != nullptr; }
+
+    private:
+        void* ptr = nullptr;
+        SDL_EventFilter fn = nullptr;
+        void (*destroy)(void*) = nullptr;
+    };
+
+    template <typename Tuple>
+    bool run_filters(Tuple&, const SDL_Event&, std::index_sequence<>) {
+        return true;
+    }
+
+    template <typename Tuple, size_t I, size_t... Is>
+    bool run_filters(Tuple& filters, const SDL_Event& event,
+                     std::index_sequence<I, Is...>) {
+        return std::get<I>(filters)(event) &&
+               run_filters(filters, event, std::index_sequence<Is...>{});
+    }
+
+    // The filter which an event_filter replaced when it was installed
+    struct installed_filter {
+        void* userdata;
+        SDL_EventFilter previous;
+        void* previous_userdata;
+    };
+
+    // The event_filters which are alive, in the order in which they were
+    // installed
+    struct filter_chain {
+        std::mutex mutex;
+        std::vector<installed_filter> filters;
+    };
+
+    inline filter_chain& installed_filters() {
+        static filter_chain chain;
+        return chain;
+    }
+
+} // end namespace detail
+
+/*!
+ Installs a chain of event filters for its lifetime
+
+ SDL allows only one event filter, which is called when an event is added
+ to the queue and can drop it by returning false. An `event_filter`
+ combines any number of filters, each a function object taking
+ `const SDL_Event&` and returning `bool`, into a single filter which calls
+ them in order, stopping at the first to drop the event. The chain is
+ fixed at compile time, so SDL makes one call per event whatever its
+ length.
+
+ Filtering is the cheapest place to drop unwanted high-frequency events,
+ since they never reach the queue:
+
+ ```
+ auto filter = sdl::event_filter{
+     sdl::drop_event_types{SDL_FINGERMOTION, SDL_JOYBALLMOTION},
+     [](const SDL_Event& e) { return e.type != SDL_MOUSEMOTION || !paused; }};
+ ```
+
+ Note that SDL discards any events in the queue whenever its filter is
+ changed, so filters are best installed once at startup. The destructor
+ restores the filter which was installed before, unless another filter has
+ replaced this one since. In that case the filter which replaced it
+ restores this one's predecessor instead, so `event_filter`s may be
+ destroyed in any order.
+
+ @warning Filters may be called on any thread which adds events to the
+ queue, and must be thread-safe.
+ */
+class event_filter {
+public:
+    //! Constructs an empty filter, which does nothing
+    event_filter() = default;
+
+    //! Installs a filter calling each of `filters` in turn
+    template <typename Filter, typename... Filters,
+              typename = std::enable_if_t<
+                  !std::is_same<std::decay_t<Filter>, event_filter>::value>>
+    explicit event_filter(Filter&& first, Filters&&... rest) {
+        using chain =
+            std::tuple<std::decay_t<Filter>, std::decay_t<Filters>...>;
+        callback = detail::event_callback{
+            new chain{std::forward<Filter>(first),
+                      std::forward<Filters>(rest)...},
+            &call_chain<chain>};
+
+        auto& installed = detail::installed_filters();
+        std::lock_guard<std::mutex> lock{installed.mutex};
+        detail::installed_filter f{callback.userdata(), nullptr, nullptr};
+        ::SDL_GetEventFilter(&f.previous, &f.previous_userdata);
+        installed.filters.push_back(f);
+        ::SDL_SetEventFilter(callback.function(), callback.userdata());
+    }
+
+    //! Move constructor
+    event_filter(event_filter&& other) noexcept = default;
+
+    //! Move assignment operator
+    event_filter& operator=(event_filter&& other) noexcept {
+        std::swap(callback, other.callback);
+        return *this;
+    }
+
+    //! Removes the filter, restoring the previous one if this is still
+    //! installed
+    ~event_filter() {
+        if (!callback) { return; }
+        auto& installed = detail::installed_filters();
+        std::lock_guard<std::mutex> lock{installed.mutex};
+        auto& filters = installed.filters;
+        const auto self = std::find_if(
+            filters.begin(), filters.end(),
+            [this](const detail::installed_filter& f) {
+                return f.userdata == callback.userdata();
+            });
+
+        // Filters which replaced this one restore its predecessor instead
+        for (auto it = std::next(self); it != filters.end(); ++it) {
+            if (it->previous_userdata == self->userdata) {
+                it->previous = self->previous;
+                it->previous_userdata = self->previous_userdata;
+            }
+        }
+
+        SDL_EventFilter current = nullptr;
+        void* current_userdata = nullptr;
+        if (::SDL_GetEventFilter(&current, &current_userdata) &&
+            current == callback.function() &&
+            current_userdata == callback.userdata()) {
+            ::SDL_SetEventFilter(self->previous, self->previous_userdata);
+        }
+        filters.erase(self);
+    }
+
+private:
+    template <typename Chain>
+    static int SDLCALL call_chain(void* userdata, SDL_Event* event) {
+        auto& filters = *static_cast<Chain*>(userdata);
+        return detail::run_filters(
+            filters, *event,
+            std::make_index_sequence<std::tuple_size<Chain>::value>{});
+    }
+
+    detail::event_callback callback;
+};
+
+/*!
+ Calls a function for every event added to the queue, for its lifetime
+
+ The function takes `const SDL_Event&`, and is called with a reference to
+ the event as it is added, without copying it. Unlike a filter it cannot
+ drop events, but any number of watches may be installed at once:
+
+ ```
+ auto watch = sdl::event_watch{[&](const SDL_Event& e) {
+     if (e.type == SDL_WINDOWEVENT) { request_redraw(); }
+ }};
+ ```
+
+ The function's address is fixed when the watch is created, so watches
+ may be moved freely.
+
+ @warning The function may be called on any thread which adds events to
+ the queue, and must be thread-safe.
+ */
+class event_watch {
+public:
+    //! Constructs an empty watch, which does nothing
+    event_watch() = default;
+
+    //! Adds `func` as an event watch
+    template <typename Func,
+              typename = std::enable_if_t<
+                  !std::is_same<std::decay_t<Func>, event_watch>::value>>
+    explicit event_watch(Func&& func) {
+        using func_type = std::decay_t<Func>;
+        callback = detail::event_callback{
+            new func_type(std::forward<Func>(func)), &call<func_type>};
+        ::SDL_AddEventWatch(callback.function(), callback.userdata());
+    }
+
+    //! Move constructor
+    event_watch(event_watch&& other) noexcept = default;
+
+    //! Move assignment operator
+    event_watch& operator=(event_watch&& other) noexcept {
+        std::swap(callback, other.callback);
+        return *this;
+    }
+
+    //! Removes the watch
+    ~event_watch() {
+        if (callback) {
+            ::SDL_DelEventWatch(callback.function(), callback.userdata());
+        }
+    }
+
+private:
+    template <typename Func>
+    static int SDLCALL call(void* userdata, SDL_Event* event) {
+        (*static_cast<Func*>(userdata))(*event);
+        return 1;
+    }
+
+    detail::event_callback callback;
+};
+
+/*!
+ An event filter which drops events of the given types
+
+ For use with `sdl::event_filter`. The types are searched linearly, so this
+ is intended for a handful of types.
+ */
+class drop_event_types {
+public:
+    //! Constructs a filter which drops events of the given types
+    drop_event_types(std::initializer_list<uint32_t> types) : types(types) {}
+
+    //! Returns false if `event` should be dropped
+    bool operator()(const SDL_Event& event) const noexcept {
+        return std::find(types.begin(), types.end(), event.type) ==
+               types.end();
+    }
+
+private:
+    std::vector<uint32_t> types;
+};
+
+//! @}
+
+} // end namespace sdl
+
+#endif // SDLXX_EVENTS_HPP
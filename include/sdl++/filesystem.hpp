@@ -27,8 +27,12 @@
 
 #include "detail/wrapper.hpp"
 #include "macros.hpp"
+#include "result.hpp"
 #include "stdinc.hpp"
 
+#include <initializer_list>
+#include <mutex>
+
 namespace sdl {
 
 /*!
@@ -63,12 +67,33 @@ namespace sdl {
   `SDL_FILESYSTEM_BASE_DIR_TYPE` with a supported value will change the
   behaviour.
 
+ @tparam String The type to return: either `sdl::string` (the default), or
+                `sdl::sdl_string` to avoid copying the path
  @return String of base dir in UTF-8 encoding
  @throws sdl::error
 */
-inline string get_base_path() {
-    auto path = detail::c_call(::SDL_GetBasePath);
-    SDLXX_CHECK(path != "");
+template <typename String = string>
+String get_base_path() {
+    auto path = detail::c_call_as<String>(::SDL_GetBasePath);
+    SDLXX_CHECK(!path.empty());
+    return path;
+}
+
+/*!
+ Get the path where the application resides, without throwing.
+
+ @tparam String The type to return: either `sdl::string` (the default), or
+                `sdl::sdl_string` to avoid copying the path
+ @return String of base dir in UTF-8 encoding, or a failed result if the path
+         could not be determined
+
+ \sa sdl::get_base_path()
+ */
+template <typename String = string>
+SDLXX_ATTR_WARN_UNUSED_RESULT
+result<String> try_get_base_path() {
+    auto path = detail::c_call_as<String>(::SDL_GetBasePath);
+    if (path.empty()) { return failure; }
     return path;
 }
 
@@ -124,6 +149,8 @@ inline string get_base_path() {
   platforms, this might be meaningless. In such cases, this function will throw
   an `sdl::error`.
 
+  @tparam String The type to return: either `sdl::string` (the default), or
+                 `sdl::sdl_string` to avoid copying the path
   @param org The name of your organization.
   @param app The name of your application.
   @return UTF-8 string of user dir in platform-dependent notation. `nullopt`
@@ -132,19 +159,290 @@ inline string get_base_path() {
 
   \sa sdl::get_base_path()
  */
-inline string get_pref_path(const char* org, const char* app) {
-    auto path = detail::c_call(::SDL_GetPrefPath, org, app);
-    SDLXX_CHECK(path != "");
+template <typename String = string>
+String get_pref_path(string_view org, string_view app) {
+    auto path = detail::c_call_as<String>(::SDL_GetPrefPath, org, app);
+    SDLXX_CHECK(!path.empty());
     return path;
 }
 
-//! Overload of get_pref_path() taking strings
-inline string get_pref_path(const string& org, const string& app) {
-    auto path = detail::c_call(::SDL_GetPrefPath, org, app);
-    SDLXX_CHECK(path != "");
+/*!
+ Get the user-and-app-specific path where files can be written, without
+ throwing.
+
+ @tparam String The type to return: either `sdl::string` (the default), or
+                `sdl::sdl_string` to avoid copying the path
+ @param org The name of your organization.
+ @param app The name of your application.
+ @return UTF-8 string of user dir in platform-dependent notation, or a failed
+         result if there's a problem (creating directory failed, etc).
+
+ \sa sdl::get_pref_path()
+ */
+template <typename String = string>
+SDLXX_ATTR_WARN_UNUSED_RESULT
+result<String> try_get_pref_path(string_view org, string_view app) {
+    auto path = detail::c_call_as<String>(::SDL_GetPrefPath, org, app);
+    if (path.empty()) { return failure; }
     return path;
 }
 
+/*!
+ The preferred path separator for the current platform
+ */
+#if defined(__WIN32__) || defined(__WINRT__)
+constexpr char path_separator = '\\';
+#else
+constexpr char path_separator = '/';
+#endif
+
+namespace detail {
+
+    constexpr bool is_path_separator(char c) {
+#if defined(__WIN32__) || defined(__WINRT__)
+        return c == '\\' || c == '/';
+#else
+        return c == '/';
+#endif
+    }
+
+    // Joins path components into `out`, inserting a separator between
+    // components only where one is not already present. Empty components
+    // are skipped. Returns the number of characters written, excluding the
+    // null terminator, or npos if `out` is too small.
+    inline size_t join_path_parts(span<char> out,
+                                  std::initializer_list<string_view> parts) {
+        size_t len = 0;
+        for (auto part : parts) {
+            if (part.empty()) { continue; }
+            if (len > 0) {
+                while (!part.empty() && is_path_separator(part.front())) {
+                    part.remove_prefix(1);
+                }
+                if (!is_path_separator(out[len - 1])) {
+                    if (len + 1 >= out.size()) { return string_view::npos; }
+                    out[len++] = path_separator;
+                }
+            }
+            if (part.size() >= out.size() - len) { return string_view::npos; }
+            SDL_memcpy(out.data() + len, part.data(), part.size());
+            len += part.size();
+        }
+        if (out.empty()) { return string_view::npos; }
+        out[len] = '\0';
+        return len;
+    }
+
+} // end namespace detail
+
+/*!
+ Joins path components into a caller-provided buffer, without allocating.
+
+ A separator is inserted between components unless the preceding component
+ already ends with one, and leading separators are removed from all but the
+ first component, so that for example
+
+ ```
+ char buf[256];
+ auto path = sdl::join_path(buf, sdl::get_base_path(), "textures", "hero.png");
+ ```
+
+ produces `/path/to/game/textures/hero.png`. Empty components are ignored.
+ The result is null-terminated, so `path->data()` may be passed to SDL
+ functions expecting a C string.
+
+ @param out The buffer to write into
+ @param first, rest The path components to join
+ @returns A view of the joined path in `out`, or a failed result if `out` is
+          too small
+ @sa sdl::path_buffer
+ */
+template <typename... Parts>
+result<string_view> join_path(span<char> out, string_view first,
+                              const Parts&... rest) {
+    const auto len = detail::join_path_parts(out, {first, string_view(rest)...});
+    if (len == string_view::npos) {
+        ::SDL_SetError("Path buffer too small");
+        return failure;
+    }
+    return string_view{out.data(), len};
+}
+
+/*!
+ A fixed-size, stack-allocated buffer for building paths with
+ `sdl::join_path()`
+
+ ```
+ sdl::path_buffer<> buf;
+ if (auto path = buf.join(paths.base(), "levels", name)) {
+     load_level(buf.c_str());
+ }
+ ```
+
+ @tparam N The capacity of the buffer, including the null terminator
+ */
+template <size_t N = 512>
+class path_buffer {
+    static_assert(N > 0, "path_buffer must have a non-zero capacity");
+
+public:
+    //! Replaces the contents of the buffer with the joined `parts`
+    //! @returns A view of the joined path, or a failed result if it does not
+    //!          fit. On failure the buffer is left empty.
+    template <typename... Parts>
+    result<string_view> join(string_view first, const Parts&... rest) {
+        auto r = join_path(buf, first, rest...);
+        len = r ? r->size() : 0;
+        if (!r) { buf[0] = '\0'; }
+        return r;
+    }
+
+    //! Returns the current contents as a null-terminated string
+    const char* c_str() const noexcept { return buf; }
+
+    //! Returns a view of the current contents
+    string_view view() const noexcept { return {buf, len}; }
+
+    //! Returns the capacity of the buffer, including the null terminator
+    static constexpr size_t capacity() noexcept { return N; }
+
+private:
+    char buf[N] = {};
+    size_t len = 0;
+};
+
+/*!
+ A cache for the application's base and pref paths
+
+ `sdl::get_base_path()` and `sdl::get_pref_path()` are not necessarily fast.
+ A `paths` object calls each of them at most once, the first time the path is
+ requested, and thereafter hands out `string_view`s referring to its cached
+ copy, which remain valid for the lifetime of the `paths` object. It is safe
+ to call the members of a `paths` object from multiple threads.
+
+ Typically an application will create a single `paths` object at startup,
+ after initializing SDL, and use it with `join_base()` and `join_pref()` to
+ build asset and save file paths without allocating:
+
+ ```
+ sdl::paths paths{"My Company", "My Game"};
+
+ sdl::path_buffer<> buf;
+ auto tex = paths.join_base(buf, "textures", "hero.png");
+ ```
+
+ `paths` is neither copyable nor movable.
+ */
+class paths {
+public:
+    //! Creates a cache for the base path, and for the pref path of the given
+    //! organization and application
+    paths(string_view org, string_view app)
+        : org{org.to_string()}, app{app.to_string()} {}
+
+    paths(const paths&) = delete;
+    paths& operator=(const paths&) = delete;
+
+    /*!
+     Returns the base path, computing it if this is the first call
+     @throws sdl::error if the base path could not be determined
+     @sa sdl::get_base_path()
+     */
+    string_view base() const { return try_base().value(); }
+
+    //! Returns the base path, or a failed result if it could not be
+    //! determined
+    result<string_view> try_base() const {
+        std::call_once(base_path.once, [this] {
+            base_path.assign(try_get_base_path<sdl_string>());
+        });
+        return base_path.get();
+    }
+
+    /*!
+     Returns the pref path, computing it if this is the first call
+     @throws sdl::error if the pref path could not be determined
+     @sa sdl::get_pref_path()
+     */
+    string_view pref() const { return try_pref().value(); }
+
+    //! Returns the pref path, or a failed result if it could not be
+    //! determined
+    result<string_view> try_pref() const {
+        std::call_once(pref_path.once, [this] {
+            pref_path.assign(try_get_pref_path<sdl_string>(org, app));
+        });
+        return pref_path.get();
+    }
+
+    //! Joins the base path and `parts` into `out` using `sdl::join_path()`
+    //! @returns A view of the joined path, or a failed result if the base
+    //!          path could not be determined or `out` is too small
+    template <typename... Parts>
+    result<string_view> join_base(span<char> out, const Parts&... parts) const {
+        const auto dir = try_base();
+        if (!dir) { return failure; }
+        return join_path(out, *dir, parts...);
+    }
+
+    //! @overload
+    template <size_t N, typename... Parts>
+    result<string_view> join_base(path_buffer<N>& out,
+                                  const Parts&... parts) const {
+        const auto dir = try_base();
+        if (!dir) { return failure; }
+        return out.join(*dir, parts...);
+    }
+
+    //! Joins the pref path and `parts` into `out` using `sdl::join_path()`
+    //! @returns A view of the joined path, or a failed result if the pref
+    //!          path could not be determined or `out` is too small
+    template <typename... Parts>
+    result<string_view> join_pref(span<char> out, const Parts&... parts) const {
+        const auto dir = try_pref();
+        if (!dir) { return failure; }
+        return join_path(out, *dir, parts...);
+    }
+
+    //! @overload
+    template <size_t N, typename... Parts>
+    result<string_view> join_pref(path_buffer<N>& out,
+                                  const Parts&... parts) const {
+        const auto dir = try_pref();
+        if (!dir) { return failure; }
+        return out.join(*dir, parts...);
+    }
+
+private:
+    // The error message must be copied when the path is computed, as SDL's
+    // copy may be overwritten (or belong to another thread) by the time a
+    // later caller asks for it
+    struct cached_path {
+        void assign(result<sdl_string>&& r) {
+            if (r) {
+                path = std::move(*r);
+            } else {
+                error = r.error_message();
+            }
+        }
+
+        result<string_view> get() const {
+            if (!path.empty()) { return path.view(); }
+            ::SDL_SetError("%s", error.c_str());
+            return failure;
+        }
+
+        std::once_flag once;
+        sdl_string path;
+        string error;
+    };
+
+    const string org;
+    const string app;
+    mutable cached_path base_path;
+    mutable cached_path pref_path;
+};
+
 } // end namespace sdl
 
 #endif // SDLXX_FILESYSTEM_HPP
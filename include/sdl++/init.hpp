@@ -28,9 +28,17 @@
 
 #include "detail/flags.hpp"
 #include "detail/wrapper.hpp"
+#include "log.hpp"
 #include "macros.hpp"
+#include "result.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace sdl {
 
@@ -103,6 +111,30 @@ namespace sdl {
  reference-counts the number of times each subsystem is initialized and shut
  down.
 
+ Lazy Initialization
+ -------------------
+
+ Initializing every subsystem up front can be slow: audio and joystick device
+ enumeration in particular can take a significant amount of time, even for
+ programs which never use them. An `sdl::lazy_init_guard` can be used in
+ place of an `init_guard` to defer this work. It records the subsystems which
+ the application may use, and each one is then initialized the first time
+ it is needed, either explicitly via `lazy_init_guard::require()` or by an
+ sdl++ wrapper function calling `sdl::require_subsystems()`.
+
+ The time taken to initialize each subsystem is logged with category
+ `sdl::log_category::system` and priority `sdl::log_priority::info`, and can
+ also be retrieved using `lazy_init_guard::init_times()`.
+
+ Parallel Initialization
+ -----------------------
+
+ Alternatively, an `sdl::async_init_guard` initializes the audio, joystick,
+ game controller and haptic subsystems on background threads, on platforms
+ where this is safe, while the video subsystem initializes on the calling
+ thread. The application can then create
+ its window without waiting for (for example) audio device probing to finish.
+
  @{
  */
 
@@ -181,13 +213,45 @@ struct init_guard {
                                    detail::ilist_to_flags(flags_list)) == 0);
     }
 
-    //! Defaulted move constructor to prevent generation of a copy constructor
-    init_guard(init_guard&&) noexcept = default;
-    //! Defaulted move assignment to prevent generation of copy assignment
-    init_guard& operator=(init_guard&&) noexcept = default;
+    /*!
+     Attempts to initialize the subsystems given in `flags`, without throwing.
+     @returns An `init_guard`, or a failed result if initialization failed
+     */
+    SDLXX_ATTR_WARN_UNUSED_RESULT
+    static result<init_guard> try_create(init_flags flags) {
+        if (detail::c_call(::SDL_Init, flags) != 0) { return failure; }
+        return init_guard{adopt_tag{}};
+    }
+
+    //! @overload
+    SDLXX_ATTR_WARN_UNUSED_RESULT
+    static result<init_guard>
+    try_create(std::initializer_list<init_flags> flags_list) {
+        return try_create(detail::ilist_to_flags(flags_list));
+    }
+
+    //! Move constructor. The moved-from guard will not shut down SDL.
+    init_guard(init_guard&& other) noexcept : active{other.active} {
+        other.active = false;
+    }
+
+    //! Move assignment operator
+    init_guard& operator=(init_guard&& other) noexcept {
+        std::swap(active, other.active);
+        return *this;
+    }
 
     //! Shuts down all SDL subsystems
-    ~init_guard() { ::SDL_Quit(); }
+    ~init_guard() {
+        if (active) { ::SDL_Quit(); }
+    }
+
+private:
+    struct adopt_tag {};
+
+    explicit init_guard(adopt_tag) noexcept {}
+
+    bool active = true;
 };
 
 /*!
@@ -248,10 +312,606 @@ public:
 
     ~subsystem_init_guard() { detail::c_call(::SDL_QuitSubSystem, flags); }
 
+    /*!
+     Attempts to initialize the subsystems given in `flags`, without throwing.
+     @returns A `subsystem_init_guard`, or a failed result if initialization
+              failed
+     */
+    SDLXX_ATTR_WARN_UNUSED_RESULT
+    static result<subsystem_init_guard> try_create(init_flags flags) {
+        if (detail::c_call(::SDL_InitSubSystem, flags) != 0) { return failure; }
+        return subsystem_init_guard{flags, adopt_tag{}};
+    }
+
+    //! @overload
+    SDLXX_ATTR_WARN_UNUSED_RESULT
+    static result<subsystem_init_guard>
+    try_create(std::initializer_list<init_flags> flags_list) {
+        return try_create(detail::ilist_to_flags(flags_list));
+    }
+
 private:
+    struct adopt_tag {};
+
+    subsystem_init_guard(init_flags flags, adopt_tag) noexcept
+        : flags{flags} {}
+
     init_flags flags = init_flags::none;
 };
 
+/*!
+ Timing information for a subsystem initialized by an `sdl::lazy_init_guard`
+ */
+struct subsystem_init_time {
+    //! The subsystem which was initialized
+    init_flags subsystem;
+    //! The time taken by `SDL_InitSubSystem()`
+    std::chrono::microseconds duration;
+};
+
+namespace detail {
+
+    // The individual subsystems, in the order in which they will be
+    // initialized. The events subsystem comes first so that the time taken
+    // for it is not attributed to video or joystick, which depend on it.
+    constexpr init_flags lazy_subsystems[] = {
+        init_flags::events, init_flags::timer,    init_flags::audio,
+        init_flags::video,  init_flags::joystick, init_flags::gamecontroller,
+        init_flags::haptic};
+
+    inline const char* subsystem_name(init_flags subsystem) {
+        switch (subsystem) {
+        case init_flags::timer: return "timer";
+        case init_flags::audio: return "audio";
+        case init_flags::video: return "video";
+        case init_flags::joystick: return "joystick";
+        case init_flags::haptic: return "haptic";
+        case init_flags::gamecontroller: return "gamecontroller";
+        case init_flags::events: return "events";
+        default: return "unknown";
+        }
+    }
+
+    class lazy_init_state {
+    public:
+        explicit lazy_init_state(init_flags requested) : requested{requested} {}
+
+        result<void> require(init_flags flags) {
+            // Wrapped calls such as event and render functions check every
+            // time, so avoid the lock once their subsystems are up
+            const auto needed = static_cast<int>(flags & requested);
+            if ((ready.load(std::memory_order_acquire) & needed) == needed) {
+                return {};
+            }
+
+            std::lock_guard<std::mutex> lock{mutex};
+
+            for (auto subsystem : lazy_subsystems) {
+                if (!flag_is_set(flags, subsystem) ||
+                    !flag_is_set(requested, subsystem) ||
+                    flag_is_set(initialized, subsystem)) {
+                    continue;
+                }
+
+                const auto start = std::chrono::steady_clock::now();
+                auto guard = subsystem_init_guard::try_create(subsystem);
+                if (!guard) { return failure; }
+                guards.push_back(std::move(*guard));
+                const auto elapsed =
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start);
+
+                initialized |= subsystem;
+                ready.store(static_cast<int>(initialized),
+                            std::memory_order_release);
+                times.push_back({subsystem, elapsed});
+                log_info(log_category::system,
+                         "Initialized %s subsystem in %.3f ms",
+                         subsystem_name(subsystem), elapsed.count() / 1000.0);
+            }
+            return {};
+        }
+
+        init_flags get_requested() const { return requested; }
+
+        init_flags get_initialized() const {
+            std::lock_guard<std::mutex> lock{mutex};
+            return initialized;
+        }
+
+        std::vector<subsystem_init_time> get_init_times() const {
+            std::lock_guard<std::mutex> lock{mutex};
+            return times;
+        }
+
+        // Shuts down subsystems in the reverse order of initialization
+        void release() {
+            std::lock_guard<std::mutex> lock{mutex};
+            while (!guards.empty()) { guards.pop_back(); }
+            initialized = init_flags::none;
+            ready.store(0, std::memory_order_release);
+        }
+
+    private:
+        mutable std::mutex mutex;
+        const init_flags requested;
+        init_flags initialized = init_flags::none;
+        // A copy of initialized which can be read without the lock
+        std::atomic<int> ready{0};
+        std::vector<subsystem_init_guard> guards;
+        std::vector<subsystem_init_time> times;
+    };
+
+    // The state of the currently active lazy_init_guard, if any
+    inline std::atomic<lazy_init_state*>& active_lazy_init() {
+        static std::atomic<lazy_init_state*> state{nullptr};
+        return state;
+    }
+
+} // end namespace detail
+
+/*!
+ RAII initialization guard which initializes subsystems on demand
+
+ A `lazy_init_guard` may be used instead of an `sdl::init_guard`. Rather than
+ initializing all the requested subsystems at construction, each one is
+ initialized the first time it is needed. Each subsystem is initialized
+ separately using an `sdl::subsystem_init_guard`, and the time taken is logged.
+
+ Like `init_guard`, the destructor calls `SDL_Quit()`, shutting down all
+ subsystems. Only one `lazy_init_guard` may be active at a time.
+
+ ```
+ int main() {
+     sdl::lazy_init_guard init{sdl::init_flags::video, sdl::init_flags::audio};
+
+     // No subsystems have been initialized yet. This will initialize video:
+     auto text = sdl::get_clipboard_text();
+
+     // ...
+ }
+ ```
+
+ @note Subsystems required by a wrapper function are initialized only if they
+ were requested at construction. Subsystems which were not requested must
+ be initialized separately, just as with `init_guard`.
+ */
+class lazy_init_guard {
+public:
+    //! Creates a `lazy_init_guard` which allows all subsystems to be
+    //! initialized on demand
+    //! @throws sdl::error if another `lazy_init_guard` is active
+    lazy_init_guard() : lazy_init_guard(init_flags::everything) {}
+
+    /*!
+     Creates a `lazy_init_guard` which will initialize the subsystems given in
+     `flags` when they are required.
+     @throws sdl::error if another `lazy_init_guard` is active
+     */
+    explicit lazy_init_guard(init_flags flags)
+        : state{std::make_unique<detail::lazy_init_state>(flags)} {
+        SDLXX_CHECK(activate(state.get()));
+    }
+
+    /*!
+     Creates a `lazy_init_guard` which will initialize the subsystems given in
+     `flags_list` when they are required.
+     @throws sdl::error if another `lazy_init_guard` is active
+     */
+    explicit lazy_init_guard(std::initializer_list<init_flags> flags_list)
+        : lazy_init_guard(detail::ilist_to_flags(flags_list)) {}
+
+    /*!
+     Attempts to create a `lazy_init_guard`, without throwing.
+     @returns A `lazy_init_guard`, or a failed result if another
+              `lazy_init_guard` is active
+     */
+    SDLXX_ATTR_WARN_UNUSED_RESULT
+    static result<lazy_init_guard> try_create(init_flags flags) {
+        auto state = std::make_unique<detail::lazy_init_state>(flags);
+        if (!activate(state.get())) { return failure; }
+        return lazy_init_guard{std::move(state)};
+    }
+
+    //! @overload
+    SDLXX_ATTR_WARN_UNUSED_RESULT
+    static result<lazy_init_guard>
+    try_create(std::initializer_list<init_flags> flags_list) {
+        return try_create(detail::ilist_to_flags(flags_list));
+    }
+
+    //! Move constructor
+    lazy_init_guard(lazy_init_guard&&) noexcept = default;
+
+    //! Move assignment operator
+    lazy_init_guard& operator=(lazy_init_guard&& other) noexcept {
+        std::swap(state, other.state);
+        return *this;
+    }
+
+    //! Shuts down all SDL subsystems
+    ~lazy_init_guard() {
+        if (!state) { return; }
+        detail::lazy_init_state* expected = state.get();
+        detail::active_lazy_init().compare_exchange_strong(expected, nullptr);
+        state->release();
+        ::SDL_Quit();
+    }
+
+    /*!
+     Initializes any of the subsystems in `flags` which were requested at
+     construction and have not yet been initialized.
+     @throws sdl::error if a subsystem fails to initialize
+     */
+    void require(init_flags flags) { state->require(flags).value(); }
+
+    //! Like `require()`, but returns a failed result rather than throwing if
+    //! a subsystem fails to initialize
+    SDLXX_ATTR_WARN_UNUSED_RESULT
+    result<void> try_require(init_flags flags) { return state->require(flags); }
+
+    //! Returns the subsystems which may be initialized on demand
+    init_flags requested() const { return state->get_requested(); }
+
+    //! Returns the subsystems which have been initialized so far
+    init_flags initialized() const { return state->get_initialized(); }
+
+    //! Returns the time taken to initialize each subsystem, in the order in
+    //! which they were initialized
+    std::vector<subsystem_init_time> init_times() const {
+        return state->get_init_times();
+    }
+
+private:
+    explicit lazy_init_guard(std::unique_ptr<detail::lazy_init_state> state)
+        : state{std::move(state)} {}
+
+    static bool activate(detail::lazy_init_state* state) {
+        detail::lazy_init_state* expected = nullptr;
+        if (!detail::active_lazy_init().compare_exchange_strong(expected,
+                                                                state)) {
+            ::SDL_SetError("An sdl::lazy_init_guard is already active");
+            return false;
+        }
+        return true;
+    }
+
+    std::unique_ptr<detail::lazy_init_state> state;
+};
+
+/*!
+ Ensures that the subsystems given in `flags` are initialized, if an
+ `sdl::lazy_init_guard` is active and they were requested by it. Otherwise,
+ does nothing.
+
+ This function is called by sdl++ wrappers which need a particular subsystem.
+ It may also be called by libraries built on sdl++.
+
+ @throws sdl::error if a subsystem fails to initialize
+ */
+inline void require_subsystems(init_flags flags) {
+    if (auto state = detail::active_lazy_init().load()) {
+        state->require(flags).value();
+    }
+}
+
+//! Like `sdl::require_subsystems()`, but returns a failed result rather than
+//! throwing if a subsystem fails to initialize
+SDLXX_ATTR_WARN_UNUSED_RESULT
+inline result<void> try_require_subsystems(init_flags flags) {
+    if (auto state = detail::active_lazy_init().load()) {
+        return state->require(flags);
+    }
+    return {};
+}
+
+namespace detail {
+
+    inline result<std::chrono::microseconds>
+    timed_init_subsystem(init_flags flags) {
+        const auto start = std::chrono::steady_clock::now();
+        if (detail::c_call(::SDL_InitSubSystem, flags) != 0) { return failure; }
+        const auto elapsed =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start);
+        log_info(log_category::system, "Initialized %s subsystem in %.3f ms",
+                 subsystem_name(flags), elapsed.count() / 1000.0);
+        return elapsed;
+    }
+
+    // Whether a subsystem may be initialized on a worker thread which exits
+    // afterwards. On Windows, the joystick and haptic backends create a
+    // helper window owned by the initializing thread, and the WASAPI audio
+    // backend creates COM objects in that thread's apartment. On macOS, the
+    // joystick backend schedules hotplug notifications on the initializing
+    // thread's run loop. Other platforms are untested, so are assumed unsafe.
+    inline bool can_init_in_background(init_flags subsystem) {
+#if defined(__LINUX__)
+        (void) subsystem;
+        return true;
+#elif defined(__MACOSX__)
+        return subsystem == init_flags::audio;
+#else
+        (void) subsystem;
+        return false;
+#endif
+    }
+
+    class async_init_state {
+    public:
+        async_init_state() = default;
+        async_init_state(const async_init_state&) = delete;
+        async_init_state& operator=(const async_init_state&) = delete;
+
+        // Waits for any outstanding work, then shuts everything down. This
+        // also runs if the constructor of async_init_guard throws.
+        ~async_init_state() {
+            for (const auto& task : tasks) { task.result.wait(); }
+            ::SDL_Quit();
+        }
+
+        // Initializes a subsystem on the calling thread
+        result<void> init_now(init_flags subsystem) {
+            const auto time = timed_init_subsystem(subsystem);
+            if (!time) { return failure; }
+            add_time(subsystem, *time);
+            return {};
+        }
+
+        // Initializes a subsystem on a worker thread
+        void init_async(init_flags subsystem) {
+            // Waiting for joystick means waiting for game controller too,
+            // as the latter initializes the former
+            const auto covers = subsystem == init_flags::gamecontroller
+                                    ? subsystem | init_flags::joystick
+                                    : subsystem;
+            // SDL's error message is thread-local, so a failure is reported
+            // by copying the message out of the worker thread
+            tasks.push_back(
+                {covers, std::async(std::launch::async, [this, subsystem] {
+                             const auto time = timed_init_subsystem(subsystem);
+                             if (!time) { return error_string(); }
+                             add_time(subsystem, *time);
+                             return std::string{};
+                         }).share()});
+        }
+
+        bool is_ready(init_flags flags) const {
+            for (const auto& task : tasks) {
+                if (flag_is_set(flags, task.subsystems) &&
+                    task.result.wait_for(std::chrono::seconds{0}) !=
+                        std::future_status::ready) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // On failure, sets the worker's error message on the calling thread
+        result<void> wait(init_flags flags) const {
+            for (const auto& task : tasks) {
+                if (!flag_is_set(flags, task.subsystems)) { continue; }
+                const auto& message = task.result.get();
+                if (!message.empty()) {
+                    ::SDL_SetError("%s", message.c_str());
+                    return failure;
+                }
+            }
+            return {};
+        }
+
+        std::vector<subsystem_init_time> get_init_times() const {
+            std::lock_guard<std::mutex> lock{mutex};
+            return times;
+        }
+
+    private:
+        struct task_t {
+            init_flags subsystems;
+            // Empty on success, or the error message on failure
+            std::shared_future<std::string> result;
+        };
+
+        static std::string error_string() {
+            const char* message = ::SDL_GetError();
+            return message && *message ? message : "Unknown error";
+        }
+
+        void add_time(init_flags subsystem, std::chrono::microseconds time) {
+            std::lock_guard<std::mutex> lock{mutex};
+            times.push_back({subsystem, time});
+        }
+
+        mutable std::mutex mutex;
+        std::vector<task_t> tasks;
+        std::vector<subsystem_init_time> times;
+    };
+
+} // end namespace detail
+
+/*!
+ RAII initialization guard which initializes subsystems in parallel
+
+ An `async_init_guard` may be used instead of an `sdl::init_guard` to reduce
+ startup time. The constructor initializes the events and timer subsystems
+ first, on the calling thread, as every call to `SDL_InitSubSystem()` starts
+ SDL's tick counter, and video and joystick both start the events
+ subsystem. Then it starts audio, joystick (together with game controller)
+ and haptic initialization on worker threads, and finally initializes the
+ video subsystem on the calling thread. When the constructor returns, video,
+ events and timer are ready to use. The remaining subsystems may still be
+ initializing.
+
+ Only subsystems whose backends do not tie state to the initializing thread
+ are initialized in the background:
+
+ Platform | Background subsystems
+ -------- | ----------------------------------------
+ Linux    | audio, joystick, game controller, haptic
+ macOS    | audio
+ Others   | none
+
+ On macOS, the joystick backend receives hotplug notifications on the
+ initializing thread's run loop. On Windows, the joystick and haptic
+ backends create a helper window owned by the initializing thread, and the
+ WASAPI audio backend uses its COM apartment. Other platforms have not been
+ checked.
+
+ Subsystems which cannot be initialized in the background are initialized
+ on the calling thread before video, and are ready when the constructor
+ returns.
+
+ Before using a background subsystem, call `wait()` to block until it is
+ ready. `wait()` also reports any error that occurred during initialization.
+ Alternatively, call `is_ready()` to poll without blocking.
+
+ ```
+ int main() {
+     sdl::async_init_guard init{sdl::init_flags::video,
+                                sdl::init_flags::audio,
+                                sdl::init_flags::gamecontroller};
+
+     // Video is ready now, so we can create a window...
+
+     init.wait(sdl::init_flags::audio);
+     // ...and start playing sound
+ }
+ ```
+
+ The destructor waits for any initialization still in progress, then calls
+ `SDL_Quit()`, shutting down all subsystems.
+
+ @warning SDL does not update its subsystem reference counts atomically,
+ and the joystick and video subsystems both add a reference to the events
+ subsystem while initializing in parallel. Subsystems initialized by an
+ `async_init_guard` must therefore not be shut down individually with
+ `SDL_QuitSubSystem()` or an `sdl::subsystem_init_guard`. Only `SDL_Quit()`
+ is reliable.
+ */
+class async_init_guard {
+public:
+    /*!
+     Creates an `async_init_guard` initializing the subsystems given in
+     `flags`.
+     @throws sdl::error if the events, timer or video subsystem fails to
+             initialize
+     */
+    explicit async_init_guard(init_flags flags)
+        : state{std::make_unique<detail::async_init_state>()} {
+        start(*state, flags).value();
+    }
+
+    /*!
+     Creates an `async_init_guard` initializing the subsystems given in
+     `flags_list`.
+     @throws sdl::error if the events, timer or video subsystem fails to
+             initialize
+     */
+    explicit async_init_guard(std::initializer_list<init_flags> flags_list)
+        : async_init_guard(detail::ilist_to_flags(flags_list)) {}
+
+    /*!
+     Attempts to create an `async_init_guard`, without throwing.
+     @returns An `async_init_guard`, or a failed result if the events, timer
+              or video subsystem failed to initialize
+     */
+    SDLXX_ATTR_WARN_UNUSED_RESULT
+    static result<async_init_guard> try_create(init_flags flags) {
+        auto state = std::make_unique<detail::async_init_state>();
+        if (!start(*state, flags)) { return failure; }
+        return async_init_guard{std::move(state)};
+    }
+
+    //! @overload
+    SDLXX_ATTR_WARN_UNUSED_RESULT
+    static result<async_init_guard>
+    try_create(std::initializer_list<init_flags> flags_list) {
+        return try_create(detail::ilist_to_flags(flags_list));
+    }
+
+    //! Move constructor
+    async_init_guard(async_init_guard&&) noexcept = default;
+
+    //! Move assignment operator
+    async_init_guard& operator=(async_init_guard&& other) noexcept {
+        std::swap(state, other.state);
+        return *this;
+    }
+
+    //! Returns true if all of the subsystems in `flags` have finished
+    //! initializing, successfully or not. Does not block.
+    bool is_ready(init_flags flags) const { return state->is_ready(flags); }
+
+    /*!
+     Blocks until all of the subsystems in `flags` have been initialized.
+     @throws sdl::error if any of the subsystems failed to initialize
+     */
+    void wait(init_flags flags) const { state->wait(flags).value(); }
+
+    /*!
+     Blocks until all subsystems have been initialized.
+     @throws sdl::error if any of the subsystems failed to initialize
+     */
+    void wait() const { state->wait(init_flags::everything).value(); }
+
+    //! Like `wait()`, but returns a failed result rather than throwing if
+    //! any of the subsystems failed to initialize
+    SDLXX_ATTR_WARN_UNUSED_RESULT
+    result<void> try_wait(init_flags flags = init_flags::everything) const {
+        return state->wait(flags);
+    }
+
+    //! Returns the time taken to initialize each subsystem which has
+    //! finished initializing so far, in order of completion
+    std::vector<subsystem_init_time> init_times() const {
+        return state->get_init_times();
+    }
+
+private:
+    explicit async_init_guard(std::unique_ptr<detail::async_init_state> state)
+        : state{std::move(state)} {}
+
+    static result<void> start(detail::async_init_state& state,
+                              init_flags flags) {
+        // The game controller subsystem initializes joystick itself
+        std::vector<init_flags> background;
+        for (auto subsystem : {init_flags::audio, init_flags::gamecontroller,
+                               init_flags::joystick, init_flags::haptic}) {
+            if (flag_is_set(flags, subsystem) &&
+                !(subsystem == init_flags::joystick &&
+                  flag_is_set(flags, init_flags::gamecontroller))) {
+                background.push_back(subsystem);
+            }
+        }
+
+        // Every SDL_InitSubSystem() call starts the tick counter, and video
+        // and joystick both start the events subsystem, so start these
+        // first rather than letting the threads race to do so
+        if (!background.empty() ||
+            flag_is_set(flags, init_flags::events | init_flags::video)) {
+            if (!state.init_now(init_flags::events)) { return failure; }
+        }
+        if (!background.empty() || flag_is_set(flags, init_flags::timer)) {
+            if (!state.init_now(init_flags::timer)) { return failure; }
+        }
+
+        for (auto subsystem : background) {
+            if (detail::can_init_in_background(subsystem)) {
+                state.init_async(subsystem);
+            } else if (!state.init_now(subsystem)) {
+                return failure;
+            }
+        }
+
+        if (flag_is_set(flags, init_flags::video)) {
+            return state.init_now(init_flags::video);
+        }
+        return {};
+    }
+
+    std::unique_ptr<detail::async_init_state> state;
+};
+
 } // end namespace sdl
 
 #endif // SDLXX_INIT_HPP
@@ -0,0 +1,889 @@
+/*!
+  @file input_record.hpp
+  Recording and deterministic replay of input events
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDLXX_INPUT_RECORD_HPP
+#define SDLXX_INPUT_RECORD_HPP
+
+#include "SDL_events.h"
+#include "SDL_rwops.h"
+#include "SDL_timer.h"
+
+#include "detail/varint.hpp"
+#include "init.hpp"
+#include "keyboard.hpp"
+#include "macros.hpp"
+#include "result.hpp"
+#include "rwops.hpp"
+#include "stdinc.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace sdl {
+
+namespace detail {
+
+    // Converts a performance counter interval to microseconds without
+    // overflowing for long sessions
+    inline uint64_t counter_to_micros(uint64_t ticks, uint64_t frequency) {
+        return (ticks / frequency) * 1000000 +
+               (ticks % frequency) * 1000000 / frequency;
+    }
+
+    /*
+     Input recordings consist of an 8-byte magic number and a version number,
+     followed by a sequence of records. Each record is made up of
+
+        - the time since the previous record in microseconds
+        - the record type, which is either an SDL event type or
+          `key_state_record`
+        - a type-specific payload
+
+     All integers are stored as varints, with signed values zigzag-encoded.
+     Mouse positions are stored relative to the previous mouse position.
+     */
+    constexpr uint8_t input_record_magic[8] = {'S', 'D', 'L', 'X',
+                                               'X', 'R', 'E', 'C'};
+    constexpr uint64_t input_record_version = 1;
+
+    // SDL_FIRSTEVENT is never used as a real event type
+    constexpr uint64_t key_state_record = SDL_FIRSTEVENT;
+
+    // The largest possible record: a key state change with every key toggled
+    constexpr size_t max_input_record_size =
+        3 * max_varint_size + SDL_NUM_SCANCODES * 2;
+
+    // State shared between encoding and decoding for delta compression
+    struct input_codec_state {
+        int64_t mouse_x = 0;
+        int64_t mouse_y = 0;
+    };
+
+    struct input_writer {
+        std::vector<uint8_t>& out;
+
+        void u(uint64_t value) { put_varint(out, value); }
+
+        void s(int64_t value) { put_varint(out, zigzag_encode(value)); }
+
+        void bytes(const void* data, size_t size) {
+            u(size);
+            const auto p = static_cast<const uint8_t*>(data);
+            out.insert(out.end(), p, p + size);
+        }
+
+        void str(const char* s, size_t max_size) {
+            size_t len = 0;
+            while (len < max_size && s[len] != '\0') { ++len; }
+            bytes(s, len);
+        }
+    };
+
+    struct input_reader {
+        const uint8_t* first;
+        const uint8_t* last;
+        bool ok = true;
+        // Set if decoding failed because the input ran out
+        bool truncated = false;
+
+        void fail(bool out_of_input) {
+            ok = false;
+            truncated = out_of_input;
+        }
+
+        uint64_t u() {
+            uint64_t value = 0;
+            if (!ok) { return value; }
+            const uint8_t* next = get_varint(first, last, value);
+            if (next) {
+                first = next;
+            } else {
+                fail(last - first < static_cast<ptrdiff_t>(max_varint_size));
+            }
+            return value;
+        }
+
+        int64_t s() { return zigzag_decode(u()); }
+
+        // Reads a length-prefixed byte string, truncating it to `max_size`
+        size_t bytes(void* dest, size_t max_size) {
+            const uint64_t size = u();
+            if (!ok) { return 0; }
+            if (size > static_cast<uint64_t>(last - first)) {
+                fail(true);
+                return 0;
+            }
+            const size_t n = size < max_size ? size : max_size;
+            SDL_memcpy(dest, first, n);
+            first += size;
+            return n;
+        }
+
+        const uint8_t* str(size_t& size) {
+            size = static_cast<size_t>(u());
+            if (!ok) { return nullptr; }
+            if (size > static_cast<size_t>(last - first)) {
+                fail(true);
+                return nullptr;
+            }
+            const uint8_t* p = first;
+            first += size;
+            return p;
+        }
+    };
+
+    inline bool is_user_event(uint32_t type) { return type >= SDL_USEREVENT; }
+
+    // Drop events carry a string allocated with SDL_malloc()
+    inline bool is_drop_event(uint32_t type) {
+#if SDL_VERSION_ATLEAST(2, 0, 5)
+        return type == SDL_DROPFILE || type == SDL_DROPTEXT ||
+               type == SDL_DROPBEGIN || type == SDL_DROPCOMPLETE;
+#else
+        return type == SDL_DROPFILE;
+#endif
+    }
+
+    // Returns false for events which cannot be meaningfully recorded
+    inline bool encode_event(input_writer& w, input_codec_state& state,
+                             const SDL_Event& e) {
+        switch (e.type) {
+        case SDL_QUIT: break;
+        case SDL_WINDOWEVENT:
+            w.u(e.window.windowID);
+            w.u(e.window.event);
+            w.s(e.window.data1);
+            w.s(e.window.data2);
+            break;
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            w.u(e.key.windowID);
+            w.u(static_cast<uint64_t>(e.key.keysym.scancode));
+            w.s(e.key.keysym.sym);
+            w.u(e.key.keysym.mod);
+            w.u(e.key.repeat);
+            break;
+        case SDL_TEXTEDITING:
+            w.u(e.edit.windowID);
+            w.s(e.edit.start);
+            w.s(e.edit.length);
+            w.str(e.edit.text, sizeof(e.edit.text));
+            break;
+        case SDL_TEXTINPUT:
+            w.u(e.text.windowID);
+            w.str(e.text.text, sizeof(e.text.text));
+            break;
+        case SDL_MOUSEMOTION:
+            w.u(e.motion.windowID);
+            w.u(e.motion.which);
+            w.u(e.motion.state);
+            w.s(e.motion.x - state.mouse_x);
+            w.s(e.motion.y - state.mouse_y);
+            w.s(e.motion.xrel);
+            w.s(e.motion.yrel);
+            state.mouse_x = e.motion.x;
+            state.mouse_y = e.motion.y;
+            break;
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            w.u(e.button.windowID);
+            w.u(e.button.which);
+            w.u(e.button.button);
+            w.u(e.button.clicks);
+            w.s(e.button.x - state.mouse_x);
+            w.s(e.button.y - state.mouse_y);
+            state.mouse_x = e.button.x;
+            state.mouse_y = e.button.y;
+            break;
+        case SDL_MOUSEWHEEL:
+            w.u(e.wheel.windowID);
+            w.u(e.wheel.which);
+            w.s(e.wheel.x);
+            w.s(e.wheel.y);
+#if SDL_VERSION_ATLEAST(2, 0, 4)
+            w.u(e.wheel.direction);
+#endif
+            break;
+        case SDL_JOYAXISMOTION:
+            w.s(e.jaxis.which);
+            w.u(e.jaxis.axis);
+            w.s(e.jaxis.value);
+            break;
+        case SDL_JOYBALLMOTION:
+            w.s(e.jball.which);
+            w.u(e.jball.ball);
+            w.s(e.jball.xrel);
+            w.s(e.jball.yrel);
+            break;
+        case SDL_JOYHATMOTION:
+            w.s(e.jhat.which);
+            w.u(e.jhat.hat);
+            w.u(e.jhat.value);
+            break;
+        case SDL_JOYBUTTONDOWN:
+        case SDL_JOYBUTTONUP:
+            w.s(e.jbutton.which);
+            w.u(e.jbutton.button);
+            break;
+        case SDL_CONTROLLERAXISMOTION:
+            w.s(e.caxis.which);
+            w.u(e.caxis.axis);
+            w.s(e.caxis.value);
+            break;
+        case SDL_CONTROLLERBUTTONDOWN:
+        case SDL_CONTROLLERBUTTONUP:
+            w.s(e.cbutton.which);
+            w.u(e.cbutton.button);
+            break;
+        case SDL_DROPFILE:
+#if SDL_VERSION_ATLEAST(2, 0, 5)
+        case SDL_DROPTEXT:
+        case SDL_DROPBEGIN:
+        case SDL_DROPCOMPLETE:
+#endif
+            w.str(e.drop.file ? e.drop.file : "", SDL_MAX_SINT32);
+            break;
+        case SDL_SYSWMEVENT:
+#if SDL_VERSION_ATLEAST(2, 0, 22)
+        case SDL_TEXTEDITING_EXT:
+#endif
+            // Contain pointers to platform-specific data or heap strings
+            return false;
+        default:
+            if (is_user_event(e.type)) {
+                // The data pointers are meaningless in another process, so
+                // only the code is stored
+                w.u(e.user.windowID);
+                w.s(e.user.code);
+            } else {
+                w.bytes(&e, sizeof(e));
+            }
+            break;
+        }
+        return true;
+    }
+
+    inline bool decode_event(input_reader& r, input_codec_state& state,
+                             uint32_t type, SDL_Event& e) {
+        SDL_memset(&e, 0, sizeof(e));
+        e.type = type;
+
+        switch (type) {
+        case SDL_QUIT: break;
+        case SDL_WINDOWEVENT:
+            e.window.windowID = static_cast<uint32_t>(r.u());
+            e.window.event = static_cast<uint8_t>(r.u());
+            e.window.data1 = static_cast<int32_t>(r.s());
+            e.window.data2 = static_cast<int32_t>(r.s());
+            break;
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            e.key.windowID = static_cast<uint32_t>(r.u());
+            e.key.state = type == SDL_KEYDOWN ? SDL_PRESSED : SDL_RELEASED;
+            e.key.keysym.scancode = static_cast<SDL_Scancode>(r.u());
+            e.key.keysym.sym = static_cast<SDL_Keycode>(r.s());
+            e.key.keysym.mod = static_cast<uint16_t>(r.u());
+            e.key.repeat = static_cast<uint8_t>(r.u());
+            break;
+        case SDL_TEXTEDITING:
+            e.edit.windowID = static_cast<uint32_t>(r.u());
+            e.edit.start = static_cast<int32_t>(r.s());
+            e.edit.length = static_cast<int32_t>(r.s());
+            r.bytes(e.edit.text, sizeof(e.edit.text) - 1);
+            break;
+        case SDL_TEXTINPUT:
+            e.text.windowID = static_cast<uint32_t>(r.u());
+            r.bytes(e.text.text, sizeof(e.text.text) - 1);
+            break;
+        case SDL_MOUSEMOTION:
+            e.motion.windowID = static_cast<uint32_t>(r.u());
+            e.motion.which = static_cast<uint32_t>(r.u());
+            e.motion.state = static_cast<uint32_t>(r.u());
+            state.mouse_x += r.s();
+            state.mouse_y += r.s();
+            e.motion.x = static_cast<int32_t>(state.mouse_x);
+            e.motion.y = static_cast<int32_t>(state.mouse_y);
+            e.motion.xrel = static_cast<int32_t>(r.s());
+            e.motion.yrel = static_cast<int32_t>(r.s());
+            break;
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            e.button.windowID = static_cast<uint32_t>(r.u());
+            e.button.which = static_cast<uint32_t>(r.u());
+            e.button.button = static_cast<uint8_t>(r.u());
+            e.button.state =
+                type == SDL_MOUSEBUTTONDOWN ? SDL_PRESSED : SDL_RELEASED;
+            e.button.clicks = static_cast<uint8_t>(r.u());
+            state.mouse_x += r.s();
+            state.mouse_y += r.s();
+            e.button.x = static_cast<int32_t>(state.mouse_x);
+            e.button.y = static_cast<int32_t>(state.mouse_y);
+            break;
+        case SDL_MOUSEWHEEL:
+            e.wheel.windowID = static_cast<uint32_t>(r.u());
+            e.wheel.which = static_cast<uint32_t>(r.u());
+            e.wheel.x = static_cast<int32_t>(r.s());
+            e.wheel.y = static_cast<int32_t>(r.s());
+#if SDL_VERSION_ATLEAST(2, 0, 4)
+            e.wheel.direction = static_cast<uint32_t>(r.u());
+#endif
+            break;
+        case SDL_JOYAXISMOTION:
+            e.jaxis.which = static_cast<SDL_JoystickID>(r.s());
+            e.jaxis.axis = static_cast<uint8_t>(r.u());
+            e.jaxis.value = static_cast<int16_t>(r.s());
+            break;
+        case SDL_JOYBALLMOTION:
+            e.jball.which = static_cast<SDL_JoystickID>(r.s());
+            e.jball.ball = static_cast<uint8_t>(r.u());
+            e.jball.xrel = static_cast<int16_t>(r.s());
+            e.jball.yrel = static_cast<int16_t>(r.s());
+            break;
+        case SDL_JOYHATMOTION:
+            e.jhat.which = static_cast<SDL_JoystickID>(r.s());
+            e.jhat.hat = static_cast<uint8_t>(r.u());
+            e.jhat.value = static_cast<uint8_t>(r.u());
+            break;
+        case SDL_JOYBUTTONDOWN:
+        case SDL_JOYBUTTONUP:
+            e.jbutton.which = static_cast<SDL_JoystickID>(r.s());
+            e.jbutton.button = static_cast<uint8_t>(r.u());
+            e.jbutton.state =
+                type == SDL_JOYBUTTONDOWN ? SDL_PRESSED : SDL_RELEASED;
+            break;
+        case SDL_CONTROLLERAXISMOTION:
+            e.caxis.which = static_cast<SDL_JoystickID>(r.s());
+            e.caxis.axis = static_cast<uint8_t>(r.u());
+            e.caxis.value = static_cast<int16_t>(r.s());
+            break;
+        case SDL_CONTROLLERBUTTONDOWN:
+        case SDL_CONTROLLERBUTTONUP:
+            e.cbutton.which = static_cast<SDL_JoystickID>(r.s());
+            e.cbutton.button = static_cast<uint8_t>(r.u());
+            e.cbutton.state =
+                type == SDL_CONTROLLERBUTTONDOWN ? SDL_PRESSED : SDL_RELEASED;
+            break;
+        case SDL_DROPFILE:
+#if SDL_VERSION_ATLEAST(2, 0, 5)
+        case SDL_DROPTEXT:
+        case SDL_DROPBEGIN:
+        case SDL_DROPCOMPLETE:
+#endif
+        {
+            // As with real drop events, the receiver must SDL_free() this
+            size_t size = 0;
+            const uint8_t* p = r.str(size);
+            if (!r.ok) { break; }
+#if SDL_VERSION_ATLEAST(2, 0, 5)
+            // SDL gives these events a null file
+            if (type == SDL_DROPBEGIN || type == SDL_DROPCOMPLETE) { break; }
+#endif
+            e.drop.file = static_cast<char*>(::SDL_malloc(size + 1));
+            if (e.drop.file) {
+                SDL_memcpy(e.drop.file, p, size);
+                e.drop.file[size] = '\0';
+            }
+            break;
+        }
+        default:
+            if (is_user_event(type)) {
+                e.user.windowID = static_cast<uint32_t>(r.u());
+                e.user.code = static_cast<int32_t>(r.s());
+            } else {
+                r.bytes(&e, sizeof(e));
+                e.type = type;
+            }
+            break;
+        }
+        return r.ok;
+    }
+
+} // end namespace detail
+
+/*!
+ @defgroup InputRecord Input Recording and Replay
+
+ This category contains types for recording input events to a file, and for
+ replaying them later with the same timing. This is useful for reproducing
+ bugs and for performance regression testing, where each build should be
+ given exactly the same input.
+
+ Recordings are written with `sdl::input_recorder`:
+
+ ```
+ sdl::input_recorder recorder{"session.rec"};
+
+ while (running) {
+     SDL_Event event;
+     while (SDL_PollEvent(&event)) {
+         recorder.record(event);
+         handle(event);
+     }
+     recorder.record(sdl::key_state::current());
+     // ...
+ }
+ ```
+
+ and replayed with `sdl::input_player`, which pushes the recorded events onto
+ the SDL event queue when they become due:
+
+ ```
+ sdl::input_player player{"session.rec"};
+
+ while (!player.finished()) {
+     player.update();
+     // ... run the frame as normal ...
+ }
+ ```
+
+ The file format is compact: timestamps are stored as deltas in microseconds,
+ integers are stored as variable-length values and mouse positions are
+ stored relative to the previous position, so that a typical event takes
+ only a few bytes. Key state snapshots only store the keys which changed since
+ the previous snapshot.
+
+ @{
+ */
+
+/*!
+ Records input events and keyboard state changes to a file.
+
+ Recording costs little more than appending a few bytes to an in-memory
+ buffer, which is written to the file in large blocks. This makes it cheap
+ enough to leave enabled all the time.
+
+ Events which contain pointers are recorded without them: the `data1` and
+ `data2` fields of user events are replayed as `nullptr`, and `SDL_SYSWMEVENT`s
+ are not recorded at all. The file name or text of drop events is recorded
+ and replayed as a new string, which must be freed as usual. Other events
+ which point to heap memory, such as `SDL_TEXTEDITING_EXT`, are not
+ recorded.
+
+ `input_recorder` is move-only.
+ */
+class input_recorder {
+public:
+    /*!
+     Creates a new recording, overwriting the file at `path`.
+     @throws sdl::error if the file could not be opened or written
+     */
+    explicit input_recorder(const char* path)
+        : input_recorder(detail::open_rwops(path, "wb")) {}
+
+    //! @overload
+    explicit input_recorder(const string& path)
+        : input_recorder(path.c_str()) {}
+
+    /*!
+     Creates a new recording, overwriting the file at `path`, without
+     throwing.
+     @returns An `input_recorder`, or a failed result if the file could not
+              be opened
+     */
+    SDLXX_ATTR_WARN_UNUSED_RESULT
+    static result<input_recorder> try_open(const char* path) {
+        rwops_ptr rw{::SDL_RWFromFile(path, "wb")};
+        if (!rw) { return failure; }
+        return input_recorder{std::move(rw)};
+    }
+
+    //! @overload
+    SDLXX_ATTR_WARN_UNUSED_RESULT
+    static result<input_recorder> try_open(const string& path) {
+        return try_open(path.c_str());
+    }
+
+    //! Move constructor
+    input_recorder(input_recorder&&) = default;
+
+    //! Move assignment operator. Any records buffered by this recorder are
+    //! written to its file before it is closed.
+    input_recorder& operator=(input_recorder&& other) {
+        if (this != &other) {
+            if (rw) { write_buffer(); }
+            rw = std::move(other.rw);
+            buffer = std::move(other.buffer);
+            codec_state = std::move(other.codec_state);
+            previous_keys = other.previous_keys;
+            frequency = other.frequency;
+            start_counter = other.start_counter;
+            last_time = other.last_time;
+            pending_time = other.pending_time;
+            written = other.written;
+        }
+        return *this;
+    }
+
+    //! Writes any buffered records and closes the file
+    ~input_recorder() {
+        if (rw) { write_buffer(); }
+    }
+
+    /*!
+     Records an event, timestamped with the current time.
+     @throws sdl::error if writing to the file fails
+     */
+    void record(const SDL_Event& event) {
+        const auto mark = buffer.size();
+        begin_record(event.type);
+        detail::input_writer w{buffer};
+        if (detail::encode_event(w, codec_state, event)) {
+            last_time = pending_time;
+            maybe_flush();
+        } else {
+            buffer.resize(mark);
+        }
+    }
+
+    /*!
+     Records a keyboard state snapshot. Only the keys which have changed since
+     the previous snapshot are stored; if no keys have changed, nothing is
+     written.
+     @throws sdl::error if writing to the file fails
+     */
+    void record(const key_state& keys) {
+        const auto changed = keys_changed(previous_keys, keys);
+        if (changed.none()) { return; }
+
+        begin_record(detail::key_state_record);
+        detail::put_varint(buffer, static_cast<uint64_t>(changed.count()));
+        uint64_t prev = 0;
+        for (auto key : changed) {
+            const auto k = static_cast<uint64_t>(key);
+            detail::put_varint(buffer, k - prev);
+            prev = k;
+        }
+        previous_keys = keys;
+        last_time = pending_time;
+        maybe_flush();
+    }
+
+    /*!
+     Writes all buffered records to the file.
+     @throws sdl::error if writing to the file fails
+     */
+    void flush() { SDLXX_CHECK(write_buffer()); }
+
+    //! Writes all buffered records to the file
+    //! @returns A failed result if writing to the file fails
+    SDLXX_ATTR_WARN_UNUSED_RESULT
+    result<void> try_flush() {
+        if (!write_buffer()) { return failure; }
+        return {};
+    }
+
+    //! Returns the total number of bytes recorded so far, including those
+    //! which have not yet been flushed
+    uint64_t size() const noexcept { return written + buffer.size(); }
+
+private:
+    static constexpr size_t flush_threshold = 64 * 1024;
+
+    explicit input_recorder(rwops_ptr file)
+        : rw(std::move(file)),
+          frequency(::SDL_GetPerformanceFrequency()),
+          start_counter(::SDL_GetPerformanceCounter()) {
+        buffer.reserve(flush_threshold + detail::max_input_record_size);
+        buffer.insert(buffer.end(), std::begin(detail::input_record_magic),
+                      std::end(detail::input_record_magic));
+        detail::put_varint(buffer, detail::input_record_version);
+    }
+
+    void begin_record(uint64_t type) {
+        pending_time = detail::counter_to_micros(
+            ::SDL_GetPerformanceCounter() - start_counter, frequency);
+        detail::put_varint(buffer, pending_time - last_time);
+        detail::put_varint(buffer, type);
+    }
+
+    void maybe_flush() {
+        if (buffer.size() >= flush_threshold) { flush(); }
+    }
+
+    bool write_buffer() noexcept {
+        if (buffer.empty()) { return true; }
+        const auto n = SDL_RWwrite(rw.get(), buffer.data(), 1, buffer.size());
+        const bool ok = n == buffer.size();
+        written += n;
+        buffer.clear();
+        return ok;
+    }
+
+    rwops_ptr rw;
+    std::vector<uint8_t> buffer;
+    detail::input_codec_state codec_state;
+    key_state previous_keys;
+    uint64_t frequency;
+    uint64_t start_counter;
+    uint64_t last_time = 0;
+    uint64_t pending_time = 0;
+    uint64_t written = 0;
+};
+
+/*!
+ Replays a recording made with `sdl::input_recorder`.
+
+ Events are pushed onto the SDL event queue using `SDL_PushEvent()`, so the
+ events subsystem must be initialized. Recorded keyboard state snapshots are
+ available from `input_player::keys()`.
+
+ The recording is streamed from the file in blocks, so long recordings do not
+ need to fit in memory. `input_player` is move-only.
+ */
+class input_player {
+public:
+    /*!
+     Opens a recording for replay. The playback clock starts at the first
+     call to `update()`.
+     @throws sdl::error if the file could not be opened or is not a valid
+             recording
+     */
+    explicit input_player(const char* path)
+        : input_player(detail::open_rwops(path, "rb")) {
+        require_subsystems(init_flags::events);
+        SDLXX_CHECK(start());
+    }
+
+    //! @overload
+    explicit input_player(const string& path) : input_player(path.c_str()) {}
+
+    /*!
+     Opens a recording for replay, without throwing.
+     @returns An `input_player`, or a failed result if the file could not be
+              opened or is not a valid recording
+     */
+    SDLXX_ATTR_WARN_UNUSED_RESULT
+    static result<input_player> try_open(const char* path) {
+        rwops_ptr rw{::SDL_RWFromFile(path, "rb")};
+        if (!rw || !try_require_subsystems(init_flags::events)) {
+            return failure;
+        }
+        input_player player{std::move(rw)};
+        if (!player.start()) { return failure; }
+        return player;
+    }
+
+    //! @overload
+    SDLXX_ATTR_WARN_UNUSED_RESULT
+    static result<input_player> try_open(const string& path) {
+        return try_open(path.c_str());
+    }
+
+    //! Move constructor
+    input_player(input_player&&) = default;
+
+    //! Move assignment operator
+    input_player& operator=(input_player&&) = default;
+
+    /*!
+     Replays every record whose time has come, pushing events onto the SDL
+     event queue and updating `keys()`.
+     @returns The number of events pushed
+     @throws sdl::error if pushing an event fails or the recording is corrupt
+     */
+    int update() { return try_update().value(); }
+
+    /*!
+     Like `update()`, but returns a failed result rather than throwing if
+     pushing an event fails or the recording is corrupt.
+     */
+    SDLXX_ATTR_WARN_UNUSED_RESULT
+    result<int> try_update() {
+        if (!started) {
+            start_counter = ::SDL_GetPerformanceCounter();
+            started = true;
+        }
+        const auto now = detail::counter_to_micros(
+            ::SDL_GetPerformanceCounter() - start_counter, frequency);
+        return try_advance_to(now);
+    }
+
+    /*!
+     Replays every record up to `micros` microseconds after the start of the
+     recording, regardless of the current time. This is useful for replaying
+     input as fast as possible, for example when testing.
+     @returns The number of events pushed
+     @throws sdl::error if pushing an event fails or the recording is corrupt
+     */
+    int advance_to(uint64_t micros) { return try_advance_to(micros).value(); }
+
+    /*!
+     Like `advance_to()`, but returns a failed result rather than throwing if
+     pushing an event fails or the recording is corrupt.
+     */
+    SDLXX_ATTR_WARN_UNUSED_RESULT
+    result<int> try_advance_to(uint64_t micros) {
+        int count = 0;
+        while (has_pending && pending_time <= micros) {
+            if (pending_is_keys) {
+                keys_ ^= pending_keys;
+            } else {
+                const int pushed = ::SDL_PushEvent(&pending_event);
+                if (pushed < 0) { return failure; }
+                if (pushed > 0) {
+                    // The receiver now owns any drop event string
+                    pending_string.release();
+                    ++count;
+                }
+            }
+            if (!read_next()) { return failure; }
+        }
+        return count;
+    }
+
+    //! Returns the keyboard state as of the most recently replayed snapshot
+    const key_state& keys() const noexcept { return keys_; }
+
+    //! Returns the time of the next record, in microseconds after the start
+    //! of the recording, or `nullopt` if the recording has finished
+    optional<uint64_t> next_time() const noexcept {
+        return has_pending ? optional<uint64_t>{pending_time} : nullopt;
+    }
+
+    //! Returns true once every record has been replayed
+    bool finished() const noexcept { return !has_pending; }
+
+private:
+    static constexpr size_t read_size = 64 * 1024;
+
+    explicit input_player(rwops_ptr file)
+        : rw(std::move(file)), frequency(::SDL_GetPerformanceFrequency()) {}
+
+    // Checks the header and reads the first record
+    bool start() {
+        fill(detail::max_input_record_size);
+        bool valid = buffer.size() > sizeof(detail::input_record_magic) &&
+                     SDL_memcmp(buffer.data(), detail::input_record_magic,
+                                sizeof(detail::input_record_magic)) == 0;
+        if (valid) {
+            pos = sizeof(detail::input_record_magic);
+            uint64_t version = 0;
+            const uint8_t* next = detail::get_varint(
+                buffer.data() + pos, buffer.data() + buffer.size(), version);
+            valid = next && version == detail::input_record_version;
+            if (valid) { pos = static_cast<size_t>(next - buffer.data()); }
+        }
+        if (!valid) {
+            ::SDL_SetError("Not a valid sdl++ input recording");
+            return false;
+        }
+        return read_next();
+    }
+
+    // Ensures that at least `needed` bytes are buffered, if available
+    void fill(size_t needed) {
+        if (buffer.size() - pos >= needed) { return; }
+        buffer.erase(buffer.begin(), buffer.begin() + pos);
+        pos = 0;
+        while (!eof && buffer.size() < needed) {
+            const auto old_size = buffer.size();
+            buffer.resize(old_size + read_size);
+            const auto n =
+                SDL_RWread(rw.get(), buffer.data() + old_size, 1, read_size);
+            buffer.resize(old_size + n);
+            eof = n == 0;
+        }
+    }
+
+    // Decodes the record at the current position into the pending record
+    bool decode_next(detail::input_reader& r, uint64_t& delta,
+                     uint64_t& type) {
+        delta = r.u();
+        type = r.u();
+        if (!r.ok) { return false; }
+
+        if (type == detail::key_state_record) {
+            pending_keys.reset();
+            const auto n = r.u();
+            uint64_t key = 0;
+            for (uint64_t i = 0; r.ok && i < n; i++) {
+                key += r.u();
+                if (key >= key_state::size()) { r.fail(false); }
+                if (r.ok) { pending_keys.set(static_cast<scancode>(key)); }
+            }
+            return r.ok;
+        }
+
+        const bool ok = detail::decode_event(
+            r, codec_state, static_cast<uint32_t>(type), pending_event);
+        // Owned until the event is pushed, so that it is freed if the push
+        // fails, the event is filtered out or the player is destroyed first
+        pending_string =
+            sdl_string{detail::is_drop_event(static_cast<uint32_t>(type))
+                           ? pending_event.drop.file
+                           : nullptr};
+        return ok;
+    }
+
+    // Returns false if the recording is corrupt
+    bool read_next() {
+        has_pending = false;
+
+        // Almost all records fit within max_input_record_size, but file
+        // names in drop events may not, so keep reading until the record
+        // decodes or the file ends
+        for (size_t needed = detail::max_input_record_size;; needed *= 2) {
+            fill(needed);
+            if (pos == buffer.size()) { return true; }
+
+            detail::input_reader r{buffer.data() + pos,
+                                   buffer.data() + buffer.size()};
+            uint64_t delta = 0;
+            uint64_t type = 0;
+            if (decode_next(r, delta, type)) {
+                pos = static_cast<size_t>(r.first - buffer.data());
+                pending_time += delta;
+                pending_is_keys = type == detail::key_state_record;
+                has_pending = true;
+                return true;
+            }
+
+            // A truncated final record means that recording was interrupted,
+            // which is not an error. Anything else is.
+            if (!r.truncated) {
+                ::SDL_SetError("Corrupt sdl++ input recording");
+                return false;
+            }
+            if (eof) { return true; }
+        }
+    }
+
+    rwops_ptr rw;
+    std::vector<uint8_t> buffer;
+    size_t pos = 0;
+    bool eof = false;
+    detail::input_codec_state codec_state;
+    uint64_t frequency;
+    uint64_t start_counter = 0;
+    bool started = false;
+    uint64_t pending_time = 0;
+    bool has_pending = false;
+    bool pending_is_keys = false;
+    SDL_Event pending_event;
+    sdl_string pending_string;
+    key_state pending_keys;
+    key_state keys_;
+};
+
+} // end namespace sdl
+
+#endif // SDLXX_INPUT_RECORD_HPP
@@ -0,0 +1,483 @@
+/*!
+  @file keyboard.hpp
+  Include file for SDL keyboard event handling
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDLXX_KEYBOARD_HPP
+#define SDLXX_KEYBOARD_HPP
+
+#include "SDL_keyboard.h"
+
+#include "detail/scancode_names.hpp"
+
+#include "bits.hpp"
+#include "scancode.hpp"
+#include "stdinc.hpp"
+
+#include <iterator>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SDLXX_KEY_STATE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace sdl {
+
+namespace detail {
+
+    // Word-wise operations used by key_state. These are overloaded for SSE
+    // vectors where available, so that each operation on a key_state
+    // handles 128 keys at a time.
+
+    struct key_state_or {
+#ifdef SDLXX_KEY_STATE_SSE2
+        __m128i operator()(__m128i a, __m128i b) const noexcept {
+            return _mm_or_si128(a, b);
+        }
+#endif
+        uint64_t operator()(uint64_t a, uint64_t b) const noexcept {
+            return a | b;
+        }
+    };
+
+    struct key_state_and {
+#ifdef SDLXX_KEY_STATE_SSE2
+        __m128i operator()(__m128i a, __m128i b) const noexcept {
+            return _mm_and_si128(a, b);
+        }
+#endif
+        uint64_t operator()(uint64_t a, uint64_t b) const noexcept {
+            return a & b;
+        }
+    };
+
+    struct key_state_xor {
+#ifdef SDLXX_KEY_STATE_SSE2
+        __m128i operator()(__m128i a, __m128i b) const noexcept {
+            return _mm_xor_si128(a, b);
+        }
+#endif
+        uint64_t operator()(uint64_t a, uint64_t b) const noexcept {
+            return a ^ b;
+        }
+    };
+
+    // Computes ~a & b, matching the operand order of _mm_andnot_si128()
+    struct key_state_andnot {
+#ifdef SDLXX_KEY_STATE_SSE2
+        __m128i operator()(__m128i a, __m128i b) const noexcept {
+            return _mm_andnot_si128(a, b);
+        }
+#endif
+        uint64_t operator()(uint64_t a, uint64_t b) const noexcept {
+            return ~a & b;
+        }
+    };
+
+} // end namespace detail
+
+/*!
+ @defgroup Keyboard Keyboard Support
+
+ This category contains functions and types for handling keyboard input.
+
+ @{
+ */
+
+/*!
+ A snapshot of the state of every key on the keyboard.
+
+ `key_state` stores one bit per `sdl::scancode`, making it a 64-byte value
+ which is cheap to copy and compare. This makes it convenient to keep the
+ state from the previous frame around, and to calculate which keys changed in
+ between:
+
+ ```
+ auto previous = sdl::key_state{};
+
+ while (running) {
+     // ... pump events ...
+     const auto current = sdl::key_state::current();
+
+     for (sdl::scancode key : sdl::keys_pressed(previous, current)) {
+         // Called once for each key which went down this frame
+     }
+
+     previous = current;
+ }
+ ```
+
+ Bitwise operations are performed on whole words at a time (using SSE2 where
+ available), so calculating the difference between two snapshots takes only a
+ handful of instructions. Iterating over a `key_state` visits only those
+ keys which are set, in increasing scancode order.
+
+ @note All member functions taking an `sdl::scancode` require that the value
+       is less than `sdl::scancode::_num_scancodes`.
+ */
+class key_state {
+public:
+    //! The type used to store each group of 64 keys
+    using word_type = uint64_t;
+
+    //! The number of keys represented
+    static constexpr size_t size() noexcept { return SDL_NUM_SCANCODES; }
+
+    //! The number of words used to represent the keys
+    static constexpr size_t word_count() noexcept { return size() / 64; }
+
+    static_assert(SDL_NUM_SCANCODES % 128 == 0,
+                  "sdl::key_state requires a multiple of 128 scancodes");
+
+    //! Forward iterator over the keys which are set in a `key_state`
+    class iterator {
+    public:
+        //! @cond
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = scancode;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const scancode*;
+        using reference = scancode;
+        //! @endcond
+
+        //! Constructs a past-the-end iterator
+        iterator() = default;
+
+        //! Returns the current key
+        scancode operator*() const noexcept {
+            return static_cast<scancode>(index * 64 + countr_zero(word));
+        }
+
+        //! Advances to the next key which is set
+        iterator& operator++() noexcept {
+            word &= word - 1;
+            skip_empty();
+            return *this;
+        }
+
+        //! Advances to the next key which is set
+        iterator operator++(int) noexcept {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        //! Equality comparison
+        friend bool operator==(const iterator& lhs,
+                               const iterator& rhs) noexcept {
+            return lhs.index == rhs.index && lhs.word == rhs.word;
+        }
+
+        //! Inequality comparison
+        friend bool operator!=(const iterator& lhs,
+                               const iterator& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+    private:
+        friend class key_state;
+
+        explicit iterator(const word_type* words) noexcept
+            : words(words), index(0), word(words[0]) {
+            skip_empty();
+        }
+
+        void skip_empty() noexcept {
+            while (word == 0 && ++index < word_count()) {
+                word = words[index];
+            }
+        }
+
+        const word_type* words = nullptr;
+        size_t index = word_count();
+        word_type word = 0;
+    };
+
+    //! Constructs a `key_state` with no keys set
+    key_state() noexcept = default;
+
+    /*!
+     Constructs a `key_state` from an array of bytes in the format returned by
+     `SDL_GetKeyboardState()`, where any non-zero value indicates a key which
+     is pressed.
+
+     @param state Pointer to an array of `num_keys` bytes
+     @param num_keys Size of the array. Values greater than
+                     `key_state::size()` are ignored.
+     */
+    key_state(const uint8_t* state, int num_keys) noexcept {
+        const size_t n = num_keys < 0 ? 0 : static_cast<size_t>(num_keys);
+        if (n >= size()) {
+            pack(state);
+        } else {
+            for (size_t i = 0; i < n; i++) {
+                if (state[i] != 0) { set_index(i); }
+            }
+        }
+    }
+
+    //! Returns a snapshot of the current state of the keyboard, as given by
+    //! `SDL_GetKeyboardState()`.
+    static key_state current() noexcept {
+        int num_keys = 0;
+        const uint8_t* state = ::SDL_GetKeyboardState(&num_keys);
+        return key_state{state, num_keys};
+    }
+
+    //! Returns whether `key` is set
+    bool test(scancode key) const noexcept {
+        const auto i = static_cast<size_t>(key);
+        return ((words[i / 64] >> (i % 64)) & 1) != 0;
+    }
+
+    //! Returns whether `key` is set
+    bool operator[](scancode key) const noexcept { return test(key); }
+
+    //! Sets the value of `key`
+    key_state& set(scancode key, bool value = true) noexcept {
+        const auto i = static_cast<size_t>(key);
+        if (value) {
+            set_index(i);
+        } else {
+            words[i / 64] &= ~(word_type{1} << (i % 64));
+        }
+        return *this;
+    }
+
+    //! Clears `key`
+    key_state& reset(scancode key) noexcept { return set(key, false); }
+
+    //! Clears all keys
+    key_state& reset() noexcept {
+        *this = key_state{};
+        return *this;
+    }
+
+    //! Returns the number of keys which are set
+    int count() const noexcept {
+        int n = 0;
+        for (auto w : words) { n += popcount(w); }
+        return n;
+    }
+
+    //! Returns true if any key is set
+    bool any() const noexcept {
+        word_type acc = 0;
+        for (auto w : words) { acc |= w; }
+        return acc != 0;
+    }
+
+    //! Returns true if no key is set
+    bool none() const noexcept { return !any(); }
+
+    //! Returns an iterator to the first key which is set
+    iterator begin() const noexcept { return iterator{words}; }
+
+    //! Returns a past-the-end iterator
+    iterator end() const noexcept { return iterator{}; }
+
+    //! Returns a pointer to the underlying words. Key `k` is stored in bit
+    //! `k % 64` of word `k / 64`.
+    const word_type* data() const noexcept { return words; }
+
+    //! Sets each key which is set in either `*this` or `other`
+    key_state& operator|=(const key_state& other) noexcept {
+        return apply(other, detail::key_state_or{});
+    }
+
+    //! Clears each key which is not set in `other`
+    key_state& operator&=(const key_state& other) noexcept {
+        return apply(other, detail::key_state_and{});
+    }
+
+    //! Toggles each key which is set in `other`
+    key_state& operator^=(const key_state& other) noexcept {
+        return apply(other, detail::key_state_xor{});
+    }
+
+    //! Returns a `key_state` with every key toggled
+    key_state operator~() const noexcept {
+        key_state out;
+        for (size_t i = 0; i < word_count(); i++) { out.words[i] = ~words[i]; }
+        return out;
+    }
+
+    //! Returns the keys set in `*this` but not in `other`, that is
+    //! `*this & ~other`, without creating a temporary.
+    key_state and_not(const key_state& other) const noexcept {
+        key_state out = other;
+        return out.apply(*this, detail::key_state_andnot{});
+    }
+
+    //! Equality comparison
+    friend bool operator==(const key_state& lhs,
+                           const key_state& rhs) noexcept {
+        word_type acc = 0;
+        for (size_t i = 0; i < word_count(); i++) {
+            acc |= lhs.words[i] ^ rhs.words[i];
+        }
+        return acc == 0;
+    }
+
+    //! Inequality comparison
+    friend bool operator!=(const key_state& lhs,
+                           const key_state& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+
+private:
+    void set_index(size_t i) noexcept {
+        words[i / 64] |= word_type{1} << (i % 64);
+    }
+
+    // Packs size() bytes into bits, 16 keys at a time
+    void pack(const uint8_t* state) noexcept {
+        for (size_t w = 0; w < word_count(); w++) {
+            word_type word = 0;
+            for (size_t chunk = 0; chunk < 4; chunk++) {
+                const uint8_t* p = state + w * 64 + chunk * 16;
+#ifdef SDLXX_KEY_STATE_SSE2
+                const __m128i bytes =
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                const __m128i zero =
+                    _mm_cmpeq_epi8(bytes, _mm_setzero_si128());
+                const auto bits = static_cast<word_type>(
+                    ~_mm_movemask_epi8(zero) & 0xFFFF);
+#else
+                word_type bits = 0;
+                for (size_t i = 0; i < 16; i++) {
+                    bits |= word_type{p[i] != 0} << i;
+                }
+#endif
+                word |= bits << (chunk * 16);
+            }
+            words[w] = word;
+        }
+    }
+
+    template <typename Op>
+    key_state& apply(const key_state& other, Op op) noexcept {
+#ifdef SDLXX_KEY_STATE_SSE2
+        for (size_t i = 0; i < word_count(); i += 2) {
+            auto* dst = reinterpret_cast<__m128i*>(words + i);
+            const auto* src = reinterpret_cast<const __m128i*>(other.words + i);
+            _mm_store_si128(dst, op(_mm_load_si128(dst), _mm_load_si128(src)));
+        }
+#else
+        for (size_t i = 0; i < word_count(); i++) {
+            words[i] = op(words[i], other.words[i]);
+        }
+#endif
+        return *this;
+    }
+
+    alignas(16) word_type words[SDL_NUM_SCANCODES / 64] = {};
+};
+
+//! @relates key_state
+inline key_state operator|(key_state lhs, const key_state& rhs) noexcept {
+    return lhs |= rhs;
+}
+
+//! @relates key_state
+inline key_state operator&(key_state lhs, const key_state& rhs) noexcept {
+    return lhs &= rhs;
+}
+
+//! @relates key_state
+inline key_state operator^(key_state lhs, const key_state& rhs) noexcept {
+    return lhs ^= rhs;
+}
+
+//! Returns the keys which are set in `current` but not in `previous`
+//! @relates key_state
+inline key_state keys_pressed(const key_state& previous,
+                              const key_state& current) noexcept {
+    return current.and_not(previous);
+}
+
+//! Returns the keys which are set in `previous` but not in `current`
+//! @relates key_state
+inline key_state keys_released(const key_state& previous,
+                               const key_state& current) noexcept {
+    return previous.and_not(current);
+}
+
+//! Returns the keys which differ between `previous` and `current`
+//! @relates key_state
+inline key_state keys_changed(const key_state& previous,
+                              const key_state& current) noexcept {
+    return previous ^ current;
+}
+
+/*!
+ Gets a human-readable name for a scancode.
+
+ The names are the same as those returned by `SDL_GetScancodeName()`, but are
+ available at compile time.
+
+ @param code The scancode to query
+ @returns The name of the scancode, or an empty string if it does not have one
+ @ingroup Keyboard
+ */
+constexpr const char* get_scancode_name(scancode code) noexcept {
+    const auto index = static_cast<size_t>(code);
+    return index < SDL_NUM_SCANCODES && detail::scancode_names[index]
+               ? detail::scancode_names[index]
+               : "";
+}
+
+/*!
+ Gets a scancode from a human-readable name.
+
+ The comparison is case-insensitive, as with `SDL_GetScancodeFromName()`.
+ Lookup uses a perfect hash table generated at compile time, so costs a
+ single hash and string comparison. This function is `constexpr` if
+ `SDLXX_HAS_CONSTEXPR14` is defined.
+
+ @param name The name of the key, which need not be null-terminated
+ @param length The number of characters in `name`
+ @returns The scancode with the given name, or `sdl::scancode::unknown` if
+          there is no such key
+ @ingroup Keyboard
+ */
+inline SDLXX_CONSTEXPR14 scancode
+get_scancode_from_name(const char* name, size_t length) noexcept {
+    return name ? static_cast<scancode>(detail::find_scancode(name, length))
+                : scancode::unknown;
+}
+
+/*!
+ Gets a scancode from a human-readable name.
+
+ @param name A null-terminated key name
+ @returns The scancode with the given name, or `sdl::scancode::unknown` if
+          there is no such key
+ @ingroup Keyboard
+ */
+inline SDLXX_CONSTEXPR14 scancode
+get_scancode_from_name(const char* name) noexcept {
+    return name ? get_scancode_from_name(name, detail::const_strlen(name))
+                : scancode::unknown;
+}
+} // end namespace sdl
+
+#endif // SDLXX_KEYBOARD_HPP
@@ -57,6 +57,10 @@ struct error : std::runtime_error {
  The final alternative for ultimate flexibility is to define the `SDLXX_CHECK`
  macro yourself. If you do this however you must ensure that the condition
  is checked _EXACTLY ONCE_, otherwise you will certainly encounter problems.
+
+ Functions which use `SDLXX_CHECK` also have `try_` variants which report
+ errors by returning an `sdl::result` instead. These are suitable for cases
+ where failure is expected and should be handled without unwinding.
  */
 #ifndef SDLXX_CHECK
 #ifndef SDLXX_NO_EXCEPTIONS
@@ -79,4 +83,19 @@ struct error : std::runtime_error {
 #define SDLXX_ATTR_WARN_UNUSED_RESULT
 #endif
 
+/*! @macro SDLXX_CONSTEXPR14
+ Expands to `constexpr` if the compiler supports C++14 relaxed constexpr
+ functions (containing loops and mutable local variables), and nothing
+ otherwise. When supported, `SDLXX_HAS_CONSTEXPR14` is also defined.
+
+ MSVC 2015 only supports C++11-style constexpr functions.
+ */
+#if (defined(__cpp_constexpr) && __cpp_constexpr >= 201304) ||                 \
+    (defined(_MSC_VER) && _MSC_VER >= 1910)
+#define SDLXX_HAS_CONSTEXPR14 1
+#define SDLXX_CONSTEXPR14 constexpr
+#else
+#define SDLXX_CONSTEXPR14
+#endif
+
 #endif // SDLXX_MACROS_HPP
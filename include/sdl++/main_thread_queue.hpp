@@ -0,0 +1,269 @@
+/*!
+  @file main_thread_queue.hpp
+  Simple DirectMedia Layer C++ Bindings
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDLXX_MAIN_THREAD_QUEUE_HPP
+#define SDLXX_MAIN_THREAD_QUEUE_HPP
+
+#include "SDL_events.h"
+
+#include "stdinc.hpp"
+
+#include <atomic>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace sdl {
+
+namespace detail {
+
+    // An intrusive multi-producer, single-consumer queue, after Dmitry
+    // Vyukov's design. push() is wait-free: a single atomic exchange. pop()
+    // may briefly see the queue as empty while a push is half-way through;
+    // the element is then returned by a later pop().
+    template <typename T>
+    class mpsc_queue {
+    public:
+        mpsc_queue() : head{&stub}, tail{&stub} {}
+
+        mpsc_queue(const mpsc_queue&) = delete;
+        mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+        ~mpsc_queue() {
+            while (pop()) {}
+        }
+
+        void push(T value) {
+            auto n = new node{std::move(value)};
+            node* prev = head.exchange(n, std::memory_order_acq_rel);
+            prev->next.store(n, std::memory_order_release);
+        }
+
+        optional<T> pop() {
+            node* t = tail;
+            node* next = t->next.load(std::memory_order_acquire);
+            if (t == &stub) {
+                if (!next) { return nullopt; }
+                // Skip over the stub
+                tail = next;
+                t = next;
+                next = next->next.load(std::memory_order_acquire);
+            }
+            if (next) {
+                tail = next;
+                return take(t);
+            }
+            if (t != head.load(std::memory_order_acquire)) {
+                // A push is in progress
+                return nullopt;
+            }
+            // t is the last node: put the stub behind it, so that t can be
+            // removed
+            stub.next.store(nullptr, std::memory_order_relaxed);
+            node* prev = head.exchange(&stub, std::memory_order_acq_rel);
+            prev->next.store(&stub, std::memory_order_release);
+            next = t->next.load(std::memory_order_acquire);
+            if (next) {
+                tail = next;
+                return take(t);
+            }
+            return nullopt;
+        }
+
+    private:
+        struct node {
+            node() = default;
+            explicit node(T&& v) : value(std::move(v)) {}
+
+            optional<T> value;
+            std::atomic<node*> next{nullptr};
+        };
+
+        static optional<T> take(node* n) {
+            optional<T> v = std::move(n->value);
+            delete n;
+            return v;
+        }
+
+        std::atomic<node*> head;
+        node* tail;
+        node stub;
+    };
+
+} // end namespace detail
+
+/*!
+ @addtogroup Events
+ @{
+ */
+
+/*!
+ A move-only, type-erased function taking no arguments, used as the
+ default message type of `sdl::main_thread_queue`
+ */
+class main_thread_task {
+public:
+    //! Constructs an empty task
+    main_thread_task() = default;
+
+    //! Constructs a task which calls `func`
+    template <typename Func,
+              typename = std::enable_if_t<!std::is_same<
+                  std::decay_t<Func>, main_thread_task>::value>>
+    main_thread_task(Func&& func)
+        : impl{new model<std::decay_t<Func>>{std::forward<Func>(func)}} {}
+
+    //! Calls the function
+    void operator()() { impl->call(); }
+
+    //! Returns true if the task holds a function
+    explicit operator bool() const noexcept { return impl != nullptr; }
+
+private:
+    struct concept_t {
+        virtual ~concept_t() = default;
+        virtual void call() = 0;
+    };
+
+    template <typename Func>
+    struct model : concept_t {
+        explicit model(Func&& f) : func(std::move(f)) {}
+        explicit model(const Func& f) : func(f) {}
+        void call() override { func(); }
+        Func func;
+    };
+
+    std::unique_ptr<concept_t> impl;
+};
+
+/*!
+ Passes messages from any thread to the main thread
+
+ `SDL_PushEvent()` takes SDL's event queue lock, contending with the
+ operating system's event pump and with every other thread posting events.
+ A `main_thread_queue` is instead a lock-free queue: posting a message is a
+ single atomic exchange (plus an allocation). Only when the queue goes
+ from empty to non-empty is a wake-up event pushed to SDL's queue, so that
+ a main loop blocked in `SDL_WaitEvent()` wakes up. The main loop then
+ handles every waiting message in one batch:
+
+ ```
+ sdl::main_thread_queue<> tasks;
+
+ // On a worker thread
+ tasks.post([texture_data = std::move(pixels)]() mutable {
+     upload(std::move(texture_data));
+ });
+
+ // In the main loop, once per frame
+ tasks.drain();
+ ```
+
+ The message type `T` must be move-constructible. By default it is
+ `sdl::main_thread_task`, a move-only callable, and `drain()` calls each
+ task. For other types, pass a handler to `drain()`.
+
+ Messages may be posted from any number of threads, but `drain()` must only
+ be called from one thread at a time.
+ */
+template <typename T = main_thread_task>
+class main_thread_queue {
+public:
+    //! Registers the wake-up event type
+    main_thread_queue() : wake_type{::SDL_RegisterEvents(1)} {}
+
+    main_thread_queue(const main_thread_queue&) = delete;
+    main_thread_queue& operator=(const main_thread_queue&) = delete;
+
+    //! Destroys any messages which have not been handled, and removes a
+    //! pending wake-up event from SDL's queue
+    ~main_thread_queue() {
+        if (wake_type != static_cast<uint32_t>(-1)) {
+            ::SDL_FlushEvent(wake_type);
+        }
+    }
+
+    /*!
+     Adds a message to the queue. May be called from any thread.
+     @returns true if a wake-up event was pushed
+     */
+    bool post(T message) {
+        queue.push(std::move(message));
+        if (signalled.exchange(true, std::memory_order_acq_rel)) {
+            return false;
+        }
+        if (wake_type == static_cast<uint32_t>(-1)) { return false; }
+        SDL_Event event{};
+        event.type = wake_type;
+        event.user.data1 = this;
+        if (::SDL_PushEvent(&event) > 0) { return true; }
+        // No wake-up event is pending, so the next post() must try again
+        signalled.store(false, std::memory_order_release);
+        return false;
+    }
+
+    /*!
+     Calls `handler` with each waiting message, in the order they were
+     posted by each thread. Must only be called on the consuming thread.
+     @returns The number of messages handled
+     */
+    template <typename Handler>
+    size_t drain(Handler&& handler) {
+        // Clearing the flag first means a message posted during the drain
+        // either is handled by it, or pushes a new wake-up event
+        signalled.exchange(false, std::memory_order_acq_rel);
+        size_t count = 0;
+        while (auto message = queue.pop()) {
+            handler(std::move(*message));
+            ++count;
+        }
+        return count;
+    }
+
+    //! Calls each waiting task. Only available when `T` is callable with no
+    //! arguments.
+    //! @returns The number of tasks called
+    template <typename U = T, typename = decltype(std::declval<U&>()())>
+    size_t drain() {
+        return drain([](T&& task) { task(); });
+    }
+
+    //! Returns the type of the wake-up events, or `(uint32_t) -1` if no
+    //! user event type could be registered
+    uint32_t event_type() const noexcept { return wake_type; }
+
+    //! Returns true if `event` is a wake-up event posted by this queue
+    bool is_wake_event(const SDL_Event& event) const noexcept {
+        return event.type == wake_type && event.user.data1 == this;
+    }
+
+private:
+    detail::mpsc_queue<T> queue;
+    std::atomic<bool> signalled{false};
+    uint32_t wake_type;
+};
+
+//! @}
+
+} // end namespace sdl
+
+#endif // SDLXX_MAIN_THREAD_QUEUE_HPP
@@ -30,7 +30,13 @@
 
 #include "SDL_power.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 namespace sdl {
 
@@ -113,6 +119,273 @@ inline power_info get_power_info() {
     return info;
 }
 
+namespace detail {
+
+    // Packs a power_info into 64 bits, so that it can be stored in a
+    // lock-free atomic. Bits 0-7 hold the state, bit 8 is set if secs_left
+    // is present and bit 9 if percent_left is, bits 16-23 hold the
+    // percentage and bits 32-63 the number of seconds.
+    inline uint64_t pack_power_info(const power_info& info) noexcept {
+        uint64_t bits = static_cast<uint8_t>(info.state);
+        if (info.secs_left) {
+            bits |= 1u << 8;
+            bits |= static_cast<uint64_t>(
+                        static_cast<uint32_t>(info.secs_left->count()))
+                    << 32;
+        }
+        if (info.percent_left) {
+            bits |= 1u << 9;
+            bits |= static_cast<uint64_t>(
+                        static_cast<uint8_t>(*info.percent_left))
+                    << 16;
+        }
+        return bits;
+    }
+
+    inline power_info unpack_power_info(uint64_t bits) noexcept {
+        power_info info{};
+        info.state = static_cast<power_state>(static_cast<int>(bits & 0xFF));
+        if (bits & (1u << 8)) {
+            info.secs_left = std::chrono::seconds{
+                static_cast<int32_t>(static_cast<uint32_t>(bits >> 32))};
+        }
+        if (bits & (1u << 9)) {
+            info.percent_left = static_cast<int>((bits >> 16) & 0xFF);
+        }
+        return info;
+    }
+
+} // end namespace detail
+
+/*!
+ Polls the power supply status on a background thread
+
+ `SDL_GetPowerInfo()` can be slow (on Linux it reads several files from
+ sysfs), so it should not be called every frame. A `power_poller` calls it
+ at a fixed interval on its own thread, and stores the result in a
+ lock-free atomic snapshot which is cheap to read from any thread.
+
+ The source of power information may be replaced, for example with a
+ function returning fake states for testing.
+
+ `power_poller` is neither copyable nor movable.
+ */
+class power_poller {
+public:
+    //! The type of function used to query the power supply
+    using source_type = std::function<power_info()>;
+
+    /*!
+     Queries the power supply once, then starts a thread which queries it
+     again every `interval`.
+     */
+    explicit power_poller(std::chrono::milliseconds interval =
+                              std::chrono::seconds{5},
+                          source_type source = get_power_info)
+        : source{std::move(source)}, interval{interval} {
+        refresh();
+        worker = std::thread{[this] { run(); }};
+    }
+
+    power_poller(const power_poller&) = delete;
+    power_poller& operator=(const power_poller&) = delete;
+
+    //! Stops the polling thread
+    ~power_poller() {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            stopping = true;
+        }
+        wake.notify_all();
+        worker.join();
+    }
+
+    //! Returns the most recent power information. This is lock-free.
+    power_info get() const noexcept {
+        return detail::unpack_power_info(
+            snapshot.load(std::memory_order_acquire));
+    }
+
+    //! Returns the number of times the power supply has been queried
+    uint64_t generation() const noexcept {
+        return polls.load(std::memory_order_acquire);
+    }
+
+    //! Queries the power supply immediately, on the calling thread
+    void refresh() {
+        std::lock_guard<std::mutex> lock{source_mutex};
+        snapshot.store(detail::pack_power_info(source()),
+                       std::memory_order_release);
+        polls.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock{mutex};
+        while (!wake.wait_for(lock, interval, [this] { return stopping; })) {
+            lock.unlock();
+            refresh();
+            lock.lock();
+        }
+    }
+
+    source_type source;
+    std::chrono::milliseconds interval;
+    std::atomic<uint64_t> snapshot{0};
+    std::atomic<uint64_t> polls{0};
+    std::mutex source_mutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread worker;
+};
+
+/*!
+ The frame rate and amount of optional work chosen by an
+ `sdl::power_governor`
+ */
+struct frame_budget {
+    //! The target number of frames per second
+    int frame_rate;
+    //! The proportion of optional work (such as particle effects or
+    //! background simulation) to perform, between 0 and 1
+    float work_scale;
+
+    //! Returns the time available for each frame
+    std::chrono::microseconds frame_time() const {
+        return std::chrono::microseconds{1000000 / std::max(frame_rate, 1)};
+    }
+};
+
+//! @relates frame_budget
+inline bool operator==(const frame_budget& lhs, const frame_budget& rhs) {
+    return lhs.frame_rate == rhs.frame_rate &&
+           lhs.work_scale == rhs.work_scale;
+}
+
+//! @relates frame_budget
+inline bool operator!=(const frame_budget& lhs, const frame_budget& rhs) {
+    return !(lhs == rhs);
+}
+
+/*!
+ The thresholds and budgets used by an `sdl::power_governor`
+ */
+struct power_policy {
+    //! The budget when running on mains power
+    frame_budget plugged_in = {60, 1.0f};
+    //! The budget when running on battery with plenty of charge remaining
+    frame_budget on_battery = {60, 1.0f};
+    //! The budget when the battery is low
+    frame_budget low_battery = {30, 0.5f};
+    //! The budget when the battery is critically low
+    frame_budget critical_battery = {20, 0.25f};
+    //! The percentage of charge at or below which the battery is low
+    int low_percent = 30;
+    //! The percentage of charge at or below which the battery is critical
+    int critical_percent = 10;
+    //! The battery must charge this many percent beyond a threshold before
+    //! a more generous budget is restored, to avoid switching back and forth
+    int hysteresis_percent = 2;
+};
+
+/*!
+ Chooses a frame rate and work budget according to the power supply
+
+ When running on battery, the governor lowers the frame rate and the amount
+ of optional work as the charge falls, according to an `sdl::power_policy`.
+ It is designed to be called once per frame from a frame pacing loop:
+
+ ```
+ sdl::power_poller poller;
+ sdl::power_governor governor{poller};
+
+ while (running) {
+     const auto frame_start = sdl::clock::now();
+     const auto budget = governor.update();
+
+     update_world(budget.work_scale);
+     render();
+
+     const auto elapsed = sdl::clock::now() - frame_start;
+     if (elapsed < budget.frame_time()) {
+         sdl::delay(std::chrono::duration_cast<sdl::duration>(
+             budget.frame_time() - elapsed));
+     }
+ }
+ ```
+ */
+class power_governor {
+public:
+    //! The level of battery charge
+    enum class level { normal, low, critical };
+
+    //! Constructs a governor which reads power information from `poller`,
+    //! which must outlive it
+    explicit power_governor(const power_poller& poller,
+                            power_policy policy = {})
+        : poller{&poller}, rules{policy} {}
+
+    //! Constructs a governor which is updated only with
+    //! `update(const power_info&)`
+    explicit power_governor(power_policy policy = {}) : rules{policy} {}
+
+    //! Reads the latest information from the poller, and returns the
+    //! budget for the next frame
+    frame_budget update() {
+        return poller ? update(poller->get()) : last_budget;
+    }
+
+    //! Returns the budget for the given power information
+    frame_budget update(const power_info& info) {
+        if (info.state != power_state::on_battery) {
+            current = level::normal;
+            last_budget = rules.plugged_in;
+            return last_budget;
+        }
+
+        if (info.percent_left) {
+            current = classify(*info.percent_left);
+        }
+        switch (current) {
+        case level::critical: last_budget = rules.critical_battery; break;
+        case level::low: last_budget = rules.low_battery; break;
+        case level::normal: last_budget = rules.on_battery; break;
+        }
+        return last_budget;
+    }
+
+    //! Returns the budget chosen by the last update
+    frame_budget budget() const noexcept { return last_budget; }
+
+    //! Returns the battery level chosen by the last update
+    level battery_level() const noexcept { return current; }
+
+    //! Returns the policy in use
+    const power_policy& policy() const noexcept { return rules; }
+
+private:
+    level classify(int percent) const {
+        // Falling charge moves to a lower level as soon as a threshold is
+        // crossed, but rising charge must clear it by the hysteresis margin
+        const int margin = rules.hysteresis_percent;
+        const int critical_limit =
+            current == level::critical ? rules.critical_percent + margin
+                                       : rules.critical_percent;
+        const int low_limit = current != level::normal
+                                  ? rules.low_percent + margin
+                                  : rules.low_percent;
+        if (percent <= critical_limit) { return level::critical; }
+        if (percent <= low_limit) { return level::low; }
+        return level::normal;
+    }
+
+    const power_poller* poller = nullptr;
+    power_policy rules;
+    level current = level::normal;
+    frame_budget last_budget = rules.plugged_in;
+};
+
 } // end namespace sdl
 
 #endif // SDLXX_POWER_HPP
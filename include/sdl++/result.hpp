@@ -0,0 +1,212 @@
+/*!
+  @file result.hpp
+  Simple DirectMedia Layer C++ Bindings
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDLXX_RESULT_HPP
+#define SDLXX_RESULT_HPP
+
+#include "SDL_error.h"
+
+#include "macros.hpp"
+#include "stdinc.hpp"
+
+#include <type_traits>
+#include <utility>
+
+namespace sdl {
+
+/*!
+ @defgroup Result Error Results
+
+ By default, sdl++ functions report errors using `SDLXX_CHECK`, which throws
+ an `sdl::error`. This is convenient, but exceptions are expensive when
+ failure is an expected outcome, for example when polling a device which may
+ have been unplugged.
+
+ Every function which uses `SDLXX_CHECK` therefore has a `try_` variant
+ which returns an `sdl::result<T>` instead. On success the result holds a
+ value of type `T`; on failure it holds nothing, and the error message is
+ available from `result::error_message()`.
+
+ ```
+ if (auto path = sdl::try_get_base_path()) {
+     load_assets(*path);
+ } else {
+     sdl::log_warn(sdl::log_category::application, "No base path: %s",
+                   path.error_message());
+ }
+ ```
+
+ The error message is not copied when the failure occurs. Instead,
+ `error_message()` returns SDL's thread-local error string, so it must be
+ read on the same thread before any other SDL call is made. This means that
+ a `result` is no larger than an `sdl::optional`, and checking it on the
+ success path costs a single branch.
+
+ @{
+ */
+
+//! Tag type used to construct a failed `sdl::result`
+struct failure_t {
+    //! @cond
+    constexpr explicit failure_t(int) {}
+    //! @endcond
+};
+
+//! Tag value which converts to a failed `sdl::result` of any type
+constexpr failure_t failure{0};
+
+/*!
+ The value returned by a successful SDL call, or an indication that the call
+ failed
+ */
+template <typename T>
+class result {
+    static_assert(!std::is_reference<T>::value,
+                  "sdl::result may not hold a reference");
+
+public:
+    //! The type of the held value
+    using value_type = T;
+
+    //! Constructs a successful result holding a copy of `value`
+    result(const T& value) : val{value} {}
+
+    //! Constructs a successful result holding `value`
+    result(T&& value) : val{std::move(value)} {}
+
+    //! Constructs a failed result
+    result(failure_t) noexcept {}
+
+    //! Returns true if the operation succeeded
+    bool has_value() const noexcept { return static_cast<bool>(val); }
+
+    //! Returns true if the operation succeeded
+    explicit operator bool() const noexcept { return has_value(); }
+
+    //! Returns the held value
+    //! @throws sdl::error if the operation failed
+    T& value() & {
+        check();
+        return *val;
+    }
+
+    //! @overload
+    const T& value() const & {
+        check();
+        return *val;
+    }
+
+    //! @overload
+    T&& value() && {
+        check();
+        return std::move(*val);
+    }
+
+    //! Returns the held value, which must exist
+    T& operator*() & noexcept { return *val; }
+    //! @overload
+    const T& operator*() const & noexcept { return *val; }
+    //! @overload
+    T&& operator*() && noexcept { return std::move(*val); }
+
+    //! Accesses a member of the held value, which must exist
+    T* operator->() noexcept { return &*val; }
+    //! @overload
+    const T* operator->() const noexcept { return &*val; }
+
+    //! Returns the held value if the operation succeeded, or `def` otherwise
+    template <typename U>
+    T value_or(U&& def) const & {
+        return has_value() ? *val : static_cast<T>(std::forward<U>(def));
+    }
+
+    //! @overload
+    template <typename U>
+    T value_or(U&& def) && {
+        return has_value() ? std::move(*val)
+                           : static_cast<T>(std::forward<U>(def));
+    }
+
+    //! Returns the message describing why the operation failed, or an empty
+    //! string if it succeeded. The message must be read before making any
+    //! further SDL calls on this thread.
+    const char* error_message() const noexcept {
+        return has_value() ? "" : ::SDL_GetError();
+    }
+
+private:
+    void check() const { SDLXX_CHECK(has_value()); }
+
+    optional<T> val;
+};
+
+/*!
+ The result of an SDL call which returns no value on success
+ */
+template <>
+class result<void> {
+public:
+    //! @cond
+    using value_type = void;
+    //! @endcond
+
+    //! Constructs a successful result
+    result() noexcept = default;
+
+    //! Constructs a failed result
+    result(failure_t) noexcept : ok{false} {}
+
+    //! Returns true if the operation succeeded
+    bool has_value() const noexcept { return ok; }
+
+    //! Returns true if the operation succeeded
+    explicit operator bool() const noexcept { return ok; }
+
+    //! Does nothing if the operation succeeded
+    //! @throws sdl::error if the operation failed
+    void value() const { SDLXX_CHECK(ok); }
+
+    //! @copydoc result::error_message()
+    const char* error_message() const noexcept {
+        return ok ? "" : ::SDL_GetError();
+    }
+
+private:
+    bool ok = true;
+};
+
+namespace detail {
+
+    // Converts the return code of an SDL function which returns zero on
+    // success and a negative value on failure
+    inline result<void> check_zero(int code) noexcept {
+        if (code == 0) { return {}; }
+        return failure;
+    }
+
+} // end namespace detail
+
+//! @}
+
+} // end namespace sdl
+
+#endif // SDLXX_RESULT_HPP
@@ -0,0 +1,70 @@
+/*!
+  @file rwops.hpp
+  Simple DirectMedia Layer C++ Bindings
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDLXX_RWOPS_HPP
+#define SDLXX_RWOPS_HPP
+
+#include "SDL_rwops.h"
+
+#include "macros.hpp"
+
+#include <memory>
+
+namespace sdl {
+
+/*!
+ @defgroup RWops File I/O Abstraction
+
+ This category contains helpers for SDL's `SDL_RWops` I/O streams.
+
+ @{
+ */
+
+namespace detail {
+
+    struct rwops_deleter {
+        void operator()(SDL_RWops* rw) const {
+            if (rw) { SDL_RWclose(rw); }
+        }
+    };
+
+    inline std::unique_ptr<SDL_RWops, rwops_deleter>
+    open_rwops(const char* path, const char* mode) {
+        std::unique_ptr<SDL_RWops, rwops_deleter> rw{
+            ::SDL_RWFromFile(path, mode)};
+        SDLXX_CHECK(rw != nullptr);
+        return rw;
+    }
+
+} // end namespace detail
+
+/*!
+ An owning handle to an `SDL_RWops` stream, which closes the stream with
+ `SDL_RWclose()` when it is destroyed
+ */
+using rwops_ptr = std::unique_ptr<SDL_RWops, detail::rwops_deleter>;
+
+//! @}
+
+} // end namespace sdl
+
+#endif // SDLXX_RWOPS_HPP
@@ -0,0 +1,437 @@
+/*!
+  @file sprite_batch.hpp
+  Simple DirectMedia Layer C++ Bindings
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#ifndef SDLXX_SPRITE_BATCH_HPP
+#define SDLXX_SPRITE_BATCH_HPP
+
+#include "SDL_assert.h"
+#include "SDL_render.h"
+
+#include "blendmode.hpp"
+#include "result.hpp"
+#include "stdinc.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+namespace sdl {
+
+/*!
+ @defgroup Render 2D Accelerated Rendering
+
+ This category contains helpers for drawing with an `SDL_Renderer`.
+
+ `sdl::sprite_batch` records a frame's sprites and submits them to the
+ renderer sorted by layer, texture and blend mode, so that the renderer
+ sees long runs of copies from the same texture and texture state is only
+ changed when it must be:
+
+ ```
+ sdl::sprite_batch batch;
+ for (const auto& e : entities) {
+     batch.draw(e.texture, e.frame, e.position, e.layer);
+ }
+ batch.submit(renderer);
+ SDL_RenderPresent(renderer);
+ ```
+
+ Batches work best when sprites share a few textures. `sdl::texture_atlas`
+ packs many small images, such as glyphs and icons, into shared textures.
+
+ @{
+ */
+
+//! Statistics from the last call to `sdl::sprite_batch::submit()`
+struct sprite_batch_stats {
+    //! The number of sprites drawn
+    size_t sprites = 0;
+    //! The number of sprites skipped because they were outside the viewport
+    size_t culled = 0;
+    //! The number of runs of sprites sharing a texture and blend mode
+    size_t batches = 0;
+    //! The number of calls made to change a texture's blend mode, colour
+    //! modulation or alpha modulation
+    size_t state_changes = 0;
+    //! The number of calls to `SDL_RenderCopy()` and `SDL_RenderCopyEx()`
+    size_t draw_calls = 0;
+};
+
+namespace detail {
+
+    /*
+     Sprites are sorted by a 64-bit key:
+
+       bits 48-63  layer, offset so that negative layers sort first
+       bits 32-47  texture, as an index into the batch's texture list
+       bits 24-31  blend mode
+       bits  0-23  the sprite's index in the order it was drawn
+
+     The index makes every key unique and is already in order, so the sort
+     only needs to look at the top five bytes.
+     */
+    constexpr int sprite_index_bits = 24;
+    constexpr uint64_t sprite_index_mask = (uint64_t{1} << 24) - 1;
+    constexpr size_t max_sprite_textures = 1 << 16;
+
+    inline uint64_t make_sprite_key(int16_t layer, size_t texture,
+                                    blend_mode mode, size_t index) noexcept {
+        const auto biased = static_cast<uint16_t>(layer + 32768);
+        return uint64_t{biased} << 48 | uint64_t{texture} << 32 |
+               uint64_t{static_cast<uint8_t>(mode)} << sprite_index_bits |
+               index;
+    }
+
+    /*
+     A least-significant-digit radix sort of `keys` on bytes `first_byte`
+     to 7, using `scratch` and `counts` as temporary storage, so that their
+     capacity is reused from one call to the next. All the histograms are
+     built in one pass, and bytes which are the same in every key are
+     skipped, so a typical frame with few layers and textures needs only one
+     or two scatter passes.
+     */
+    inline void radix_sort(std::vector<uint64_t>& keys,
+                           std::vector<uint64_t>& scratch,
+                           std::vector<size_t>& counts, int first_byte) {
+        const size_t n = keys.size();
+        if (std::is_sorted(keys.begin(), keys.end())) { return; }
+
+        counts.assign(static_cast<size_t>(8 - first_byte) * 256, 0);
+        for (const uint64_t key : keys) {
+            for (int b = first_byte; b < 8; b++) {
+                counts[(b - first_byte) * 256 + ((key >> 8 * b) & 0xFF)]++;
+            }
+        }
+
+        scratch.resize(n);
+        for (int b = first_byte; b < 8; b++) {
+            size_t* count = &counts[static_cast<size_t>(b - first_byte) * 256];
+            if (count[(keys[0] >> 8 * b) & 0xFF] == n) { continue; }
+
+            size_t offset = 0;
+            for (int i = 0; i < 256; i++) {
+                const size_t c = count[i];
+                count[i] = offset;
+                offset += c;
+            }
+            for (const uint64_t key : keys) {
+                scratch[count[(key >> 8 * b) & 0xFF]++] = key;
+            }
+            keys.swap(scratch);
+        }
+    }
+
+    // The state last set on a texture during a submit
+    struct sprite_texture_state {
+        SDL_Texture* texture;
+        bool known;
+        uint8_t mode;
+        SDL_Color tint;
+    };
+
+    inline uint32_t pack_color(SDL_Color c) noexcept {
+        return uint32_t{c.r} << 24 | uint32_t{c.g} << 16 |
+               uint32_t{c.b} << 8 | c.a;
+    }
+
+} // end namespace detail
+
+/*!
+ Records sprites drawn during a frame, and submits them to an `SDL_Renderer`
+ in as few calls as possible
+
+ Sprites are stored in a flat structure-of-arrays buffer, which keeps its
+ capacity between frames. `submit()` sorts them with a radix sort, so that
+ they are drawn in order of layer, then texture, then blend mode.
+ Sprites which are entirely outside the renderer's viewport are skipped.
+
+ Sprites in lower layers are drawn first. Within a layer, sprites with the
+ same texture and blend mode are drawn in the order they were added, but
+ sprites with different textures may be reordered, so sprites which
+ overlap and must be drawn in a given order should be given different
+ layers.
+
+ Each texture's blend mode, colour modulation and alpha modulation are set
+ as each sprite requires and are not restored afterwards. They are read back
+ the first time a texture is used in each submit and only changed when they
+ differ, so a frame in which every texture already has the right state
+ makes no state changes at all.
+
+ SDL 2.0.4 draws each sprite with its own `SDL_RenderCopy()` call. Later
+ versions of SDL queue consecutive copies and combine those which use the
+ same texture and state, so sorting also reduces the number of draw calls
+ which reach the graphics driver.
+
+ A batch may hold up to 2<sup>24</sup> sprites using up to 65536 textures;
+ beyond that, `submit()` fails.
+ */
+class sprite_batch {
+public:
+    //! Constructs an empty batch
+    sprite_batch() = default;
+
+    //! Constructs an empty batch with room for `capacity` sprites
+    explicit sprite_batch(size_t capacity) { reserve(capacity); }
+
+    //! Allocates room for `capacity` sprites
+    void reserve(size_t capacity) {
+        keys.reserve(capacity);
+        src_rects.reserve(capacity);
+        dst_rects.reserve(capacity);
+        tints.reserve(capacity);
+        angles.reserve(capacity);
+        flips.reserve(capacity);
+    }
+
+    //! Sets the colour and alpha modulation of sprites drawn after this call.
+    //! The default is opaque white, which leaves the texture unchanged.
+    void set_tint(SDL_Color tint) noexcept { current_tint = tint; }
+
+    //! Returns the colour and alpha modulation of sprites being drawn
+    SDL_Color get_tint() const noexcept { return current_tint; }
+
+    //! Draws the whole of `texture` into `dst`
+    void draw(SDL_Texture* texture, const SDL_Rect& dst, int16_t layer = 0,
+              blend_mode mode = blend_mode::blend) {
+        add(texture, SDL_Rect{0, 0, 0, 0}, dst, 0.0, SDL_FLIP_NONE, layer,
+            mode);
+    }
+
+    //! Draws the `src` rectangle of `texture` into `dst`
+    void draw(SDL_Texture* texture, const SDL_Rect& src, const SDL_Rect& dst,
+              int16_t layer = 0, blend_mode mode = blend_mode::blend) {
+        SDL_assert(src.w > 0 && src.h > 0);
+        add(texture, src, dst, 0.0, SDL_FLIP_NONE, layer, mode);
+    }
+
+    //! Draws the `src` rectangle of `texture` into `dst`, rotated clockwise
+    //! by `angle` degrees about the centre of `dst` and flipped by `flip`
+    void draw(SDL_Texture* texture, const SDL_Rect& src, const SDL_Rect& dst,
+              double angle, SDL_RendererFlip flip, int16_t layer = 0,
+              blend_mode mode = blend_mode::blend) {
+        SDL_assert(src.w > 0 && src.h > 0);
+        add(texture, src, dst, angle, flip, layer, mode);
+    }
+
+    //! Returns the number of sprites waiting to be submitted
+    size_t size() const noexcept { return keys.size(); }
+
+    //! Returns true if there are no sprites waiting to be submitted
+    bool empty() const noexcept { return keys.empty(); }
+
+    //! Discards the sprites waiting to be submitted, keeping the buffer's
+    //! capacity
+    void clear() noexcept {
+        keys.clear();
+        src_rects.clear();
+        dst_rects.clear();
+        tints.clear();
+        angles.clear();
+        flips.clear();
+        textures.clear();
+        texture_index.clear();
+        last_texture = nullptr;
+        overflowed = false;
+    }
+
+    /*!
+     Draws the recorded sprites with `renderer` and clears the batch
+     @throws sdl::error if SDL reports an error or the batch is too large
+     */
+    void submit(SDL_Renderer* renderer) { try_submit(renderer).value(); }
+
+    /*!
+     Draws the recorded sprites with `renderer` and clears the batch,
+     without throwing
+     @returns A failed result if SDL reports an error or the batch is too
+     large. The batch is cleared regardless.
+     */
+    result<void> try_submit(SDL_Renderer* renderer) {
+        last_stats = sprite_batch_stats{};
+        auto r = draw_all(renderer);
+        clear();
+        return r;
+    }
+
+    //! Returns statistics from the last call to `submit()`
+    const sprite_batch_stats& stats() const noexcept { return last_stats; }
+
+private:
+    void add(SDL_Texture* texture, const SDL_Rect& src, const SDL_Rect& dst,
+             double angle, SDL_RendererFlip flip, int16_t layer,
+             blend_mode mode) {
+        SDL_assert(texture);
+        const size_t index = keys.size();
+        if (index > detail::sprite_index_mask) {
+            overflowed = true;
+            return;
+        }
+        keys.push_back(detail::make_sprite_key(layer, find_texture(texture),
+                                               mode, index));
+        src_rects.push_back(src);
+        dst_rects.push_back(dst);
+        tints.push_back(current_tint);
+        angles.push_back(angle);
+        flips.push_back(static_cast<uint8_t>(flip));
+    }
+
+    // Returns the index of `texture` in the texture list, adding it if need
+    // be. Consecutive sprites usually share a texture, so the last one is
+    // checked before the hash table.
+    size_t find_texture(SDL_Texture* texture) {
+        if (texture == last_texture) { return last_index; }
+        const auto it =
+            texture_index.emplace(texture, textures.size()).first;
+        if (it->second == textures.size()) {
+            if (textures.size() == detail::max_sprite_textures) {
+                overflowed = true;
+                texture_index.erase(it);
+                return 0;
+            }
+            textures.push_back({texture, false, 0, SDL_Color{}});
+        }
+        last_texture = texture;
+        last_index = it->second;
+        return last_index;
+    }
+
+    result<void> draw_all(SDL_Renderer* renderer) {
+        if (overflowed) {
+            ::SDL_SetError("Too many sprites or textures in sprite_batch");
+            return failure;
+        }
+        if (keys.empty()) { return {}; }
+
+        detail::radix_sort(keys, scratch, counts, 3);
+
+        SDL_Rect viewport;
+        ::SDL_RenderGetViewport(renderer, &viewport);
+
+        auto& st = last_stats;
+        uint64_t last_state = ~uint64_t{0};
+        for (const uint64_t key : keys) {
+            const size_t i = key & detail::sprite_index_mask;
+            if (culled(dst_rects[i], angles[i], viewport)) {
+                ++st.culled;
+                continue;
+            }
+
+            // The texture and blend mode
+            const uint64_t state = (key >> detail::sprite_index_bits) &
+                                   0xFFFFFF;
+            auto& tex = textures[(key >> 32) & 0xFFFF];
+            if (state != last_state) {
+                ++st.batches;
+                last_state = state;
+                if (!tex.known) { read_state(tex); }
+                const auto mode = static_cast<uint8_t>(state & 0xFF);
+                if (tex.mode != mode) {
+                    if (::SDL_SetTextureBlendMode(
+                            tex.texture, static_cast<SDL_BlendMode>(mode)) <
+                        0) {
+                        return failure;
+                    }
+                    tex.mode = mode;
+                    ++st.state_changes;
+                }
+            }
+            if (!set_tint(tex, tints[i])) { return failure; }
+
+            const SDL_Rect* src = src_rects[i].w == 0 ? nullptr : &src_rects[i];
+            const auto flip = static_cast<SDL_RendererFlip>(flips[i]);
+            const int ret =
+                angles[i] == 0.0 && flip == SDL_FLIP_NONE
+                    ? ::SDL_RenderCopy(renderer, tex.texture, src,
+                                       &dst_rects[i])
+                    : ::SDL_RenderCopyEx(renderer, tex.texture, src,
+                                         &dst_rects[i], angles[i], nullptr,
+                                         flip);
+            if (ret < 0) { return failure; }
+            ++st.draw_calls;
+            ++st.sprites;
+        }
+        return {};
+    }
+
+    // Rotated sprites are tested using a square which contains them at any
+    // angle
+    static bool culled(const SDL_Rect& dst, double angle,
+                       const SDL_Rect& viewport) noexcept {
+        const int margin = angle == 0.0 ? 0 : (dst.w + dst.h) / 2;
+        return dst.x + dst.w + margin <= 0 || dst.y + dst.h + margin <= 0 ||
+               dst.x - margin >= viewport.w || dst.y - margin >= viewport.h;
+    }
+
+    static void read_state(detail::sprite_texture_state& tex) {
+        SDL_BlendMode mode = SDL_BLENDMODE_NONE;
+        ::SDL_GetTextureBlendMode(tex.texture, &mode);
+        tex.mode = static_cast<uint8_t>(mode);
+        ::SDL_GetTextureColorMod(tex.texture, &tex.tint.r, &tex.tint.g,
+                                 &tex.tint.b);
+        ::SDL_GetTextureAlphaMod(tex.texture, &tex.tint.a);
+        tex.known = true;
+    }
+
+    bool set_tint(detail::sprite_texture_state& tex, SDL_Color tint) {
+        const auto old = detail::pack_color(tex.tint);
+        const auto wanted = detail::pack_color(tint);
+        if ((old ^ wanted) & 0xFFFFFF00) {
+            if (::SDL_SetTextureColorMod(tex.texture, tint.r, tint.g,
+                                         tint.b) < 0) {
+                return false;
+            }
+            ++last_stats.state_changes;
+        }
+        if ((old ^ wanted) & 0xFF) {
+            if (::SDL_SetTextureAlphaMod(tex.texture, tint.a) < 0) {
+                return false;
+            }
+            ++last_stats.state_changes;
+        }
+        tex.tint = tint;
+        return true;
+    }
+
+    // One entry per sprite
+    std::vector<uint64_t> keys;
+    std::vector<SDL_Rect> src_rects; // Zero width for the whole texture
+    std::vector<SDL_Rect> dst_rects;
+    std::vector<SDL_Color> tints;
+    std::vector<double> angles;
+    std::vector<uint8_t> flips;
+
+    std::vector<detail::sprite_texture_state> textures;
+    std::unordered_map<SDL_Texture*, size_t> texture_index;
+    SDL_Texture* last_texture = nullptr;
+    size_t last_index = 0;
+
+    std::vector<uint64_t> scratch;
+    std::vector<size_t> counts;
+    SDL_Color current_tint{255, 255, 255, 255};
+    bool overflowed = false;
+    sprite_batch_stats last_stats;
+};
+
+//! @}
+
+} // end namespace sdl
+
+#endif // SDLXX_SPRITE_BATCH_HPP
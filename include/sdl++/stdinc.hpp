@@ -38,6 +38,9 @@ using std::experimental::nullopt;
 #include "external/optional.hpp"
 #endif
 
+#include "detail/span.hpp"
+#include "detail/string_view.hpp"
+
 #include <sstream>
 #include <string>
 
@@ -54,6 +57,132 @@ void string_append(string& s, T&& entry) {
 inline void string_append(string& s, const string& entry) { s.append(entry); }
 
 inline void string_append(string& s, const char* entry) { s.append(entry); }
+
+/*!
+ A move-only owning handle to a string allocated by SDL
+
+ Several SDL functions, such as `SDL_GetClipboardText()`, return a string
+ which the caller must release with `SDL_free()`. By default, sdl++ copies
+ such strings into an `sdl::string` and frees the original immediately. For
+ large strings, this extra allocation and copy may be significant. An
+ `sdl_string` instead takes ownership of the SDL allocation and frees it in
+ its destructor, allowing access to the characters without copying.
+
+ Functions which return SDL-allocated strings allow the return type to be
+ selected with a template parameter, for example
+
+ ```
+ sdl::sdl_string text = sdl::get_clipboard_text<sdl::sdl_string>();
+ process(text.view());
+ ```
+ */
+class sdl_string {
+public:
+    //! Constructs an empty `sdl_string`
+    sdl_string() noexcept = default;
+
+    //! Takes ownership of `str`, which must have been allocated by SDL (or
+    //! `SDL_malloc()`), or be null
+    explicit sdl_string(char* str) noexcept
+        : ptr{str}, len{str ? SDL_strlen(str) : 0} {}
+
+    //! Move constructor
+    sdl_string(sdl_string&& other) noexcept : ptr{other.ptr}, len{other.len} {
+        other.ptr = nullptr;
+        other.len = 0;
+    }
+
+    //! Move assignment operator
+    sdl_string& operator=(sdl_string&& other) noexcept {
+        std::swap(ptr, other.ptr);
+        std::swap(len, other.len);
+        return *this;
+    }
+
+    //! Frees the owned string
+    ~sdl_string() { SDL_free(ptr); }
+
+    //! Returns a null-terminated string. This is never null: if no string is
+    //! owned, an empty string is returned.
+    const char* c_str() const noexcept { return ptr ? ptr : ""; }
+
+    //! Returns a pointer to the characters. Equivalent to `c_str()`.
+    const char* data() const noexcept { return c_str(); }
+
+    //! Returns the number of characters, excluding the null terminator
+    std::size_t size() const noexcept { return len; }
+
+    //! Returns the number of characters, excluding the null terminator
+    std::size_t length() const noexcept { return len; }
+
+    //! Returns true if the string is empty or null
+    bool empty() const noexcept { return len == 0; }
+
+    //! Returns a view of the characters
+    string_view view() const noexcept { return {c_str(), len}; }
+
+    //! Returns a view of the characters
+    operator string_view() const noexcept { return view(); }
+
+    //! Copies the characters into a new `sdl::string`
+    string str() const { return {c_str(), len}; }
+
+    //! Returns an iterator to the first character
+    const char* begin() const noexcept { return c_str(); }
+
+    //! Returns an iterator past the last character
+    const char* end() const noexcept { return c_str() + len; }
+
+    //! Returns the owned pointer, which may be null, without releasing it
+    char* get() const noexcept { return ptr; }
+
+    //! Releases ownership of the string. It must later be freed with
+    //! `SDL_free()`.
+    char* release() noexcept {
+        char* p = ptr;
+        ptr = nullptr;
+        len = 0;
+        return p;
+    }
+
+private:
+    char* ptr = nullptr;
+    std::size_t len = 0;
+};
+
+//! @cond
+#define SDLXX_SDL_STRING_COMPARISONS(type)                                     \
+    inline bool operator==(const sdl_string& lhs, type rhs) noexcept {         \
+        return lhs.view() == rhs;                                              \
+    }                                                                          \
+    inline bool operator==(type lhs, const sdl_string& rhs) noexcept {         \
+        return lhs == rhs.view();                                              \
+    }                                                                          \
+    inline bool operator!=(const sdl_string& lhs, type rhs) noexcept {         \
+        return lhs.view() != rhs;                                              \
+    }                                                                          \
+    inline bool operator!=(type lhs, const sdl_string& rhs) noexcept {         \
+        return lhs != rhs.view();                                              \
+    }
+
+SDLXX_SDL_STRING_COMPARISONS(string_view)
+SDLXX_SDL_STRING_COMPARISONS(const char*)
+SDLXX_SDL_STRING_COMPARISONS(const string&)
+
+#undef SDLXX_SDL_STRING_COMPARISONS
+
+inline bool operator==(const sdl_string& lhs, const sdl_string& rhs) noexcept {
+    return lhs.view() == rhs.view();
+}
+
+inline bool operator!=(const sdl_string& lhs, const sdl_string& rhs) noexcept {
+    return lhs.view() != rhs.view();
+}
+
+inline std::ostream& operator<<(std::ostream& os, const sdl_string& str) {
+    return os << str.view();
+}
+//! @endcond
 }
 
 /* Add namespaced typedefs for sized integer types. This is utterly pointless
@@ -0,0 +1,846 @@
+/*!
+  @file surface.hpp
+  Simple DirectMedia Layer C++ Bindings
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDLXX_SURFACE_HPP
+#define SDLXX_SURFACE_HPP
+
+#include "SDL_pixels.h"
+#include "SDL_surface.h"
+
+#include "detail/convert_pixels.hpp"
+#include "macros.hpp"
+#include "result.hpp"
+#include "stdinc.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sdl {
+
+/*!
+ @defgroup Surface Surface Creation and Pixel Access
+
+ This category contains an owning wrapper for `SDL_Surface`, typed views of
+ its pixels, a pool which recycles the pixel storage of short-lived
+ surfaces, and fast conversion between pixel formats.
+
+ @{
+ */
+
+//! Commonly used pixel formats. Any other `SDL_PIXELFORMAT_*` value may be
+//! used by casting.
+enum class pixel_format : uint32_t {
+    unknown = SDL_PIXELFORMAT_UNKNOWN,
+    index8 = SDL_PIXELFORMAT_INDEX8,
+    rgb565 = SDL_PIXELFORMAT_RGB565,
+    rgb24 = SDL_PIXELFORMAT_RGB24,
+    bgr24 = SDL_PIXELFORMAT_BGR24,
+    rgb888 = SDL_PIXELFORMAT_RGB888,
+    bgr888 = SDL_PIXELFORMAT_BGR888,
+    argb8888 = SDL_PIXELFORMAT_ARGB8888,
+    rgba8888 = SDL_PIXELFORMAT_RGBA8888,
+    abgr8888 = SDL_PIXELFORMAT_ABGR8888,
+    bgra8888 = SDL_PIXELFORMAT_BGRA8888,
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+    rgba32 = SDL_PIXELFORMAT_RGBA8888,
+    argb32 = SDL_PIXELFORMAT_ARGB8888,
+    bgra32 = SDL_PIXELFORMAT_BGRA8888,
+    abgr32 = SDL_PIXELFORMAT_ABGR8888,
+#else
+    //! Four bytes per pixel, in the order R, G, B, A in memory
+    rgba32 = SDL_PIXELFORMAT_ABGR8888,
+    //! Four bytes per pixel, in the order A, R, G, B in memory
+    argb32 = SDL_PIXELFORMAT_BGRA8888,
+    //! Four bytes per pixel, in the order B, G, R, A in memory
+    bgra32 = SDL_PIXELFORMAT_ARGB8888,
+    //! Four bytes per pixel, in the order A, B, G, R in memory
+    abgr32 = SDL_PIXELFORMAT_RGBA8888,
+#endif
+    yv12 = SDL_PIXELFORMAT_YV12,
+    iyuv = SDL_PIXELFORMAT_IYUV,
+    yuy2 = SDL_PIXELFORMAT_YUY2,
+    uyvy = SDL_PIXELFORMAT_UYVY,
+    yvyu = SDL_PIXELFORMAT_YVYU,
+    nv12 = SDL_PIXELFORMAT_NV12,
+    nv21 = SDL_PIXELFORMAT_NV21
+};
+
+//! Returns the number of bytes used by each pixel in `format`. For planar
+//! YUV formats this is the size of a sample in the first plane.
+inline int bytes_per_pixel(pixel_format format) noexcept {
+    return SDL_BYTESPERPIXEL(static_cast<uint32_t>(format));
+}
+
+//! Returns true if `format` is a YUV format identified by a FourCC code
+inline bool is_fourcc(pixel_format format) noexcept {
+    return SDL_ISPIXELFORMAT_FOURCC(static_cast<uint32_t>(format));
+}
+
+/*!
+ A non-owning view of a rectangle of pixels of type `T`
+
+ Rows are `pitch()` bytes apart, which may be more than
+ `width() * sizeof(T)`. Iterating over a `pixel_view` yields each row in
+ turn as an `sdl::span<T>`, so that the inner loop runs over contiguous
+ memory:
+
+ ```
+ for (auto row : surface.view<uint32_t>()) {
+     for (uint32_t& pixel : row) { pixel |= alpha_mask; }
+ }
+ ```
+ */
+template <typename T>
+class pixel_view {
+    using byte_type =
+        std::conditional_t<std::is_const<T>::value, const unsigned char,
+                           unsigned char>;
+
+public:
+    //! An iterator over the rows of a view
+    class row_iterator {
+    public:
+        //! @cond
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = span<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = span<T>;
+
+        row_iterator() = default;
+
+        row_iterator(byte_type* row, int width, int pitch) noexcept
+            : row{row}, width{width}, pitch{pitch} {}
+
+        span<T> operator*() const noexcept {
+            return {reinterpret_cast<T*>(row), static_cast<size_t>(width)};
+        }
+
+        span<T> operator[](difference_type n) const noexcept {
+            return *(*this + n);
+        }
+
+        row_iterator& operator++() noexcept {
+            row += pitch;
+            return *this;
+        }
+
+        row_iterator operator++(int) noexcept {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        row_iterator& operator--() noexcept {
+            row -= pitch;
+            return *this;
+        }
+
+        row_iterator operator--(int) noexcept {
+            auto tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        row_iterator& operator+=(difference_type n) noexcept {
+            row += n * pitch;
+            return *this;
+        }
+
+        row_iterator& operator-=(difference_type n) noexcept {
+            row -= n * pitch;
+            return *this;
+        }
+
+        friend row_iterator operator+(row_iterator it,
+                                      difference_type n) noexcept {
+            return it += n;
+        }
+
+        friend row_iterator operator-(row_iterator it,
+                                      difference_type n) noexcept {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const row_iterator& a,
+                                         const row_iterator& b) noexcept {
+            return a.pitch == 0 ? 0 : (a.row - b.row) / a.pitch;
+        }
+
+        friend bool operator==(const row_iterator& a,
+                               const row_iterator& b) noexcept {
+            return a.row == b.row;
+        }
+
+        friend bool operator!=(const row_iterator& a,
+                               const row_iterator& b) noexcept {
+            return a.row != b.row;
+        }
+
+        friend bool operator<(const row_iterator& a,
+                              const row_iterator& b) noexcept {
+            return a - b < 0;
+        }
+        //! @endcond
+
+    private:
+        byte_type* row = nullptr;
+        int width = 0;
+        int pitch = 0;
+    };
+
+    //! Constructs an empty view
+    pixel_view() = default;
+
+    //! Constructs a view of `width` by `height` pixels starting at `pixels`,
+    //! with rows `pitch` bytes apart
+    pixel_view(T* pixels, int width, int height, int pitch) noexcept
+        : ptr{reinterpret_cast<byte_type*>(pixels)},
+          w{width},
+          h{height},
+          pitch_bytes{pitch} {}
+
+    //! Converts a view of `U` to a view of `T`, for example
+    //! `pixel_view<uint32_t>` to `pixel_view<const uint32_t>`
+    template <typename U,
+              typename = std::enable_if_t<
+                  std::is_convertible<U (*)[], T (*)[]>::value>>
+    pixel_view(const pixel_view<U>& other) noexcept
+        : pixel_view(other.data(), other.width(), other.height(),
+                     other.pitch()) {}
+
+    //! Returns a pointer to the first pixel
+    T* data() const noexcept { return reinterpret_cast<T*>(ptr); }
+    //! Returns the width in pixels
+    int width() const noexcept { return w; }
+    //! Returns the height in pixels
+    int height() const noexcept { return h; }
+    //! Returns the distance between the starts of consecutive rows, in bytes
+    int pitch() const noexcept { return pitch_bytes; }
+    //! Returns true if the view has no pixels
+    bool empty() const noexcept { return w == 0 || h == 0; }
+
+    //! Returns true if there is no padding between rows, so that the pixels
+    //! may be processed as a single span
+    bool contiguous() const noexcept {
+        return h <= 1 || static_cast<size_t>(pitch_bytes) == w * sizeof(T);
+    }
+
+    //! Returns row `y`, which must be less than `height()`
+    span<T> row(int y) const noexcept { return *(begin() + y); }
+
+    //! Returns the pixel at (`x`, `y`), which must lie within the view
+    T& operator()(int x, int y) const noexcept { return row(y)[x]; }
+
+    //! Returns an iterator to the first row
+    row_iterator begin() const noexcept { return {ptr, w, pitch_bytes}; }
+
+    //! Returns an iterator past the last row
+    row_iterator end() const noexcept {
+        // Computed in ptrdiff_t, as a large surface may hold more than
+        // INT_MAX bytes
+        return {ptr + static_cast<std::ptrdiff_t>(h) * pitch_bytes, w,
+                pitch_bytes};
+    }
+
+    //! Returns a view of the `width` by `height` rectangle with its top left
+    //! corner at (`x`, `y`), which must lie within this view
+    pixel_view subview(int x, int y, int width, int height) const noexcept {
+        return {&(*this)(x, y), width, height, pitch_bytes};
+    }
+
+private:
+    byte_type* ptr = nullptr;
+    int w = 0;
+    int h = 0;
+    int pitch_bytes = 0;
+};
+
+namespace detail {
+
+    struct surface_deleter {
+        void operator()(SDL_Surface* surface) const noexcept {
+            ::SDL_FreeSurface(surface);
+        }
+    };
+
+    // SDL 2.0.5 can create surfaces from a format enum directly; before
+    // that the format must be described by its masks. Packed formats of
+    // 24 bits in 4 bytes need a depth of 32, or SDL picks the 3-byte format.
+    inline int surface_depth(uint32_t format) noexcept {
+        const int bits = SDL_BITSPERPIXEL(format);
+        return bits < 8 ? bits : SDL_BYTESPERPIXEL(format) * 8;
+    }
+
+    inline SDL_Surface* create_surface(int width, int height,
+                                       uint32_t format) noexcept {
+#if SDL_VERSION_ATLEAST(2, 0, 5)
+        return ::SDL_CreateRGBSurfaceWithFormat(
+            0, width, height, surface_depth(format), format);
+#else
+        int bpp = 0;
+        Uint32 r = 0, g = 0, b = 0, a = 0;
+        if (!::SDL_PixelFormatEnumToMasks(format, &bpp, &r, &g, &b, &a)) {
+            return nullptr;
+        }
+        return ::SDL_CreateRGBSurface(0, width, height, surface_depth(format),
+                                      r, g, b, a);
+#endif
+    }
+
+    inline SDL_Surface* create_surface_from(void* pixels, int width,
+                                            int height, int pitch,
+                                            uint32_t format) noexcept {
+#if SDL_VERSION_ATLEAST(2, 0, 5)
+        return ::SDL_CreateRGBSurfaceWithFormatFrom(
+            pixels, width, height, surface_depth(format), pitch, format);
+#else
+        int bpp = 0;
+        Uint32 r = 0, g = 0, b = 0, a = 0;
+        if (!::SDL_PixelFormatEnumToMasks(format, &bpp, &r, &g, &b, &a)) {
+            return nullptr;
+        }
+        return ::SDL_CreateRGBSurfaceFrom(pixels, width, height,
+                                          surface_depth(format), pitch, r, g,
+                                          b, a);
+#endif
+    }
+
+    // Pixel buffers cached by a surface_pool, keyed by format and size. The
+    // cache is shared with the surfaces using its buffers, so that a buffer
+    // returned after the pool has gone is simply freed.
+    class surface_buffer_cache {
+    public:
+        using key_type = std::tuple<uint32_t, int, int>;
+        using buffer_type = std::unique_ptr<unsigned char[]>;
+
+        explicit surface_buffer_cache(size_t capacity) : capacity{capacity} {}
+
+        buffer_type take(const key_type& key, size_t size) {
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                auto it = buffers.find(key);
+                if (it != buffers.end() && !it->second.empty()) {
+                    auto buffer = std::move(it->second.back());
+                    it->second.pop_back();
+                    cached_bytes -= size;
+                    --cached_count;
+                    ++hit_count;
+                    return buffer;
+                }
+                ++miss_count;
+            }
+            return buffer_type{new unsigned char[size]};
+        }
+
+        void give(const key_type& key, buffer_type buffer, size_t size) {
+            std::lock_guard<std::mutex> lock{mutex};
+            if (cached_bytes + size > capacity) { return; }
+            buffers[key].push_back(std::move(buffer));
+            cached_bytes += size;
+            ++cached_count;
+        }
+
+        void clear() {
+            std::lock_guard<std::mutex> lock{mutex};
+            buffers.clear();
+            cached_bytes = 0;
+            cached_count = 0;
+        }
+
+        template <typename Func>
+        auto read(Func func) const {
+            std::lock_guard<std::mutex> lock{mutex};
+            return func(*this);
+        }
+
+        const size_t capacity;
+        size_t cached_bytes = 0;
+        size_t cached_count = 0;
+        uint64_t hit_count = 0;
+        uint64_t miss_count = 0;
+
+    private:
+        mutable std::mutex mutex;
+        std::map<key_type, std::vector<buffer_type>> buffers;
+    };
+
+    // The pixel buffer of a pooled surface, which goes back to the pool's
+    // cache when the surface is destroyed
+    class pooled_pixels {
+    public:
+        pooled_pixels() = default;
+
+        pooled_pixels(surface_buffer_cache::buffer_type buffer,
+                      std::weak_ptr<surface_buffer_cache> cache,
+                      surface_buffer_cache::key_type key, size_t size) noexcept
+            : buffer{std::move(buffer)},
+              cache{std::move(cache)},
+              key{key},
+              size{size} {}
+
+        pooled_pixels(pooled_pixels&&) noexcept = default;
+
+        pooled_pixels& operator=(pooled_pixels&& other) noexcept {
+            std::swap(buffer, other.buffer);
+            std::swap(cache, other.cache);
+            std::swap(key, other.key);
+            std::swap(size, other.size);
+            return *this;
+        }
+
+        ~pooled_pixels() {
+            if (!buffer) { return; }
+            if (auto owner = cache.lock()) {
+                owner->give(key, std::move(buffer), size);
+            }
+        }
+
+        unsigned char* get() const noexcept { return buffer.get(); }
+
+    private:
+        surface_buffer_cache::buffer_type buffer;
+        std::weak_ptr<surface_buffer_cache> cache;
+        surface_buffer_cache::key_type key{};
+        size_t size = 0;
+    };
+
+} // end namespace detail
+
+class surface_pool;
+
+/*!
+ Holds a lock on a surface for its lifetime
+
+ Surfaces for which `surface::must_lock()` is true, such as RLE-encoded
+ surfaces, must be locked before their pixels are accessed.
+ */
+class surface_lock {
+public:
+    //! Move constructor
+    surface_lock(surface_lock&& other) noexcept : locked{other.locked} {
+        other.locked = nullptr;
+    }
+
+    //! Move assignment operator
+    surface_lock& operator=(surface_lock&& other) noexcept {
+        std::swap(locked, other.locked);
+        return *this;
+    }
+
+    //! Unlocks the surface
+    ~surface_lock() {
+        if (locked) { ::SDL_UnlockSurface(locked); }
+    }
+
+private:
+    friend class surface;
+    explicit surface_lock(SDL_Surface* locked) noexcept : locked{locked} {}
+
+    SDL_Surface* locked;
+};
+
+/*!
+ An owning handle to an `SDL_Surface`, which is freed with `SDL_FreeSurface()`
+ when the handle is destroyed
+
+ `surface` is move-only. It may be empty, in which case only `get()`, the
+ boolean conversion and assignment may be used.
+ */
+class surface {
+public:
+    //! Constructs an empty handle
+    surface() = default;
+
+    //! Takes ownership of `owned`, which may be null
+    explicit surface(SDL_Surface* owned) noexcept : ptr{owned} {}
+
+    /*!
+     Creates a surface of `width` by `height` pixels in `format`
+     @throws sdl::error if the surface could not be created
+     */
+    surface(int width, int height, pixel_format format)
+        : surface(try_create(width, height, format).value()) {}
+
+    /*!
+     Creates a surface of `width` by `height` pixels in `format`, without
+     throwing
+     @returns The new surface, or a failed result
+     */
+    static result<surface> try_create(int width, int height,
+                                      pixel_format format) {
+        surface s{detail::create_surface(width, height,
+                                         static_cast<uint32_t>(format))};
+        if (!s) { return failure; }
+        return s;
+    }
+
+    /*!
+     Creates a surface which uses the existing `pixels`, without copying them.
+     The pixels must outlive the surface.
+     @throws sdl::error if the surface could not be created
+     */
+    static surface create_from(void* pixels, int width, int height, int pitch,
+                               pixel_format format) {
+        return try_create_from(pixels, width, height, pitch, format).value();
+    }
+
+    //! Creates a surface which uses the existing `pixels`, without throwing
+    static result<surface> try_create_from(void* pixels, int width, int height,
+                                           int pitch, pixel_format format) {
+        surface s{detail::create_surface_from(pixels, width, height, pitch,
+                                              static_cast<uint32_t>(format))};
+        if (!s) { return failure; }
+        return s;
+    }
+
+    //! Move constructor
+    surface(surface&&) noexcept = default;
+
+    //! Move assignment operator
+    surface& operator=(surface&& other) noexcept {
+        // The surface must be freed before its pixels are recycled
+        std::swap(ptr, other.ptr);
+        std::swap(storage, other.storage);
+        return *this;
+    }
+
+    //! Returns the underlying `SDL_Surface`, which may be null
+    SDL_Surface* get() const noexcept { return ptr.get(); }
+
+    //! Returns true if the handle is not empty
+    explicit operator bool() const noexcept { return ptr != nullptr; }
+
+    //! Returns the width in pixels
+    int width() const noexcept { return ptr->w; }
+    //! Returns the height in pixels
+    int height() const noexcept { return ptr->h; }
+    //! Returns the distance between the starts of consecutive rows, in bytes
+    int pitch() const noexcept { return ptr->pitch; }
+
+    //! Returns the pixel format
+    pixel_format format() const noexcept {
+        return static_cast<pixel_format>(ptr->format->format);
+    }
+
+    //! Returns a pointer to the pixels
+    void* pixels() const noexcept { return ptr->pixels; }
+
+    //! Returns true if the surface must be locked before its pixels are
+    //! accessed
+    bool must_lock() const noexcept { return SDL_MUSTLOCK(ptr.get()); }
+
+    /*!
+     Locks the surface for direct access to its pixels
+     @throws sdl::error if the surface could not be locked
+     */
+    surface_lock lock() { return try_lock().value(); }
+
+    //! Locks the surface for direct access to its pixels, without throwing
+    result<surface_lock> try_lock() {
+        if (::SDL_LockSurface(ptr.get()) != 0) { return failure; }
+        return surface_lock{ptr.get()};
+    }
+
+    /*!
+     Returns a view of the pixels as type `T`, which must be the same size
+     as a pixel
+
+     For example, `uint32_t` may be used for 32-bit formats and `uint16_t`
+     for 16-bit formats.
+     */
+    template <typename T>
+    pixel_view<T> view() {
+        SDL_assert(sizeof(T) == static_cast<size_t>(bytes_per_pixel(format())));
+        return {static_cast<T*>(pixels()), width(), height(), pitch()};
+    }
+
+    //! @overload
+    template <typename T>
+    pixel_view<const T> view() const {
+        SDL_assert(sizeof(T) == static_cast<size_t>(bytes_per_pixel(format())));
+        return {static_cast<const T*>(pixels()), width(), height(), pitch()};
+    }
+
+private:
+    friend class surface_pool;
+
+    surface(SDL_Surface* owned, detail::pooled_pixels storage) noexcept
+        : storage{std::move(storage)}, ptr{owned} {}
+
+    // Declared first so that the surface is freed before its pixels
+    detail::pooled_pixels storage;
+    std::unique_ptr<SDL_Surface, detail::surface_deleter> ptr;
+};
+
+/*!
+ Recycles the pixel storage of short-lived surfaces
+
+ Creating a surface allocates its pixels, which becomes significant when
+ temporary surfaces, such as rendered text or thumbnails, are created every
+ frame. Surfaces acquired from a pool instead use a buffer which is returned
+ to the pool when the surface is destroyed, and reused by the next surface
+ with the same format and dimensions:
+
+ ```
+ sdl::surface_pool pool;
+ for (const auto& label : labels) {
+     auto s = pool.acquire(label.w, label.h, sdl::pixel_format::rgba32);
+     draw_label(s.view<uint32_t>(), label);
+     upload(s);
+ } // each surface's buffer goes back to the pool here
+ ```
+
+ At most `capacity()` bytes are kept; buffers returned to a full pool are
+ freed. Rows of pooled surfaces are aligned to 16 bytes. Pooled surfaces
+ may outlive the pool, and may be destroyed on any thread.
+ */
+class surface_pool {
+public:
+    //! The default capacity, in bytes
+    static constexpr size_t default_capacity = 64 * 1024 * 1024;
+
+    //! Constructs a pool which keeps up to `capacity` bytes of buffers
+    explicit surface_pool(size_t capacity = default_capacity)
+        : cache{std::make_shared<detail::surface_buffer_cache>(capacity)} {}
+
+    /*!
+     Returns a surface of `width` by `height` pixels in `format`, reusing a
+     buffer from the pool if one is available. The pixels are not
+     initialized.
+     @throws sdl::error if the surface could not be created
+     */
+    surface acquire(int width, int height, pixel_format format) {
+        return try_acquire(width, height, format).value();
+    }
+
+    //! Returns a surface from the pool, without throwing
+    result<surface> try_acquire(int width, int height, pixel_format format) {
+        if (width < 0 || height < 0 || is_fourcc(format) ||
+            format == pixel_format::unknown) {
+            ::SDL_SetError("Invalid surface size or format");
+            return failure;
+        }
+        const auto fmt = static_cast<uint32_t>(format);
+        // Computed in 64 bits, as the pitch of a wide surface may not fit
+        // in an int
+        const long long row_bytes =
+            (static_cast<long long>(width) * SDL_BITSPERPIXEL(fmt) + 7) / 8;
+        const long long wide_pitch = (row_bytes + 15) & ~15LL;
+        const auto bytes = static_cast<unsigned long long>(wide_pitch) *
+                           static_cast<unsigned long long>(height);
+        if (wide_pitch > SDL_MAX_SINT32 || bytes > SIZE_MAX) {
+            ::SDL_SetError("Surface is too large");
+            return failure;
+        }
+        const int pitch = static_cast<int>(wide_pitch);
+        const auto size = static_cast<size_t>(bytes);
+        const auto key = std::make_tuple(fmt, width, height);
+
+        detail::pooled_pixels storage{cache->take(key, size), cache, key,
+                                      size};
+        SDL_Surface* s = detail::create_surface_from(storage.get(), width,
+                                                     height, pitch, fmt);
+        if (!s) { return failure; }
+        return surface{s, std::move(storage)};
+    }
+
+    //! Returns the maximum number of bytes kept by the pool
+    size_t capacity() const noexcept { return cache->capacity; }
+
+    //! Returns the number of buffers waiting to be reused
+    size_t cached_count() const {
+        return cache->read([](auto& c) { return c.cached_count; });
+    }
+
+    //! Returns the total size of the buffers waiting to be reused
+    size_t cached_bytes() const {
+        return cache->read([](auto& c) { return c.cached_bytes; });
+    }
+
+    //! Returns the number of surfaces which reused a buffer
+    uint64_t hits() const {
+        return cache->read([](auto& c) { return c.hit_count; });
+    }
+
+    //! Returns the number of surfaces which needed a new buffer
+    uint64_t misses() const {
+        return cache->read([](auto& c) { return c.miss_count; });
+    }
+
+    //! Frees all the buffers waiting to be reused
+    void clear() { cache->clear(); }
+
+private:
+    std::shared_ptr<detail::surface_buffer_cache> cache;
+};
+
+/*!
+ Converts a block of pixels from one format to another, without throwing
+
+ Conversions between the 24- and 32-bit RGB formats, and from the packed
+ (YUY2, UYVY, YVYU) and semi-planar (NV12, NV21) YUV formats to 32-bit RGB,
+ use kernels for SSE2, SSSE3 or AVX2, chosen at run time according to the
+ processor. Other conversions are passed to `SDL_ConvertPixels()`.
+
+ YUV is converted with the ITU-R BT.601 limited-range coefficients. As in
+ SDL, the interleaved chroma plane of NV12 and NV21 follows the luma plane,
+ with the same pitch rounded up to an even number.
+
+ Padding bytes, such as the X of `SDL_PIXELFORMAT_RGBX8888`, are set to
+ 0xFF, as is alpha when the source has none.
+
+ @returns A failed result if the conversion is not supported
+ */
+inline result<void> try_convert_pixels(int width, int height,
+                                       pixel_format src_format,
+                                       const void* src, int src_pitch,
+                                       pixel_format dst_format, void* dst,
+                                       int dst_pitch) {
+    const auto from = static_cast<uint32_t>(src_format);
+    const auto to = static_cast<uint32_t>(dst_format);
+    const auto conv =
+        detail::plan_pixel_conversion(from, to, detail::best_simd_level());
+    if (!conv.row) {
+        return detail::check_zero(::SDL_ConvertPixels(
+            width, height, from, src, src_pitch, to, dst, dst_pitch));
+    }
+    detail::convert_pixels(conv, width, height, src, src_pitch, dst,
+                           dst_pitch);
+    return {};
+}
+
+/*!
+ Converts a block of pixels from one format to another
+ @see try_convert_pixels()
+ @throws sdl::error if the conversion is not supported
+ */
+inline void convert_pixels(int width, int height, pixel_format src_format,
+                           const void* src, int src_pitch,
+                           pixel_format dst_format, void* dst, int dst_pitch) {
+    try_convert_pixels(width, height, src_format, src, src_pitch, dst_format,
+                       dst, dst_pitch)
+        .value();
+}
+
+//! Converts the pixels of `src` into the format of `dst`, which must have
+//! the same dimensions, without throwing
+inline result<void> try_convert_pixels(const surface& src, surface& dst) {
+    if (src.width() != dst.width() || src.height() != dst.height()) {
+        ::SDL_SetError("Surfaces must have the same dimensions");
+        return failure;
+    }
+    return try_convert_pixels(src.width(), src.height(), src.format(),
+                              src.pixels(), src.pitch(), dst.format(),
+                              dst.pixels(), dst.pitch());
+}
+
+/*!
+ Converts the pixels of `src` into the format of `dst`, which must have the
+ same dimensions
+ @throws sdl::error if the dimensions differ or the conversion is not
+ supported
+ */
+inline void convert_pixels(const surface& src, surface& dst) {
+    try_convert_pixels(src, dst).value();
+}
+
+//! Returns a copy of `src` converted to `format`, without throwing
+inline result<surface> try_convert_surface(const surface& src,
+                                           pixel_format format) {
+    auto dst = surface::try_create(src.width(), src.height(), format);
+    if (!dst || !try_convert_pixels(src, *dst)) { return failure; }
+    return dst;
+}
+
+/*!
+ Returns a copy of `src` converted to `format`
+ @throws sdl::error if the surface could not be created or converted
+ */
+inline surface convert_surface(const surface& src, pixel_format format) {
+    return try_convert_surface(src, format).value();
+}
+
+/*!
+ Multiplies the colour channels of a block of pixels by their alpha,
+ without throwing
+
+ `format` must be a 32-bit format with alpha. `src` and `dst` may be the
+ same. Kernels for SSE2 and AVX2 are chosen at run time.
+
+ @returns A failed result if the format has no alpha channel
+ */
+inline result<void> try_premultiply_alpha(int width, int height,
+                                          pixel_format format, const void* src,
+                                          int src_pitch, void* dst,
+                                          int dst_pitch) {
+    detail::pixel_byte_order order;
+    if (!detail::get_pixel_byte_order(static_cast<uint32_t>(format), order) ||
+        !order.alpha) {
+        ::SDL_SetError("Pixel format has no alpha channel");
+        return failure;
+    }
+    const auto row = detail::select_premultiply(detail::best_simd_level());
+    for (int y = 0; y < height; y++) {
+        row(order.a,
+            static_cast<const unsigned char*>(src) +
+                static_cast<std::ptrdiff_t>(y) * src_pitch,
+            static_cast<unsigned char*>(dst) +
+                static_cast<std::ptrdiff_t>(y) * dst_pitch,
+            width);
+    }
+    return {};
+}
+
+/*!
+ Multiplies the colour channels of a block of pixels by their alpha
+ @see try_premultiply_alpha()
+ @throws sdl::error if the format has no alpha channel
+ */
+inline void premultiply_alpha(int width, int height, pixel_format format,
+                              const void* src, int src_pitch, void* dst,
+                              int dst_pitch) {
+    try_premultiply_alpha(width, height, format, src, src_pitch, dst,
+                          dst_pitch)
+        .value();
+}
+
+//! Multiplies the colour channels of `s` by their alpha, in place
+//! @throws sdl::error if the surface's format has no alpha channel
+inline void premultiply_alpha(surface& s) {
+    premultiply_alpha(s.width(), s.height(), s.format(), s.pixels(),
+                      s.pitch(), s.pixels(), s.pitch());
+}
+
+//! @}
+
+} // end namespace sdl
+
+#endif // SDLXX_SURFACE_HPP
@@ -0,0 +1,350 @@
+/*!
+  @file texture_atlas.hpp
+  Simple DirectMedia Layer C++ Bindings
+  @copyright (C) 2016 Tristan Brindle <t.c.brindle@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDLXX_TEXTURE_ATLAS_HPP
+#define SDLXX_TEXTURE_ATLAS_HPP
+
+#include "SDL_render.h"
+
+#include "detail/rect_packer.hpp"
+#include "result.hpp"
+#include "stdinc.hpp"
+#include "surface.hpp"
+
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace sdl {
+
+//! A rectangle of an atlas page, which can be passed to `SDL_RenderCopy()`
+//! or `sdl::sprite_batch::draw()`
+//! @ingroup Render
+struct atlas_region {
+    //! The page texture holding the image
+    SDL_Texture* texture;
+    //! The image's position within the page
+    SDL_Rect rect;
+};
+
+/*!
+ Packs many small images, such as glyphs or icons, into a few large
+ textures at run time
+
+ Drawing from one texture lets `sdl::sprite_batch` draw long runs of sprites
+ without changing texture. Each image is identified by a 64-bit id chosen
+ by the caller, such as a glyph's font and code point, and is found with a
+ hash table lookup.
+
+ Images are packed into pages of a fixed size with a skyline allocator,
+ leaving `padding` pixels between them so that linear filtering does not
+ bleed between neighbours. When a page is full a new one is created.
+ Removed images leave space which later images may reuse, and a page whose
+ images have all been removed is reset.
+
+ Each page keeps a copy of its pixels in a surface. Adding an image only
+ writes to that copy; `upload()` then sends the changed regions of each page
+ to its texture with `SDL_UpdateTexture()`, so a frame which adds many
+ glyphs uploads them together. Call `upload()` before drawing.
+
+ ```
+ sdl::texture_atlas icons{renderer};
+ for (const auto& icon : icon_files) {
+     icons.add(icon.id, load_icon(icon.path));
+ }
+ icons.upload();
+
+ if (const auto* region = icons.find(save_icon_id)) {
+     batch.draw(region->texture, region->rect, SDL_Rect{8, 8, 32, 32});
+ }
+ ```
+
+ @ingroup Render
+ */
+class texture_atlas {
+public:
+    /*!
+     Creates an empty atlas for `renderer`, whose pages will be
+     `page_width` by `page_height` textures in `format`. No textures are
+     created until the first image is added.
+     */
+    explicit texture_atlas(SDL_Renderer* renderer, int page_width = 1024,
+                           int page_height = 1024, int padding = 1,
+                           pixel_format format = pixel_format::argb8888)
+        : renderer{renderer},
+          page_width{page_width},
+          page_height{page_height},
+          padding{padding},
+          format{format} {}
+
+    /*!
+     Adds a copy of `image` under `id`, replacing any image with that id.
+     If the image cannot be added, the existing image is kept.
+     @returns Where the image will be found once uploaded
+     @throws sdl::error if the image is larger than a page, cannot be
+     converted to the atlas format or a page cannot be created
+     */
+    atlas_region add(uint64_t id, const surface& image) {
+        return try_add(id, image).value();
+    }
+
+    //! Adds a copy of `image` under `id`, without throwing
+    //! @see add()
+    result<atlas_region> try_add(uint64_t id, const surface& image) {
+        return try_add(id, image.width(), image.height(), image.format(),
+                       image.pixels(), image.pitch());
+    }
+
+    //! Adds a copy of a block of pixels under `id`, without throwing
+    //! @see add()
+    result<atlas_region> try_add(uint64_t id, int width, int height,
+                                 pixel_format src_format, const void* pixels,
+                                 int pitch) {
+        const int w = width + padding;
+        const int h = height + padding;
+        SDL_Rect slot;
+        size_t index = 0;
+        while (index < pages.size() &&
+               !pages[index]->packer.insert(w, h, slot)) {
+            index++;
+        }
+        const bool new_page = index == pages.size();
+        if (new_page) {
+            if (w > page_width || h > page_height) {
+                ::SDL_SetError("Image is larger than a texture atlas page");
+                return failure;
+            }
+            auto p = page::create(renderer, page_width, page_height, format);
+            if (!p) { return failure; }
+            pages.push_back(std::move(*p));
+            pages.back()->packer.insert(w, h, slot);
+        }
+
+        auto& pg = *pages[index];
+        pg.live++;
+        const SDL_Rect rect{slot.x, slot.y, width, height};
+        auto* dst = static_cast<unsigned char*>(pg.pixels.pixels()) +
+                    rect.y * pg.pixels.pitch() +
+                    rect.x * bytes_per_pixel(format);
+        const auto converted =
+            try_convert_pixels(width, height, src_format, pixels, pitch,
+                               format, dst, pg.pixels.pitch());
+        if (!converted) {
+            // A page created for this image would be left empty
+            if (new_page) {
+                pages.pop_back();
+            } else {
+                release(pg, slot);
+            }
+            return failure;
+        }
+        pg.dirty.push_back(rect);
+
+        // The slot may hold part of an earlier image, which would otherwise
+        // bleed into this one through the padding
+        if (padding > 0) {
+            pg.clear(SDL_Rect{rect.x + width, rect.y, padding, slot.h});
+            pg.clear(SDL_Rect{rect.x, rect.y + height, width, padding});
+        }
+
+        // Only now that the new image is in place is any old one removed, so
+        // that a failed add leaves the atlas unchanged
+        remove(id);
+        used_area += static_cast<long long>(width) * height;
+        const atlas_region region{pg.texture.get(), rect};
+        entries.emplace(id, entry{region, slot, index});
+        return region;
+    }
+
+    /*!
+     Removes the image with the given id, if there is one, so that its space
+     can be reused
+     @returns Whether an image was removed
+     */
+    bool remove(uint64_t id) {
+        const auto it = entries.find(id);
+        if (it == entries.end()) { return false; }
+        const auto& e = it->second;
+        used_area -= static_cast<long long>(e.region.rect.w) *
+                     e.region.rect.h;
+        release(*pages[e.page], e.slot);
+        entries.erase(it);
+        return true;
+    }
+
+    /*!
+     Returns the region holding the image with the given id, or null if
+     there is none. The pointer is invalidated by `add()` and `remove()`.
+     */
+    const atlas_region* find(uint64_t id) const noexcept {
+        const auto it = entries.find(id);
+        return it == entries.end() ? nullptr : &it->second.region;
+    }
+
+    //! Returns whether there is an image with the given id
+    bool contains(uint64_t id) const noexcept {
+        return entries.find(id) != entries.end();
+    }
+
+    //! Returns the number of images in the atlas
+    size_t size() const noexcept { return entries.size(); }
+
+    //! Returns the number of page textures
+    size_t page_count() const noexcept { return pages.size(); }
+
+    //! Returns the texture of page `index`
+    SDL_Texture* page_texture(size_t index) const noexcept {
+        return pages[index]->texture.get();
+    }
+
+    //! Returns the fraction of the pages' area covered by images, not
+    //! counting padding
+    double occupancy() const noexcept {
+        if (pages.empty()) { return 0.0; }
+        return static_cast<double>(used_area) /
+               (static_cast<double>(page_width) * page_height * pages.size());
+    }
+
+    /*!
+     Uploads the regions changed since the last upload to the page textures
+     @throws sdl::error if SDL cannot update a texture
+     */
+    void upload() { try_upload().value(); }
+
+    /*!
+     Uploads the regions changed since the last upload to the page textures,
+     without throwing
+
+     Each page's changed regions are uploaded separately, unless they are
+     numerous or cover most of their bounding box, in which case the
+     bounding box is uploaded in one call.
+
+     @returns A failed result if SDL cannot update a texture
+     */
+    result<void> try_upload() {
+        for (auto& p : pages) {
+            if (!p->upload()) { return failure; }
+        }
+        return {};
+    }
+
+private:
+    struct page {
+        page(std::unique_ptr<SDL_Texture, void (*)(SDL_Texture*)> texture,
+             surface pixels)
+            : texture{std::move(texture)},
+              pixels{std::move(pixels)},
+              packer{this->pixels.width(), this->pixels.height()},
+              dirty{SDL_Rect{0, 0, this->pixels.width(),
+                             this->pixels.height()}} {}
+
+        static result<std::unique_ptr<page>>
+        create(SDL_Renderer* renderer, int w, int h, pixel_format format) {
+            std::unique_ptr<SDL_Texture, void (*)(SDL_Texture*)> texture{
+                ::SDL_CreateTexture(renderer, static_cast<uint32_t>(format),
+                                    SDL_TEXTUREACCESS_STATIC, w, h),
+                &::SDL_DestroyTexture};
+            if (!texture) { return failure; }
+            ::SDL_SetTextureBlendMode(texture.get(), SDL_BLENDMODE_BLEND);
+            auto pixels = surface::try_create(w, h, format);
+            if (!pixels) { return failure; }
+            return std::make_unique<page>(std::move(texture),
+                                          std::move(*pixels));
+        }
+
+        // Zeroes a region of the pixels, and marks it for upload
+        void clear(const SDL_Rect& r) {
+            const int bpp = bytes_per_pixel(pixels.format());
+            auto* row = static_cast<unsigned char*>(pixels.pixels()) +
+                        r.y * pixels.pitch() + r.x * bpp;
+            for (int y = 0; y < r.h; y++, row += pixels.pitch()) {
+                std::memset(row, 0, static_cast<size_t>(r.w) * bpp);
+            }
+            dirty.push_back(r);
+        }
+
+        bool upload() {
+            if (dirty.empty()) { return true; }
+            SDL_Rect bounds = dirty[0];
+            long long area = 0;
+            for (const auto& r : dirty) {
+                const int right = std::max(bounds.x + bounds.w, r.x + r.w);
+                const int bottom = std::max(bounds.y + bounds.h, r.y + r.h);
+                bounds.x = std::min(bounds.x, r.x);
+                bounds.y = std::min(bounds.y, r.y);
+                bounds.w = right - bounds.x;
+                bounds.h = bottom - bounds.y;
+                area += static_cast<long long>(r.w) * r.h;
+            }
+            if (dirty.size() > 16 ||
+                2 * area >= static_cast<long long>(bounds.w) * bounds.h) {
+                dirty.assign(1, bounds);
+            }
+            const int bpp = bytes_per_pixel(pixels.format());
+            for (const auto& r : dirty) {
+                const auto* src = static_cast<const unsigned char*>(
+                                      pixels.pixels()) +
+                                  r.y * pixels.pitch() + r.x * bpp;
+                if (::SDL_UpdateTexture(texture.get(), &r, src,
+                                        pixels.pitch()) < 0) {
+                    return false;
+                }
+            }
+            dirty.clear();
+            return true;
+        }
+
+        std::unique_ptr<SDL_Texture, void (*)(SDL_Texture*)> texture;
+        surface pixels;
+        detail::rect_packer packer;
+        std::vector<SDL_Rect> dirty;
+        size_t live = 0;
+    };
+
+    struct entry {
+        atlas_region region;
+        SDL_Rect slot; // Including padding
+        size_t page;
+    };
+
+    static void release(page& p, const SDL_Rect& slot) {
+        if (--p.live == 0) {
+            p.packer.reset();
+        } else {
+            p.packer.release(slot);
+        }
+    }
+
+    SDL_Renderer* renderer;
+    int page_width;
+    int page_height;
+    int padding;
+    pixel_format format;
+    std::vector<std::unique_ptr<page>> pages;
+    std::unordered_map<uint64_t, entry> entries;
+    long long used_area = 0;
+};
+
+} // end namespace sdl
+
+#endif // SDLXX_TEXTURE_ATLAS_HPP
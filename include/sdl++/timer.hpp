@@ -26,10 +26,15 @@
 
 #include "SDL_timer.h"
 
+#include "init.hpp"
 #include "macros.hpp"
+#include "result.hpp"
 #include "stdinc.hpp"
 
 #include <chrono>
+#include <functional>
+#include <memory>
+#include <type_traits>
 
 namespace sdl {
 
@@ -154,26 +159,63 @@ namespace detail {
 
     public:
         timeout_t(duration interval, Func&& callback)
-            : callback(std::forward<Func>(callback)),
-              id{::SDL_AddTimer(interval.count(), run_callback, this)} {
+            : timeout_t(interval, make_callback(std::forward<Func>(callback))) {
             SDLXX_CHECK(id != 0);
         }
 
-        // Not default constructable, move-only
-        timeout_t(timeout_t&&) = default;
-        timeout_t& operator=(timeout_t&&) = default;
+        // Returns a failed result rather than throwing if the timer could
+        // not be added
+        SDLXX_ATTR_WARN_UNUSED_RESULT
+        static result<timeout_t> try_create(duration interval,
+                                            Func&& callback) {
+            timeout_t t{interval, make_callback(std::forward<Func>(callback))};
+            if (t.id == 0) { return failure; }
+            return t;
+        }
 
-        ~timeout_t() { ::SDL_RemoveTimer(id); }
+        // Not default constructable, move-only. The callback lives on the
+        // heap, so its address (which SDL holds) is unchanged by a move.
+        timeout_t(timeout_t&& other) noexcept
+            : callback(std::move(other.callback)), id{other.id} {
+            other.id = 0;
+        }
+
+        timeout_t& operator=(timeout_t&& other) noexcept {
+            std::swap(callback, other.callback);
+            std::swap(id, other.id);
+            return *this;
+        }
+
+        ~timeout_t() {
+            if (id != 0) { ::SDL_RemoveTimer(id); }
+        }
 
     private:
+        // An lvalue callback is referred to, as the caller's object is the one
+        // which should observe any state changes; an rvalue is moved in
+        using callback_type = std::conditional_t<
+            std::is_lvalue_reference<Func>::value,
+            std::reference_wrapper<std::remove_reference_t<Func>>,
+            std::decay_t<Func>>;
+
+        static std::unique_ptr<callback_type> make_callback(Func&& callback) {
+            return std::make_unique<callback_type>(
+                std::forward<Func>(callback));
+        }
+
+        timeout_t(duration interval, std::unique_ptr<callback_type> cb)
+            : callback(std::move(cb)),
+              id{::SDL_AddTimer(interval.count(), run_callback,
+                                callback.get())} {}
+
         static uint32_t run_callback(uint32_t interval, void* param) {
-            auto self = static_cast<timeout_t*>(param);
-            return optional<duration>{self->callback(duration{interval})}
+            auto& callback = *static_cast<callback_type*>(param);
+            return optional<duration>{callback(duration{interval})}
                 .value_or(duration::zero())
                 .count();
         }
 
-        Func callback;
+        std::unique_ptr<callback_type> callback;
         int id;
     };
 
@@ -211,6 +253,9 @@ namespace detail {
  @warning The callback will be called in a different thread. Be very careful
  about what you do inside the callback function.
 
+ @note If `callback` is an lvalue, the handle refers to it rather than taking
+ a copy, so it must outlive the handle. An rvalue is moved into the handle.
+
  @param interval An `sdl::duration` after which the callback will be called
  @param callback A callable (a function, functor, lambda etc) which can be
  called with a single argument of type `sdl::duration` and which returns an
@@ -223,9 +268,28 @@ namespace detail {
 template <typename Func>
 SDLXX_ATTR_WARN_UNUSED_RESULT auto make_timeout(duration interval,
                                                 Func&& callback) {
+    require_subsystems(init_flags::timer);
     return detail::timeout_t<Func>{interval, std::forward<Func>(callback)};
 }
 
+/*!
+ Add a new timer to the pool of timers already running, without throwing.
+
+ This behaves like `sdl::make_timeout()`, except that failure is reported
+ by returning a failed `sdl::result`.
+
+ @returns A move-only RAII handle representing the callback, or a failed
+          result if the callback could not be added
+ */
+template <typename Func>
+SDLXX_ATTR_WARN_UNUSED_RESULT auto try_make_timeout(duration interval,
+                                                    Func&& callback)
+    -> result<detail::timeout_t<Func>> {
+    if (!try_require_subsystems(init_flags::timer)) { return failure; }
+    return detail::timeout_t<Func>::try_create(interval,
+                                               std::forward<Func>(callback));
+}
+
 } // end namespace sdl
 
 #endif // SDLXX_TIMER_HPP
@@ -0,0 +1,234 @@
+
+#include <sdl++/asset_archive.hpp>
+
+#include "catch.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr const char test_archive[] = "sdlxx_asset_archive_test.pak";
+
+std::vector<uint8_t> bytes(const std::string& str) {
+    return {str.begin(), str.end()};
+}
+
+std::vector<uint8_t> random_bytes(size_t n, unsigned seed) {
+    std::mt19937 gen{seed};
+    std::vector<uint8_t> out(n);
+    for (auto& b : out) { b = static_cast<uint8_t>(gen()); }
+    return out;
+}
+
+std::vector<uint8_t> repetitive_bytes(size_t n) {
+    const std::string text = "The quick brown fox jumps over the lazy dog. ";
+    std::vector<uint8_t> out;
+    while (out.size() < n) { out.insert(out.end(), text.begin(), text.end()); }
+    out.resize(n);
+    return out;
+}
+
+std::vector<uint8_t> read_rwops(SDL_RWops* rw) {
+    std::vector<uint8_t> out(static_cast<size_t>(SDL_RWsize(rw)));
+    REQUIRE(SDL_RWread(rw, out.data(), 1, out.size()) == out.size());
+    return out;
+}
+}
+
+TEST_CASE("The LZ codec round-trips data", "[asset_archive]") {
+    for (auto data : {std::vector<uint8_t>{}, bytes("a"), bytes("abcd"),
+                      repetitive_bytes(100000), random_bytes(5000, 1),
+                      std::vector<uint8_t>(70000, 7)}) {
+        const auto packed = sdl::detail::lz_compress(data.data(), data.size());
+        std::vector<uint8_t> unpacked(data.size());
+        REQUIRE(sdl::detail::lz_decompress(packed.data(), packed.size(),
+                                           unpacked.data(), unpacked.size()));
+        REQUIRE(unpacked == data);
+    }
+
+    const auto text = repetitive_bytes(100000);
+    const auto packed = sdl::detail::lz_compress(text.data(), text.size());
+    REQUIRE(packed.size() < text.size() / 10);
+
+    // Truncated or mis-sized input is rejected
+    std::vector<uint8_t> out(text.size());
+    REQUIRE_FALSE(sdl::detail::lz_decompress(packed.data(), packed.size() / 2,
+                                             out.data(), out.size()));
+    REQUIRE_FALSE(sdl::detail::lz_decompress(packed.data(), packed.size(),
+                                             out.data(), out.size() - 1));
+}
+
+TEST_CASE("Assets round-trip through an archive", "[asset_archive]") {
+    const auto text = repetitive_bytes(20000);
+    const auto noise = random_bytes(3000, 2);
+
+    {
+        sdl::asset_archive_builder builder{64};
+        builder.add("hello.txt", bytes("Hello, world"));
+        builder.add("levels/text.txt", text, true);
+        builder.add("noise.bin", noise, true);
+        builder.add("empty", {});
+        REQUIRE(builder.size() == 4);
+        builder.write(test_archive);
+    }
+
+    sdl::asset_archive archive{test_archive};
+    REQUIRE(archive.size() == 4);
+    REQUIRE(archive.contains("hello.txt"));
+    REQUIRE_FALSE(archive.contains("hello.txt2"));
+    REQUIRE_FALSE(archive.contains(""));
+    REQUIRE(archive.list().size() == 4);
+
+    SECTION("Uncompressed assets can be viewed in place") {
+        const auto view = archive.view("hello.txt");
+        REQUIRE(std::string(view.begin(), view.end()) == "Hello, world");
+        REQUIRE(reinterpret_cast<uintptr_t>(view.data()) % 64 == 0);
+
+        // Random data does not compress, so is stored as-is
+        const auto info = archive.find("noise.bin");
+        REQUIRE(info);
+        REQUIRE_FALSE(info->compressed());
+        const auto nview = archive.view("noise.bin");
+        REQUIRE(std::vector<uint8_t>(nview.begin(), nview.end()) == noise);
+
+        REQUIRE(archive.view("empty").empty());
+    }
+
+    SECTION("Compressed assets can be read") {
+        const auto info = archive.find("levels/text.txt");
+        REQUIRE(info);
+        REQUIRE(info->name == "levels/text.txt");
+        REQUIRE(info->size == text.size());
+        REQUIRE(info->compressed());
+
+        REQUIRE(archive.read("levels/text.txt") == text);
+        REQUIRE_FALSE(archive.try_view("levels/text.txt"));
+        REQUIRE_THROWS_AS(archive.view("levels/text.txt"), sdl::error);
+    }
+
+    SECTION("Assets can be opened as SDL_RWops") {
+        auto rw = archive.open_rwops("hello.txt");
+        REQUIRE(read_rwops(rw.get()) == bytes("Hello, world"));
+
+        auto crw = archive.open_rwops("levels/text.txt");
+        REQUIRE(read_rwops(crw.get()) == text);
+    }
+
+    SECTION("Empty assets can be opened as SDL_RWops") {
+        auto rw = archive.open_rwops("empty");
+        REQUIRE(SDL_RWsize(rw.get()) == 0);
+        uint8_t byte = 0;
+        REQUIRE(SDL_RWread(rw.get(), &byte, 1, 1) == 0);
+        REQUIRE(read_rwops(rw.get()).empty());
+    }
+
+    SECTION("Missing assets are reported") {
+        REQUIRE_FALSE(archive.find("missing"));
+        const auto r = archive.try_read("missing");
+        REQUIRE_FALSE(r);
+        REQUIRE(std::string{r.error_message()} == "Asset not found");
+        REQUIRE_THROWS_AS(archive.read("missing"), sdl::error);
+        REQUIRE_FALSE(archive.try_open_rwops("missing"));
+    }
+
+    std::remove(test_archive);
+}
+
+TEST_CASE("Archive lookups work with many assets", "[asset_archive]") {
+    constexpr int count = 3000;
+    {
+        sdl::asset_archive_builder builder;
+        for (int i = 0; i < count; i++) {
+            builder.add("asset" + std::to_string(i),
+                        bytes(std::to_string(i * 7)));
+        }
+        // The last asset added with a given name wins
+        builder.add("asset42", bytes("replaced"));
+        builder.write(test_archive);
+    }
+
+    sdl::asset_archive archive{test_archive};
+    REQUIRE(archive.size() == count);
+    for (int i = 0; i < count; i++) {
+        if (i == 42) { continue; }
+        const auto view = archive.view("asset" + std::to_string(i));
+        REQUIRE(std::string(view.begin(), view.end()) == std::to_string(i * 7));
+    }
+    REQUIRE(archive.read("asset42") == bytes("replaced"));
+
+    std::remove(test_archive);
+}
+
+TEST_CASE("An empty archive can be written and read", "[asset_archive]") {
+    sdl::asset_archive_builder{}.write(test_archive);
+
+    sdl::asset_archive archive{test_archive};
+    REQUIRE(archive.size() == 0);
+    REQUIRE_FALSE(archive.contains("anything"));
+
+    std::remove(test_archive);
+}
+
+TEST_CASE("Opening an invalid archive fails", "[asset_archive]") {
+    {
+        auto f = std::fopen(test_archive, "wb");
+        std::fputs("SDLXXPAK but not really an archive at all", f);
+        std::fclose(f);
+    }
+
+    const auto r = sdl::asset_archive::try_open(test_archive);
+    REQUIRE_FALSE(r);
+    REQUIRE(std::string{r.error_message()} ==
+            "Not a valid sdl++ asset archive");
+    REQUIRE_THROWS_AS(sdl::asset_archive{test_archive}, sdl::error);
+    REQUIRE_FALSE(sdl::asset_archive::try_open("no/such/archive.pak"));
+
+    std::remove(test_archive);
+}
+
+TEST_CASE("Asset archive vs loose files", "[.][benchmark][asset_archive]") {
+    using std::chrono::steady_clock;
+    using ms = std::chrono::duration<double, std::milli>;
+
+    constexpr int count = 2000;
+    std::vector<std::string> names;
+    sdl::asset_archive_builder builder;
+    for (int i = 0; i < count; i++) {
+        names.push_back("sdlxx_loose_asset_" + std::to_string(i) + ".bin");
+        const auto data = random_bytes(1024 + (i % 8) * 512, i);
+        auto f = std::fopen(names.back().c_str(), "wb");
+        std::fwrite(data.data(), 1, data.size(), f);
+        std::fclose(f);
+        builder.add(names.back(), data);
+    }
+    builder.write(test_archive);
+
+    size_t total = 0;
+    auto start = steady_clock::now();
+    for (const auto& name : names) {
+        SDL_RWops* rw = SDL_RWFromFile(name.c_str(), "rb");
+        std::vector<uint8_t> buf(static_cast<size_t>(SDL_RWsize(rw)));
+        total += SDL_RWread(rw, buf.data(), 1, buf.size());
+        SDL_RWclose(rw);
+    }
+    const ms loose = steady_clock::now() - start;
+
+    start = steady_clock::now();
+    sdl::asset_archive archive{test_archive};
+    for (const auto& name : names) {
+        const auto view = archive.view(name);
+        total += view.size() + view[0] * 0;
+    }
+    const ms packed = steady_clock::now() - start;
+
+    WARN(count << " assets: loose files " << loose.count()
+               << " ms, asset_archive " << packed.count() << " ms (" << total
+               << " bytes)");
+
+    for (const auto& name : names) { std::remove(name.c_str()); }
+    std::remove(test_archive);
+}
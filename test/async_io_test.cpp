@@ -0,0 +1,362 @@
+
+#include <sdl++/async_io.hpp>
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr const char test_file[] = "sdlxx_async_io_test.bin";
+
+std::vector<uint8_t> make_data(size_t n) {
+    std::vector<uint8_t> out(n);
+    for (size_t i = 0; i < n; i++) { out[i] = static_cast<uint8_t>(i * 31); }
+    return out;
+}
+
+void write_file(const char* name, const std::vector<uint8_t>& data) {
+    auto f = std::fopen(name, "wb");
+    std::fwrite(data.data(), 1, data.size(), f);
+    std::fclose(f);
+}
+
+std::vector<uint8_t> to_vector(const sdl::io_result& r) {
+    return {r.data().begin(), r.data().end()};
+}
+
+// Occupies the only thread of an async_io until release() is called, so
+// that the order in which later requests are started can be controlled
+struct blocker {
+    explicit blocker(sdl::async_io& io) {
+        io.read({test_file, 0, 1}, [this](const sdl::io_result&) {
+            std::unique_lock<std::mutex> lock{mutex};
+            started = true;
+            cv.notify_all();
+            cv.wait(lock, [this] { return released; });
+            finished = true;
+            cv.notify_all();
+        });
+        std::unique_lock<std::mutex> lock{mutex};
+        cv.wait(lock, [this] { return started; });
+    }
+
+    ~blocker() {
+        release();
+        std::unique_lock<std::mutex> lock{mutex};
+        cv.wait(lock, [this] { return finished; });
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock{mutex};
+        released = true;
+        cv.notify_all();
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool started = false;
+    bool released = false;
+    bool finished = false;
+};
+}
+
+TEST_CASE("Whole files and ranges can be read", "[async_io]") {
+    const auto data = make_data(600000);
+    write_file(test_file, data);
+
+    sdl::async_io io;
+
+    SECTION("Whole file") {
+        const auto r = io.read({test_file}).future().get();
+        REQUIRE(r);
+        REQUIRE(r.get_status() == sdl::io_result::status::ok);
+        REQUIRE(to_vector(r) == data);
+    }
+
+    SECTION("Byte range") {
+        const auto r = io.read({test_file, 1000, 300000}).future().get();
+        REQUIRE(r);
+        REQUIRE(to_vector(r) == std::vector<uint8_t>(data.begin() + 1000,
+                                                     data.begin() + 301000));
+    }
+
+    SECTION("Caller-provided buffer") {
+        std::vector<uint8_t> buf(500);
+        sdl::io_request req{test_file, 10, 500};
+        req.buffer = buf;
+        const auto r = io.read(req).future().get();
+        REQUIRE(r);
+        REQUIRE(r.data().data() == buf.data());
+        REQUIRE(buf == std::vector<uint8_t>(data.begin() + 10,
+                                            data.begin() + 510));
+    }
+
+    SECTION("Callback") {
+        std::promise<std::vector<uint8_t>> p;
+        io.read({test_file, 0, 16},
+                [&p](const sdl::io_result& r) { p.set_value(to_vector(r)); });
+        REQUIRE(p.get_future().get() ==
+                std::vector<uint8_t>(data.begin(), data.begin() + 16));
+    }
+
+    std::remove(test_file);
+}
+
+TEST_CASE("Failed reads report an error", "[async_io]") {
+    write_file(test_file, make_data(100));
+    sdl::async_io io;
+
+    const auto missing = io.read({"no/such/file.bin"}).future().get();
+    REQUIRE_FALSE(missing);
+    REQUIRE(missing.get_status() == sdl::io_result::status::failed);
+    REQUIRE_FALSE(missing.error_message().empty());
+
+    const auto past_end = io.read({test_file, 50, 100}).future().get();
+    REQUIRE_FALSE(past_end);
+    REQUIRE(past_end.error_message() == "Unexpected end of file");
+
+    std::vector<uint8_t> small(10);
+    sdl::io_request req{test_file};
+    req.buffer = small;
+    const auto too_small = io.read(req).future().get();
+    REQUIRE_FALSE(too_small);
+    REQUIRE(too_small.error_message() == "Buffer is too small");
+
+    std::remove(test_file);
+}
+
+TEST_CASE("Completion can be posted as an SDL event", "[async_io]") {
+    const auto data = make_data(1000);
+    write_file(test_file, data);
+
+    sdl::async_io io;
+    const auto id = io.post({test_file}).id();
+
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    SDL_Event event;
+    bool found = false;
+    while (!found && std::chrono::steady_clock::now() < deadline) {
+        while (SDL_PollEvent(&event)) {
+            if (event.type != io.event_type()) { continue; }
+            REQUIRE(static_cast<uint64_t>(event.user.code) == id);
+            const auto r = sdl::async_io::take_result(event);
+            REQUIRE(*r);
+            REQUIRE(to_vector(*r) == data);
+            found = true;
+        }
+        SDL_Delay(1);
+    }
+    REQUIRE(found);
+
+    std::remove(test_file);
+}
+
+TEST_CASE("Duplicate requests are coalesced", "[async_io]") {
+    const auto data = make_data(5000);
+    write_file(test_file, data);
+
+    sdl::async_io io{1};
+    blocker block{io};
+
+    auto a = io.read({test_file});
+    auto b = io.read({test_file});
+    auto c = io.read({test_file, 0, 100});
+    REQUIRE(io.pending() == 3);
+    block.release();
+
+    const auto ra = a.future().get();
+    const auto rb = b.future().get();
+    const auto rc = c.future().get();
+    REQUIRE(ra);
+    REQUIRE(to_vector(ra) == data);
+    // The same buffer is shared by both requesters
+    REQUIRE(ra.data().data() == rb.data().data());
+    REQUIRE(rc.data().data() != ra.data().data());
+    REQUIRE(rc.data().size() == 100);
+
+    std::remove(test_file);
+}
+
+TEST_CASE("Requests are started in order of priority", "[async_io]") {
+    write_file(test_file, make_data(100));
+
+    sdl::async_io io{1};
+    blocker block{io};
+
+    std::vector<int> order;
+    std::mutex m;
+    auto record = [&](int n) {
+        return [&, n](const sdl::io_result&) {
+            std::lock_guard<std::mutex> lock{m};
+            order.push_back(n);
+        };
+    };
+    auto request = [](uint64_t offset, sdl::io_priority p) {
+        sdl::io_request req{test_file, offset, 1};
+        req.priority = p;
+        return req;
+    };
+
+    io.read(request(1, sdl::io_priority::low), record(1));
+    io.read(request(2, sdl::io_priority::normal), record(2));
+    io.read(request(3, sdl::io_priority::high), record(3));
+    io.read(request(4, sdl::io_priority::normal), record(4));
+    // A more urgent duplicate promotes the earlier request, which keeps its
+    // place among requests of the same priority
+    io.read(request(1, sdl::io_priority::high), record(5));
+
+    auto last = io.read(request(9, sdl::io_priority::low));
+    block.release();
+    last.future().wait();
+
+    REQUIRE(order == (std::vector<int>{1, 5, 3, 2, 4}));
+
+    std::remove(test_file);
+}
+
+TEST_CASE("Requests can be cancelled", "[async_io]") {
+    write_file(test_file, make_data(100));
+
+    sdl::async_io io{1};
+    blocker block{io};
+
+    auto a = io.read({test_file});
+    auto b = io.read({test_file});
+    auto c = io.read({test_file, 0, 10});
+
+    // Cancelling one of two coalesced requests leaves the other running
+    REQUIRE(io.cancel(a));
+    REQUIRE_FALSE(io.cancel(a));
+    REQUIRE(a.future().get().cancelled());
+
+    REQUIRE(io.cancel(c));
+    REQUIRE(c.future().get().cancelled());
+    REQUIRE(io.pending() == 1);
+
+    block.release();
+    const auto rb = b.future().get();
+    REQUIRE(rb);
+    REQUIRE(rb.data().size() == 100);
+    REQUIRE_FALSE(io.cancel(b));
+
+    std::remove(test_file);
+}
+
+TEST_CASE("A cancelled request does not affect a later identical one",
+          "[async_io]") {
+    // A large file, so that requests are usually cancelled mid-read
+    constexpr size_t size = 4 * 1024 * 1024;
+    write_file(test_file, make_data(size));
+
+    sdl::async_io io{1};
+    for (int i = 0; i < 20; i++) {
+        auto a = io.read({test_file});
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        io.cancel(a);
+
+        const auto r = io.read({test_file}).future().get();
+        REQUIRE(r);
+        REQUIRE(r.data().size() == size);
+    }
+
+    std::remove(test_file);
+}
+
+TEST_CASE("A cancelled read does not write to the buffer after delivery",
+          "[async_io]") {
+    // A large file, and increasing delays, so that some of the requests are
+    // cancelled mid-read
+    constexpr size_t size = 8 * 1024 * 1024;
+    write_file(test_file, make_data(size));
+
+    std::vector<uint8_t> buffer(size);
+    for (int i = 0; i < 10; i++) {
+        std::fill(buffer.begin(), buffer.end(), uint8_t{0});
+        std::vector<uint8_t> delivered;
+        {
+            sdl::async_io io{1};
+            sdl::io_request req{test_file};
+            req.buffer = buffer;
+            auto t = io.read(req);
+            std::this_thread::sleep_for(std::chrono::microseconds{200 * i});
+            if (!io.cancel(t)) { continue; }
+
+            REQUIRE(t.future().get().cancelled());
+            delivered = buffer;
+            // Joins the I/O thread, so any late writes have happened
+        }
+        // Compared outside REQUIRE, which would print both buffers
+        const bool unchanged = buffer == delivered;
+        REQUIRE(unchanged);
+    }
+
+    std::remove(test_file);
+}
+
+TEST_CASE("Destroying an async_io cancels waiting requests", "[async_io]") {
+    write_file(test_file, make_data(100));
+
+    auto io = std::make_unique<sdl::async_io>(1);
+    blocker block{*io};
+    const auto fut = io->read({test_file}).future();
+
+    // The queued request cannot start until the blocker is released, which
+    // only happens once the destructor has cancelled it
+    std::thread releaser{[&] {
+        fut.wait();
+        block.release();
+    }};
+    io.reset();
+    releaser.join();
+    REQUIRE(fut.get().cancelled());
+
+    std::remove(test_file);
+}
+
+TEST_CASE("Background loading vs blocking reads", "[.][benchmark][async_io]") {
+    using std::chrono::steady_clock;
+    using ms = std::chrono::duration<double, std::milli>;
+
+    constexpr int count = 200;
+    std::vector<std::string> names;
+    for (int i = 0; i < count; i++) {
+        names.push_back("sdlxx_async_io_" + std::to_string(i) + ".bin");
+        write_file(names.back().c_str(), make_data(64 * 1024));
+    }
+
+    size_t total = 0;
+    auto start = steady_clock::now();
+    for (const auto& name : names) {
+        SDL_RWops* rw = SDL_RWFromFile(name.c_str(), "rb");
+        std::vector<uint8_t> buf(static_cast<size_t>(SDL_RWsize(rw)));
+        total += SDL_RWread(rw, buf.data(), 1, buf.size());
+        SDL_RWclose(rw);
+    }
+    const ms blocking = steady_clock::now() - start;
+
+    sdl::async_io io{4};
+    start = steady_clock::now();
+    std::vector<sdl::io_ticket> tickets;
+    for (const auto& name : names) { tickets.push_back(io.read({name})); }
+    const ms submit = steady_clock::now() - start;
+    for (auto& t : tickets) { total += t.future().get().data().size(); }
+    const ms async = steady_clock::now() - start;
+
+    WARN(count << " files: blocking reads " << blocking.count()
+               << " ms, async_io " << async.count() << " ms total, "
+               << submit.count() << " ms on the calling thread (" << total
+               << " bytes)");
+
+    for (const auto& name : names) { std::remove(name.c_str()); }
+}
@@ -0,0 +1,165 @@
+
+#include <sdl++/atomic_file_writer.hpp>
+
+#include "catch.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr const char test_file[] = "sdlxx_atomic_file_writer_test.sav";
+
+std::string read_file(const std::string& name) {
+    std::ifstream in{name, std::ios::binary};
+    return {std::istreambuf_iterator<char>{in}, {}};
+}
+
+bool file_exists(const std::string& name) {
+    return static_cast<bool>(std::ifstream{name});
+}
+}
+
+TEST_CASE("Files are written atomically", "[atomic_file_writer]") {
+    sdl::atomic_file_writer writer;
+
+    auto r = writer.write(test_file, "first version").get();
+    REQUIRE(r);
+    REQUIRE(r.error_message().empty());
+    REQUIRE(read_file(test_file) == "first version");
+
+    // Replacing a file leaves no temporary file behind
+    r = writer.write(test_file, std::vector<uint8_t>{'a', 'b', 0, 'c'}).get();
+    REQUIRE(r);
+    REQUIRE(read_file(test_file) == std::string("ab\0c", 4));
+    REQUIRE_FALSE(file_exists(std::string{test_file} + ".tmp"));
+
+    std::remove(test_file);
+}
+
+TEST_CASE("Completion can be reported with a callback",
+          "[atomic_file_writer]") {
+    std::promise<sdl::write_result> p;
+    {
+        sdl::atomic_file_writer writer;
+        writer.write(test_file, {'x'},
+                     [&p](const sdl::write_result& r) { p.set_value(r); });
+    }
+    REQUIRE(p.get_future().get());
+    REQUIRE(read_file(test_file) == "x");
+
+    std::remove(test_file);
+}
+
+TEST_CASE("Failed writes leave the original file intact",
+          "[atomic_file_writer]") {
+    sdl::atomic_file_writer writer;
+
+    const auto r = writer.write("no/such/dir/save.dat", "data").get();
+    REQUIRE_FALSE(r);
+    REQUIRE(r.error_message().find("no/such/dir/save.dat.tmp") !=
+            std::string::npos);
+
+#if defined(__unix__) || defined(__APPLE__)
+    // A directory in the way of the temporary file makes the write fail
+    REQUIRE(writer.write(test_file, "original").get());
+    const std::string temp = std::string{test_file} + ".tmp";
+    REQUIRE(::mkdir(temp.c_str(), 0755) == 0);
+    REQUIRE_FALSE(writer.write(test_file, "replacement").get());
+    REQUIRE(read_file(test_file) == "original");
+    ::rmdir(temp.c_str());
+    std::remove(test_file);
+#endif
+}
+
+TEST_CASE("Writes within the commit delay are batched",
+          "[atomic_file_writer]") {
+    const std::string other = std::string{test_file} + "2";
+    sdl::atomic_file_writer writer{std::chrono::milliseconds{200}};
+
+    auto a = writer.write(test_file, "one");
+    auto b = writer.write(other, "two");
+    auto c = writer.write(test_file, "three");
+    writer.flush();
+
+    REQUIRE(a.get());
+    REQUIRE(b.get());
+    REQUIRE(c.get());
+    REQUIRE(writer.batches() == 1);
+    // Only the last contents written to a file in a batch are committed
+    REQUIRE(read_file(test_file) == "three");
+    REQUIRE(read_file(other) == "two");
+
+    std::remove(test_file);
+    std::remove(other.c_str());
+}
+
+TEST_CASE("The destructor waits for pending writes", "[atomic_file_writer]") {
+    {
+        sdl::atomic_file_writer writer{std::chrono::seconds{10}};
+        for (int i = 0; i < 10; i++) {
+            writer.write(test_file, "version " + std::to_string(i));
+        }
+    }
+    REQUIRE(read_file(test_file) == "version 9");
+
+    std::remove(test_file);
+}
+
+#ifdef __linux__
+TEST_CASE("Files can be written on tmpfs", "[atomic_file_writer]") {
+    const std::string path = "/dev/shm/sdlxx_atomic_file_writer_test.sav";
+    if (!file_exists("/dev/shm")) { return; }
+
+    sdl::atomic_file_writer writer;
+    REQUIRE(writer.write(path, "on tmpfs").get());
+    REQUIRE(read_file(path) == "on tmpfs");
+
+    std::remove(path.c_str());
+}
+#endif
+
+TEST_CASE("Background vs synchronous saving",
+          "[.][benchmark][atomic_file_writer]") {
+    using std::chrono::steady_clock;
+    using ms = std::chrono::duration<double, std::milli>;
+
+    constexpr int count = 50;
+    const std::vector<uint8_t> data(16 * 1024, 42);
+    std::vector<std::string> names;
+    for (int i = 0; i < count; i++) {
+        names.push_back("sdlxx_atomic_save_" + std::to_string(i) + ".sav");
+    }
+
+    auto start = steady_clock::now();
+    for (const auto& name : names) {
+        REQUIRE(sdl::detail::write_temp_file(name, data).empty());
+        REQUIRE(sdl::detail::replace_with_temp_file(name).empty());
+        sdl::detail::sync_directory(".");
+    }
+    const ms sync = steady_clock::now() - start;
+
+    sdl::atomic_file_writer writer;
+    start = steady_clock::now();
+    for (const auto& name : names) { writer.write(name, data); }
+    const ms submit = steady_clock::now() - start;
+    writer.flush();
+    const ms total = steady_clock::now() - start;
+
+    WARN(count << " saves: synchronous " << sync.count()
+               << " ms on the calling thread, atomic_file_writer "
+               << submit.count() << " ms on the calling thread, "
+               << total.count() << " ms in total (" << writer.batches()
+               << " batches)");
+
+    for (const auto& name : names) { std::remove(name.c_str()); }
+}
@@ -3,6 +3,129 @@
 
 #include "catch.hpp"
 
+#include <limits>
+
+namespace {
+
+// Naive reference implementations to check against
+
+template <typename T>
+int ref_countl_zero(T x) {
+    const int n = std::numeric_limits<T>::digits;
+    int count = 0;
+    for (int i = n - 1; i >= 0 && !((x >> i) & 1); --i) { ++count; }
+    return count;
+}
+
+template <typename T>
+int ref_countr_zero(T x) {
+    const int n = std::numeric_limits<T>::digits;
+    int count = 0;
+    for (int i = 0; i < n && !((x >> i) & 1); ++i) { ++count; }
+    return count;
+}
+
+template <typename T>
+int ref_popcount(T x) {
+    int count = 0;
+    for (; x != 0; x >>= 1) { count += x & 1; }
+    return count;
+}
+
+template <typename T>
+T ref_bit_floor(T x) {
+    T p = 0;
+    for (T i = 1; i != 0 && i <= x; i <<= 1) { p = i; }
+    return p;
+}
+
+template <typename T>
+T ref_bit_ceil(T x) {
+    T p = 1;
+    while (p < x && p != 0) { p <<= 1; }
+    return p;
+}
+
+template <typename T>
+T ref_rotl(T x, int s) {
+    const int n = std::numeric_limits<T>::digits;
+    s = ((s % n) + n) % n;
+    for (int i = 0; i < s; ++i) {
+        x = static_cast<T>((x << 1) | (x >> (n - 1)));
+    }
+    return x;
+}
+
+template <typename T>
+void check_value(T x) {
+    const int n = std::numeric_limits<T>::digits;
+    const uint64_t wide = x;
+
+    REQUIRE(sdl::countl_zero(x) == ref_countl_zero(x));
+    REQUIRE(sdl::countr_zero(x) == ref_countr_zero(x));
+    REQUIRE(sdl::countl_one(x) == ref_countl_zero(static_cast<T>(~x)));
+    REQUIRE(sdl::countr_one(x) == ref_countr_zero(static_cast<T>(~x)));
+    REQUIRE(sdl::popcount(x) == ref_popcount(x));
+    REQUIRE(sdl::has_single_bit(x) == (ref_popcount(x) == 1));
+    REQUIRE(sdl::bit_width(x) == n - ref_countl_zero(x));
+    REQUIRE(sdl::bit_floor(x) == ref_bit_floor(x));
+    REQUIRE(sdl::msb(x) == n - ref_countl_zero(x) - 1);
+    REQUIRE(sdl::lsb(x) == (x == 0 ? -1 : ref_countr_zero(x)));
+
+    if (x <= (T{1} << (n - 1))) {
+        REQUIRE(sdl::bit_ceil(x) == ref_bit_ceil(x));
+    }
+
+    // Both implementations must agree, whichever one is in use
+    REQUIRE(sdl::detail::portable_countl_zero(wide, n) == ref_countl_zero(x));
+    REQUIRE(sdl::detail::portable_countr_zero(wide, n) == ref_countr_zero(x));
+    REQUIRE(sdl::detail::portable_popcount(wide) == ref_popcount(x));
+#ifdef SDLXX_HAS_BUILTIN_BITOPS
+    REQUIRE(sdl::detail::builtin_countl_zero(wide, n) == ref_countl_zero(x));
+    REQUIRE(sdl::detail::builtin_countr_zero(wide, n) == ref_countr_zero(x));
+    REQUIRE(sdl::detail::builtin_popcount(wide) == ref_popcount(x));
+#endif
+}
+
+template <typename T>
+void check_rotations(T x) {
+    const int n = std::numeric_limits<T>::digits;
+    for (int s = -2 * n; s <= 2 * n; ++s) {
+        REQUIRE(sdl::rotl(x, s) == ref_rotl(x, s));
+        REQUIRE(sdl::rotr(x, s) == ref_rotl(x, -s));
+    }
+}
+
+// Powers of two, their neighbours and a pseudo-random sample
+template <typename T>
+void check_wide_type() {
+    const int n = std::numeric_limits<T>::digits;
+
+    check_value(T{0});
+    check_value(std::numeric_limits<T>::max());
+
+    for (int i = 0; i < n; ++i) {
+        const T p = T{1} << i;
+        check_value(p);
+        check_value(static_cast<T>(p - 1));
+        check_value(static_cast<T>(p + 1));
+        check_value(static_cast<T>(~p));
+    }
+
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < 10000; ++i) {
+        // xorshift64
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        const T x = static_cast<T>(state >> (i % n));
+        check_value(x);
+        if (i % 100 == 0) { check_rotations(x); }
+    }
+}
+
+} // end anonymous namespace
+
 TEST_CASE("SDL_MostSignificantBitIndex32() is wrapped correctly", "[bits]") {
     std::uint32_t val = 0x12345678;
     REQUIRE(SDL_MostSignificantBitIndex32(val) ==
@@ -12,3 +135,58 @@ TEST_CASE("SDL_MostSignificantBitIndex32() is wrapped correctly", "[bits]") {
 TEST_CASE("sdl::most_significant_bit_index(0) == -1", "[bits]") {
     REQUIRE(sdl::most_significant_bit_index(0) == -1);
 }
+
+TEST_CASE("sdl::most_significant_bit_index() agrees with SDL", "[bits]") {
+    for (int i = 0; i < 32; ++i) {
+        const uint32_t p = uint32_t{1} << i;
+        REQUIRE(sdl::most_significant_bit_index(p) ==
+                SDL_MostSignificantBitIndex32(p));
+        REQUIRE(sdl::most_significant_bit_index(p | 1) ==
+                SDL_MostSignificantBitIndex32(p | 1));
+    }
+}
+
+TEST_CASE("Bit operations can be used in constant expressions", "[bits]") {
+    static_assert(sdl::countl_zero(uint8_t{1}) == 7, "");
+    static_assert(sdl::countl_zero(uint64_t{1}) == 63, "");
+    static_assert(sdl::countr_zero(uint16_t{0x100}) == 8, "");
+    static_assert(sdl::countr_zero(uint32_t{0}) == 32, "");
+    static_assert(sdl::countl_one(uint8_t{0xF0}) == 4, "");
+    static_assert(sdl::countr_one(uint8_t{0x0F}) == 4, "");
+    static_assert(sdl::popcount(uint64_t{0xFFFF0000FFFF0000}) == 32, "");
+    static_assert(sdl::has_single_bit(uint32_t{4096}), "");
+    static_assert(!sdl::has_single_bit(uint32_t{0}), "");
+    static_assert(sdl::bit_width(uint32_t{255}) == 8, "");
+    static_assert(sdl::bit_floor(uint32_t{1000}) == 512, "");
+    static_assert(sdl::bit_ceil(uint32_t{1000}) == 1024, "");
+    static_assert(sdl::bit_ceil(uint64_t{0}) == 1, "");
+    static_assert(sdl::rotl(uint8_t{0x81}, 1) == 0x03, "");
+    static_assert(sdl::rotr(uint16_t{0x0001}, 1) == 0x8000, "");
+    static_assert(sdl::msb(uint64_t{1} << 40) == 40, "");
+    static_assert(sdl::lsb(uint64_t{0}) == -1, "");
+    static_assert(sdl::most_significant_bit_index(0x12345678) == 28, "");
+    SUCCEED();
+}
+
+TEST_CASE("Bit operations are correct for all 8-bit values", "[bits]") {
+    for (unsigned i = 0; i <= 0xFF; ++i) {
+        const auto x = static_cast<uint8_t>(i);
+        check_value(x);
+        check_rotations(x);
+    }
+}
+
+TEST_CASE("Bit operations are correct for all 16-bit values", "[bits]") {
+    for (unsigned i = 0; i <= 0xFFFF; ++i) {
+        check_value(static_cast<uint16_t>(i));
+    }
+    check_rotations(uint16_t{0xBEEF});
+}
+
+TEST_CASE("Bit operations are correct for 32-bit values", "[bits]") {
+    check_wide_type<uint32_t>();
+}
+
+TEST_CASE("Bit operations are correct for 64-bit values", "[bits]") {
+    check_wide_type<uint64_t>();
+}
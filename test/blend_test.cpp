@@ -0,0 +1,298 @@
+
+#include <sdl++/blend.hpp>
+
+#include "catch.hpp"
+
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+constexpr sdl::blend_mode all_modes[] = {
+    sdl::blend_mode::none, sdl::blend_mode::blend, sdl::blend_mode::add,
+    sdl::blend_mode::mod};
+
+// Random pixels, with runs which are fully opaque or fully transparent to
+// exercise the fast paths
+std::vector<uint32_t> random_pixels(size_t n, unsigned seed,
+                                    uint32_t alpha_mask) {
+    std::mt19937 gen{seed};
+    std::vector<uint32_t> out(n);
+    for (size_t i = 0; i < n; i++) {
+        out[i] = static_cast<uint32_t>(gen());
+        switch ((i / 8) % 4) {
+        case 1: out[i] |= alpha_mask; break;
+        case 2: out[i] &= ~alpha_mask; break;
+        default: break;
+        }
+    }
+    return out;
+}
+
+// SDL's generic blitter for blend_mode::blend, from SDL_blit_slow.c
+uint32_t reference_blend(uint32_t src, uint32_t dst, int alpha) {
+    const unsigned sa = (src >> 8 * alpha) & 0xFF;
+    uint32_t out = 0;
+    for (int c = 0; c < 4; c++) {
+        const unsigned s = (src >> 8 * c) & 0xFF;
+        const unsigned d = (dst >> 8 * c) & 0xFF;
+        const unsigned v = c == alpha ? sa + ((255 - sa) * d) / 255
+                                      : (s * sa) / 255 + ((255 - sa) * d) / 255;
+        out |= v << 8 * c;
+    }
+    return out;
+}
+
+sdl::surface blit(sdl::blend_mode mode, const sdl::surface& src,
+                  const sdl::surface& dst, int x, int y) {
+    auto out = sdl::convert_surface(dst, dst.format());
+    auto* s = const_cast<SDL_Surface*>(src.get());
+    SDL_SetSurfaceBlendMode(s, static_cast<SDL_BlendMode>(mode));
+    SDL_Rect rect{x, y, 0, 0};
+    REQUIRE(SDL_BlitSurface(s, nullptr, out.get(), &rect) == 0);
+    return out;
+}
+
+std::vector<uint32_t> pixels_of(const sdl::surface& s) {
+    std::vector<uint32_t> out;
+    for (auto row : s.view<uint32_t>()) {
+        out.insert(out.end(), row.begin(), row.end());
+    }
+    return out;
+}
+
+sdl::surface make_surface(int w, int h, sdl::pixel_format format,
+                          unsigned seed, uint32_t alpha_mask) {
+    sdl::surface s{w, h, format};
+    const auto px = random_pixels(static_cast<size_t>(w) * h, seed, alpha_mask);
+    auto it = px.begin();
+    for (auto row : s.view<uint32_t>()) {
+        for (auto& p : row) { p = *it++; }
+    }
+    return s;
+}
+
+std::vector<sdl::detail::simd_level> simd_levels() {
+    using sdl::detail::simd_level;
+    std::vector<simd_level> levels{simd_level::none};
+    for (auto level : {simd_level::sse2, simd_level::avx2}) {
+        if (level <= sdl::detail::best_simd_level()) {
+            levels.push_back(level);
+        }
+    }
+    return levels;
+}
+}
+
+TEST_CASE("Blending matches SDL's software blitter", "[blend]") {
+    // Alpha is the low byte of RGBA8888 and the high byte of ARGB8888
+    for (auto format : {sdl::pixel_format::rgba8888,
+                        sdl::pixel_format::argb8888}) {
+        const uint32_t amask = format == sdl::pixel_format::rgba8888
+                                   ? 0xFFu
+                                   : 0xFF000000u;
+        const auto src = make_surface(37, 19, format, 1, amask);
+        const auto dst = make_surface(45, 23, format, 2, amask);
+
+        for (auto mode : all_modes) {
+            for (auto pos : {SDL_Point{0, 0}, SDL_Point{5, 3},
+                             SDL_Point{-7, -4}, SDL_Point{30, 20}}) {
+                auto out = sdl::convert_surface(dst, format);
+                sdl::blend_rect(mode, src, out, pos.x, pos.y);
+
+                if (mode != sdl::blend_mode::blend) {
+                    REQUIRE(pixels_of(out) ==
+                            pixels_of(blit(mode, src, dst, pos.x, pos.y)));
+                    continue;
+                }
+
+                // SDL's x86 blitters approximate blending, so compare with
+                // the generic formula instead
+                const int alpha = format == sdl::pixel_format::rgba8888 ? 0 : 3;
+                auto expected = sdl::convert_surface(dst, format);
+                const auto sv = src.view<uint32_t>();
+                const auto ev = expected.view<uint32_t>();
+                for (int y = 0; y < sv.height(); y++) {
+                    for (int x = 0; x < sv.width(); x++) {
+                        const int dx = x + pos.x;
+                        const int dy = y + pos.y;
+                        if (dx < 0 || dy < 0 || dx >= ev.width() ||
+                            dy >= ev.height()) {
+                            continue;
+                        }
+                        ev(dx, dy) = reference_blend(sv(x, y), ev(dx, dy),
+                                                     alpha);
+                    }
+                }
+                REQUIRE(pixels_of(out) == pixels_of(expected));
+            }
+        }
+    }
+}
+
+TEST_CASE("Blending locks surfaces which must be locked", "[blend]") {
+    constexpr auto format = sdl::pixel_format::argb8888;
+    const auto src = make_surface(16, 8, format, 3, 0xFF000000u);
+    auto dst = make_surface(16, 8, format, 4, 0xFF000000u);
+    auto expected = sdl::convert_surface(dst, format);
+    sdl::blend_rect(sdl::blend_mode::blend, src, expected, 2, 1);
+
+    // RLE-encoding happens on the first blit from each surface
+    auto rle_src = sdl::convert_surface(src, format);
+    auto scratch = sdl::convert_surface(dst, format);
+    for (auto* s : {rle_src.get(), dst.get()}) {
+        SDL_SetSurfaceRLE(s, 1);
+        SDL_SetSurfaceBlendMode(s, SDL_BLENDMODE_NONE);
+        REQUIRE(SDL_BlitSurface(s, nullptr, scratch.get(), nullptr) == 0);
+    }
+    REQUIRE(rle_src.must_lock());
+    REQUIRE(dst.must_lock());
+
+    sdl::blend_rect(sdl::blend_mode::blend, rle_src, dst, 2, 1);
+    REQUIRE(dst.get()->locked == 0);
+    SDL_SetSurfaceRLE(dst.get(), 0);
+    REQUIRE(pixels_of(dst) == pixels_of(expected));
+}
+
+TEST_CASE("SIMD blend kernels match the scalar kernels", "[blend]") {
+    using sdl::detail::simd_level;
+    constexpr size_t max_width = 75;
+
+    for (int alpha : {0, 3}) {
+        const auto src = random_pixels(max_width, 3, 0xFFu << 8 * alpha);
+        const auto dst = random_pixels(max_width, 4, 0xFFu << 8 * alpha);
+        for (auto mode : {sdl::blend_mode::blend, sdl::blend_mode::add,
+                          sdl::blend_mode::mod}) {
+            for (auto pm : {sdl::blend_alpha::straight,
+                            sdl::blend_alpha::premultiplied}) {
+                const auto scalar =
+                    sdl::detail::select_blend_row(mode, pm, simd_level::none);
+                for (size_t width = 0; width <= max_width; width++) {
+                    auto expected = dst;
+                    scalar(alpha,
+                           reinterpret_cast<const unsigned char*>(src.data()),
+                           reinterpret_cast<unsigned char*>(expected.data()),
+                           width);
+                    for (auto level : simd_levels()) {
+                        auto out = dst;
+                        sdl::detail::select_blend_row(mode, pm, level)(
+                            alpha,
+                            reinterpret_cast<const unsigned char*>(src.data()),
+                            reinterpret_cast<unsigned char*>(out.data()),
+                            width);
+                        REQUIRE(out == expected);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Premultiplied blending matches straight blending", "[blend]") {
+    const auto format = sdl::pixel_format::argb8888;
+    const auto src = random_pixels(200, 5, 0xFF000000u);
+    const auto dst = random_pixels(200, 6, 0xFF000000u);
+
+    // Premultiply rounding down, as the straight blend does; the results
+    // of sdl::premultiply_alpha(), which rounds, may differ by one
+    std::vector<uint32_t> pm(src.size());
+    for (size_t i = 0; i < src.size(); i++) {
+        const uint32_t a = src[i] >> 24;
+        pm[i] = a << 24;
+        for (int c = 0; c < 24; c += 8) {
+            pm[i] |= (((src[i] >> c) & 0xFF) * a / 255) << c;
+        }
+    }
+
+    for (auto mode : {sdl::blend_mode::blend, sdl::blend_mode::add}) {
+        auto straight = dst;
+        sdl::blend_span(mode, format, src.data(), straight.data(), src.size());
+        auto premultiplied = dst;
+        sdl::blend_span(mode, format, pm.data(), premultiplied.data(),
+                        pm.size(), sdl::blend_alpha::premultiplied);
+        REQUIRE(premultiplied == straight);
+    }
+}
+
+TEST_CASE("Blending rejects unsupported formats", "[blend]") {
+    std::vector<uint32_t> src(4), dst(4);
+    const auto r = sdl::try_blend_span(sdl::blend_mode::blend,
+                                       sdl::pixel_format::rgb888, src.data(),
+                                       dst.data(), src.size());
+    REQUIRE_FALSE(r);
+    REQUIRE_THROWS_AS(sdl::blend_span(sdl::blend_mode::add,
+                                      sdl::pixel_format::rgb565, src.data(),
+                                      dst.data(), src.size()),
+                      sdl::error);
+
+    sdl::surface a{4, 4, sdl::pixel_format::rgba8888};
+    sdl::surface b{4, 4, sdl::pixel_format::argb8888};
+    REQUIRE_FALSE(sdl::try_blend_rect(sdl::blend_mode::blend, a, b, 0, 0));
+
+    const auto small = sdl::pixel_view<const uint32_t>{src.data(), 2, 2, 8};
+    const auto large = sdl::pixel_view<uint32_t>{dst.data(), 4, 1, 16};
+    REQUIRE_FALSE(sdl::try_blend_rect(sdl::blend_mode::blend,
+                                      sdl::pixel_format::rgba8888, small,
+                                      large));
+}
+
+TEST_CASE("Blend engine vs SDL_BlitSurface", "[.][benchmark][blend]") {
+    using std::chrono::steady_clock;
+    using sdl::detail::simd_level;
+    using seconds = std::chrono::duration<double>;
+
+    constexpr int size = 512;
+    constexpr int iterations = 20;
+    constexpr double mpixels = double(size) * size * iterations / 1e6;
+    const auto format = sdl::pixel_format::argb8888;
+    const auto src = make_surface(size, size, format, 7, 0xFF000000u);
+    auto dst = make_surface(size, size, format, 8, 0xFF000000u);
+    const auto sv = src.view<uint32_t>();
+    const auto dv = dst.view<uint32_t>();
+
+    for (auto mode : all_modes) {
+        std::ostringstream report;
+        report << "blend_mode " << static_cast<int>(mode) << " (MP/s):";
+
+        SDL_SetSurfaceBlendMode(const_cast<SDL_Surface*>(src.get()),
+                                static_cast<SDL_BlendMode>(mode));
+        auto start = steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            SDL_BlitSurface(const_cast<SDL_Surface*>(src.get()), nullptr,
+                            dst.get(), nullptr);
+        }
+        seconds elapsed = steady_clock::now() - start;
+        report << " SDL_BlitSurface " << mpixels / elapsed.count();
+
+        const auto names = {"scalar", "SSE2", "AVX2"};
+        auto name = names.begin();
+        for (auto level : simd_levels()) {
+            const auto row = sdl::detail::select_blend_row(
+                mode, sdl::blend_alpha::straight, level);
+            if (!row) { break; }
+            start = steady_clock::now();
+            for (int i = 0; i < iterations; i++) {
+                for (int y = 0; y < size; y++) {
+                    row(3,
+                        reinterpret_cast<const unsigned char*>(
+                            sv.row(y).data()),
+                        reinterpret_cast<unsigned char*>(dv.row(y).data()),
+                        size);
+                }
+            }
+            elapsed = steady_clock::now() - start;
+            report << ", " << *name++ << " " << mpixels / elapsed.count();
+        }
+        if (mode == sdl::blend_mode::none) {
+            start = steady_clock::now();
+            for (int i = 0; i < iterations; i++) {
+                sdl::blend_rect(mode, src, dst, 0, 0);
+            }
+            elapsed = steady_clock::now() - start;
+            report << ", blend_rect " << mpixels / elapsed.count();
+        }
+        WARN(report.str());
+    }
+}
@@ -3,6 +3,10 @@
 
 #include "catch.hpp"
 
+#include <chrono>
+#include <string>
+#include <vector>
+
 TEST_CASE("SDL_clipboard.h is wrapped correctly", "clipboard") {
 
     SDL_Init(SDL_INIT_VIDEO);
@@ -20,6 +24,12 @@ TEST_CASE("SDL_clipboard.h is wrapped correctly", "clipboard") {
         SECTION("SDL_GetClipboardText() is wrapped correctly") {
             REQUIRE(sdl::get_clipboard_text() == test_str);
         }
+
+        SECTION("Clipboard text can be read without copying") {
+            const auto text = sdl::get_clipboard_text<sdl::sdl_string>();
+            REQUIRE(text == test_str);
+            REQUIRE(text.size() == SDL_strlen(test_str));
+        }
     }
 
     SECTION("Clipboard text can be set") {
@@ -30,6 +40,132 @@ TEST_CASE("SDL_clipboard.h is wrapped correctly", "clipboard") {
         REQUIRE(SDL_strcmp(SDL_GetClipboardText(), test_str) == 0);
     }
 
+    SECTION("Clipboard text can be set without throwing") {
+        REQUIRE(sdl::try_set_clipboard_text(test_str));
+        REQUIRE(SDL_strcmp(SDL_GetClipboardText(), test_str) == 0);
+
+        REQUIRE(sdl::try_set_clipboard_text(sdl::string(test_str)));
+        REQUIRE(SDL_strcmp(SDL_GetClipboardText(), test_str) == 0);
+    }
+
     // SDL_SetClipboardText(nullptr);
     SDL_Quit();
 }
+
+TEST_CASE("The clipboard can be accessed asynchronously", "clipboard") {
+    SDL_Init(SDL_INIT_VIDEO);
+    SDL_SetClipboardText("");
+
+    sdl::async_clipboard clipboard;
+    clipboard.wait_idle();
+    REQUIRE_FALSE(clipboard.has_text());
+
+    SECTION("Text can be set and read back in order") {
+        auto set = clipboard.set_text(sdl::string(u8"Async \u2713"));
+        auto get = clipboard.get_text();
+        REQUIRE_NOTHROW(set.get());
+        REQUIRE(get.get() == u8"Async \u2713");
+        REQUIRE(clipboard.has_text());
+
+        clipboard.set_text(sdl::sdl_string{SDL_strdup("owned")}).get();
+        REQUIRE(clipboard.get_text().get() == "owned");
+    }
+
+    SECTION("has_text() is refreshed by clipboard update events") {
+        SDL_SetClipboardText("changed elsewhere");
+        REQUIRE_FALSE(clipboard.has_text());
+
+        SDL_Event other{};
+        other.type = SDL_KEYDOWN;
+        REQUIRE_FALSE(clipboard.handle_event(other));
+
+        SDL_Event update{};
+        update.type = SDL_CLIPBOARDUPDATE;
+        REQUIRE(clipboard.handle_event(update));
+        clipboard.wait_idle();
+        REQUIRE(clipboard.has_text());
+    }
+
+    SDL_SetClipboardText("");
+    SDL_Quit();
+}
+
+TEST_CASE("The clipboard helper thread is refused on X11 and Wayland",
+          "clipboard") {
+    SDL_Init(SDL_INIT_VIDEO);
+
+    const char* driver = SDL_GetCurrentVideoDriver();
+    if (driver && (SDL_strcmp(driver, "x11") == 0 ||
+                   SDL_strcmp(driver, "wayland") == 0)) {
+        REQUIRE_THROWS_AS(sdl::async_clipboard{}, sdl::error);
+    } else {
+        REQUIRE_NOTHROW(sdl::async_clipboard{});
+    }
+
+    // A main thread queue may be used with any driver
+    sdl::main_thread_queue<> queue;
+    REQUIRE_NOTHROW(sdl::async_clipboard{queue});
+
+    SDL_Quit();
+}
+
+TEST_CASE("Asynchronous clipboard requests can run on the main thread",
+          "clipboard") {
+    SDL_Init(SDL_INIT_VIDEO);
+    SDL_SetClipboardText("");
+
+    sdl::main_thread_queue<> queue;
+    sdl::async_clipboard clipboard{queue};
+    auto set = clipboard.set_text(sdl::string("main thread"));
+    auto get = clipboard.get_text();
+
+    // Nothing happens until the queue is drained
+    REQUIRE(get.wait_for(std::chrono::seconds{0}) ==
+            std::future_status::timeout);
+    REQUIRE(queue.drain() == 3);
+    REQUIRE_NOTHROW(set.get());
+    REQUIRE(get.get() == "main thread");
+    REQUIRE(clipboard.has_text());
+
+    SDL_SetClipboardText("");
+    SDL_Quit();
+}
+
+TEST_CASE("Asynchronous vs synchronous clipboard access",
+          "[.][benchmark][clipboard]") {
+    using std::chrono::steady_clock;
+    using ms = std::chrono::duration<double, std::milli>;
+
+    SDL_Init(SDL_INIT_VIDEO);
+    const sdl::string payload(8 * 1024 * 1024, 'x');
+    constexpr int rounds = 10;
+    size_t total = 0;
+
+    auto start = steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        sdl::set_clipboard_text(payload);
+        total += sdl::get_clipboard_text().size();
+    }
+    const ms sync = steady_clock::now() - start;
+
+    // Each payload is moved into the clipboard rather than copied
+    std::vector<sdl::string> payloads(rounds, payload);
+    sdl::async_clipboard clipboard;
+    start = steady_clock::now();
+    std::vector<std::future<sdl::sdl_string>> reads;
+    for (int i = 0; i < rounds; i++) {
+        clipboard.set_text(std::move(payloads[i]));
+        reads.push_back(clipboard.get_text());
+    }
+    const ms submit = steady_clock::now() - start;
+    for (auto& r : reads) { total += r.get().size(); }
+    const ms async = steady_clock::now() - start;
+
+    WARN(rounds << " 8MB round trips: synchronous " << sync.count()
+                << " ms, async_clipboard " << submit.count()
+                << " ms on the calling thread, " << async.count()
+                << " ms in total (" << total << " bytes)");
+
+    SDL_SetClipboardText("");
+    SDL_Quit();
+}
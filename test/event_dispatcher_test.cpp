@@ -0,0 +1,154 @@
+
+#include <sdl++/event_dispatcher.hpp>
+
+#include "catch.hpp"
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace {
+
+SDL_Event make_event(uint32_t type) {
+    SDL_Event event{};
+    event.type = type;
+    return event;
+}
+
+int free_function_calls = 0;
+
+void on_quit(const SDL_QuitEvent&) { ++free_function_calls; }
+}
+
+TEST_CASE("Built-in event types map to the right structures",
+          "[event_dispatcher]") {
+    using sdl::detail::event_kind;
+    using sdl::detail::event_kind_of;
+
+    REQUIRE(event_kind(SDL_FIRSTEVENT) == 0);
+    REQUIRE(event_kind(SDL_APP_TERMINATING) == 0);
+    REQUIRE(event_kind(SDL_KEYDOWN) == event_kind(SDL_KEYUP));
+    REQUIRE(event_kind(SDL_KEYDOWN) != event_kind(SDL_TEXTINPUT));
+    REQUIRE(event_kind(SDL_CONTROLLERDEVICEREMAPPED) ==
+            event_kind_of(SDL_CONTROLLERDEVICEADDED));
+    REQUIRE(event_kind(SDL_USEREVENT + 100) == event_kind(SDL_USEREVENT));
+    REQUIRE(event_kind(SDL_LASTEVENT) == 0);
+    REQUIRE(event_kind(0x7000) == 0);
+
+    static_assert(event_kind_of(SDL_MOUSEMOTION) != 0,
+                  "Kinds are computed at compile time");
+}
+
+TEST_CASE("Events are dispatched to typed handlers", "[event_dispatcher]") {
+    int quits = 0;
+    std::vector<SDL_Keycode> keys;
+    int motion_x = 0;
+
+    auto dispatcher = sdl::make_event_dispatcher(
+        [&](const SDL_QuitEvent&) { ++quits; },
+        [&](const SDL_KeyboardEvent& e) { keys.push_back(e.keysym.sym); },
+        [&](SDL_MouseMotionEvent e) { motion_x = e.x; });
+
+    REQUIRE(dispatcher.dispatch(make_event(SDL_QUIT)));
+    REQUIRE(quits == 1);
+
+    auto down = make_event(SDL_KEYDOWN);
+    down.key.keysym.sym = 'a';
+    auto up = make_event(SDL_KEYUP);
+    up.key.keysym.sym = 'b';
+    REQUIRE(dispatcher.dispatch(down));
+    REQUIRE(dispatcher.dispatch(up));
+    REQUIRE(keys == (std::vector<SDL_Keycode>{'a', 'b'}));
+
+    auto motion = make_event(SDL_MOUSEMOTION);
+    motion.motion.x = 42;
+    REQUIRE(dispatcher.dispatch(motion));
+    REQUIRE(motion_x == 42);
+
+    // Types without a handler are ignored
+    REQUIRE_FALSE(dispatcher.dispatch(make_event(SDL_MOUSEBUTTONDOWN)));
+    REQUIRE_FALSE(dispatcher.dispatch(make_event(SDL_USEREVENT)));
+    REQUIRE_FALSE(dispatcher.dispatch(make_event(SDL_APP_LOWMEMORY)));
+
+    REQUIRE(decltype(dispatcher)::handles(SDL_KEYUP));
+    REQUIRE_FALSE(decltype(dispatcher)::handles(SDL_MOUSEWHEEL));
+}
+
+TEST_CASE("A handler for SDL_Event receives unhandled events",
+          "[event_dispatcher]") {
+    std::vector<uint32_t> others;
+    int users = 0;
+
+    auto dispatcher = sdl::make_event_dispatcher(
+        [&](const SDL_Event& e) { others.push_back(e.type); },
+        [&](const SDL_UserEvent& e) { users += e.code; }, &on_quit);
+
+    const SDL_Event events[] = {make_event(SDL_QUIT),
+                                make_event(SDL_APP_LOWMEMORY),
+                                make_event(SDL_USEREVENT + 5),
+                                make_event(SDL_WINDOWEVENT)};
+    free_function_calls = 0;
+    REQUIRE(dispatcher.dispatch(events) == 4);
+
+    REQUIRE(free_function_calls == 1);
+    REQUIRE(users == 0);
+    REQUIRE(others ==
+            (std::vector<uint32_t>{SDL_APP_LOWMEMORY, SDL_WINDOWEVENT}));
+}
+
+TEST_CASE("event_dispatcher vs switch and std::function",
+          "[.][benchmark][event_dispatcher]") {
+    using std::chrono::steady_clock;
+    using ms = std::chrono::duration<double, std::milli>;
+
+    const uint32_t types[] = {SDL_MOUSEMOTION, SDL_KEYDOWN, SDL_KEYUP,
+                              SDL_MOUSEBUTTONDOWN, SDL_CONTROLLERAXISMOTION,
+                              SDL_WINDOWEVENT, SDL_TEXTINPUT, SDL_MOUSEWHEEL};
+    std::vector<SDL_Event> events;
+    for (int i = 0; i < 1000000; i++) {
+        auto e = make_event(types[(i * 7) % 8]);
+        e.motion.x = i;
+        events.push_back(e);
+    }
+
+    long sum = 0;
+    auto start = steady_clock::now();
+    for (const auto& e : events) {
+        switch (e.type) {
+        case SDL_MOUSEMOTION: sum += e.motion.x; break;
+        case SDL_KEYDOWN: sum += e.key.keysym.sym; break;
+        case SDL_KEYUP: sum -= e.key.keysym.sym; break;
+        case SDL_CONTROLLERAXISMOTION: sum += e.caxis.value; break;
+        }
+    }
+    const ms switched = steady_clock::now() - start;
+
+    start = steady_clock::now();
+    std::map<uint32_t, std::function<void(const SDL_Event&)>> map{
+        {SDL_MOUSEMOTION, [&](const SDL_Event& e) { sum += e.motion.x; }},
+        {SDL_KEYDOWN, [&](const SDL_Event& e) { sum += e.key.keysym.sym; }},
+        {SDL_KEYUP, [&](const SDL_Event& e) { sum -= e.key.keysym.sym; }},
+        {SDL_CONTROLLERAXISMOTION,
+         [&](const SDL_Event& e) { sum += e.caxis.value; }}};
+    for (const auto& e : events) {
+        const auto it = map.find(e.type);
+        if (it != map.end()) { it->second(e); }
+    }
+    const ms function_map = steady_clock::now() - start;
+
+    start = steady_clock::now();
+    auto dispatcher = sdl::make_event_dispatcher(
+        [&](const SDL_MouseMotionEvent& e) { sum += e.x; },
+        [&](const SDL_KeyboardEvent& e) {
+            sum += e.type == SDL_KEYDOWN ? e.keysym.sym : -e.keysym.sym;
+        },
+        [&](const SDL_ControllerAxisEvent& e) { sum += e.value; });
+    dispatcher.dispatch(events);
+    const ms dispatched = steady_clock::now() - start;
+
+    WARN(events.size() << " events: switch " << switched.count()
+                       << " ms, std::function map " << function_map.count()
+                       << " ms, event_dispatcher "
+                       << dispatched.count() << " ms (" << sum << ")");
+}
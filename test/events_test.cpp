@@ -0,0 +1,420 @@
+
+#include <sdl++/events.hpp>
+
+#include "catch.hpp"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace {
+
+void push_user_events(int count, int first_code = 0) {
+    for (int i = 0; i < count; i++) {
+        SDL_Event event{};
+        event.type = SDL_USEREVENT;
+        event.user.code = first_code + i;
+        SDL_PushEvent(&event);
+    }
+}
+}
+
+TEST_CASE("event_pump drains the queue in order", "[events]") {
+    SDL_Init(SDL_INIT_EVENTS);
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+    sdl::event_pump pump{4};
+    REQUIRE(pump.capacity() == 4);
+    REQUIRE(pump.poll().empty());
+
+    SECTION("Fewer events than the capacity") {
+        push_user_events(3);
+        const auto events = pump.poll();
+        REQUIRE(events.size() == 3);
+        for (int i = 0; i < 3; i++) { REQUIRE(events[i].user.code == i); }
+        REQUIRE(pump.capacity() == 4);
+        REQUIRE_FALSE(SDL_HasEvents(SDL_FIRSTEVENT, SDL_LASTEVENT));
+    }
+
+    SECTION("The buffer grows when more events are waiting") {
+        push_user_events(37);
+        const auto events = pump.poll();
+        REQUIRE(events.size() == 37);
+        int expected = 0;
+        for (const SDL_Event& e : events) {
+            REQUIRE(e.user.code == expected++);
+        }
+        REQUIRE(pump.capacity() >= 37);
+        REQUIRE(pump.events().size() == 37);
+    }
+
+    SECTION("Each poll returns only new events") {
+        push_user_events(2);
+        REQUIRE(pump.poll().size() == 2);
+        push_user_events(1, 10);
+        const auto events = pump.drain();
+        REQUIRE(events.size() == 1);
+        REQUIRE(events[0].user.code == 10);
+        REQUIRE(pump.try_poll().value().empty());
+    }
+
+    SDL_Quit();
+}
+
+TEST_CASE("event_pump can merge motion events", "[events]") {
+    SDL_Init(SDL_INIT_EVENTS);
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+    auto push_motion = [](uint32_t window, int x, int xrel) {
+        SDL_Event e{};
+        e.type = SDL_MOUSEMOTION;
+        e.motion.windowID = window;
+        e.motion.x = x;
+        e.motion.xrel = xrel;
+        e.motion.yrel = 1;
+        SDL_PushEvent(&e);
+    };
+    auto push_axis = [](uint32_t type, int which, int axis, int value) {
+        SDL_Event e{};
+        e.type = type;
+        e.jaxis.which = which;
+        e.jaxis.axis = static_cast<Uint8>(axis);
+        e.jaxis.value = static_cast<Sint16>(value);
+        SDL_PushEvent(&e);
+    };
+    auto push_type = [](uint32_t type) {
+        SDL_Event e{};
+        e.type = type;
+        SDL_PushEvent(&e);
+    };
+
+    SECTION("Coalescing is off by default") {
+        sdl::event_pump pump;
+        REQUIRE(pump.get_coalescing() == sdl::coalesce::none);
+        push_motion(1, 10, 1);
+        push_motion(1, 11, 1);
+        REQUIRE(pump.poll().size() == 2);
+        REQUIRE(pump.merge_counts().empty());
+    }
+
+    SECTION("Mouse motion is merged per window") {
+        sdl::event_pump pump{sdl::coalesce::mouse_motion};
+        for (int i = 0; i < 100; i++) {
+            push_motion(1, i, 2);
+            push_motion(2, -i, -1);
+        }
+        push_type(SDL_MOUSEBUTTONDOWN);
+        push_motion(1, 500, 3);
+
+        const auto events = pump.poll();
+        REQUIRE(pump.raw_count() == 202);
+        REQUIRE(events.size() == 4);
+
+        REQUIRE(events[0].motion.windowID == 1);
+        REQUIRE(events[0].motion.x == 99);
+        REQUIRE(events[0].motion.xrel == 200);
+        REQUIRE(events[0].motion.yrel == 100);
+        REQUIRE(events[1].motion.windowID == 2);
+        REQUIRE(events[1].motion.x == -99);
+        REQUIRE(events[1].motion.xrel == -100);
+
+        // Motion after another event is not merged with motion before it
+        REQUIRE(events[2].type == SDL_MOUSEBUTTONDOWN);
+        REQUIRE(events[3].motion.x == 500);
+        REQUIRE(events[3].motion.xrel == 3);
+
+        const auto counts = pump.merge_counts();
+        REQUIRE(counts.size() == 4);
+        REQUIRE(counts[0] == 100);
+        REQUIRE(counts[1] == 100);
+        REQUIRE(counts[2] == 1);
+        REQUIRE(counts[3] == 1);
+    }
+
+    SECTION("Axis motion is merged per device and axis") {
+        sdl::event_pump pump{sdl::coalesce::joystick_axes |
+                             sdl::coalesce::controller_axes};
+        push_axis(SDL_JOYAXISMOTION, 0, 0, 1);
+        push_axis(SDL_JOYAXISMOTION, 0, 1, 2);
+        push_axis(SDL_JOYAXISMOTION, 0, 0, 3);
+        push_axis(SDL_CONTROLLERAXISMOTION, 0, 0, 4);
+        push_axis(SDL_JOYAXISMOTION, 1, 0, 5);
+        push_axis(SDL_CONTROLLERAXISMOTION, 0, 0, 6);
+        // Mouse motion is not merged by this pump, so it ends the run
+        push_motion(1, 0, 0);
+        push_motion(1, 0, 0);
+        push_axis(SDL_JOYAXISMOTION, 0, 1, 7);
+
+        const auto events = pump.poll();
+        REQUIRE(events.size() == 7);
+        REQUIRE(events[0].jaxis.value == 3);
+        REQUIRE(events[1].jaxis.value == 2);
+        REQUIRE(events[2].type == SDL_CONTROLLERAXISMOTION);
+        REQUIRE(events[2].caxis.value == 6);
+        REQUIRE(events[3].jaxis.which == 1);
+        REQUIRE(events[4].type == SDL_MOUSEMOTION);
+        REQUIRE(events[5].type == SDL_MOUSEMOTION);
+        REQUIRE(events[6].jaxis.value == 7);
+        REQUIRE(pump.merge_counts()[0] == 2);
+        REQUIRE(pump.merge_counts()[2] == 2);
+    }
+
+    SDL_Quit();
+}
+
+TEST_CASE("event_filter drops events before they are queued", "[events]") {
+    SDL_Init(SDL_INIT_EVENTS);
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+    int first_calls = 0;
+    int second_calls = 0;
+    {
+        sdl::event_filter filter{
+            sdl::drop_event_types{SDL_MOUSEMOTION, SDL_FINGERMOTION},
+            [&](const SDL_Event&) {
+                ++first_calls;
+                return true;
+            },
+            [&](const SDL_Event& e) {
+                ++second_calls;
+                return e.type != SDL_USEREVENT || e.user.code % 2 == 0;
+            }};
+
+        SDL_Event motion{};
+        motion.type = SDL_MOUSEMOTION;
+        SDL_PushEvent(&motion);
+        push_user_events(4);
+
+        // The chain stops at the first filter to drop an event
+        REQUIRE(first_calls == 4);
+        REQUIRE(second_calls == 4);
+
+        sdl::event_pump pump;
+        const auto events = pump.poll();
+        REQUIRE(events.size() == 2);
+        REQUIRE(events[0].user.code == 0);
+        REQUIRE(events[1].user.code == 2);
+
+        // Moving the handle leaves the installed filter untouched
+        sdl::event_filter moved = std::move(filter);
+        push_user_events(2);
+        REQUIRE(pump.poll().size() == 1);
+    }
+
+    // The previous (empty) filter is restored
+    SDL_EventFilter current = nullptr;
+    void* userdata = nullptr;
+    REQUIRE_FALSE(SDL_GetEventFilter(&current, &userdata));
+    push_user_events(2);
+    REQUIRE(sdl::event_pump{}.poll().size() == 2);
+    SDL_Quit();
+}
+
+TEST_CASE("Nested event_filters restore their predecessor", "[events]") {
+    SDL_Init(SDL_INIT_EVENTS);
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+    auto drop_code = [](int code) {
+        return [code](const SDL_Event& e) { return e.user.code != code; };
+    };
+    sdl::event_pump pump;
+
+    sdl::event_filter outer{drop_code(0)};
+    {
+        sdl::event_filter inner{drop_code(1)};
+        push_user_events(3);
+        const auto events = pump.poll();
+        REQUIRE(events.size() == 2);
+        REQUIRE(events[0].user.code == 0);
+    }
+    push_user_events(3);
+    const auto events = pump.poll();
+    REQUIRE(events.size() == 2);
+    REQUIRE(events[0].user.code == 1);
+
+    // An empty filter does nothing
+    { sdl::event_filter empty; }
+    push_user_events(1);
+    REQUIRE(pump.poll().empty());
+    SDL_Quit();
+}
+
+TEST_CASE("event_filters may be destroyed in any order", "[events]") {
+    SDL_Init(SDL_INIT_EVENTS);
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+    auto drop_code = [](int code) {
+        return [code](const SDL_Event& e) { return e.user.code != code; };
+    };
+    sdl::event_pump pump;
+
+    auto first = std::make_unique<sdl::event_filter>(drop_code(0));
+    auto second = std::make_unique<sdl::event_filter>(drop_code(1));
+
+    // The second filter stays installed
+    first.reset();
+    push_user_events(3);
+    auto events = pump.poll();
+    REQUIRE(events.size() == 2);
+    REQUIRE(events[0].user.code == 0);
+
+    // The first filter, which has been destroyed, is not restored
+    second.reset();
+    SDL_EventFilter current = nullptr;
+    void* userdata = nullptr;
+    REQUIRE_FALSE(SDL_GetEventFilter(&current, &userdata));
+    push_user_events(3);
+    REQUIRE(pump.poll().size() == 3);
+
+    SDL_Quit();
+}
+
+TEST_CASE("event_watch sees every queued event", "[events]") {
+    SDL_Init(SDL_INIT_EVENTS);
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+    std::vector<int> seen;
+    int other = 0;
+    {
+        sdl::event_watch watch{
+            [&](const SDL_Event& e) { seen.push_back(e.user.code); }};
+        sdl::event_watch second{[&](const SDL_Event&) { ++other; }};
+        push_user_events(3);
+
+        sdl::event_watch moved;
+        moved = std::move(watch);
+        push_user_events(2, 3);
+    }
+    push_user_events(2, 5);
+
+    REQUIRE(seen == (std::vector<int>{0, 1, 2, 3, 4}));
+    REQUIRE(other == 5);
+    REQUIRE(sdl::event_pump{}.poll().size() == 7);
+    SDL_Quit();
+}
+
+TEST_CASE("event_pump vs SDL_PollEvent", "[.][benchmark][events]") {
+    using std::chrono::steady_clock;
+    using ms = std::chrono::duration<double, std::milli>;
+
+    SDL_Init(SDL_INIT_EVENTS);
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+    // SDL's queue holds at most 65535 events, so 100k events are pushed in
+    // batches, each drained before the next is pushed. Only draining is
+    // timed.
+    constexpr int total = 100000;
+    constexpr int batch = 10000;
+    long sum = 0;
+
+    ms polling{0};
+    for (int pushed = 0; pushed < total; pushed += batch) {
+        push_user_events(batch);
+        const auto start = steady_clock::now();
+        SDL_Event event;
+        while (SDL_PollEvent(&event)) { sum += event.user.code; }
+        polling += steady_clock::now() - start;
+    }
+
+    sdl::event_pump pump;
+    ms pumped{0};
+    for (int pushed = 0; pushed < total; pushed += batch) {
+        push_user_events(batch);
+        const auto start = steady_clock::now();
+        for (const SDL_Event& event : pump.poll()) { sum += event.user.code; }
+        pumped += steady_clock::now() - start;
+    }
+
+    WARN(total << " events: SDL_PollEvent " << polling.count()
+               << " ms, event_pump " << pumped.count() << " ms (" << sum
+               << ")");
+    SDL_Quit();
+}
+
+TEST_CASE("Handling coalesced vs raw mouse motion", "[.][benchmark][events]") {
+    using std::chrono::steady_clock;
+    using ms = std::chrono::duration<double, std::milli>;
+
+    SDL_Init(SDL_INIT_EVENTS);
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+    // An 8kHz mouse produces about 133 motion events in a 60Hz frame
+    constexpr int frames = 1000;
+    constexpr int per_frame = 133;
+    long handled[2] = {0, 0};
+    ms elapsed[2] = {ms{0}, ms{0}};
+
+    // Stands in for an input layer doing real work for each event
+    auto handle = [](const SDL_Event& e) {
+        volatile long work = 0;
+        for (int i = 0; i < 200; i++) { work = work + e.motion.xrel * i; }
+    };
+
+    for (int mode = 0; mode < 2; mode++) {
+        sdl::event_pump pump{mode ? sdl::coalesce::all : sdl::coalesce::none};
+        for (int f = 0; f < frames; f++) {
+            for (int i = 0; i < per_frame; i++) {
+                SDL_Event e{};
+                e.type = SDL_MOUSEMOTION;
+                e.motion.x = i;
+                e.motion.xrel = 1;
+                SDL_PushEvent(&e);
+            }
+            const auto start = steady_clock::now();
+            for (const SDL_Event& e : pump.poll()) {
+                handle(e);
+                ++handled[mode];
+            }
+            elapsed[mode] += steady_clock::now() - start;
+        }
+    }
+
+    WARN(frames << " frames of " << per_frame << " motion events: raw "
+                << elapsed[0].count() << " ms (" << handled[0]
+                << " handled), coalesced " << elapsed[1].count() << " ms ("
+                << handled[1] << " handled)");
+    SDL_Quit();
+}
+
+TEST_CASE("Filtering vs draining unwanted events", "[.][benchmark][events]") {
+    using std::chrono::steady_clock;
+    using ms = std::chrono::duration<double, std::milli>;
+
+    SDL_Init(SDL_INIT_EVENTS);
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+    // A touch screen producing a burst of motion among a few useful events
+    constexpr int frames = 1000;
+    constexpr int per_frame = 200;
+    long kept[2] = {0, 0};
+    ms elapsed[2] = {ms{0}, ms{0}};
+
+    auto push_frame = [] {
+        for (int i = 0; i < per_frame; i++) {
+            SDL_Event e{};
+            e.type = i % 50 == 0 ? SDL_USEREVENT : SDL_FINGERMOTION;
+            SDL_PushEvent(&e);
+        }
+    };
+
+    for (int mode = 0; mode < 2; mode++) {
+        sdl::event_filter filter;
+        if (mode) {
+            filter = sdl::event_filter{sdl::drop_event_types{SDL_FINGERMOTION}};
+        }
+        sdl::event_pump pump;
+        for (int f = 0; f < frames; f++) {
+            const auto start = steady_clock::now();
+            push_frame();
+            for (const SDL_Event& e : pump.poll()) {
+                if (e.type != SDL_FINGERMOTION) { ++kept[mode]; }
+            }
+            elapsed[mode] += steady_clock::now() - start;
+        }
+    }
+
+    WARN(frames << " frames of " << per_frame << " events: draining "
+                << elapsed[0].count() << " ms, filtering " << elapsed[1].count()
+                << " ms (" << kept[0] << "/" << kept[1] << " kept)");
+    SDL_Quit();
+}
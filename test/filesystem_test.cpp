@@ -3,6 +3,10 @@
 
 #include "catch.hpp"
 
+#include <chrono>
+#include <cstring>
+#include <string>
+
 using namespace std::string_literals;
 
 TEST_CASE("sdl::get_base_path() is wrapped correctly", "[filesystem]") {
@@ -48,3 +52,183 @@ TEST_CASE("sdl::get_pref_path(string, string) is wrapped correctly",
 
     SDL_free(c_path);
 }
+
+TEST_CASE("sdl::get_pref_path() accepts string_views", "[filesystem]") {
+    constexpr const char org[] = "com.github.tcbrindle/ignored";
+    constexpr const char app[] = "sdl++ Test";
+
+    char* c_path = SDL_GetPrefPath("com.github.tcbrindle", app);
+    const sdl::string_view org_view(org, 20);
+
+    if (c_path) {
+        REQUIRE(sdl::get_pref_path(org_view, app) == c_path);
+    } else {
+        REQUIRE_THROWS_AS(sdl::get_pref_path(org_view, app), sdl::error);
+    }
+
+    SDL_free(c_path);
+}
+
+TEST_CASE("sdl::get_base_path() can return an sdl_string", "[filesystem]") {
+    char* c_path = SDL_GetBasePath();
+
+    if (c_path) {
+        REQUIRE(sdl::get_base_path<sdl::sdl_string>() == c_path);
+    } else {
+        REQUIRE_THROWS_AS(sdl::get_base_path<sdl::sdl_string>(), sdl::error);
+    }
+
+    SDL_free(c_path);
+}
+
+TEST_CASE("sdl::get_pref_path() can return an sdl_string", "[filesystem]") {
+    constexpr const char org[] = "com.github.tcbrindle";
+    constexpr const char app[] = "sdl++ Test";
+
+    char* c_path = SDL_GetPrefPath(org, app);
+
+    if (c_path) {
+        REQUIRE(sdl::get_pref_path<sdl::sdl_string>(org, app) == c_path);
+    } else {
+        REQUIRE_THROWS_AS(sdl::get_pref_path<sdl::sdl_string>(org, app),
+                          sdl::error);
+    }
+
+    SDL_free(c_path);
+}
+
+TEST_CASE("sdl::try_get_base_path() is wrapped correctly", "[filesystem]") {
+    char* c_path = SDL_GetBasePath();
+
+    const auto path = sdl::try_get_base_path();
+    REQUIRE(path.has_value() == (c_path != nullptr));
+    if (c_path) { REQUIRE(*path == c_path); }
+
+    SDL_free(c_path);
+}
+
+TEST_CASE("sdl::try_get_pref_path() is wrapped correctly", "[filesystem]") {
+    constexpr const char org[] = "com.github.tcbrindle";
+    constexpr const char app[] = "sdl++ Test";
+
+    char* c_path = SDL_GetPrefPath(org, app);
+
+    const auto path = sdl::try_get_pref_path<sdl::sdl_string>(org, app);
+    REQUIRE(path.has_value() == (c_path != nullptr));
+    if (c_path) { REQUIRE(*path == c_path); }
+
+    SDL_free(c_path);
+}
+
+TEST_CASE("sdl::join_path() joins components", "[filesystem]") {
+    char buf[64];
+    const std::string sep(1, sdl::path_separator);
+
+    auto path = sdl::join_path(buf, "base" + sep, "textures", "hero.png");
+    REQUIRE(path);
+    REQUIRE(*path == "base" + sep + "textures" + sep + "hero.png");
+    REQUIRE(path->data() == buf);
+    REQUIRE(buf[path->size()] == '\0');
+
+    // Separators are not doubled, and empty components are skipped
+    path = sdl::join_path(buf, "base", "", sep + "file");
+    REQUIRE(path);
+    REQUIRE(*path == "base" + sep + "file");
+
+    path = sdl::join_path(buf, "file.txt");
+    REQUIRE(path);
+    REQUIRE(*path == "file.txt");
+}
+
+TEST_CASE("sdl::join_path() fails if the buffer is too small",
+          "[filesystem]") {
+    char buf[8];
+    REQUIRE(sdl::join_path(buf, "abc", "def"));
+    REQUIRE_FALSE(sdl::join_path(buf, "abcd", "efg"));
+    REQUIRE_FALSE(sdl::join_path(buf, "abcdefgh"));
+
+    const auto r = sdl::join_path(buf, "abc", "defg");
+    REQUIRE_FALSE(r);
+    REQUIRE(std::string{r.error_message()} == "Path buffer too small");
+}
+
+TEST_CASE("sdl::path_buffer holds a joined path", "[filesystem]") {
+    sdl::path_buffer<16> buf;
+    REQUIRE(buf.capacity() == 16);
+    REQUIRE(buf.view().empty());
+
+    REQUIRE(buf.join("a", "b"));
+    REQUIRE(buf.view() == std::string{"a"} + sdl::path_separator + "b");
+    REQUIRE(std::strlen(buf.c_str()) == 3);
+
+    REQUIRE_FALSE(buf.join("a long path which", "does not fit"));
+    REQUIRE(buf.view().empty());
+    REQUIRE(*buf.c_str() == '\0');
+}
+
+TEST_CASE("sdl::paths caches the base and pref paths", "[filesystem]") {
+    constexpr const char org[] = "com.github.tcbrindle";
+    constexpr const char app[] = "sdl++ Test";
+
+    char* c_base = SDL_GetBasePath();
+    char* c_pref = SDL_GetPrefPath(org, app);
+
+    const sdl::paths paths{org, app};
+
+    if (c_base) {
+        const auto base = paths.base();
+        REQUIRE(base == c_base);
+        REQUIRE(paths.base().data() == base.data());
+
+        sdl::path_buffer<> buf;
+        const auto joined = paths.join_base(buf, "assets");
+        REQUIRE(joined);
+        REQUIRE(*joined == std::string{c_base} + "assets");
+    } else {
+        REQUIRE_FALSE(paths.try_base());
+        REQUIRE_THROWS_AS(paths.base(), sdl::error);
+    }
+
+    if (c_pref) {
+        const auto pref = paths.pref();
+        REQUIRE(pref == c_pref);
+        REQUIRE(paths.pref().data() == pref.data());
+
+        char buf[512];
+        REQUIRE(paths.join_pref(buf, "save.dat"));
+    } else {
+        REQUIRE_FALSE(paths.try_pref());
+    }
+
+    SDL_free(c_base);
+    SDL_free(c_pref);
+}
+
+TEST_CASE("Path joining", "[.][benchmark][filesystem]") {
+    using std::chrono::steady_clock;
+    using ms = std::chrono::duration<double, std::milli>;
+
+    constexpr int count = 50000;
+    const std::string base = "/home/user/games/my game/";
+    const std::string names[] = {"hero.png", "level01.map", "music.ogg",
+                                 "font.ttf"};
+    size_t total = 0;
+
+    auto start = steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        const auto path = base + "assets/" + names[i % 4];
+        total += path.size();
+    }
+    const ms concat = steady_clock::now() - start;
+
+    sdl::path_buffer<> buf;
+    start = steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        total += buf.join(base, "assets", names[i % 4])->size();
+    }
+    const ms joined = steady_clock::now() - start;
+
+    WARN(count << " paths: std::string concatenation " << concat.count()
+               << " ms, path_buffer " << joined.count() << " ms (" << total
+               << " chars)");
+}
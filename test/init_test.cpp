@@ -3,6 +3,9 @@
 
 #include "catch.hpp"
 
+#include <chrono>
+#include <string>
+
 namespace {
 
 inline void expect_initted(uint32_t flags) {
@@ -12,6 +15,11 @@ inline void expect_initted(uint32_t flags) {
 inline void expect_not_initted(uint32_t flags = SDL_INIT_EVERYTHING) {
     REQUIRE(SDL_WasInit(flags) == SDL_FALSE);
 }
+
+inline void use_dummy_drivers() {
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+}
 }
 
 TEST_CASE("sdl::init_flags behave as expected", "[init]") {
@@ -98,3 +106,234 @@ TEST_CASE("Can assign a subsystem_init_guard", "[init]") {
 
     expect_not_initted();
 }
+
+TEST_CASE("A lazy_init_guard does not initialize subsystems immediately",
+          "[init]") {
+    expect_not_initted();
+
+    {
+        sdl::lazy_init_guard guard{sdl::init_flags::events,
+                                   sdl::init_flags::timer};
+
+        REQUIRE(guard.requested() ==
+                (sdl::init_flags::events | sdl::init_flags::timer));
+        REQUIRE(guard.initialized() == sdl::init_flags::none);
+        REQUIRE(guard.init_times().empty());
+        expect_not_initted();
+    }
+
+    expect_not_initted();
+}
+
+TEST_CASE("A lazy_init_guard initializes subsystems on demand", "[init]") {
+    expect_not_initted();
+
+    {
+        sdl::lazy_init_guard guard{sdl::init_flags::events,
+                                   sdl::init_flags::timer};
+
+        sdl::require_subsystems(sdl::init_flags::timer);
+        expect_initted(SDL_INIT_TIMER);
+        expect_not_initted(SDL_INIT_EVENTS);
+        REQUIRE(guard.initialized() == sdl::init_flags::timer);
+
+        // Requiring a subsystem again has no effect
+        guard.require(sdl::init_flags::timer | sdl::init_flags::events);
+        expect_initted(SDL_INIT_TIMER | SDL_INIT_EVENTS);
+
+        const auto times = guard.init_times();
+        REQUIRE(times.size() == 2);
+        REQUIRE(times[0].subsystem == sdl::init_flags::timer);
+        REQUIRE(times[1].subsystem == sdl::init_flags::events);
+        REQUIRE(times[0].duration.count() >= 0);
+    }
+
+    expect_not_initted();
+}
+
+TEST_CASE("A lazy_init_guard ignores subsystems which were not requested",
+          "[init]") {
+    expect_not_initted();
+
+    {
+        sdl::lazy_init_guard guard{sdl::init_flags::events};
+
+        sdl::require_subsystems(sdl::init_flags::timer);
+        expect_not_initted();
+        REQUIRE(guard.initialized() == sdl::init_flags::none);
+    }
+
+    // Without an active lazy_init_guard, nothing happens
+    sdl::require_subsystems(sdl::init_flags::events);
+    expect_not_initted();
+}
+
+TEST_CASE("A lazy_init_guard can be moved", "[init]") {
+    expect_not_initted();
+
+    {
+        sdl::lazy_init_guard g1{sdl::init_flags::events};
+        {
+            auto g2 = std::move(g1);
+            sdl::require_subsystems(sdl::init_flags::events);
+            expect_initted(SDL_INIT_EVENTS);
+            REQUIRE(g2.initialized() == sdl::init_flags::events);
+        }
+        expect_not_initted();
+
+        // Another guard may be created once the first has been destroyed
+        sdl::lazy_init_guard g3{sdl::init_flags::events};
+        g3.require(sdl::init_flags::events);
+        expect_initted(SDL_INIT_EVENTS);
+    }
+
+    expect_not_initted();
+}
+
+TEST_CASE("Only one lazy_init_guard may be active", "[init]") {
+    sdl::lazy_init_guard guard{};
+    REQUIRE_THROWS_AS(sdl::lazy_init_guard{}, sdl::error);
+}
+
+TEST_CASE("Guards can be created without throwing", "[init]") {
+    expect_not_initted();
+
+    {
+        auto guard = sdl::init_guard::try_create(sdl::init_flags::events);
+        REQUIRE(guard);
+        expect_initted(SDL_INIT_EVENTS);
+
+        // Moving the guard out of the result does not shut down SDL
+        auto g2 = std::move(guard).value();
+        expect_initted(SDL_INIT_EVENTS);
+
+        auto sub = sdl::subsystem_init_guard::try_create(
+            {sdl::init_flags::timer});
+        REQUIRE(sub);
+        expect_initted(SDL_INIT_TIMER);
+    }
+
+    expect_not_initted();
+}
+
+TEST_CASE("A second lazy_init_guard reports a failed result", "[init]") {
+    auto guard = sdl::lazy_init_guard::try_create(sdl::init_flags::events);
+    REQUIRE(guard);
+
+    const auto second = sdl::lazy_init_guard::try_create({});
+    REQUIRE_FALSE(second);
+    REQUIRE(std::string{second.error_message()} ==
+            "An sdl::lazy_init_guard is already active");
+
+    REQUIRE(guard->try_require(sdl::init_flags::events));
+    REQUIRE(sdl::try_require_subsystems(sdl::init_flags::events));
+    expect_initted(SDL_INIT_EVENTS);
+}
+
+TEST_CASE("An async_init_guard initializes video on the calling thread",
+          "[init]") {
+    use_dummy_drivers();
+    expect_not_initted();
+
+    {
+        sdl::async_init_guard guard{sdl::init_flags::video,
+                                    sdl::init_flags::audio};
+
+        // Video is ready as soon as the constructor returns
+        REQUIRE(guard.is_ready(sdl::init_flags::video));
+
+        // SDL_WasInit() is not safe to call while other threads are still
+        // initializing subsystems
+        guard.wait(sdl::init_flags::audio);
+        REQUIRE(guard.is_ready(sdl::init_flags::audio));
+        expect_initted(SDL_INIT_VIDEO | SDL_INIT_EVENTS | SDL_INIT_TIMER |
+                       SDL_INIT_AUDIO);
+
+        // Events and timer are started before the background work
+        const auto times = guard.init_times();
+        REQUIRE(times.size() == 4);
+        REQUIRE(times[0].subsystem == sdl::init_flags::events);
+        REQUIRE(times[1].subsystem == sdl::init_flags::timer);
+    }
+
+    expect_not_initted();
+}
+
+TEST_CASE("An async_init_guard initializes joysticks in the background",
+          "[init]") {
+    use_dummy_drivers();
+    expect_not_initted();
+
+    {
+        sdl::async_init_guard guard{sdl::init_flags::gamecontroller,
+                                    sdl::init_flags::haptic};
+
+        guard.wait(sdl::init_flags::joystick);
+        REQUIRE(guard.is_ready(sdl::init_flags::gamecontroller));
+
+        guard.wait();
+        REQUIRE(guard.is_ready(sdl::init_flags::everything));
+        expect_initted(SDL_INIT_JOYSTICK | SDL_INIT_GAMECONTROLLER |
+                       SDL_INIT_HAPTIC);
+    }
+
+    expect_not_initted();
+}
+
+TEST_CASE("An async_init_guard can be created without throwing", "[init]") {
+    use_dummy_drivers();
+    expect_not_initted();
+
+    {
+        auto guard = sdl::async_init_guard::try_create(
+            {sdl::init_flags::video, sdl::init_flags::joystick});
+        REQUIRE(guard);
+        REQUIRE(guard->try_wait(sdl::init_flags::joystick));
+        REQUIRE(guard->try_wait());
+        expect_initted(SDL_INIT_VIDEO | SDL_INIT_JOYSTICK);
+    }
+
+    expect_not_initted();
+}
+
+TEST_CASE("An async_init_guard can be destroyed while still initializing",
+          "[init]") {
+    use_dummy_drivers();
+    expect_not_initted();
+
+    {
+        sdl::async_init_guard g1{sdl::init_flags::audio,
+                                 sdl::init_flags::joystick};
+        auto g2 = std::move(g1);
+    }
+
+    expect_not_initted();
+}
+
+TEST_CASE("Parallel subsystem initialization timing",
+          "[.][benchmark][init]") {
+    using std::chrono::steady_clock;
+    using ms = std::chrono::duration<double, std::milli>;
+    use_dummy_drivers();
+
+    const auto flags = sdl::init_flags::video | sdl::init_flags::audio |
+                       sdl::init_flags::gamecontroller |
+                       sdl::init_flags::haptic;
+
+    auto start = steady_clock::now();
+    { sdl::init_guard guard{flags}; }
+    const ms sequential = steady_clock::now() - start;
+
+    start = steady_clock::now();
+    ms until_video{};
+    {
+        sdl::async_init_guard guard{flags};
+        until_video = steady_clock::now() - start;
+        guard.wait();
+    }
+    const ms parallel = steady_clock::now() - start;
+
+    WARN("init_guard: " << sequential.count() << " ms, async_init_guard: "
+                        << parallel.count() << " ms (video ready after "
+                        << until_video.count() << " ms)");
+}
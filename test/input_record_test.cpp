@@ -0,0 +1,373 @@
+
+#include <sdl++/input_record.hpp>
+
+#include "catch.hpp"
+
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+namespace {
+
+constexpr const char test_file[] = "sdlxx_input_record_test.rec";
+
+struct event_env {
+    event_env() { SDL_Init(SDL_INIT_EVENTS); }
+    ~event_env() {
+        SDL_Quit();
+        std::remove(test_file);
+    }
+};
+
+std::vector<SDL_Event> drain_events() {
+    std::vector<SDL_Event> events;
+    SDL_Event e;
+    while (SDL_PollEvent(&e)) { events.push_back(e); }
+    return events;
+}
+
+SDL_Event key_event(uint32_t type, SDL_Scancode code) {
+    SDL_Event e{};
+    e.type = type;
+    e.key.windowID = 1;
+    e.key.state = type == SDL_KEYDOWN ? SDL_PRESSED : SDL_RELEASED;
+    e.key.keysym.scancode = code;
+    e.key.keysym.sym = -42;
+    e.key.keysym.mod = 3;
+    return e;
+}
+
+SDL_Event motion_event(int x, int y, int xrel, int yrel) {
+    SDL_Event e{};
+    e.type = SDL_MOUSEMOTION;
+    e.motion.windowID = 1;
+    e.motion.state = 1;
+    e.motion.x = x;
+    e.motion.y = y;
+    e.motion.xrel = xrel;
+    e.motion.yrel = yrel;
+    return e;
+}
+
+constexpr uint64_t end_of_time = std::numeric_limits<uint64_t>::max();
+}
+
+TEST_CASE("Varints round-trip correctly", "[input_record]") {
+    const uint64_t values[] = {0, 1, 127, 128, 300, 1ull << 32,
+                               std::numeric_limits<uint64_t>::max()};
+    std::vector<uint8_t> buf;
+    for (auto v : values) { sdl::detail::put_varint(buf, v); }
+
+    const uint8_t* p = buf.data();
+    for (auto v : values) {
+        uint64_t out = 0;
+        p = sdl::detail::get_varint(p, buf.data() + buf.size(), out);
+        REQUIRE(p != nullptr);
+        REQUIRE(out == v);
+    }
+    REQUIRE(p == buf.data() + buf.size());
+
+    uint64_t out = 0;
+    REQUIRE(sdl::detail::get_varint(buf.data(), buf.data() + 1, out) ==
+            buf.data() + 1);
+    REQUIRE(sdl::detail::get_varint(buf.data() + 5, buf.data() + 6, out) ==
+            nullptr);
+
+    const int64_t signed_values[] = {0, 1, -1, 1000, -1000,
+                                     std::numeric_limits<int64_t>::min(),
+                                     std::numeric_limits<int64_t>::max()};
+    for (auto v : signed_values) {
+        REQUIRE(sdl::detail::zigzag_decode(sdl::detail::zigzag_encode(v)) ==
+                v);
+    }
+    REQUIRE(sdl::detail::zigzag_encode(-1) == 1);
+    REQUIRE(sdl::detail::zigzag_encode(1) == 2);
+}
+
+TEST_CASE("Recorded events are replayed identically", "[input_record]") {
+    event_env env;
+
+    std::vector<SDL_Event> events;
+    events.push_back(key_event(SDL_KEYDOWN, SDL_SCANCODE_W));
+    events.push_back(motion_event(400, 300, 0, 0));
+    events.push_back(motion_event(402, 297, 2, -3));
+    events.push_back(key_event(SDL_KEYUP, SDL_SCANCODE_W));
+    {
+        SDL_Event e{};
+        e.type = SDL_MOUSEBUTTONDOWN;
+        e.button.windowID = 1;
+        e.button.button = 3;
+        e.button.state = SDL_PRESSED;
+        e.button.clicks = 2;
+        e.button.x = 390;
+        e.button.y = 310;
+        events.push_back(e);
+    }
+    {
+        SDL_Event e{};
+        e.type = SDL_TEXTINPUT;
+        e.text.windowID = 1;
+        SDL_memcpy(e.text.text, "hello", 6);
+        events.push_back(e);
+    }
+    {
+        SDL_Event e{};
+        e.type = SDL_CONTROLLERAXISMOTION;
+        e.caxis.which = 2;
+        e.caxis.axis = 1;
+        e.caxis.value = -32768;
+        events.push_back(e);
+    }
+    {
+        SDL_Event e{};
+        e.type = SDL_QUIT;
+        events.push_back(e);
+    }
+
+    {
+        sdl::input_recorder recorder{test_file};
+        for (const auto& e : events) { recorder.record(e); }
+    }
+
+    sdl::input_player player{test_file};
+    REQUIRE_FALSE(player.finished());
+    REQUIRE(player.advance_to(end_of_time) == int(events.size()));
+    REQUIRE(player.finished());
+
+    const auto replayed = drain_events();
+    REQUIRE(replayed.size() == events.size());
+
+    for (size_t i = 0; i < events.size(); i++) {
+        const auto& a = events[i];
+        const auto& b = replayed[i];
+        REQUIRE(a.type == b.type);
+        switch (a.type) {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            REQUIRE(a.key.windowID == b.key.windowID);
+            REQUIRE(a.key.state == b.key.state);
+            REQUIRE(a.key.keysym.scancode == b.key.keysym.scancode);
+            REQUIRE(a.key.keysym.sym == b.key.keysym.sym);
+            REQUIRE(a.key.keysym.mod == b.key.keysym.mod);
+            break;
+        case SDL_MOUSEMOTION:
+            REQUIRE(a.motion.x == b.motion.x);
+            REQUIRE(a.motion.y == b.motion.y);
+            REQUIRE(a.motion.xrel == b.motion.xrel);
+            REQUIRE(a.motion.yrel == b.motion.yrel);
+            REQUIRE(a.motion.state == b.motion.state);
+            break;
+        case SDL_MOUSEBUTTONDOWN:
+            REQUIRE(a.button.button == b.button.button);
+            REQUIRE(a.button.state == b.button.state);
+            REQUIRE(a.button.clicks == b.button.clicks);
+            REQUIRE(a.button.x == b.button.x);
+            REQUIRE(a.button.y == b.button.y);
+            break;
+        case SDL_TEXTINPUT:
+            REQUIRE(SDL_strcmp(a.text.text, b.text.text) == 0);
+            break;
+        case SDL_CONTROLLERAXISMOTION:
+            REQUIRE(a.caxis.which == b.caxis.which);
+            REQUIRE(a.caxis.axis == b.caxis.axis);
+            REQUIRE(a.caxis.value == b.caxis.value);
+            break;
+        }
+    }
+}
+
+TEST_CASE("Replayed drop strings are freed if not delivered",
+          "[input_record]") {
+    event_env env;
+
+    char name[] = "dropped.txt";
+    {
+        sdl::input_recorder recorder{test_file};
+        SDL_Event e{};
+        e.type = SDL_DROPFILE;
+        e.drop.file = name;
+        recorder.record(e);
+        recorder.record(e);
+    }
+
+    // Destroyed with a decoded event still pending
+    { sdl::input_player player{test_file}; }
+
+    // Every event is filtered out, so SDL never takes the strings
+    SDL_SetEventFilter([](void*, SDL_Event*) { return 0; }, nullptr);
+    {
+        sdl::input_player player{test_file};
+        REQUIRE(player.advance_to(end_of_time) == 0);
+        REQUIRE(player.finished());
+    }
+    SDL_SetEventFilter(nullptr, nullptr);
+    REQUIRE(drain_events().empty());
+
+    sdl::input_player player{test_file};
+    REQUIRE(player.advance_to(end_of_time) == 2);
+    for (auto& e : drain_events()) {
+        REQUIRE(e.type == SDL_DROPFILE);
+        REQUIRE(SDL_strcmp(e.drop.file, name) == 0);
+        SDL_free(e.drop.file);
+    }
+}
+
+TEST_CASE("Key state changes are replayed", "[input_record]") {
+    event_env env;
+
+    sdl::key_state s1{};
+    s1.set(sdl::scancode::a).set(sdl::scancode::lshift);
+    sdl::key_state s2 = s1;
+    s2.reset(sdl::scancode::a).set(sdl::scancode::app2);
+
+    {
+        sdl::input_recorder recorder{test_file};
+        recorder.record(s1);
+        recorder.record(s1); // unchanged, so not recorded
+        recorder.record(s2);
+    }
+
+    sdl::input_player player{test_file};
+    REQUIRE(player.keys().none());
+    REQUIRE(player.advance_to(0) == 0);
+    player.advance_to(end_of_time);
+    REQUIRE(player.keys() == s2);
+    REQUIRE(player.finished());
+}
+
+TEST_CASE("Assigning to a recorder keeps its buffered records",
+          "[input_record]") {
+    event_env env;
+    constexpr const char other_file[] = "sdlxx_input_record_test2.rec";
+
+    sdl::key_state keys{};
+    keys.set(sdl::scancode::b);
+    {
+        sdl::input_recorder recorder{test_file};
+        recorder.record(keys);
+        recorder = sdl::input_recorder{other_file};
+    }
+
+    sdl::input_player player{test_file};
+    player.advance_to(end_of_time);
+    REQUIRE(player.keys() == keys);
+    std::remove(other_file);
+}
+
+TEST_CASE("Replay respects recorded timing", "[input_record]") {
+    event_env env;
+
+    {
+        sdl::input_recorder recorder{test_file};
+        recorder.record(key_event(SDL_KEYDOWN, SDL_SCANCODE_A));
+        SDL_Delay(20);
+        recorder.record(key_event(SDL_KEYUP, SDL_SCANCODE_A));
+    }
+
+    sdl::input_player player{test_file};
+    const auto t0 = player.next_time();
+    REQUIRE(t0);
+    REQUIRE(player.advance_to(*t0) == 1);
+
+    const auto t1 = player.next_time();
+    REQUIRE(t1);
+    REQUIRE(*t1 - *t0 >= 20000);
+    REQUIRE(player.advance_to(*t1 - 1) == 0);
+    REQUIRE(player.advance_to(*t1) == 1);
+    REQUIRE_FALSE(player.next_time());
+}
+
+TEST_CASE("Recordings are compact", "[input_record]") {
+    event_env env;
+
+    constexpr int count = 10000;
+    uint64_t size = 0;
+    {
+        sdl::input_recorder recorder{test_file};
+        for (int i = 0; i < count; i++) {
+            recorder.record(motion_event(100 + i % 7, 100 - i % 5, 1, -1));
+        }
+        size = recorder.size();
+    }
+
+    // type, time delta, window, mouse, state, x, y, xrel, yrel
+    REQUIRE(size < count * 12);
+
+    sdl::input_player player{test_file};
+    REQUIRE(player.advance_to(end_of_time) == count);
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+}
+
+TEST_CASE("A truncated recording replays up to the truncation",
+          "[input_record]") {
+    event_env env;
+
+    {
+        sdl::input_recorder recorder{test_file};
+        recorder.record(key_event(SDL_KEYDOWN, SDL_SCANCODE_A));
+        recorder.record(key_event(SDL_KEYUP, SDL_SCANCODE_A));
+    }
+
+    // Chop the last byte off the file
+    std::vector<uint8_t> contents;
+    {
+        auto f = std::fopen(test_file, "rb");
+        int c;
+        while ((c = std::fgetc(f)) != EOF) {
+            contents.push_back(static_cast<uint8_t>(c));
+        }
+        std::fclose(f);
+        f = std::fopen(test_file, "wb");
+        std::fwrite(contents.data(), 1, contents.size() - 1, f);
+        std::fclose(f);
+    }
+
+    sdl::input_player player{test_file};
+    REQUIRE(player.advance_to(end_of_time) == 1);
+    REQUIRE(player.finished());
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+}
+
+TEST_CASE("Opening an invalid recording throws", "[input_record]") {
+    event_env env;
+
+    {
+        auto f = std::fopen(test_file, "wb");
+        std::fputs("This is not a recording", f);
+        std::fclose(f);
+    }
+
+    REQUIRE_THROWS_AS(sdl::input_player{test_file}, sdl::error);
+    REQUIRE_THROWS_AS(sdl::input_player{"no/such/file.rec"}, sdl::error);
+}
+
+TEST_CASE("Recordings can be opened without throwing", "[input_record]") {
+    event_env env;
+
+    {
+        auto recorder = sdl::input_recorder::try_open(test_file);
+        REQUIRE(recorder);
+        recorder->record(key_event(SDL_KEYDOWN, SDL_SCANCODE_A));
+        REQUIRE(recorder->try_flush());
+    }
+
+    auto player = sdl::input_player::try_open(test_file);
+    REQUIRE(player);
+    const auto count = player->try_advance_to(end_of_time);
+    REQUIRE(count);
+    REQUIRE(*count == 1);
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+    {
+        auto f = std::fopen(test_file, "wb");
+        std::fputs("This is not a recording", f);
+        std::fclose(f);
+    }
+
+    const auto invalid = sdl::input_player::try_open(test_file);
+    REQUIRE_FALSE(invalid);
+    REQUIRE(std::string{invalid.error_message()} ==
+            "Not a valid sdl++ input recording");
+    REQUIRE_FALSE(sdl::input_player::try_open("no/such/file.rec"));
+    REQUIRE_FALSE(sdl::input_recorder::try_open("no/such/dir/file.rec"));
+}
@@ -0,0 +1,184 @@
+
+#include <sdl++/keyboard.hpp>
+
+#include "catch.hpp"
+
+#include <vector>
+
+namespace {
+
+using sdl::scancode;
+
+std::vector<uint8_t> make_bytes(std::initializer_list<scancode> keys) {
+    std::vector<uint8_t> bytes(SDL_NUM_SCANCODES, 0);
+    for (auto k : keys) { bytes[static_cast<size_t>(k)] = 1; }
+    return bytes;
+}
+
+sdl::key_state make_state(std::initializer_list<scancode> keys) {
+    sdl::key_state state{};
+    for (auto k : keys) { state.set(k); }
+    return state;
+}
+
+std::vector<scancode> to_vector(const sdl::key_state& state) {
+    return std::vector<scancode>(state.begin(), state.end());
+}
+}
+
+TEST_CASE("A default-constructed key_state has no keys set", "[keyboard]") {
+    sdl::key_state state{};
+
+    REQUIRE(state.none());
+    REQUIRE_FALSE(state.any());
+    REQUIRE(state.count() == 0);
+    REQUIRE(state.begin() == state.end());
+}
+
+TEST_CASE("key_state can be constructed from keyboard state bytes",
+          "[keyboard]") {
+    const auto bytes = make_bytes(
+        {scancode::a, scancode::space, scancode::lshift, scancode::app2});
+    const sdl::key_state state{bytes.data(), int(bytes.size())};
+
+    for (size_t i = 0; i < bytes.size(); i++) {
+        REQUIRE(state.test(static_cast<scancode>(i)) == (bytes[i] != 0));
+    }
+    REQUIRE(state.count() == 4);
+    REQUIRE(state == make_state({scancode::a, scancode::space,
+                                 scancode::lshift, scancode::app2}));
+}
+
+TEST_CASE("key_state handles short keyboard state arrays", "[keyboard]") {
+    const uint8_t bytes[] = {0, 0, 0, 0, 1, 0, 1};
+    const sdl::key_state state{bytes, int(sizeof(bytes))};
+
+    REQUIRE(state == make_state({scancode::a, scancode::c}));
+}
+
+TEST_CASE("key_state::current() matches SDL_GetKeyboardState()",
+          "[keyboard]") {
+    int num_keys = 0;
+    const uint8_t* bytes = SDL_GetKeyboardState(&num_keys);
+    const auto state = sdl::key_state::current();
+
+    for (int i = 0; i < num_keys; i++) {
+        REQUIRE(state[static_cast<scancode>(i)] == (bytes[i] != 0));
+    }
+}
+
+TEST_CASE("key_state keys can be set and reset", "[keyboard]") {
+    sdl::key_state state{};
+
+    state.set(scancode::escape);
+    REQUIRE(state.test(scancode::escape));
+    REQUIRE(state.count() == 1);
+
+    state.set(scancode::escape, false);
+    REQUIRE_FALSE(state.test(scancode::escape));
+
+    state.set(scancode::f1).set(scancode::f2);
+    state.reset(scancode::f1);
+    REQUIRE(state == make_state({scancode::f2}));
+
+    state.reset();
+    REQUIRE(state.none());
+}
+
+TEST_CASE("key_state iteration visits set keys in order", "[keyboard]") {
+    const auto state = make_state({scancode::app2, scancode::a, scancode::up,
+                                   scancode::rgui, scancode::mode});
+
+    const std::vector<scancode> expected = {scancode::a, scancode::up,
+                                            scancode::rgui, scancode::mode,
+                                            scancode::app2};
+    REQUIRE(to_vector(state) == expected);
+
+    sdl::key_state all = ~sdl::key_state{};
+    REQUIRE(all.count() == SDL_NUM_SCANCODES);
+    int i = 0;
+    for (auto k : all) { REQUIRE(static_cast<int>(k) == i++); }
+    REQUIRE(i == SDL_NUM_SCANCODES);
+}
+
+TEST_CASE("key_state bitwise operations work correctly", "[keyboard]") {
+    const auto s1 = make_state({scancode::a, scancode::b, scancode::kp_0});
+    const auto s2 = make_state({scancode::b, scancode::c, scancode::app1});
+
+    REQUIRE((s1 | s2) == make_state({scancode::a, scancode::b, scancode::c,
+                                     scancode::kp_0, scancode::app1}));
+    REQUIRE((s1 & s2) == make_state({scancode::b}));
+    REQUIRE((s1 ^ s2) == make_state({scancode::a, scancode::c,
+                                     scancode::kp_0, scancode::app1}));
+    REQUIRE(s1.and_not(s2) == make_state({scancode::a, scancode::kp_0}));
+    REQUIRE((s1 & ~s2) == s1.and_not(s2));
+    REQUIRE(s1 != s2);
+}
+
+TEST_CASE("Key edges can be calculated between snapshots", "[keyboard]") {
+    const auto previous = make_state({scancode::w, scancode::lshift});
+    const auto current = make_state({scancode::w, scancode::space});
+
+    REQUIRE(sdl::keys_pressed(previous, current) ==
+            make_state({scancode::space}));
+    REQUIRE(sdl::keys_released(previous, current) ==
+            make_state({scancode::lshift}));
+    REQUIRE(sdl::keys_changed(previous, current) ==
+            make_state({scancode::space, scancode::lshift}));
+}
+
+TEST_CASE("Scancode names match SDL_GetScancodeName()", "[keyboard]") {
+    // The name table covers the scancodes of SDL 2.0.4, which end at App2;
+    // later versions name some higher codes
+    for (int i = 0; i <= SDL_SCANCODE_APP2; i++) {
+        const auto code = static_cast<scancode>(i);
+        const std::string expected =
+            SDL_GetScancodeName(static_cast<SDL_Scancode>(i));
+        // Older SDL versions may not know about some keys
+        if (!expected.empty()) {
+            REQUIRE(sdl::get_scancode_name(code) == expected);
+        }
+    }
+}
+
+TEST_CASE("Scancodes can be found from their names", "[keyboard]") {
+    for (int i = 0; i < SDL_NUM_SCANCODES; i++) {
+        const auto code = static_cast<scancode>(i);
+        const std::string name = sdl::get_scancode_name(code);
+        if (name.empty()) { continue; }
+
+        const auto found = sdl::get_scancode_from_name(name.c_str());
+        // Some names are duplicated, in which case the lowest code wins
+        REQUIRE(found <= code);
+        REQUIRE(sdl::get_scancode_name(found) == name);
+    }
+
+    REQUIRE(sdl::get_scancode_from_name("Return") == scancode::_return);
+}
+
+TEST_CASE("Scancode name lookup is case-insensitive", "[keyboard]") {
+    REQUIRE(sdl::get_scancode_from_name("escape") == scancode::escape);
+    REQUIRE(sdl::get_scancode_from_name("LEFT SHIFT") == scancode::lshift);
+    REQUIRE(sdl::get_scancode_from_name("keypad enter") ==
+            scancode::kp_enter);
+}
+
+TEST_CASE("Unknown scancode names are rejected", "[keyboard]") {
+    REQUIRE(sdl::get_scancode_from_name("") == scancode::unknown);
+    REQUIRE(sdl::get_scancode_from_name("Not a key") == scancode::unknown);
+    REQUIRE(sdl::get_scancode_from_name("Escape2") == scancode::unknown);
+    REQUIRE(sdl::get_scancode_from_name("Escap") == scancode::unknown);
+    REQUIRE(sdl::get_scancode_from_name(nullptr) == scancode::unknown);
+    REQUIRE(sdl::get_scancode_from_name("Space bar", 5) == scancode::space);
+}
+
+TEST_CASE("Scancode names can be used at compile time", "[keyboard]") {
+    static_assert(sdl::get_scancode_name(scancode::lctrl)[0] == 'L', "");
+    static_assert(sdl::get_scancode_name(scancode::unknown)[0] == '\0', "");
+#ifdef SDLXX_HAS_CONSTEXPR14
+    static_assert(sdl::get_scancode_from_name("A") == scancode::a, "");
+    static_assert(sdl::get_scancode_from_name("F13") == scancode::f13, "");
+    static_assert(
+        sdl::get_scancode_from_name("Keypad 00") == scancode::kp_00, "");
+#endif
+}
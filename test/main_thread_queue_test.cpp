@@ -0,0 +1,234 @@
+
+#include <sdl++/main_thread_queue.hpp>
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int count_wake_events(const sdl::main_thread_queue<int>& queue) {
+    int count = 0;
+    SDL_Event event;
+    while (SDL_PeepEvents(&event, 1, SDL_GETEVENT, queue.event_type(),
+                          queue.event_type()) > 0) {
+        REQUIRE(queue.is_wake_event(event));
+        ++count;
+    }
+    return count;
+}
+}
+
+TEST_CASE("The MPSC queue is first-in, first-out", "[main_thread_queue]") {
+    sdl::detail::mpsc_queue<std::string> queue;
+    REQUIRE_FALSE(queue.pop());
+
+    queue.push("a");
+    queue.push("b");
+    REQUIRE(queue.pop() == std::string{"a"});
+    queue.push("c");
+    REQUIRE(queue.pop() == std::string{"b"});
+    REQUIRE(queue.pop() == std::string{"c"});
+    REQUIRE_FALSE(queue.pop());
+
+    // Elements left in the queue are destroyed with it
+    queue.push("d");
+}
+
+TEST_CASE("Tasks are run by drain()", "[main_thread_queue]") {
+    SDL_Init(SDL_INIT_EVENTS);
+    sdl::main_thread_queue<> tasks;
+
+    std::vector<int> order;
+    auto owned = std::make_unique<int>(3);
+    tasks.post([&order] { order.push_back(1); });
+    tasks.post([&order, p = std::move(owned)] { order.push_back(*p); });
+
+    REQUIRE(tasks.drain() == 2);
+    REQUIRE(order == (std::vector<int>{1, 3}));
+    REQUIRE(tasks.drain() == 0);
+
+    SDL_Quit();
+}
+
+TEST_CASE("A wake-up event is pushed only when the queue becomes non-empty",
+          "[main_thread_queue]") {
+    SDL_Init(SDL_INIT_EVENTS);
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+    sdl::main_thread_queue<int> queue;
+
+    REQUIRE(queue.post(1));
+    REQUIRE_FALSE(queue.post(2));
+    REQUIRE_FALSE(queue.post(3));
+    REQUIRE(count_wake_events(queue) == 1);
+
+    int sum = 0;
+    REQUIRE(queue.drain([&](int n) { sum += n; }) == 3);
+    REQUIRE(sum == 6);
+
+    REQUIRE(queue.post(4));
+    REQUIRE(count_wake_events(queue) == 1);
+    REQUIRE(queue.drain([](int) {}) == 1);
+
+    SDL_Event other{};
+    other.type = queue.event_type();
+    REQUIRE_FALSE(queue.is_wake_event(other));
+
+    SDL_Quit();
+}
+
+TEST_CASE("A dropped wake-up event is retried by the next post",
+          "[main_thread_queue]") {
+    SDL_Init(SDL_INIT_EVENTS);
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+    sdl::main_thread_queue<int> queue;
+
+    // Drops the first event pushed, then lets the rest through
+    int dropped = 0;
+    SDL_SetEventFilter(
+        [](void* userdata, SDL_Event*) -> int {
+            return (*static_cast<int*>(userdata))++ == 0 ? 0 : 1;
+        },
+        &dropped);
+
+    REQUIRE_FALSE(queue.post(1));
+    REQUIRE(count_wake_events(queue) == 0);
+    REQUIRE(queue.post(2));
+    REQUIRE(count_wake_events(queue) == 1);
+    REQUIRE(queue.drain([](int) {}) == 2);
+
+    SDL_SetEventFilter(nullptr, nullptr);
+    SDL_Quit();
+}
+
+TEST_CASE("Messages from many producers all arrive", "[main_thread_queue]") {
+    SDL_Init(SDL_INIT_EVENTS);
+    constexpr int producers = 8;
+    constexpr int per_producer = 20000;
+
+    sdl::main_thread_queue<std::pair<int, int>> queue;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&queue, p] {
+            for (int i = 0; i < per_producer; i++) { queue.post({p, i}); }
+        });
+    }
+
+    // Messages from each producer arrive in the order they were posted
+    std::vector<int> next(producers, 0);
+    int received = 0;
+    bool in_order = true;
+    while (received < producers * per_producer) {
+        received += static_cast<int>(queue.drain([&](std::pair<int, int> m) {
+            in_order = in_order && m.second == next[m.first];
+            next[m.first] = m.second + 1;
+        }));
+    }
+    for (auto& t : threads) { t.join(); }
+
+    REQUIRE(in_order);
+    REQUIRE(queue.drain([](std::pair<int, int>) {}) == 0);
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+    SDL_Quit();
+}
+
+TEST_CASE("main_thread_queue vs SDL_PushEvent",
+          "[.][benchmark][main_thread_queue]") {
+    using std::chrono::steady_clock;
+    using ms = std::chrono::duration<double, std::milli>;
+    using us = std::chrono::duration<double, std::micro>;
+
+    SDL_Init(SDL_INIT_EVENTS);
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+    constexpr int producers = 8;
+
+    // Runs `producers` threads each posting `count` messages, spaced by at
+    // least `interval`, and drains them on this thread. Each message is the
+    // time at which it was posted, so that the latency can be measured.
+    // Returns the elapsed time and the median and 99th percentile latency.
+    auto run = [&](int count, steady_clock::duration interval, auto&& post,
+                   auto&& drain) {
+        const int total = producers * count;
+        std::vector<double> latencies;
+        latencies.reserve(total);
+        std::atomic<bool> go{false};
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; p++) {
+            threads.emplace_back([&] {
+                while (!go) { std::this_thread::yield(); }
+                auto next = steady_clock::now();
+                for (int i = 0; i < count; i++) {
+                    while (steady_clock::now() < next) {}
+                    next += interval;
+                    post(steady_clock::now().time_since_epoch().count());
+                }
+            });
+        }
+        const auto start = steady_clock::now();
+        go = true;
+        while (static_cast<int>(latencies.size()) < total) {
+            drain([&](steady_clock::rep posted) {
+                const auto now = steady_clock::now().time_since_epoch();
+                latencies.push_back(
+                    us(steady_clock::duration(now.count() - posted)).count());
+            });
+        }
+        const ms elapsed = steady_clock::now() - start;
+        for (auto& t : threads) { t.join(); }
+        std::sort(latencies.begin(), latencies.end());
+        return std::make_tuple(elapsed.count(), latencies[total / 2],
+                               latencies[total * 99 / 100]);
+    };
+
+    const uint32_t type = SDL_RegisterEvents(1);
+    auto sdl_post = [&](steady_clock::rep t) {
+        SDL_Event e{};
+        e.type = type;
+        e.user.data1 = reinterpret_cast<void*>(static_cast<intptr_t>(t));
+        // Retry if SDL's queue is full
+        while (SDL_PushEvent(&e) <= 0) { std::this_thread::yield(); }
+    };
+    auto sdl_drain = [&](auto&& handle) {
+        SDL_Event events[256];
+        const int n = SDL_PeepEvents(events, 256, SDL_GETEVENT, type, type);
+        for (int i = 0; i < n; i++) {
+            handle(static_cast<steady_clock::rep>(
+                reinterpret_cast<intptr_t>(events[i].user.data1)));
+        }
+    };
+
+    sdl::main_thread_queue<steady_clock::rep> queue;
+    auto queue_post = [&](steady_clock::rep t) { queue.post(t); };
+    auto queue_drain = [&](auto&& handle) { queue.drain(handle); };
+
+    auto report = [](const char* what, const char* name, const auto& r) {
+        WARN(what << ", " << name << ": " << std::get<0>(r)
+                  << " ms, latency median " << std::get<1>(r) << " us, p99 "
+                  << std::get<2>(r) << " us");
+    };
+
+    // Throughput: producers post as fast as they can
+    constexpr int burst = 50000;
+    const auto zero = steady_clock::duration::zero();
+    report("Throughput, 8 x 50000 messages", "SDL_PushEvent",
+           run(burst, zero, sdl_post, sdl_drain));
+    report("Throughput, 8 x 50000 messages", "main_thread_queue",
+           run(burst, zero, queue_post, queue_drain));
+
+    // Latency: producers post at a steady rate the consumer can sustain
+    constexpr int paced = 5000;
+    const auto interval = std::chrono::microseconds{20};
+    report("Latency, 8 x 5000 messages at 50kHz", "SDL_PushEvent",
+           run(paced, interval, sdl_post, sdl_drain));
+    report("Latency, 8 x 5000 messages at 50kHz", "main_thread_queue",
+           run(paced, interval, queue_post, queue_drain));
+
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+    SDL_Quit();
+}
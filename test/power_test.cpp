@@ -5,6 +5,9 @@
 
 #include "catch.hpp"
 
+#include <atomic>
+#include <thread>
+
 using namespace std::chrono_literals;
 
 TEST_CASE("SDL_PowerState is wrapped correctly", "[power]") {
@@ -49,3 +52,133 @@ TEST_CASE("SDL_GetPowerInfo() is wrapped correctly", "[power]") {
 
     SDL_Quit();
 }
+
+TEST_CASE("sdl::power_info survives packing into an atomic", "[power]") {
+    const sdl::power_info infos[] = {
+        {},
+        {sdl::power_state::on_battery, 3600s, 58},
+        {sdl::power_state::charging, sdl::nullopt, 100},
+        {sdl::power_state::on_battery, 0s, 0},
+        {sdl::power_state::charged, 2147483647s, sdl::nullopt}};
+
+    for (const auto& info : infos) {
+        const auto bits = sdl::detail::pack_power_info(info);
+        REQUIRE(sdl::detail::unpack_power_info(bits) == info);
+    }
+}
+
+TEST_CASE("sdl::power_poller refreshes its snapshot", "[power]") {
+    std::atomic<int> percent{80};
+    std::atomic<int> calls{0};
+    auto fake = [&] {
+        ++calls;
+        return sdl::power_info{sdl::power_state::on_battery, sdl::nullopt,
+                               percent.load()};
+    };
+
+    SECTION("Manually") {
+        sdl::power_poller poller{std::chrono::hours{1}, fake};
+        REQUIRE(poller.get().percent_left == 80);
+        REQUIRE(poller.generation() == 1);
+
+        percent = 40;
+        REQUIRE(poller.get().percent_left == 80);
+        poller.refresh();
+        REQUIRE(poller.get().percent_left == 40);
+        REQUIRE(poller.generation() == 2);
+    }
+
+    SECTION("On a background thread") {
+        sdl::power_poller poller{std::chrono::milliseconds{1}, fake};
+        percent = 25;
+        while (poller.get().percent_left != 25) {
+            std::this_thread::yield();
+        }
+        REQUIRE(calls >= 2);
+    }
+}
+
+TEST_CASE("sdl::power_poller uses SDL_GetPowerInfo() by default", "[power]") {
+    SDL_Init(SDL_INIT_EVENTS);
+    sdl::power_poller poller;
+    REQUIRE(poller.get() == sdl::get_power_info());
+    SDL_Quit();
+}
+
+TEST_CASE("sdl::power_governor lowers the budget on low battery", "[power]") {
+    using state = sdl::power_state;
+    using level = sdl::power_governor::level;
+    const sdl::power_policy policy{};
+    sdl::power_governor governor{policy};
+
+    auto battery = [](int percent) {
+        return sdl::power_info{state::on_battery, sdl::nullopt, percent};
+    };
+
+    REQUIRE(governor.update({state::charging, sdl::nullopt, 5}) ==
+            policy.plugged_in);
+    REQUIRE(governor.update(battery(80)) == policy.on_battery);
+    REQUIRE(governor.update(battery(30)) == policy.low_battery);
+    REQUIRE(governor.battery_level() == level::low);
+    REQUIRE(governor.update(battery(10)) == policy.critical_battery);
+
+    // Recovery requires clearing the threshold by the hysteresis margin
+    REQUIRE(governor.update(battery(12)) == policy.critical_battery);
+    REQUIRE(governor.update(battery(13)) == policy.low_battery);
+    REQUIRE(governor.update(battery(32)) == policy.low_battery);
+    REQUIRE(governor.update(battery(33)) == policy.on_battery);
+
+    // An unknown percentage keeps the previous level
+    governor.update(battery(20));
+    REQUIRE(governor.update({state::on_battery, sdl::nullopt, sdl::nullopt}) ==
+            policy.low_battery);
+
+    // Plugging in restores the full budget immediately
+    REQUIRE(governor.update({state::charging, sdl::nullopt, 20}) ==
+            policy.plugged_in);
+    REQUIRE(governor.budget().frame_time() ==
+            std::chrono::microseconds{1000000 / 60});
+}
+
+TEST_CASE("sdl::power_governor reads from a poller", "[power]") {
+    std::atomic<int> percent{50};
+    sdl::power_poller poller{std::chrono::hours{1}, [&] {
+        return sdl::power_info{sdl::power_state::on_battery, sdl::nullopt,
+                               percent.load()};
+    }};
+    sdl::power_governor governor{poller};
+
+    REQUIRE(governor.update().frame_rate == 60);
+    percent = 5;
+    poller.refresh();
+    const auto budget = governor.update();
+    REQUIRE(budget.frame_rate == 20);
+    REQUIRE(budget.work_scale == 0.25f);
+}
+
+TEST_CASE("Polled vs direct power queries", "[.][benchmark][power]") {
+    using std::chrono::steady_clock;
+    using ms = std::chrono::duration<double, std::milli>;
+
+    SDL_Init(SDL_INIT_EVENTS);
+    constexpr int frames = 10000;
+    int sum = 0;
+
+    auto start = steady_clock::now();
+    for (int i = 0; i < frames; i++) {
+        sum += static_cast<int>(sdl::get_power_info().state);
+    }
+    const ms direct = steady_clock::now() - start;
+
+    sdl::power_poller poller;
+    start = steady_clock::now();
+    for (int i = 0; i < frames; i++) {
+        sum += static_cast<int>(poller.get().state);
+    }
+    const ms polled = steady_clock::now() - start;
+
+    WARN(frames << " frames: get_power_info() " << direct.count()
+                << " ms, power_poller::get() " << polled.count() << " ms ("
+                << sum << ")");
+    SDL_Quit();
+}
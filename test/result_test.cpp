@@ -0,0 +1,121 @@
+
+#include <sdl++/result.hpp>
+
+#include "catch.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace {
+
+sdl::result<int> parse_digit(char c) {
+    if (c < '0' || c > '9') {
+        SDL_SetError("Not a digit");
+        return sdl::failure;
+    }
+    return c - '0';
+}
+
+// A call which fails once in every `fail_every` attempts, in the manner of
+// polling a device which is occasionally unplugged
+int throwing_poll(int i, int fail_every) {
+    SDLXX_CHECK(fail_every == 0 || i % fail_every != 0);
+    return i & 0xFF;
+}
+
+sdl::result<int> result_poll(int i, int fail_every) {
+    if (fail_every != 0 && i % fail_every == 0) { return sdl::failure; }
+    return i & 0xFF;
+}
+}
+
+TEST_CASE("A successful result holds a value", "[result]") {
+    const auto r = parse_digit('7');
+
+    REQUIRE(r.has_value());
+    REQUIRE(static_cast<bool>(r));
+    REQUIRE(r.value() == 7);
+    REQUIRE(*r == 7);
+    REQUIRE(r.value_or(-1) == 7);
+    REQUIRE(std::string{r.error_message()}.empty());
+}
+
+TEST_CASE("A failed result reports SDL's error", "[result]") {
+    const auto r = parse_digit('x');
+
+    REQUIRE_FALSE(r.has_value());
+    REQUIRE_FALSE(static_cast<bool>(r));
+    REQUIRE(r.value_or(-1) == -1);
+    REQUIRE(std::string{r.error_message()} == "Not a digit");
+    REQUIRE_THROWS_AS(r.value(), sdl::error);
+}
+
+TEST_CASE("A result can hold a move-only type", "[result]") {
+    sdl::result<std::unique_ptr<int>> r{std::make_unique<int>(3)};
+    REQUIRE(r);
+    REQUIRE(**r == 3);
+
+    auto p = std::move(r).value();
+    REQUIRE(*p == 3);
+
+    sdl::result<std::unique_ptr<int>> f = sdl::failure;
+    REQUIRE_FALSE(f);
+}
+
+TEST_CASE("result<void> reports success or failure", "[result]") {
+    const sdl::result<void> ok{};
+    REQUIRE(ok);
+    REQUIRE_NOTHROW(ok.value());
+
+    SDL_SetError("Something went wrong");
+    const sdl::result<void> failed = sdl::failure;
+    REQUIRE_FALSE(failed);
+    REQUIRE(std::string{failed.error_message()} == "Something went wrong");
+    REQUIRE_THROWS_AS(failed.value(), sdl::error);
+
+    REQUIRE(sdl::detail::check_zero(0));
+    REQUIRE_FALSE(sdl::detail::check_zero(-1));
+}
+
+TEST_CASE("Exception vs result error handling", "[.][benchmark][result]") {
+    using std::chrono::steady_clock;
+    using ms = std::chrono::duration<double, std::milli>;
+
+    constexpr int iterations = 1000000;
+    SDL_SetError("Device unplugged");
+
+    // Failure rates of 0%, 0.1%, 1% and 10%
+    for (int fail_every : {0, 1000, 100, 10}) {
+        long sum = 0;
+        int failures = 0;
+
+        auto start = steady_clock::now();
+        for (int i = 1; i <= iterations; i++) {
+            try {
+                sum += throwing_poll(i, fail_every);
+            } catch (const sdl::error&) {
+                ++failures;
+            }
+        }
+        const ms throwing = steady_clock::now() - start;
+
+        start = steady_clock::now();
+        for (int i = 1; i <= iterations; i++) {
+            const auto r = result_poll(i, fail_every);
+            if (r) {
+                sum += *r;
+            } else {
+                ++failures;
+            }
+        }
+        const ms result = steady_clock::now() - start;
+
+        const double rate =
+            fail_every == 0 ? 0.0 : 100.0 / static_cast<double>(fail_every);
+        WARN("Failure rate " << rate << "%: exceptions " << throwing.count()
+                             << " ms, result " << result.count() << " ms ("
+                             << failures << " failures, checksum " << sum
+                             << ")");
+    }
+}
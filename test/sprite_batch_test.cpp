@@ -0,0 +1,254 @@
+
+#include <sdl++/sprite_batch.hpp>
+#include <sdl++/surface.hpp>
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+// A software renderer drawing into a surface, which needs no video driver
+struct test_target {
+    explicit test_target(int size)
+        : target{size, size, sdl::pixel_format::argb8888},
+          renderer{SDL_CreateSoftwareRenderer(target.get()),
+                   &SDL_DestroyRenderer} {
+        REQUIRE(renderer);
+        SDL_SetRenderDrawColor(renderer.get(), 20, 40, 60, 255);
+        SDL_RenderClear(renderer.get());
+    }
+
+    std::vector<uint32_t> pixels() const {
+        std::vector<uint32_t> out;
+        for (auto row : target.view<uint32_t>()) {
+            out.insert(out.end(), row.begin(), row.end());
+        }
+        return out;
+    }
+
+    sdl::surface target;
+    std::unique_ptr<SDL_Renderer, decltype(&SDL_DestroyRenderer)> renderer;
+};
+
+using texture_ptr = std::unique_ptr<SDL_Texture, decltype(&SDL_DestroyTexture)>;
+
+// An 8x8 texture with a gradient in the given colour
+texture_ptr make_texture(SDL_Renderer* renderer, uint32_t argb) {
+    sdl::surface s{8, 8, sdl::pixel_format::argb8888};
+    auto view = s.view<uint32_t>();
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            view(x, y) = argb - static_cast<uint32_t>(x * 0x0F0000 + y * 0x0F);
+        }
+    }
+    texture_ptr t{SDL_CreateTextureFromSurface(renderer, s.get()),
+                  &SDL_DestroyTexture};
+    REQUIRE(t);
+    return t;
+}
+
+struct sprite {
+    SDL_Texture* texture;
+    SDL_Rect src;
+    SDL_Rect dst;
+    int16_t layer;
+    sdl::blend_mode mode;
+    double angle;
+};
+}
+
+TEST_CASE("Radix sort orders sprite keys", "[sprite_batch]") {
+    std::mt19937_64 gen{1};
+    std::vector<uint64_t> keys, scratch;
+    std::vector<size_t> counts;
+    for (size_t n : {0, 1, 2, 100, 5000}) {
+        keys.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            const auto layer = static_cast<int16_t>(gen() % 7) - 3;
+            keys[i] = sdl::detail::make_sprite_key(
+                static_cast<int16_t>(layer), gen() % 300,
+                sdl::blend_mode::add, i);
+        }
+        auto expected = keys;
+        std::sort(expected.begin(), expected.end());
+        sdl::detail::radix_sort(keys, scratch, counts, 3);
+        REQUIRE(keys == expected);
+    }
+}
+
+TEST_CASE("A sprite batch draws the same image as direct calls",
+          "[sprite_batch]") {
+    test_target batched{64}, direct{64};
+    auto red = make_texture(batched.renderer.get(), 0xC0FF4020);
+    auto green = make_texture(batched.renderer.get(), 0xFF20FF40);
+    auto blue = make_texture(batched.renderer.get(), 0x8040A0FF);
+
+    // Sprites overlap only across layers
+    std::vector<sprite> sprites;
+    std::mt19937 gen{2};
+    SDL_Texture* textures[] = {red.get(), green.get(), blue.get()};
+    const sdl::blend_mode modes[] = {sdl::blend_mode::blend,
+                                     sdl::blend_mode::add,
+                                     sdl::blend_mode::mod};
+    for (int16_t layer : {2, -1, 0}) {
+        for (int i = 0; i < 16; i++) {
+            const int x = (i % 4) * 16 + layer * 3;
+            const int y = (i / 4) * 16 + layer * 2;
+            sprites.push_back({textures[gen() % 3],
+                               SDL_Rect{1, 1, 6, 6},
+                               SDL_Rect{x, y, 12, 10},
+                               layer,
+                               modes[gen() % 3],
+                               i % 5 == 0 ? 30.0 : 0.0});
+        }
+    }
+
+    sdl::sprite_batch batch;
+    for (const auto& s : sprites) {
+        if (s.angle != 0.0) {
+            batch.draw(s.texture, s.src, s.dst, s.angle, SDL_FLIP_HORIZONTAL,
+                       s.layer, s.mode);
+        } else {
+            batch.draw(s.texture, s.src, s.dst, s.layer, s.mode);
+        }
+    }
+    REQUIRE(batch.size() == sprites.size());
+    batch.submit(batched.renderer.get());
+    REQUIRE(batch.empty());
+
+    std::stable_sort(sprites.begin(), sprites.end(),
+                     [](const sprite& a, const sprite& b) {
+                         return a.layer < b.layer;
+                     });
+    for (const auto& s : sprites) {
+        SDL_SetTextureBlendMode(s.texture,
+                                static_cast<SDL_BlendMode>(s.mode));
+        SDL_RenderCopyEx(direct.renderer.get(), s.texture, &s.src, &s.dst,
+                         s.angle,
+                         nullptr, s.angle != 0.0 ? SDL_FLIP_HORIZONTAL
+                                                 : SDL_FLIP_NONE);
+    }
+
+    REQUIRE(batched.pixels() == direct.pixels());
+    REQUIRE(batch.stats().sprites == sprites.size());
+    REQUIRE(batch.stats().draw_calls == sprites.size());
+    REQUIRE(batch.stats().culled == 0);
+}
+
+TEST_CASE("A sprite batch minimises state changes", "[sprite_batch]") {
+    test_target t{64};
+    auto a = make_texture(t.renderer.get(), 0xFFFF0000);
+    auto b = make_texture(t.renderer.get(), 0xFF0000FF);
+
+    sdl::sprite_batch batch{200};
+    for (int i = 0; i < 200; i++) {
+        batch.draw(i % 2 ? a.get() : b.get(), SDL_Rect{i % 56, i / 4, 8, 8});
+    }
+    batch.submit(t.renderer.get());
+
+    // Textures made from surfaces with alpha already use blend_mode::blend
+    REQUIRE(batch.stats().sprites == 200);
+    REQUIRE(batch.stats().batches == 2);
+    REQUIRE(batch.stats().state_changes == 0);
+
+    SECTION("Changed state persists to later frames") {
+        for (int frame = 0; frame < 2; frame++) {
+            for (int i = 0; i < 10; i++) {
+                batch.draw(a.get(), SDL_Rect{i, i, 8, 8}, 0,
+                           sdl::blend_mode::add);
+            }
+            batch.submit(t.renderer.get());
+            REQUIRE(batch.stats().batches == 1);
+            REQUIRE(batch.stats().state_changes == (frame == 0 ? 1 : 0));
+        }
+        SDL_BlendMode mode;
+        SDL_GetTextureBlendMode(a.get(), &mode);
+        REQUIRE(mode == SDL_BLENDMODE_ADD);
+    }
+
+    SECTION("Tints are applied per sprite") {
+        batch.set_tint(SDL_Color{255, 0, 0, 128});
+        batch.draw(a.get(), SDL_Rect{0, 0, 8, 8});
+        batch.draw(a.get(), SDL_Rect{8, 0, 8, 8});
+        batch.set_tint(SDL_Color{255, 0, 0, 255});
+        batch.draw(a.get(), SDL_Rect{16, 0, 8, 8});
+        batch.submit(t.renderer.get());
+
+        // Colour and alpha for the first sprite, then alpha again
+        REQUIRE(batch.stats().state_changes == 3);
+        REQUIRE(batch.get_tint().a == 255);
+
+        Uint8 r, g, b, alpha;
+        SDL_GetTextureColorMod(a.get(), &r, &g, &b);
+        SDL_GetTextureAlphaMod(a.get(), &alpha);
+        REQUIRE((r == 255 && g == 0 && b == 0 && alpha == 255));
+    }
+
+    SECTION("Sprites outside the viewport are culled") {
+        batch.draw(a.get(), SDL_Rect{-8, 0, 8, 8});
+        batch.draw(a.get(), SDL_Rect{64, 10, 8, 8});
+        batch.draw(a.get(), SDL_Rect{10, 70, 8, 8});
+        batch.draw(a.get(), SDL_Rect{-7, -7, 8, 8});
+        batch.draw(a.get(), SDL_Rect{1, 1, 6, 6}, SDL_Rect{-10, 0, 8, 8},
+                   45.0, SDL_FLIP_NONE);
+        batch.submit(t.renderer.get());
+        REQUIRE(batch.stats().culled == 3);
+        REQUIRE(batch.stats().sprites == 2);
+    }
+}
+
+TEST_CASE("Sprite batch vs direct rendering", "[.][benchmark][sprite_batch]") {
+    using std::chrono::steady_clock;
+    using ms = std::chrono::duration<double, std::milli>;
+
+    constexpr int count = 20000;
+    test_target t{256};
+    std::vector<texture_ptr> textures;
+    for (uint32_t i = 0; i < 16; i++) {
+        textures.push_back(
+            make_texture(t.renderer.get(), 0xFF000000 | (i * 0x0F0F0F)));
+    }
+
+    std::mt19937 gen{3};
+    std::vector<sprite> sprites;
+    for (int i = 0; i < count; i++) {
+        sprites.push_back({textures[gen() % 16].get(), SDL_Rect{0, 0, 8, 8},
+                           SDL_Rect{static_cast<int>(gen() % 300) - 22,
+                                    static_cast<int>(gen() % 300) - 22, 8, 8},
+                           static_cast<int16_t>(gen() % 4),
+                           gen() % 4 ? sdl::blend_mode::blend
+                                     : sdl::blend_mode::add,
+                           0.0});
+    }
+
+    // Drawing in submission order, setting state for every sprite
+    auto start = steady_clock::now();
+    for (const auto& s : sprites) {
+        SDL_SetTextureBlendMode(s.texture,
+                                static_cast<SDL_BlendMode>(s.mode));
+        SDL_RenderCopy(t.renderer.get(), s.texture, &s.src, &s.dst);
+    }
+    const ms direct = steady_clock::now() - start;
+
+    sdl::sprite_batch batch{count};
+    start = steady_clock::now();
+    for (const auto& s : sprites) {
+        batch.draw(s.texture, s.src, s.dst, s.layer, s.mode);
+    }
+    const auto recorded = steady_clock::now();
+    batch.submit(t.renderer.get());
+    const ms record = recorded - start;
+    const ms submit = steady_clock::now() - recorded;
+
+    const auto& st = batch.stats();
+    WARN(count << " sprites: direct " << direct.count() << " ms ("
+               << 2 * count << " calls), sprite_batch record "
+               << record.count() << " ms + submit " << submit.count()
+               << " ms (" << st.draw_calls + st.state_changes << " calls, "
+               << st.batches << " batches, " << st.culled << " culled)");
+}
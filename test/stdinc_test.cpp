@@ -0,0 +1,138 @@
+
+#include <sdl++/stdinc.hpp>
+
+#include "catch.hpp"
+
+#include <sstream>
+
+using namespace std::string_literals;
+
+TEST_CASE("string_view can be constructed", "[stdinc]") {
+    const sdl::string_view empty{};
+    REQUIRE(empty.empty());
+    REQUIRE(empty.size() == 0);
+
+    const char* c_str = "Hello world";
+    const sdl::string_view from_c_str = c_str;
+    REQUIRE(from_c_str.data() == c_str);
+    REQUIRE(from_c_str.size() == 11);
+
+    const sdl::string_view from_ptr_len{c_str, 5};
+    REQUIRE(from_ptr_len.size() == 5);
+    REQUIRE(from_ptr_len == "Hello");
+
+    const auto str = "Hello world"s;
+    const sdl::string_view from_string = str;
+    REQUIRE(from_string.data() == str.data());
+    REQUIRE(from_string.size() == str.size());
+}
+
+TEST_CASE("string_view element access works", "[stdinc]") {
+    const sdl::string_view sv = "abcdef";
+
+    REQUIRE(sv[0] == 'a');
+    REQUIRE(sv.at(2) == 'c');
+    REQUIRE(sv.front() == 'a');
+    REQUIRE(sv.back() == 'f');
+    REQUIRE_THROWS_AS(sv.at(6), std::out_of_range);
+    REQUIRE(std::string(sv.begin(), sv.end()) == "abcdef");
+}
+
+TEST_CASE("string_view substrings work", "[stdinc]") {
+    sdl::string_view sv = "abcdef";
+
+    REQUIRE(sv.substr(2) == "cdef");
+    REQUIRE(sv.substr(2, 2) == "cd");
+    REQUIRE(sv.substr(6).empty());
+    REQUIRE_THROWS_AS(sv.substr(7), std::out_of_range);
+
+    sv.remove_prefix(1);
+    sv.remove_suffix(2);
+    REQUIRE(sv == "bcd");
+}
+
+TEST_CASE("string_view searching works", "[stdinc]") {
+    const sdl::string_view sv = "path/to/file.txt";
+
+    REQUIRE(sv.find('/') == 4);
+    REQUIRE(sv.find('/', 5) == 7);
+    REQUIRE(sv.find('x', 15) == sdl::string_view::npos);
+    REQUIRE(sv.find("to") == 5);
+    REQUIRE(sv.find("") == 0);
+    REQUIRE(sv.find("txt", 14) == sdl::string_view::npos);
+    REQUIRE(sv.rfind('/') == 7);
+    REQUIRE(sv.rfind('/', 6) == 4);
+    REQUIRE(sv.rfind('#') == sdl::string_view::npos);
+}
+
+TEST_CASE("string_view comparisons work", "[stdinc]") {
+    const sdl::string_view abc = "abc";
+
+    REQUIRE(abc == "abc");
+    REQUIRE("abc" == abc);
+    REQUIRE(abc == "abc"s);
+    REQUIRE(abc != "abd");
+    REQUIRE(abc < "abd");
+    REQUIRE(abc < "abcd");
+    REQUIRE(abc > "ab");
+    REQUIRE(abc <= "abc");
+    REQUIRE(abc >= "abc");
+    REQUIRE(abc.compare("abc") == 0);
+}
+
+TEST_CASE("string_view can be converted to and streamed as a string",
+          "[stdinc]") {
+    const sdl::string_view sv{"abcdef", 3};
+
+    REQUIRE(sv.to_string() == "abc");
+    REQUIRE(static_cast<std::string>(sv) == "abc");
+
+    std::ostringstream ss;
+    ss << sv;
+    REQUIRE(ss.str() == "abc");
+}
+
+TEST_CASE("sdl_string takes ownership of SDL strings", "[stdinc]") {
+    sdl::sdl_string str{SDL_strdup("Hello")};
+
+    REQUIRE(str.size() == 5);
+    REQUIRE_FALSE(str.empty());
+    REQUIRE(SDL_strcmp(str.c_str(), "Hello") == 0);
+    REQUIRE(str == "Hello");
+    REQUIRE("Hello" == str);
+    REQUIRE(str == "Hello"s);
+    REQUIRE(str.view() == "Hello");
+    REQUIRE(str.str() == "Hello");
+
+    const sdl::string_view sv = str;
+    REQUIRE(sv.data() == str.get());
+}
+
+TEST_CASE("sdl_string handles null pointers", "[stdinc]") {
+    const sdl::sdl_string str{nullptr};
+
+    REQUIRE(str.empty());
+    REQUIRE(str.get() == nullptr);
+    REQUIRE(str.c_str() != nullptr);
+    REQUIRE(str == "");
+    REQUIRE(str.begin() == str.end());
+}
+
+TEST_CASE("sdl_string can be moved", "[stdinc]") {
+    char* raw = SDL_strdup("Hello");
+    sdl::sdl_string s1{raw};
+    sdl::sdl_string s2 = std::move(s1);
+
+    REQUIRE(s2.get() == raw);
+    REQUIRE(s1.get() == nullptr);
+    REQUIRE(s1.empty());
+
+    s1 = sdl::sdl_string{SDL_strdup("World")};
+    s1 = std::move(s2);
+    REQUIRE(s1.get() == raw);
+
+    char* released = s1.release();
+    REQUIRE(released == raw);
+    REQUIRE(s1.get() == nullptr);
+    SDL_free(released);
+}
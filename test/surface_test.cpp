@@ -0,0 +1,491 @@
+
+#include <sdl++/surface.hpp>
+
+#include "catch.hpp"
+
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct rgb {
+    uint8_t r, g, b;
+};
+
+std::vector<uint8_t> random_pixels(size_t n, unsigned seed) {
+    std::mt19937 gen{seed};
+    std::vector<uint8_t> out(n);
+    for (auto& b : out) { b = static_cast<uint8_t>(gen()); }
+    return out;
+}
+
+// Converts with the kernels for `level`, or SDL_ConvertPixels() if there is
+// none
+std::vector<uint8_t> convert_at(sdl::detail::simd_level level, int width,
+                                int height, sdl::pixel_format from,
+                                const std::vector<uint8_t>& src, int src_pitch,
+                                sdl::pixel_format to) {
+    const int pitch = width * sdl::bytes_per_pixel(to) + 5;
+    std::vector<uint8_t> dst(static_cast<size_t>(pitch) * height, 0xAB);
+    const auto conv = sdl::detail::plan_pixel_conversion(
+        static_cast<uint32_t>(from), static_cast<uint32_t>(to), level);
+    REQUIRE(conv.row);
+    sdl::detail::convert_pixels(conv, width, height, src.data(), src_pitch,
+                                dst.data(), pitch);
+    return dst;
+}
+
+std::vector<sdl::detail::simd_level> simd_levels() {
+    using sdl::detail::simd_level;
+    std::vector<simd_level> levels;
+    for (auto level : {simd_level::sse2, simd_level::sse41, simd_level::avx2}) {
+        if (level <= sdl::detail::best_simd_level()) {
+            levels.push_back(level);
+        }
+    }
+    return levels;
+}
+}
+
+TEST_CASE("Pixel format properties", "[surface]") {
+    REQUIRE(sdl::bytes_per_pixel(sdl::pixel_format::rgba8888) == 4);
+    REQUIRE(sdl::bytes_per_pixel(sdl::pixel_format::rgb24) == 3);
+    REQUIRE(sdl::bytes_per_pixel(sdl::pixel_format::rgb565) == 2);
+    REQUIRE(sdl::bytes_per_pixel(sdl::pixel_format::yuy2) == 2);
+    REQUIRE(sdl::is_fourcc(sdl::pixel_format::nv12));
+    REQUIRE_FALSE(sdl::is_fourcc(sdl::pixel_format::abgr8888));
+    REQUIRE_FALSE(sdl::is_fourcc(sdl::pixel_format::unknown));
+}
+
+TEST_CASE("Surfaces can be created and accessed", "[surface]") {
+    {
+        sdl::surface s{7, 5, sdl::pixel_format::rgba32};
+        REQUIRE(s);
+        REQUIRE(s.width() == 7);
+        REQUIRE(s.height() == 5);
+        REQUIRE(s.pitch() >= 7 * 4);
+        REQUIRE(s.format() == sdl::pixel_format::rgba32);
+        REQUIRE_FALSE(s.must_lock());
+
+        // 24-bit packed formats keep their 4-byte layout
+        sdl::surface rgb{2, 2, sdl::pixel_format::rgb888};
+        REQUIRE(rgb.format() == sdl::pixel_format::rgb888);
+
+        sdl::surface moved = std::move(s);
+        REQUIRE_FALSE(s);
+        REQUIRE(moved.width() == 7);
+
+        { auto lock = moved.lock(); }
+    }
+
+    REQUIRE_FALSE(sdl::surface::try_create(4, 4, sdl::pixel_format::unknown));
+    REQUIRE_THROWS_AS((sdl::surface{4, 4, sdl::pixel_format::unknown}),
+                      sdl::error);
+}
+
+TEST_CASE("Surfaces can wrap existing pixels", "[surface]") {
+    std::vector<uint16_t> pixels(8 * 3, 0);
+    auto s = sdl::surface::create_from(pixels.data(), 6, 3, 16,
+                                       sdl::pixel_format::rgb565);
+    REQUIRE(s.pixels() == pixels.data());
+    REQUIRE(s.pitch() == 16);
+
+    s.view<uint16_t>()(5, 2) = 0xF800;
+    REQUIRE(pixels[2 * 8 + 5] == 0xF800);
+}
+
+TEST_CASE("pixel_view iterates rows with padding", "[surface]") {
+    // 3 pixels wide with a 4-pixel pitch
+    std::vector<uint32_t> pixels(4 * 3, 0xDEAD);
+    sdl::pixel_view<uint32_t> view{pixels.data(), 3, 3, 16};
+    REQUIRE(view.width() == 3);
+    REQUIRE(view.height() == 3);
+    REQUIRE_FALSE(view.contiguous());
+    REQUIRE(std::distance(view.begin(), view.end()) == 3);
+
+    uint32_t n = 0;
+    for (auto row : view) {
+        REQUIRE(row.size() == 3);
+        for (uint32_t& px : row) { px = n++; }
+    }
+    // Padding is untouched
+    REQUIRE(pixels == (std::vector<uint32_t>{0, 1, 2, 0xDEAD, 3, 4, 5, 0xDEAD,
+                                             6, 7, 8, 0xDEAD}));
+    REQUIRE(view(1, 2) == 7);
+    REQUIRE(view.row(1)[0] == 3);
+    REQUIRE(view.begin()[2][2] == 8);
+
+    const auto sub = view.subview(1, 1, 2, 2);
+    REQUIRE(sub(0, 0) == 4);
+    REQUIRE(sub(1, 1) == 8);
+
+    sdl::pixel_view<const uint32_t> cview = view;
+    REQUIRE(cview(2, 0) == 2);
+    const sdl::pixel_view<uint32_t> packed{pixels.data(), 4, 3, 16};
+    REQUIRE(packed.contiguous());
+    REQUIRE(sdl::pixel_view<uint32_t>{}.empty());
+}
+
+TEST_CASE("surface_pool reuses pixel buffers", "[surface]") {
+    sdl::surface_pool pool;
+
+    void* first = nullptr;
+    {
+        auto s = pool.acquire(33, 10, sdl::pixel_format::argb8888);
+        REQUIRE(s.width() == 33);
+        REQUIRE(s.format() == sdl::pixel_format::argb8888);
+        REQUIRE(s.pitch() % 16 == 0);
+        REQUIRE(s.pitch() >= 33 * 4);
+        first = s.pixels();
+        s.view<uint32_t>()(32, 9) = 42;
+        REQUIRE(pool.cached_count() == 0);
+    }
+    REQUIRE(pool.cached_count() == 1);
+    REQUIRE(pool.cached_bytes() == 144 * 10);
+
+    SECTION("The same format and size reuses the buffer") {
+        auto s = pool.acquire(33, 10, sdl::pixel_format::argb8888);
+        REQUIRE(s.pixels() == first);
+        REQUIRE(pool.hits() == 1);
+        REQUIRE(pool.misses() == 1);
+        REQUIRE(pool.cached_count() == 0);
+    }
+
+    SECTION("A different format or size does not") {
+        auto a = pool.acquire(33, 10, sdl::pixel_format::rgba8888);
+        auto b = pool.acquire(33, 11, sdl::pixel_format::argb8888);
+        REQUIRE(a.pixels() != first);
+        REQUIRE(b.pixels() != first);
+        REQUIRE(pool.hits() == 0);
+        REQUIRE(pool.cached_count() == 1);
+    }
+
+    SECTION("Clearing frees cached buffers") {
+        pool.clear();
+        REQUIRE(pool.cached_count() == 0);
+        REQUIRE(pool.cached_bytes() == 0);
+    }
+
+    SECTION("Invalid requests fail") {
+        REQUIRE_FALSE(pool.try_acquire(-1, 4, sdl::pixel_format::rgba32));
+        REQUIRE_FALSE(pool.try_acquire(4, 4, sdl::pixel_format::nv12));
+        REQUIRE_FALSE(
+            pool.try_acquire(SDL_MAX_SINT32, 1, sdl::pixel_format::rgba32));
+        REQUIRE_FALSE(
+            pool.try_acquire(1 << 30, 1, sdl::pixel_format::rgba32));
+        REQUIRE_THROWS_AS(pool.acquire(4, 4, sdl::pixel_format::unknown),
+                          sdl::error);
+    }
+}
+
+TEST_CASE("surface_pool respects its capacity", "[surface]") {
+    sdl::surface_pool pool{1000};
+    REQUIRE(pool.capacity() == 1000);
+    {
+        auto a = pool.acquire(10, 10, sdl::pixel_format::rgba32);
+        auto b = pool.acquire(10, 10, sdl::pixel_format::rgba32);
+    }
+    // Each buffer is 48 * 10 bytes, so only two fit
+    REQUIRE(pool.cached_count() == 2);
+    { auto c = pool.acquire(20, 20, sdl::pixel_format::rgba32); }
+    REQUIRE(pool.cached_count() == 2);
+    REQUIRE(pool.cached_bytes() == 960);
+}
+
+TEST_CASE("Pooled surfaces may outlive the pool", "[surface]") {
+    sdl::surface s;
+    {
+        sdl::surface_pool pool;
+        s = pool.acquire(4, 4, sdl::pixel_format::rgb24);
+    }
+    REQUIRE(s.pitch() == 16);
+    s.view<rgb>()(3, 3).b = 7;
+    REQUIRE(static_cast<uint8_t*>(s.pixels())[3 * 16 + 3 * 3 + 2] == 7);
+
+    // Surfaces may also be returned from other threads
+    sdl::surface_pool pool;
+    std::vector<sdl::surface> surfaces;
+    for (int i = 0; i < 16; i++) {
+        surfaces.push_back(pool.acquire(8, 8, sdl::pixel_format::rgba32));
+    }
+    std::thread t{[&] { surfaces.clear(); }};
+    t.join();
+    REQUIRE(pool.cached_count() == 16);
+}
+
+TEST_CASE("RGB pixels are converted between byte orders", "[surface]") {
+    using pf = sdl::pixel_format;
+
+    const uint8_t rgb_pixels[] = {1, 2, 3, 4, 5, 6};
+    uint8_t out[8] = {};
+    sdl::convert_pixels(2, 1, pf::rgb24, rgb_pixels, 6, pf::rgba32, out, 8);
+    REQUIRE(std::vector<uint8_t>(out, out + 8) ==
+            (std::vector<uint8_t>{1, 2, 3, 255, 4, 5, 6, 255}));
+
+    const uint32_t argb[] = {0x80102030, 0xFF405060};
+    uint32_t abgr[2] = {};
+    sdl::convert_pixels(2, 1, pf::argb8888, argb, 8, pf::abgr8888, abgr, 8);
+    REQUIRE(abgr[0] == 0x80302010);
+    REQUIRE(abgr[1] == 0xFF605040);
+
+    // Padding is filled rather than copied from alpha
+    uint32_t rgbx[2] = {};
+    sdl::convert_pixels(2, 1, pf::argb8888, argb, 8, pf::rgb888, rgbx, 8);
+    REQUIRE(rgbx[0] == 0xFF102030);
+
+    // Formats without a kernel are converted by SDL
+    const uint16_t rgb565[] = {0xF800, 0x001F};
+    sdl::convert_pixels(2, 1, pf::rgb565, rgb565, 4, pf::argb8888, abgr, 8);
+    REQUIRE(abgr[0] == 0xFFFF0000);
+    REQUIRE(abgr[1] == 0xFF0000FF);
+    REQUIRE_FALSE(sdl::try_convert_pixels(2, 1, pf::index8, rgb565, 2,
+                                          pf::argb8888, abgr, 8));
+}
+
+TEST_CASE("YUV pixels are converted to RGB", "[surface]") {
+    using pf = sdl::pixel_format;
+
+    // Black, white, and saturated red and blue in BT.601 limited range
+    const uint8_t yuy2[] = {16, 128, 235, 128, 81, 90, 41, 240};
+    uint8_t rgba[16] = {};
+    sdl::convert_pixels(4, 1, pf::yuy2, yuy2, 8, pf::rgba32, rgba, 16);
+    REQUIRE(std::vector<uint8_t>(rgba, rgba + 8) ==
+            (std::vector<uint8_t>{0, 0, 0, 255, 255, 255, 255, 255}));
+    REQUIRE(rgba[8] == 255);
+    REQUIRE(rgba[9] < 5);
+    REQUIRE(rgba[14] < 5);
+
+    // A 2x2 NV12 image is 4 bytes of luma and one chroma pair
+    const uint8_t nv12[] = {16, 235, 235, 16, 128, 128};
+    uint32_t bgra[4] = {};
+    sdl::convert_pixels(2, 2, pf::nv12, nv12, 2, pf::argb8888, bgra, 8);
+    REQUIRE(bgra[0] == 0xFF000000);
+    REQUIRE(bgra[1] == 0xFFFFFFFF);
+    REQUIRE(bgra[2] == 0xFFFFFFFF);
+    REQUIRE(bgra[3] == 0xFF000000);
+}
+
+TEST_CASE("SIMD pixel kernels match the scalar kernels", "[surface]") {
+    using pf = sdl::pixel_format;
+    using sdl::detail::simd_level;
+
+    const pf rgb_formats[] = {pf::rgb24,    pf::bgr24,    pf::rgb888,
+                              pf::bgr888,   pf::argb8888, pf::rgba8888,
+                              pf::abgr8888, pf::bgra8888};
+    const pf yuv_formats[] = {pf::yuy2, pf::uyvy, pf::yvyu, pf::nv12,
+                              pf::nv21};
+    const pf rgb32_formats[] = {pf::rgb888, pf::argb8888, pf::rgba8888,
+                                pf::bgra8888};
+
+    // Widths around each kernel's block size exercise the scalar tails
+    for (int width : {1, 2, 3, 5, 7, 8, 9, 15, 16, 17, 31, 37, 64}) {
+        const int height = 3;
+        // Enough for 4 bytes per pixel plus an NV12 chroma plane
+        const int src_pitch = width * 4 + 3;
+        const auto src = random_pixels(
+            static_cast<size_t>(src_pitch) * height * 2,
+            static_cast<unsigned>(width));
+
+        for (pf to : rgb32_formats) {
+            for (pf from : rgb_formats) {
+                const auto expected = convert_at(simd_level::none, width,
+                                                 height, from, src, src_pitch,
+                                                 to);
+                for (auto level : simd_levels()) {
+                    REQUIRE(convert_at(level, width, height, from, src,
+                                       src_pitch, to) == expected);
+                }
+            }
+            for (pf from : yuv_formats) {
+                const auto expected = convert_at(simd_level::none, width,
+                                                 height, from, src, src_pitch,
+                                                 to);
+                for (auto level : simd_levels()) {
+                    REQUIRE(convert_at(level, width, height, from, src,
+                                       src_pitch, to) == expected);
+                }
+            }
+
+            // Kernels must not read past the end of a tightly packed row
+            for (pf from : {pf::rgb24, pf::argb8888, pf::yuy2, pf::nv12}) {
+                const int pitch = from == pf::yuy2
+                                      ? (width + 1) / 2 * 4
+                                      : width * sdl::bytes_per_pixel(from);
+                const size_t size = from == pf::nv12
+                                        ? width + ((width + 1) & ~1)
+                                        : static_cast<size_t>(pitch);
+                const std::vector<uint8_t> row(src.begin(),
+                                               src.begin() + size);
+                const auto expected = convert_at(simd_level::none, width, 1,
+                                                 from, row, pitch, to);
+                for (auto level : simd_levels()) {
+                    REQUIRE(convert_at(level, width, 1, from, row, pitch, to) ==
+                            expected);
+                }
+            }
+        }
+
+        std::vector<uint8_t> expected(src.size());
+        std::vector<uint8_t> actual(src.size());
+        sdl::detail::premultiply_row(3, src.data(), expected.data(), width);
+        for (auto level : simd_levels()) {
+            sdl::detail::select_premultiply(level)(3, src.data(),
+                                                   actual.data(), width);
+            REQUIRE(std::equal(expected.begin(), expected.begin() + 4 * width,
+                               actual.begin()));
+        }
+    }
+}
+
+TEST_CASE("Alpha can be premultiplied", "[surface]") {
+    using pf = sdl::pixel_format;
+
+    uint32_t pixels[] = {0x80FF8040, 0xFF123456, 0x00FFFFFF, 0x40000000};
+    sdl::premultiply_alpha(4, 1, pf::argb8888, pixels, 16, pixels, 16);
+    REQUIRE(pixels[0] == 0x80804020);
+    REQUIRE(pixels[1] == 0xFF123456);
+    REQUIRE(pixels[2] == 0x00000000);
+    REQUIRE(pixels[3] == 0x40000000);
+
+    sdl::surface s{3, 2, pf::rgba8888};
+    s.view<uint32_t>()(2, 1) = 0xFFFFFF80;
+    sdl::premultiply_alpha(s);
+    REQUIRE(s.view<uint32_t>()(2, 1) == 0x80808080);
+
+    REQUIRE_FALSE(
+        sdl::try_premultiply_alpha(4, 1, pf::rgb888, pixels, 16, pixels, 16));
+}
+
+TEST_CASE("Surfaces can be converted", "[surface]") {
+    sdl::surface src{5, 3, sdl::pixel_format::rgb24};
+    src.view<rgb>()(4, 2) = rgb{10, 20, 30};
+
+    const auto dst = sdl::convert_surface(src, sdl::pixel_format::argb8888);
+    REQUIRE(dst.width() == 5);
+    REQUIRE(dst.format() == sdl::pixel_format::argb8888);
+    REQUIRE(dst.view<uint32_t>()(4, 2) == 0xFF0A141E);
+
+    sdl::surface small{2, 2, sdl::pixel_format::argb8888};
+    REQUIRE_FALSE(sdl::try_convert_pixels(src, small));
+    REQUIRE_THROWS_AS(sdl::convert_pixels(src, small), sdl::error);
+}
+
+TEST_CASE("Pooled vs newly allocated surfaces", "[.][benchmark][surface]") {
+    using std::chrono::steady_clock;
+    using ms = std::chrono::duration<double, std::milli>;
+
+    // A frame's worth of text labels of a few sizes, for many frames
+    constexpr int frames = 2000;
+    const int sizes[][2] = {{120, 24}, {200, 24}, {64, 16}, {320, 32}};
+    long checksum = 0;
+
+    auto run = [&](auto&& make) {
+        const auto start = steady_clock::now();
+        for (int f = 0; f < frames; f++) {
+            for (const auto& size : sizes) {
+                sdl::surface s = make(size[0], size[1]);
+                auto view = s.view<uint32_t>();
+                view(0, 0) = static_cast<uint32_t>(f);
+                checksum += view(0, 0);
+            }
+        }
+        return ms{steady_clock::now() - start};
+    };
+
+    const ms fresh = run([](int w, int h) {
+        return sdl::surface{w, h, sdl::pixel_format::rgba32};
+    });
+    sdl::surface_pool pool;
+    const ms pooled = run([&](int w, int h) {
+        return pool.acquire(w, h, sdl::pixel_format::rgba32);
+    });
+
+    WARN(frames * 4 << " surfaces: SDL_CreateRGBSurface " << fresh.count()
+                    << " ms, surface_pool " << pooled.count() << " ms ("
+                    << pool.hits() << " reused, checksum " << checksum << ")");
+}
+
+TEST_CASE("Pixel format conversion throughput", "[.][benchmark][surface]") {
+    using pf = sdl::pixel_format;
+    using sdl::detail::simd_level;
+    using std::chrono::steady_clock;
+    using seconds = std::chrono::duration<double>;
+
+    // A 1080p video frame
+    constexpr int width = 1920;
+    constexpr int height = 1080;
+    constexpr int frames = 20;
+    const int src_pitch = width * 4;
+    const auto src =
+        random_pixels(static_cast<size_t>(src_pitch) * height * 2, 1);
+    std::vector<uint8_t> dst(static_cast<size_t>(width) * 4 * height);
+
+    const struct {
+        const char* name;
+        pf from, to;
+    } pairs[] = {
+        {"RGB24 -> RGBA32", pf::rgb24, pf::rgba32},
+        {"BGRA32 -> RGBA32", pf::bgra32, pf::rgba32},
+        {"ARGB8888 -> RGBA8888", pf::argb8888, pf::rgba8888},
+        {"YUY2 -> BGRA32", pf::yuy2, pf::bgra32},
+        {"NV12 -> RGBA32", pf::nv12, pf::rgba32},
+    };
+    const char* level_names[] = {"scalar", "SSE2", "SSSE3", "AVX2"};
+
+    auto megapixels_per_second = [&](auto&& convert) {
+        const auto start = steady_clock::now();
+        for (int f = 0; f < frames; f++) { convert(); }
+        const seconds elapsed = steady_clock::now() - start;
+        return frames * width * height / elapsed.count() / 1e6;
+    };
+
+    for (const auto& pair : pairs) {
+        std::ostringstream report;
+        report << pair.name << " (MP/s):";
+        const char* separator = " ";
+        if (!sdl::is_fourcc(pair.from)) {
+            separator = ", ";
+            report << " SDL_ConvertPixels " << megapixels_per_second([&] {
+                SDL_ConvertPixels(width, height,
+                                  static_cast<uint32_t>(pair.from), src.data(),
+                                  src_pitch, static_cast<uint32_t>(pair.to),
+                                  dst.data(), width * 4);
+            });
+        }
+        for (auto level : {simd_level::none, simd_level::sse2,
+                           simd_level::sse41, simd_level::avx2}) {
+            if (level > sdl::detail::best_simd_level()) { break; }
+            const auto conv = sdl::detail::plan_pixel_conversion(
+                static_cast<uint32_t>(pair.from),
+                static_cast<uint32_t>(pair.to), level);
+            report << separator << level_names[static_cast<int>(level)] << " "
+                   << megapixels_per_second([&] {
+                          sdl::detail::convert_pixels(conv, width, height,
+                                                      src.data(), src_pitch,
+                                                      dst.data(), width * 4);
+                      });
+            separator = ", ";
+        }
+        WARN(report.str());
+    }
+
+    std::ostringstream report;
+    report << "Premultiply ARGB8888 (MP/s):";
+    const char* separator = " ";
+    for (auto level : {simd_level::none, simd_level::sse2, simd_level::avx2}) {
+        if (level > sdl::detail::best_simd_level()) { break; }
+        const auto row = sdl::detail::select_premultiply(level);
+        report << separator << level_names[static_cast<int>(level)] << " "
+               << megapixels_per_second([&] {
+                      for (int y = 0; y < height; y++) {
+                          row(3, &src[static_cast<size_t>(y) * src_pitch],
+                              &dst[static_cast<size_t>(y) * width * 4], width);
+                      }
+                  });
+        separator = ", ";
+    }
+    WARN(report.str());
+}
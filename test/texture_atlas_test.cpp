@@ -0,0 +1,275 @@
+
+#include <sdl++/texture_atlas.hpp>
+
+#include "catch.hpp"
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Checks that `rects` lie within a `w` by `h` area without overlapping
+bool disjoint(const std::vector<SDL_Rect>& rects, int w, int h) {
+    std::vector<bool> used(static_cast<size_t>(w) * h);
+    for (const auto& r : rects) {
+        if (r.x < 0 || r.y < 0 || r.x + r.w > w || r.y + r.h > h) {
+            return false;
+        }
+        for (int y = r.y; y < r.y + r.h; y++) {
+            for (int x = r.x; x < r.x + r.w; x++) {
+                if (used[static_cast<size_t>(y) * w + x]) { return false; }
+                used[static_cast<size_t>(y) * w + x] = true;
+            }
+        }
+    }
+    return true;
+}
+
+using renderer_ptr =
+    std::unique_ptr<SDL_Renderer, decltype(&SDL_DestroyRenderer)>;
+
+// A software renderer drawing into a surface, which needs no video driver
+renderer_ptr make_renderer(sdl::surface& target) {
+    renderer_ptr r{SDL_CreateSoftwareRenderer(target.get()),
+                   &SDL_DestroyRenderer};
+    REQUIRE(r);
+    return r;
+}
+
+// An image of the given size in which every pixel is different
+sdl::surface make_image(int w, int h, uint32_t seed) {
+    sdl::surface s{w, h, sdl::pixel_format::argb8888};
+    auto view = s.view<uint32_t>();
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            view(x, y) = 0xFF000000 | (seed * 0x10101 + y * 256 + x);
+        }
+    }
+    return s;
+}
+}
+
+TEST_CASE("The rectangle packer places rectangles without overlap",
+          "[texture_atlas]") {
+    sdl::detail::rect_packer packer{256, 256};
+    std::mt19937 gen{1};
+    std::vector<SDL_Rect> placed;
+    SDL_Rect r;
+    for (int i = 0; i < 2000; i++) {
+        const int w = 4 + static_cast<int>(gen() % 29);
+        const int h = 4 + static_cast<int>(gen() % 29);
+        if (packer.insert(w, h, r)) {
+            REQUIRE((r.w == w && r.h == h));
+            placed.push_back(r);
+        }
+    }
+    REQUIRE(disjoint(placed, 256, 256));
+
+    long area = 0;
+    for (const auto& p : placed) { area += long{p.w} * p.h; }
+    REQUIRE(area > 256 * 256 * 3 / 4);
+
+    REQUIRE_FALSE(packer.insert(257, 1, r));
+    REQUIRE_FALSE(packer.insert(0, 1, r));
+}
+
+TEST_CASE("The rectangle packer reuses released space", "[texture_atlas]") {
+    sdl::detail::rect_packer packer{64, 64};
+    std::vector<SDL_Rect> placed;
+    SDL_Rect r;
+    while (packer.insert(8, 8, r)) { placed.push_back(r); }
+    REQUIRE(placed.size() == 64);
+
+    // Free every other rectangle, then fill them with smaller ones
+    std::vector<SDL_Rect> kept;
+    for (size_t i = 0; i < placed.size(); i++) {
+        if (i % 2) {
+            packer.release(placed[i]);
+        } else {
+            kept.push_back(placed[i]);
+        }
+    }
+    for (int i = 0; i < 64; i++) {
+        REQUIRE(packer.insert(4, 8, r));
+        kept.push_back(r);
+    }
+    REQUIRE_FALSE(packer.insert(4, 8, r));
+    REQUIRE(disjoint(kept, 64, 64));
+
+    packer.reset();
+    REQUIRE(packer.insert(64, 64, r));
+}
+
+TEST_CASE("Images are packed into atlas textures", "[texture_atlas]") {
+    sdl::surface target{64, 64, sdl::pixel_format::argb8888};
+    auto renderer = make_renderer(target);
+    sdl::texture_atlas atlas{renderer.get(), 64, 64};
+
+    std::vector<sdl::surface> images;
+    int area = 0;
+    for (uint32_t id = 0; id < 12; id++) {
+        images.push_back(make_image(10 + static_cast<int>(id % 5),
+                                    9 + static_cast<int>(id % 3), id));
+        const auto region = atlas.add(id, images.back());
+        REQUIRE(region.rect.w == images.back().width());
+        REQUIRE(region.rect.h == images.back().height());
+        area += region.rect.w * region.rect.h;
+    }
+    REQUIRE(atlas.size() == 12);
+    REQUIRE(atlas.page_count() == 1);
+    REQUIRE(atlas.occupancy() == Approx(area / (64.0 * 64.0)));
+    REQUIRE_FALSE(atlas.find(99));
+
+    atlas.upload();
+
+    // Each region shows its image when drawn
+    for (uint32_t id = 0; id < 12; id++) {
+        const auto* region = atlas.find(id);
+        REQUIRE(region);
+        const auto& image = images[id];
+        SDL_SetTextureBlendMode(region->texture, SDL_BLENDMODE_NONE);
+        const SDL_Rect dst{0, 0, image.width(), image.height()};
+        SDL_RenderCopy(renderer.get(), region->texture, &region->rect, &dst);
+
+        const auto src = image.view<uint32_t>();
+        const auto out = target.view<uint32_t>();
+        for (int y = 0; y < image.height(); y++) {
+            for (int x = 0; x < image.width(); x++) {
+                REQUIRE(out(x, y) == src(x, y));
+            }
+        }
+    }
+
+    SECTION("Full pages overflow onto new pages") {
+        for (uint32_t id = 100; id < 120; id++) {
+            atlas.add(id, make_image(20, 20, id));
+        }
+        REQUIRE(atlas.page_count() > 1);
+        REQUIRE(atlas.find(119)->texture != atlas.page_texture(0));
+    }
+
+    SECTION("Removed images make room for new ones") {
+        for (uint32_t id = 0; id < 12; id++) { REQUIRE(atlas.remove(id)); }
+        REQUIRE_FALSE(atlas.remove(0));
+        REQUIRE(atlas.size() == 0);
+        REQUIRE(atlas.occupancy() == 0.0);
+
+        // The emptied page is reset, so a full-size image fits
+        atlas.add(7, make_image(63, 63, 7));
+        REQUIRE(atlas.page_count() == 1);
+    }
+
+    SECTION("Adding an existing id replaces it") {
+        atlas.add(3, make_image(5, 5, 3));
+        REQUIRE(atlas.size() == 12);
+        REQUIRE(atlas.find(3)->rect.w == 5);
+    }
+
+    SECTION("Images larger than a page are rejected") {
+        const auto r = atlas.try_add(50, make_image(64, 10, 0));
+        REQUIRE_FALSE(r);
+        REQUIRE_FALSE(atlas.contains(50));
+        REQUIRE_THROWS_AS(atlas.add(51, make_image(10, 80, 0)), sdl::error);
+
+        // A failed replacement keeps the existing image
+        const auto old_rect = atlas.find(3)->rect;
+        REQUIRE_FALSE(atlas.try_add(3, make_image(64, 10, 0)));
+        REQUIRE(atlas.size() == 12);
+        REQUIRE(atlas.find(3)->rect.w == old_rect.w);
+        REQUIRE(atlas.find(3)->rect.h == old_rect.h);
+    }
+}
+
+TEST_CASE("Reused atlas space has its padding cleared", "[texture_atlas]") {
+    sdl::surface target{16, 16, sdl::pixel_format::argb8888};
+    auto renderer = make_renderer(target);
+    sdl::texture_atlas atlas{renderer.get(), 16, 16};
+
+    // Fill the page, then replace the image with a smaller one in its place
+    atlas.add(1, make_image(15, 15, 1));
+    atlas.upload();
+    REQUIRE(atlas.remove(1));
+    const auto region = atlas.add(2, make_image(4, 4, 2));
+    REQUIRE(region.rect.x == 0);
+    REQUIRE(region.rect.y == 0);
+    atlas.upload();
+
+    SDL_SetTextureBlendMode(region.texture, SDL_BLENDMODE_NONE);
+    REQUIRE(SDL_RenderCopy(renderer.get(), region.texture, nullptr,
+                           nullptr) == 0);
+    const auto out = target.view<uint32_t>();
+    for (int i = 0; i <= 4; i++) {
+        REQUIRE(out(4, i) == 0);
+        REQUIRE(out(i, 4) == 0);
+    }
+    REQUIRE(out(3, 3) == make_image(4, 4, 2).view<uint32_t>()(3, 3));
+}
+
+TEST_CASE("A failed add does not leave an empty page", "[texture_atlas]") {
+    sdl::surface target{16, 16, sdl::pixel_format::argb8888};
+    auto renderer = make_renderer(target);
+    sdl::texture_atlas atlas{renderer.get(), 16, 16};
+
+    // Indexed pixels cannot be converted without a palette
+    const std::vector<uint8_t> indexed(15 * 15);
+    REQUIRE_FALSE(atlas.try_add(1, 15, 15, sdl::pixel_format::index8,
+                                indexed.data(), 15));
+    REQUIRE(atlas.page_count() == 0);
+
+    // Nor when the image would have started a second page
+    atlas.add(2, make_image(15, 15, 2));
+    REQUIRE_FALSE(atlas.try_add(3, 15, 15, sdl::pixel_format::index8,
+                                indexed.data(), 15));
+    REQUIRE(atlas.page_count() == 1);
+    REQUIRE(atlas.size() == 1);
+    REQUIRE(atlas.occupancy() == Approx(15.0 * 15.0 / (16.0 * 16.0)));
+}
+
+TEST_CASE("Texture atlas packing throughput and occupancy",
+          "[.][benchmark][texture_atlas]") {
+    using std::chrono::steady_clock;
+    using ms = std::chrono::duration<double, std::milli>;
+
+    std::mt19937 gen{2};
+    sdl::surface target{16, 16, sdl::pixel_format::argb8888};
+    auto renderer = make_renderer(target);
+
+    // Glyph-sized images, then icon-sized ones
+    for (int max_size : {24, 64}) {
+        std::vector<sdl::surface> images;
+        for (int i = 0; i < 64; i++) {
+            images.push_back(
+                make_image(max_size / 4 + static_cast<int>(gen() % max_size),
+                           max_size / 4 + static_cast<int>(gen() % max_size),
+                           static_cast<uint32_t>(i)));
+        }
+
+        constexpr uint64_t count = 20000;
+        sdl::texture_atlas atlas{renderer.get(), 1024, 1024};
+        auto start = steady_clock::now();
+        for (uint64_t id = 0; id < count; id++) {
+            atlas.add(id, images[id % images.size()]);
+        }
+        atlas.upload();
+        const ms pack = steady_clock::now() - start;
+        const double packed = atlas.occupancy();
+
+        // Replace half of the images, as a glyph cache evicts and refills
+        start = steady_clock::now();
+        for (uint64_t id = 0; id < count; id += 2) { atlas.remove(id); }
+        for (uint64_t id = count; id < count + count / 2; id++) {
+            atlas.add(id, images[(id * 7) % images.size()]);
+        }
+        atlas.upload();
+        const ms churn = steady_clock::now() - start;
+
+        WARN("Images up to " << max_size + max_size / 4 << " px: packed "
+                             << count / pack.count() << " images/ms into "
+                             << atlas.page_count() << " pages at "
+                             << 100 * packed << "% occupancy; replaced half at "
+                             << count / 2 / churn.count() << " images/ms, "
+                             << 100 * atlas.occupancy() << "% occupancy");
+    }
+}
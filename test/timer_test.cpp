@@ -64,5 +64,50 @@ TEST_CASE("SDL_timer.h is wrapped correctly", "[timer]") {
         REQUIRE(call_count == call_count2);
     }
 
+    SECTION("Timeouts can be created without throwing and moved") {
+        int call_count = 0;
+        {
+            auto t = sdl::try_make_timeout(10ms, [&call_count](auto) {
+                call_count++;
+                return 10ms;
+            });
+            REQUIRE(t);
+
+            // The callback must survive being moved out of the result
+            auto handle = std::move(t).value();
+            SDL_Delay(25);
+        }
+
+        REQUIRE(call_count >= 2);
+        int call_count2 = call_count;
+        SDL_Delay(25);
+        REQUIRE(call_count == call_count2);
+    }
+
+    SECTION("Lvalue callbacks are called by reference") {
+        struct counter {
+            int calls = 0;
+            sdl::duration operator()(sdl::duration) {
+                ++calls;
+                return 10ms;
+            }
+        };
+
+        counter c;
+        {
+            auto t = sdl::make_timeout(10ms, c);
+            SDL_Delay(25);
+        }
+        REQUIRE(c.calls >= 2);
+
+        counter c2;
+        {
+            auto t = sdl::try_make_timeout(10ms, c2);
+            REQUIRE(t);
+            SDL_Delay(25);
+        }
+        REQUIRE(c2.calls >= 2);
+    }
+
     SDL_Quit();
 }
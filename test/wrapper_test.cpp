@@ -0,0 +1,164 @@
+
+#include <sdl++/detail/wrapper.hpp>
+
+#include "catch.hpp"
+
+#include <array>
+#include <chrono>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+// Stand-ins for C functions with various signatures
+
+int sum_ints(const int* values, size_t count) {
+    return std::accumulate(values, values + count, 0);
+}
+
+void fill_ints(int* values, size_t count, int value) {
+    std::fill(values, values + count, value);
+}
+
+void get_outputs(int* i, SDL_bool* b, SDL_LogPriority* p) {
+    *i = 42;
+    *b = SDL_TRUE;
+    *p = SDL_LOG_PRIORITY_WARN;
+}
+
+enum class priority : std::underlying_type_t<SDL_LogPriority> {
+    verbose = SDL_LOG_PRIORITY_VERBOSE,
+    warn = SDL_LOG_PRIORITY_WARN
+};
+}
+
+namespace sdl {
+namespace detail {
+    template <>
+    struct c_type<priority> {
+        using type = SDL_LogPriority;
+    };
+}
+}
+
+// Arguments which need no conversion are passed straight through
+static_assert(
+    std::is_same<decltype(sdl::detail::to_c_value(std::declval<int>())),
+                 int>::value,
+    "");
+static_assert(std::is_same<decltype(sdl::detail::to_c_value(
+                               std::declval<const char*>())),
+                           const char*>::value,
+              "");
+static_assert(std::is_same<decltype(sdl::detail::to_c_value(
+                               sdl::detail::out(std::declval<int&>()))),
+                           int*>::value,
+              "");
+static_assert(!sdl::detail::has_span_arg<int, const char*, sdl::string>::value,
+              "");
+static_assert(sdl::detail::has_span_arg<int, sdl::span<int>&>::value, "");
+
+TEST_CASE("string_view arguments are passed null-terminated", "[wrapper]") {
+    const char text[] = "Hello world";
+
+    REQUIRE(sdl::detail::c_call(::SDL_strlen, sdl::string_view(text, 5)) ==
+            5);
+    REQUIRE(sdl::detail::c_call(::SDL_strlen, sdl::string_view{}) == 0);
+
+    // Long strings fall back to a heap allocation
+    const std::string long_str(1000, 'x');
+    const sdl::string_view long_view(long_str.data(), 999);
+    REQUIRE(sdl::detail::c_call(::SDL_strlen, long_view) == 999);
+}
+
+TEST_CASE("sdl_string arguments are passed directly", "[wrapper]") {
+    const sdl::sdl_string str{SDL_strdup("Hello")};
+
+    REQUIRE(sdl::detail::to_c_value(str) == str.get());
+    REQUIRE(sdl::detail::c_call(::SDL_strlen, str) == 5);
+}
+
+TEST_CASE("span arguments become a pointer and a length", "[wrapper]") {
+    const std::vector<int> vec{1, 2, 3, 4};
+    REQUIRE(sdl::detail::c_call(sum_ints, sdl::span<const int>(vec)) == 10);
+
+    const int arr[] = {5, 6, 7};
+    REQUIRE(sdl::detail::c_call(sum_ints, sdl::span<const int>(arr)) == 18);
+
+    std::array<int, 8> out_arr{};
+    sdl::detail::c_call(fill_ints, sdl::span<int>(out_arr), 3);
+    REQUIRE(std::accumulate(out_arr.begin(), out_arr.end(), 0) == 24);
+
+    // Spans can be mixed with other arguments requiring conversion
+    sdl::detail::c_call(fill_ints, sdl::span<int>(out_arr).first(2), 0);
+    REQUIRE(out_arr[1] == 0);
+    REQUIRE(out_arr[2] == 3);
+}
+
+TEST_CASE("Output parameters are converted back to C++ types", "[wrapper]") {
+    int i = 0;
+    bool b = false;
+    priority p = priority::verbose;
+
+    sdl::detail::c_call(get_outputs, sdl::detail::out(i),
+                        sdl::detail::out(b), sdl::detail::out(p));
+
+    REQUIRE(i == 42);
+    REQUIRE(b);
+    REQUIRE(p == priority::warn);
+}
+
+TEST_CASE("span provides access to its elements", "[wrapper]") {
+    std::vector<int> vec{1, 2, 3, 4, 5};
+    const sdl::span<int> s = vec;
+
+    REQUIRE(s.data() == vec.data());
+    REQUIRE(s.size() == 5);
+    REQUIRE(s.size_bytes() == 5 * sizeof(int));
+    REQUIRE(s[2] == 3);
+    REQUIRE(s.first(2).size() == 2);
+    REQUIRE(s.last(2)[0] == 4);
+    REQUIRE(s.subspan(1, 3).size() == 3);
+    REQUIRE(s.subspan(1)[0] == 2);
+    REQUIRE(sdl::as_bytes(s).size() == s.size_bytes());
+
+    const sdl::span<const int> cs = s;
+    REQUIRE(std::accumulate(cs.begin(), cs.end(), 0) == 15);
+    REQUIRE(sdl::span<int>{}.empty());
+}
+
+TEST_CASE("c_call overhead", "[.][benchmark][wrapper]") {
+    using std::chrono::steady_clock;
+    using ns = std::chrono::duration<double, std::nano>;
+    constexpr int iterations = 1000000;
+    const char name[] = "com.github.tcbrindle";
+
+    size_t total = 0;
+    auto start = steady_clock::now();
+    for (int i = 0; i < iterations; i++) { total += ::SDL_strlen(name); }
+    const ns raw = (steady_clock::now() - start) / iterations;
+
+    start = steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        total += sdl::detail::c_call(::SDL_strlen, name);
+    }
+    const ns wrapped = (steady_clock::now() - start) / iterations;
+
+    start = steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        total += sdl::detail::c_call(::SDL_strlen, sdl::string(name));
+    }
+    const ns via_string = (steady_clock::now() - start) / iterations;
+
+    start = steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        total += sdl::detail::c_call(::SDL_strlen, sdl::string_view(name));
+    }
+    const ns via_view = (steady_clock::now() - start) / iterations;
+
+    REQUIRE(total == 4u * iterations * (sizeof(name) - 1));
+    WARN("Per call: raw " << raw.count() << " ns, c_call " << wrapped.count()
+                          << " ns, std::string temporary "
+                          << via_string.count() << " ns, string_view "
+                          << via_view.count() << " ns");
+}